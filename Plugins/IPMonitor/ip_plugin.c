@@ -5362,6 +5362,8 @@ services_info_copy(SCDynamicStoreRef session, CFArrayRef service_list)
     CFMutableArrayRef	get_keys;
     CFMutableArrayRef	get_patterns;
     CFDictionaryRef	info;
+    static CFDictionaryRef	last_info;
+    static uint64_t	last_generation;
     CFIndex		s;
 
     count = CFArrayGetCount(service_list);
@@ -5385,9 +5387,15 @@ services_info_copy(SCDynamicStoreRef session, CFArrayRef service_list)
 
     add_interface_link_pattern(get_patterns);
 
-    info = SCDynamicStoreCopyMultiple(session, get_keys, get_patterns);
+    /* only copy the values that have changed since the last time around */
+    info = SCDynamicStoreCopyMultipleIfChanged(session, get_keys, get_patterns,
+					       last_info, &last_generation);
     my_CFRelease(&get_keys);
     my_CFRelease(&get_patterns);
+    if (info != NULL && info != last_info) {
+	my_CFRelease(&last_info);
+	last_info = CFRetain(info);
+    }
     return (info);
 }
 
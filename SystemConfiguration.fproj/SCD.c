@@ -994,6 +994,7 @@ static const struct sc_errmsg {
 	{ kSCStatusFailed,		"Failed!" },
 	{ kSCStatusInvalidArgument,	"Invalid argument" },
 	{ kSCStatusKeyExists,		"Key already defined" },
+	{ kSCStatusLimitExceeded,	"Configuration daemon session limit exceeded" },
 	{ kSCStatusLocked,		"Lock already held" },
 	{ kSCStatusMaxLink,		"Maximum link count exceeded" },
 	{ kSCStatusNeedLock,		"Lock required for this operation" },
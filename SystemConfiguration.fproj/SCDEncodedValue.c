@@ -0,0 +1,804 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+/*
+ * A compact, position-independent, encoding of the property list types
+ * stored in the dynamic store (CFDictionary, CFArray, CFString, CFData,
+ * CFNumber, and CFBoolean).  An encoded value can be read in place (e.g.
+ * directly from a message buffer or a mapped file) without creating any
+ * CF objects.
+ *
+ * Layout (all fields are host-endian uint32_t's, all nodes are 4-byte
+ * aligned and all offsets are relative to the start of the buffer) :
+ *
+ *   header	magic, length (of the buffer), offset of the root node
+ *
+ *   node	type, count, <payload>
+ *
+ *		string		count = length (in bytes), UTF-8 bytes, NUL
+ *		data		count = length (in bytes), bytes
+ *		integer		int64_t
+ *		real		double (Float64)
+ *		boolean		count = 0 (false), 1 (true)
+ *		array		count = # of elements, element offsets
+ *		dictionary	count = # of entries, (key offset, value offset)
+ *				pairs sorted by the key's UTF-8 bytes
+ *
+ * Nodes are written "children first" and strings are uniqued, so a
+ * node only ever references nodes that appear before it in the buffer.
+ * The readers rely on (and check) this to guard against a malformed
+ * buffer referencing itself.  A malformed buffer can still reference the
+ * same node many times (or nest nodes very deeply) so the conversion to a
+ * property list also limits the nesting depth and the number of nodes
+ * visited (each reference takes at least 4 bytes so a valid buffer never
+ * visits more than length / 4 nodes).
+ */
+
+#include <SystemConfiguration/SystemConfiguration.h>
+#include <SystemConfiguration/SCValidation.h>
+#include <SystemConfiguration/SCPrivate.h>
+
+
+#define	kEncodedMagic		0x53434556	/* 'SCEV' */
+#define	kEncodedDepthMax	64		/* max nesting of arrays / dictionaries */
+
+enum {
+	kEncodedString		= 1,
+	kEncodedData,
+	kEncodedInteger,
+	kEncodedReal,
+	kEncodedBoolean,
+	kEncodedArray,
+	kEncodedDictionary,
+};
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	length;
+	uint32_t	root;
+} encodedHeader;
+
+typedef struct {
+	uint32_t	type;
+	uint32_t	count;
+} encodedNode;
+
+typedef struct {
+	uint32_t	key;
+	uint32_t	value;
+} encodedEntry;
+
+
+#pragma mark -
+#pragma mark Encoding
+
+
+typedef struct {
+	CFMutableDataRef	buf;
+	CFMutableDictionaryRef	strings;	/* CFString --> offset (uniqued strings) */
+} encodeContext, *encodeContextRef;
+
+
+static uint32_t
+encodeAppend(encodeContextRef context, const void *bytes, CFIndex length)
+{
+	static const uint8_t	pad[4]	= { 0 };
+	CFIndex			offset;
+
+	offset = CFDataGetLength(context->buf);
+	CFDataAppendBytes(context->buf, bytes, length);
+	if ((length % 4) != 0) {
+		CFDataAppendBytes(context->buf, pad, 4 - (length % 4));
+	}
+
+	return (uint32_t)offset;
+}
+
+
+static uint32_t
+encodeNode(encodeContextRef context, uint32_t type, uint32_t count, const void *payload, CFIndex payloadLen)
+{
+	encodedNode	node	= { type, count };
+	uint32_t	offset;
+
+	offset = encodeAppend(context, &node, sizeof(node));
+	if (payloadLen > 0) {
+		(void) encodeAppend(context, payload, payloadLen);
+	}
+
+	return offset;
+}
+
+
+static uint32_t
+encodeString(encodeContextRef context, CFStringRef str)
+{
+	char		buf_q[256];
+	char		*buf		= buf_q;
+	CFIndex		bufLen;
+	CFIndex		len;
+	uint32_t	offset		= 0;
+	CFNumberRef	num;
+
+	num = CFDictionaryGetValue(context->strings, str);
+	if ((num != NULL) && CFNumberGetValue(num, kCFNumberSInt32Type, &offset)) {
+		/* if we have already encoded this string */
+		return offset;
+	}
+
+	len = CFStringGetLength(str);
+	bufLen = CFStringGetMaximumSizeForEncoding(len, kCFStringEncodingUTF8) + 1;
+	if (bufLen > (CFIndex)sizeof(buf_q)) {
+		buf = CFAllocatorAllocate(NULL, bufLen, 0);
+	}
+	(void) CFStringGetBytes(str, CFRangeMake(0, len), kCFStringEncodingUTF8, 0, FALSE, (UInt8 *)buf, bufLen - 1, &len);
+	buf[len] = '\0';
+
+	offset = encodeNode(context, kEncodedString, (uint32_t)len, buf, len + 1);
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+
+	num = CFNumberCreate(NULL, kCFNumberSInt32Type, &offset);
+	CFDictionarySetValue(context->strings, str, num);
+	CFRelease(num);
+
+	return offset;
+}
+
+
+static Boolean	encodeValue	(encodeContextRef context, CFPropertyListRef value, uint32_t *offset);
+
+
+/*
+ * compareKeys
+ *   compares two [UTF-8] keys by their bytes.  The stored lengths are used
+ *   (rather than the NUL terminator) since a key may include a NUL.
+ */
+static int
+compareKeys(const void *key1, size_t len1, const void *key2, size_t len2)
+{
+	int	result;
+
+	result = memcmp(key1, key2, (len1 < len2) ? len1 : len2);
+	if (result == 0) {
+		result = (len1 < len2) ? -1 : ((len1 > len2) ? 1 : 0);
+	}
+
+	return result;
+}
+
+
+static CFComparisonResult
+compareEntries(const void *val1, const void *val2, void *context)
+{
+	const uint8_t		*bytes	= (const uint8_t *)context;
+	const encodedEntry	*e1	= (const encodedEntry *)val1;
+	const encodedEntry	*e2	= (const encodedEntry *)val2;
+	const encodedNode	*k1	= (const encodedNode *)(const void *)(bytes + e1->key);
+	const encodedNode	*k2	= (const encodedNode *)(const void *)(bytes + e2->key);
+	int			result;
+
+	result = compareKeys(k1 + 1, k1->count, k2 + 1, k2->count);
+	return (result < 0) ? kCFCompareLessThan : ((result > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo);
+}
+
+
+static Boolean
+encodeDictionary(encodeContextRef context, CFDictionaryRef dict, uint32_t *offset)
+{
+	CFIndex		i;
+	CFIndex		n;
+	encodedEntry	*entries;
+	const void *	keys_q[32];
+	const void **	keys		= keys_q;
+	Boolean		ok		= TRUE;
+	const void *	values_q[32];
+	const void **	values		= values_q;
+
+	n = CFDictionaryGetCount(dict);
+	if (n > (CFIndex)(sizeof(keys_q) / sizeof(CFTypeRef))) {
+		keys   = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+		values = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	}
+	CFDictionaryGetKeysAndValues(dict, keys, values);
+
+	entries = CFAllocatorAllocate(NULL, (n > 0) ? n * sizeof(encodedEntry) : 1, 0);
+	for (i = 0; ok && (i < n); i++) {
+		if (!isA_CFString(keys[i])) {
+			/* sorry, only CFString keys */
+			ok = FALSE;
+			break;
+		}
+		entries[i].key = encodeString(context, keys[i]);
+		ok = encodeValue(context, values[i], &entries[i].value);
+	}
+
+	if (ok) {
+		CFQSortArray(entries, n, sizeof(encodedEntry), compareEntries, (void *)CFDataGetBytePtr(context->buf));
+		*offset = encodeNode(context, kEncodedDictionary, (uint32_t)n, entries, n * sizeof(encodedEntry));
+	}
+
+	CFAllocatorDeallocate(NULL, entries);
+	if (keys != keys_q) {
+		CFAllocatorDeallocate(NULL, keys);
+		CFAllocatorDeallocate(NULL, values);
+	}
+	return ok;
+}
+
+
+static Boolean
+encodeArray(encodeContextRef context, CFArrayRef array, uint32_t *offset)
+{
+	uint32_t	*elements;
+	CFIndex		i;
+	CFIndex		n;
+	Boolean		ok		= TRUE;
+
+	n = CFArrayGetCount(array);
+	elements = CFAllocatorAllocate(NULL, (n > 0) ? n * sizeof(uint32_t) : 1, 0);
+	for (i = 0; ok && (i < n); i++) {
+		ok = encodeValue(context, CFArrayGetValueAtIndex(array, i), &elements[i]);
+	}
+
+	if (ok) {
+		*offset = encodeNode(context, kEncodedArray, (uint32_t)n, elements, n * sizeof(uint32_t));
+	}
+
+	CFAllocatorDeallocate(NULL, elements);
+	return ok;
+}
+
+
+static Boolean
+encodeValue(encodeContextRef context, CFPropertyListRef value, uint32_t *offset)
+{
+	CFTypeID	type;
+
+	type = CFGetTypeID(value);
+	if (type == CFStringGetTypeID()) {
+		*offset = encodeString(context, value);
+	} else if (type == CFDictionaryGetTypeID()) {
+		return encodeDictionary(context, value, offset);
+	} else if (type == CFArrayGetTypeID()) {
+		return encodeArray(context, value, offset);
+	} else if (type == CFDataGetTypeID()) {
+		*offset = encodeNode(context,
+				     kEncodedData,
+				     (uint32_t)CFDataGetLength(value),
+				     CFDataGetBytePtr(value),
+				     CFDataGetLength(value));
+	} else if (type == CFNumberGetTypeID()) {
+		if (CFNumberIsFloatType(value)) {
+			Float64	d;
+
+			(void) CFNumberGetValue(value, kCFNumberFloat64Type, &d);
+			*offset = encodeNode(context, kEncodedReal, 0, &d, sizeof(d));
+		} else {
+			int64_t	i;
+
+			(void) CFNumberGetValue(value, kCFNumberSInt64Type, &i);
+			*offset = encodeNode(context, kEncodedInteger, 0, &i, sizeof(i));
+		}
+	} else if (type == CFBooleanGetTypeID()) {
+		*offset = encodeNode(context, kEncodedBoolean, CFBooleanGetValue(value) ? 1 : 0, NULL, 0);
+	} else {
+		/* sorry, not one of the supported types */
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+CFDataRef
+_SCEncodedValueCreateData(CFPropertyListRef value)
+{
+	encodeContext	context;
+	encodedHeader	header	= { kEncodedMagic, 0, 0 };
+	Boolean		ok;
+
+	if (value == NULL) {
+		return NULL;
+	}
+
+	context.buf = CFDataCreateMutable(NULL, 0);
+	context.strings = CFDictionaryCreateMutable(NULL,
+						    0,
+						    &kCFTypeDictionaryKeyCallBacks,
+						    &kCFTypeDictionaryValueCallBacks);
+
+	(void) encodeAppend(&context, &header, sizeof(header));
+	ok = encodeValue(&context, value, &header.root);
+	CFRelease(context.strings);
+	if (!ok || (CFDataGetLength(context.buf) > UINT32_MAX)) {
+		CFRelease(context.buf);
+		return NULL;
+	}
+
+	header.length = (uint32_t)CFDataGetLength(context.buf);
+	CFDataReplaceBytes(context.buf, CFRangeMake(0, sizeof(header)), (const UInt8 *)&header, sizeof(header));
+	return context.buf;
+}
+
+
+#pragma mark -
+#pragma mark Decoding (in place)
+
+
+/*
+ * getNode
+ *   returns the node (and, optionally, the size of its payload) at the
+ *   value's offset, NULL if the node is not within the buffer.
+ */
+static const encodedNode *
+getNode(const _SCEncodedValue *value, uint32_t type, size_t *payloadLen)
+{
+	const encodedNode	*node;
+	size_t			len;
+	size_t			avail;
+
+	if ((value->offset < sizeof(encodedHeader)) ||
+	    ((value->offset % 4) != 0) ||
+	    (((size_t)value->offset + sizeof(encodedNode)) > value->length)) {
+		return NULL;
+	}
+
+	node = (const encodedNode *)(value->bytes + value->offset);
+	if ((type != 0) && (node->type != type)) {
+		return NULL;
+	}
+
+	switch (node->type) {
+		case kEncodedString :
+			len = (size_t)node->count + 1;
+			break;
+		case kEncodedData :
+			len = node->count;
+			break;
+		case kEncodedInteger :
+		case kEncodedReal :
+			len = sizeof(int64_t);
+			break;
+		case kEncodedBoolean :
+			len = 0;
+			break;
+		case kEncodedArray :
+			len = (size_t)node->count * sizeof(uint32_t);
+			break;
+		case kEncodedDictionary :
+			len = (size_t)node->count * sizeof(encodedEntry);
+			break;
+		default :
+			return NULL;
+	}
+
+	avail = value->length - value->offset - sizeof(encodedNode);
+	if (len > avail) {
+		return NULL;
+	}
+
+	if ((node->type == kEncodedString) &&
+	    (value->bytes[value->offset + sizeof(encodedNode) + node->count] != '\0')) {
+		return NULL;
+	}
+
+	if (payloadLen != NULL) {
+		*payloadLen = len;
+	}
+	return node;
+}
+
+
+static Boolean
+getChild(const _SCEncodedValue *parent, uint32_t offset, _SCEncodedValue *child)
+{
+	if (offset >= parent->offset) {
+		/* children always precede their parent */
+		return FALSE;
+	}
+
+	child->bytes  = parent->bytes;
+	child->length = parent->length;
+	child->offset = offset;
+	return (getNode(child, 0, NULL) != NULL);
+}
+
+
+Boolean
+_SCEncodedValueInit(_SCEncodedValue *value, const void *bytes, CFIndex length)
+{
+	encodedHeader	header;
+
+	if ((bytes == NULL) || (length < (CFIndex)sizeof(header)) || (length > UINT32_MAX)) {
+		return FALSE;
+	}
+
+	memcpy(&header, bytes, sizeof(header));
+	if ((header.magic != kEncodedMagic) || (header.length > length)) {
+		return FALSE;
+	}
+
+	value->bytes  = bytes;
+	value->length = header.length;
+	value->offset = header.root;
+	return (getNode(value, 0, NULL) != NULL);
+}
+
+
+CFTypeID
+_SCEncodedValueGetTypeID(const _SCEncodedValue *value)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, 0, NULL);
+	if (node == NULL) {
+		return 0;
+	}
+
+	switch (node->type) {
+		case kEncodedString :		return CFStringGetTypeID();
+		case kEncodedData :		return CFDataGetTypeID();
+		case kEncodedInteger :
+		case kEncodedReal :		return CFNumberGetTypeID();
+		case kEncodedBoolean :		return CFBooleanGetTypeID();
+		case kEncodedArray :		return CFArrayGetTypeID();
+		case kEncodedDictionary :	return CFDictionaryGetTypeID();
+	}
+
+	return 0;
+}
+
+
+CFIndex
+_SCEncodedValueGetCount(const _SCEncodedValue *value)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, 0, NULL);
+	if (node == NULL) {
+		return 0;
+	}
+
+	switch (node->type) {
+		case kEncodedString :
+		case kEncodedData :
+		case kEncodedArray :
+		case kEncodedDictionary :
+			return node->count;
+	}
+
+	return 0;
+}
+
+
+const char *
+_SCEncodedValueGetCString(const _SCEncodedValue *value, CFIndex *length)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, kEncodedString, NULL);
+	if (node == NULL) {
+		return NULL;
+	}
+
+	if (length != NULL) {
+		*length = node->count;
+	}
+	return (const char *)(node + 1);
+}
+
+
+const UInt8 *
+_SCEncodedValueGetBytePtr(const _SCEncodedValue *value, CFIndex *length)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, kEncodedData, NULL);
+	if (node == NULL) {
+		return NULL;
+	}
+
+	if (length != NULL) {
+		*length = node->count;
+	}
+	return (const UInt8 *)(node + 1);
+}
+
+
+Boolean
+_SCEncodedValueGetInt64(const _SCEncodedValue *value, int64_t *i)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, 0, NULL);
+	if (node == NULL) {
+		return FALSE;
+	}
+
+	if (node->type == kEncodedInteger) {
+		memcpy(i, node + 1, sizeof(*i));
+	} else if (node->type == kEncodedReal) {
+		Float64	d;
+
+		memcpy(&d, node + 1, sizeof(d));
+		*i = (int64_t)d;
+	} else {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+Boolean
+_SCEncodedValueGetFloat64(const _SCEncodedValue *value, Float64 *d)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, 0, NULL);
+	if (node == NULL) {
+		return FALSE;
+	}
+
+	if (node->type == kEncodedReal) {
+		memcpy(d, node + 1, sizeof(*d));
+	} else if (node->type == kEncodedInteger) {
+		int64_t	i;
+
+		memcpy(&i, node + 1, sizeof(i));
+		*d = (Float64)i;
+	} else {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+Boolean
+_SCEncodedValueGetBoolean(const _SCEncodedValue *value, Boolean *b)
+{
+	const encodedNode	*node;
+
+	node = getNode(value, kEncodedBoolean, NULL);
+	if (node == NULL) {
+		return FALSE;
+	}
+
+	*b = (node->count != 0);
+	return TRUE;
+}
+
+
+Boolean
+_SCEncodedValueGetArrayValue(const _SCEncodedValue *array, CFIndex index, _SCEncodedValue *value)
+{
+	uint32_t		element;
+	const encodedNode	*node;
+
+	node = getNode(array, kEncodedArray, NULL);
+	if ((node == NULL) || (index < 0) || (index >= node->count)) {
+		return FALSE;
+	}
+
+	memcpy(&element, (const uint32_t *)(node + 1) + index, sizeof(element));
+	return getChild(array, element, value);
+}
+
+
+Boolean
+_SCEncodedValueGetDictionaryEntry(const _SCEncodedValue *dict, CFIndex index, _SCEncodedValue *key, _SCEncodedValue *value)
+{
+	encodedEntry		entry;
+	const encodedNode	*node;
+
+	node = getNode(dict, kEncodedDictionary, NULL);
+	if ((node == NULL) || (index < 0) || (index >= node->count)) {
+		return FALSE;
+	}
+
+	memcpy(&entry, (const encodedEntry *)(node + 1) + index, sizeof(entry));
+	if ((key != NULL) &&
+	    (!getChild(dict, entry.key, key) || (getNode(key, kEncodedString, NULL) == NULL))) {
+		return FALSE;
+	}
+
+	return (value != NULL) ? getChild(dict, entry.value, value) : TRUE;
+}
+
+
+Boolean
+_SCEncodedValueGetDictionaryValue(const _SCEncodedValue *dict, const char *key, _SCEncodedValue *value)
+{
+	CFIndex			high;
+	size_t			keyLen;
+	CFIndex			low	= 0;
+	const encodedNode	*node;
+
+	node = getNode(dict, kEncodedDictionary, NULL);
+	if (node == NULL) {
+		return FALSE;
+	}
+	keyLen = strlen(key);
+
+	/* binary search of the [sorted] keys */
+	high = (CFIndex)node->count - 1;
+	while (low <= high) {
+		CFIndex		mid	= low + ((high - low) / 2);
+		_SCEncodedValue	midKey;
+		const char	*midKeyBytes;
+		CFIndex		midKeyLen;
+		int		result;
+
+		if (!_SCEncodedValueGetDictionaryEntry(dict, mid, &midKey, NULL)) {
+			return FALSE;
+		}
+
+		midKeyBytes = _SCEncodedValueGetCString(&midKey, &midKeyLen);
+		result = compareKeys(key, keyLen, midKeyBytes, midKeyLen);
+		if (result == 0) {
+			return _SCEncodedValueGetDictionaryEntry(dict, mid, NULL, value);
+		} else if (result < 0) {
+			high = mid - 1;
+		} else {
+			low = mid + 1;
+		}
+	}
+
+	return FALSE;
+}
+
+
+static CFPropertyListRef
+copyPropertyList(const _SCEncodedValue *value, int depth, size_t *budget)
+{
+	CFIndex			i;
+	CFIndex			n;
+	const encodedNode	*node;
+	CFPropertyListRef	plist	= NULL;
+
+	if (*budget == 0) {
+		/* if more nodes visited than a valid buffer could reference */
+		return NULL;
+	}
+	(*budget)--;
+
+	node = getNode(value, 0, NULL);
+	if (node == NULL) {
+		return NULL;
+	}
+
+	if (((node->type == kEncodedArray) || (node->type == kEncodedDictionary)) &&
+	    (depth >= kEncodedDepthMax)) {
+		/* if nested too deeply */
+		return NULL;
+	}
+
+	switch (node->type) {
+		case kEncodedString :
+			plist = CFStringCreateWithBytes(NULL,
+							(const UInt8 *)(node + 1),
+							node->count,
+							kCFStringEncodingUTF8,
+							FALSE);
+			break;
+
+		case kEncodedData :
+			plist = CFDataCreate(NULL, (const UInt8 *)(node + 1), node->count);
+			break;
+
+		case kEncodedInteger : {
+			int64_t	num;
+
+			memcpy(&num, node + 1, sizeof(num));
+			plist = CFNumberCreate(NULL, kCFNumberSInt64Type, &num);
+			break;
+		}
+
+		case kEncodedReal : {
+			Float64	num;
+
+			memcpy(&num, node + 1, sizeof(num));
+			plist = CFNumberCreate(NULL, kCFNumberFloat64Type, &num);
+			break;
+		}
+
+		case kEncodedBoolean :
+			plist = CFRetain((node->count != 0) ? kCFBooleanTrue : kCFBooleanFalse);
+			break;
+
+		case kEncodedArray : {
+			CFMutableArrayRef	array;
+
+			n = node->count;
+			array = CFArrayCreateMutable(NULL, n, &kCFTypeArrayCallBacks);
+			for (i = 0; i < n; i++) {
+				_SCEncodedValue		element;
+				CFPropertyListRef	elementPlist;
+
+				if (!_SCEncodedValueGetArrayValue(value, i, &element) ||
+				    ((elementPlist = copyPropertyList(&element, depth + 1, budget)) == NULL)) {
+					CFRelease(array);
+					return NULL;
+				}
+				CFArrayAppendValue(array, elementPlist);
+				CFRelease(elementPlist);
+			}
+			plist = array;
+			break;
+		}
+
+		case kEncodedDictionary : {
+			CFMutableDictionaryRef	dict;
+
+			n = node->count;
+			dict = CFDictionaryCreateMutable(NULL,
+							 n,
+							 &kCFTypeDictionaryKeyCallBacks,
+							 &kCFTypeDictionaryValueCallBacks);
+			for (i = 0; i < n; i++) {
+				_SCEncodedValue		entryKey;
+				CFStringRef		entryKeyPlist;
+				_SCEncodedValue		entryValue;
+				CFPropertyListRef	entryValuePlist;
+
+				if (!_SCEncodedValueGetDictionaryEntry(value, i, &entryKey, &entryValue) ||
+				    ((entryKeyPlist = copyPropertyList(&entryKey, depth + 1, budget)) == NULL)) {
+					CFRelease(dict);
+					return NULL;
+				}
+				entryValuePlist = copyPropertyList(&entryValue, depth + 1, budget);
+				if (entryValuePlist == NULL) {
+					CFRelease(entryKeyPlist);
+					CFRelease(dict);
+					return NULL;
+				}
+				CFDictionarySetValue(dict, entryKeyPlist, entryValuePlist);
+				CFRelease(entryKeyPlist);
+				CFRelease(entryValuePlist);
+			}
+			plist = dict;
+			break;
+		}
+	}
+
+	return plist;
+}
+
+
+CFPropertyListRef
+_SCEncodedValueCopyPropertyList(const _SCEncodedValue *value)
+{
+	size_t	budget;
+
+	budget = (value->length / sizeof(uint32_t)) + 1;
+	return copyPropertyList(value, 0, &budget);
+}
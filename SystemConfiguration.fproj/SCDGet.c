@@ -135,6 +135,293 @@ SCDynamicStoreCopyMultiple(SCDynamicStoreRef	store,
 }
 
 
+CFDictionaryRef
+SCDynamicStoreCopyMultipleWithGeneration(SCDynamicStoreRef	store,
+					 CFArrayRef		keys,
+					 CFArrayRef		patterns,
+					 uint64_t		asOf,
+					 uint64_t		*generation)
+{
+	SCDynamicStorePrivateRef	storePrivate;
+	kern_return_t			status;
+	CFDataRef			xmlKeys		= NULL;	/* keys (XML serialized) */
+	xmlData_t			myKeysRef	= NULL;	/* keys (serialized) */
+	CFIndex				myKeysLen	= 0;
+	CFDataRef			xmlPatterns	= NULL;	/* patterns (XML serialized) */
+	xmlData_t			myPatternsRef	= NULL;	/* patterns (serialized) */
+	CFIndex				myPatternsLen	= 0;
+	xmlDataOut_t			xmlDictRef	= NULL;	/* dict (serialized) */
+	mach_msg_type_number_t		xmlDictLen	= 0;
+	CFDictionaryRef			dict		= NULL;	/* dict (un-serialized) */
+	CFDictionaryRef			expDict		= NULL;	/* dict (un-serialized / expanded) */
+	uint64_t			myGeneration	= 0;
+	int				sc_status;
+
+	if (store == NULL) {
+		store = __SCDynamicStoreNullSession();
+		if (store == NULL) {
+			/* sorry, you must provide a session */
+			_SCErrorSet(kSCStatusNoStoreSession);
+			return NULL;
+		}
+	}
+
+	storePrivate = (SCDynamicStorePrivateRef)store;
+	if (storePrivate->server == MACH_PORT_NULL) {
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return NULL;	/* you must have an open session to play */
+	}
+
+	/* serialize the keys */
+	if (keys != NULL) {
+		if (!_SCSerialize(keys, &xmlKeys, (void **)&myKeysRef, &myKeysLen)) {
+			_SCErrorSet(kSCStatusFailed);
+			return NULL;
+		}
+	}
+
+	/* serialize the patterns */
+	if (patterns != NULL) {
+		if (!_SCSerialize(patterns, &xmlPatterns, (void **)&myPatternsRef, &myPatternsLen)) {
+			if (xmlKeys != NULL) CFRelease(xmlKeys);
+			_SCErrorSet(kSCStatusFailed);
+			return NULL;
+		}
+	}
+
+    retry :
+
+	/* send the keys and patterns, fetch the associated result from the server */
+	status = configget_m_gen(storePrivate->server,
+				 myKeysRef,
+				 (mach_msg_type_number_t)myKeysLen,
+				 myPatternsRef,
+				 (mach_msg_type_number_t)myPatternsLen,
+				 asOf,
+				 &xmlDictRef,
+				 &xmlDictLen,
+				 &myGeneration,
+				 (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreCopyMultipleWithGeneration configget_m_gen()")) {
+		goto retry;
+	}
+
+	/* clean up */
+	if (xmlKeys != NULL)		CFRelease(xmlKeys);
+	if (xmlPatterns != NULL)	CFRelease(xmlPatterns);
+
+	if (sc_status != kSCStatusOK) {
+		if (xmlDictRef != NULL) {
+			(void) vm_deallocate(mach_task_self(), (vm_address_t)xmlDictRef, xmlDictLen);
+		}
+		_SCErrorSet(sc_status);
+		return NULL;
+	}
+
+	/* un-serialize the dictionary */
+	if (!_SCUnserialize((CFPropertyListRef *)&dict, NULL, xmlDictRef, xmlDictLen)) {
+		_SCErrorSet(kSCStatusFailed);
+		return NULL;
+	}
+
+	expDict = _SCUnserializeMultiple(dict);
+	CFRelease(dict);
+
+	if (generation != NULL) {
+		*generation = myGeneration;
+	}
+
+	return expDict;
+}
+
+
+CFDictionaryRef
+SCDynamicStoreCopyMultipleIfChanged(SCDynamicStoreRef	store,
+				    CFArrayRef		keys,
+				    CFArrayRef		patterns,
+				    CFDictionaryRef	previous,
+				    uint64_t		*generation)
+{
+	SCDynamicStorePrivateRef	storePrivate;
+	kern_return_t			status;
+	CFDataRef			xmlKeys		= NULL;	/* keys (XML serialized) */
+	xmlData_t			myKeysRef	= NULL;	/* keys (serialized) */
+	CFIndex				myKeysLen	= 0;
+	CFDataRef			xmlPatterns	= NULL;	/* patterns (XML serialized) */
+	xmlData_t			myPatternsRef	= NULL;	/* patterns (serialized) */
+	CFIndex				myPatternsLen	= 0;
+	xmlDataOut_t			xmlDictRef	= NULL;	/* dict (serialized) */
+	mach_msg_type_number_t		xmlDictLen	= 0;
+	xmlDataOut_t			xmlUnchangedRef	= NULL;	/* unchanged keys (serialized) */
+	mach_msg_type_number_t		xmlUnchangedLen	= 0;
+	CFDictionaryRef			dict		= NULL;	/* dict (un-serialized) */
+	CFDictionaryRef			expDict		= NULL;	/* dict (un-serialized / expanded) */
+	CFArrayRef			unchanged	= NULL;	/* unchanged keys (un-serialized) */
+	CFMutableDictionaryRef		newDict;
+	CFIndex				i;
+	CFIndex				n;
+	uint64_t			myGeneration	= 0;
+	uint64_t			since;
+	int				sc_status;
+
+	if (generation == NULL) {
+		_SCErrorSet(kSCStatusInvalidArgument);
+		return NULL;
+	}
+
+	if (store == NULL) {
+		store = __SCDynamicStoreNullSession();
+		if (store == NULL) {
+			/* sorry, you must provide a session */
+			_SCErrorSet(kSCStatusNoStoreSession);
+			return NULL;
+		}
+	}
+
+	storePrivate = (SCDynamicStorePrivateRef)store;
+	if (storePrivate->server == MACH_PORT_NULL) {
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return NULL;	/* you must have an open session to play */
+	}
+
+	/* serialize the keys */
+	if (keys != NULL) {
+		if (!_SCSerialize(keys, &xmlKeys, (void **)&myKeysRef, &myKeysLen)) {
+			_SCErrorSet(kSCStatusFailed);
+			return NULL;
+		}
+	}
+
+	/* serialize the patterns */
+	if (patterns != NULL) {
+		if (!_SCSerialize(patterns, &xmlPatterns, (void **)&myPatternsRef, &myPatternsLen)) {
+			if (xmlKeys != NULL) CFRelease(xmlKeys);
+			_SCErrorSet(kSCStatusFailed);
+			return NULL;
+		}
+	}
+
+	/* only ask for the values that have changed since we last asked */
+	since = (previous != NULL) ? *generation : 0;
+
+    retry :
+
+	/* send the keys and patterns, fetch the associated result from the server */
+	status = configget_m_since(storePrivate->server,
+				   myKeysRef,
+				   (mach_msg_type_number_t)myKeysLen,
+				   myPatternsRef,
+				   (mach_msg_type_number_t)myPatternsLen,
+				   since,
+				   &xmlDictRef,
+				   &xmlDictLen,
+				   &xmlUnchangedRef,
+				   &xmlUnchangedLen,
+				   &myGeneration,
+				   (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreCopyMultipleIfChanged configget_m_since()")) {
+		goto retry;
+	}
+
+	if (sc_status != kSCStatusOK) {
+		if (xmlDictRef != NULL) {
+			(void) vm_deallocate(mach_task_self(), (vm_address_t)xmlDictRef, xmlDictLen);
+		}
+		if (xmlUnchangedRef != NULL) {
+			(void) vm_deallocate(mach_task_self(), (vm_address_t)xmlUnchangedRef, xmlUnchangedLen);
+		}
+		goto done;
+	}
+
+	/* un-serialize the dictionary of changed values */
+	if (!_SCUnserialize((CFPropertyListRef *)&dict, NULL, xmlDictRef, xmlDictLen)) {
+		if (xmlUnchangedRef != NULL) {
+			(void) vm_deallocate(mach_task_self(), (vm_address_t)xmlUnchangedRef, xmlUnchangedLen);
+		}
+		sc_status = kSCStatusFailed;
+		goto done;
+	}
+
+	expDict = _SCUnserializeMultiple(dict);
+	CFRelease(dict);
+
+	/* un-serialize the list of unchanged keys */
+	if (!_SCUnserialize((CFPropertyListRef *)&unchanged, NULL, xmlUnchangedRef, xmlUnchangedLen)) {
+		CFRelease(expDict);
+		expDict = NULL;
+		sc_status = kSCStatusFailed;
+		goto done;
+	}
+
+	n = CFArrayGetCount(unchanged);
+	for (i = 0; i < n; i++) {
+		CFStringRef	key	= CFArrayGetValueAtIndex(unchanged, i);
+
+		if ((previous == NULL) || !CFDictionaryContainsKey(previous, key)) {
+			/*
+			 * the previous values do not match the keys/patterns
+			 * (or generation) so we fall back to fetching all of
+			 * the values.
+			 */
+			CFRelease(expDict);
+			expDict = NULL;
+			CFRelease(unchanged);
+			unchanged = NULL;
+			xmlDictRef = NULL;
+			xmlUnchangedRef = NULL;
+			since = 0;
+			goto retry;
+		}
+	}
+
+	if (n == 0) {
+		/* if everything has been added or changed */
+		goto done;
+	}
+
+	if ((CFDictionaryGetCount(expDict) == 0) &&
+	    (CFDictionaryGetCount(previous) == n)) {
+		/* if nothing has been added, changed, or removed */
+		CFRelease(expDict);
+		expDict = CFRetain(previous);
+		goto done;
+	}
+
+	/* merge the changed values with the unchanged [previous] values */
+	newDict = CFDictionaryCreateMutableCopy(NULL, 0, expDict);
+	CFRelease(expDict);
+	for (i = 0; i < n; i++) {
+		CFStringRef	key	= CFArrayGetValueAtIndex(unchanged, i);
+
+		CFDictionarySetValue(newDict, key, CFDictionaryGetValue(previous, key));
+	}
+	expDict = newDict;
+
+    done :
+
+	/* clean up */
+	if (xmlKeys != NULL)		CFRelease(xmlKeys);
+	if (xmlPatterns != NULL)	CFRelease(xmlPatterns);
+	if (unchanged != NULL)		CFRelease(unchanged);
+
+	if (sc_status != kSCStatusOK) {
+		_SCErrorSet(sc_status);
+		return NULL;
+	}
+
+	*generation = myGeneration;
+	return expDict;
+}
+
+
 CFPropertyListRef
 SCDynamicStoreCopyValue(SCDynamicStoreRef store, CFStringRef key)
 {
@@ -67,6 +67,9 @@ SCDynamicStoreNotifyCancel(SCDynamicStoreRef store)
 			break;
 	}
 
+	/* unmap any [shared] notification ring (file descriptor notifications) */
+	__SCDynamicStoreNotifyRingUnmap(store);
+
 	if (storePrivate->server == MACH_PORT_NULL) {
 		/* sorry, you must have an open session to play */
 		sc_status = kSCStatusNoStoreServer;
@@ -39,8 +39,14 @@
 #include "SCDynamicStoreInternal.h"
 #include "config.h"		/* MiG generated file */
 
+/*
+ * __SCDynamicStoreCopyNotifiedKeys
+ *   fetches the changed keys from the server (rather than from the
+ *   [shared] notification ring).
+ */
+__private_extern__
 CFArrayRef
-SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store)
+__SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store)
 {
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
 	kern_return_t			status;
@@ -49,17 +55,6 @@ SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store)
 	int				sc_status;
 	CFArrayRef			allKeys;
 
-	if (store == NULL) {
-		/* sorry, you must provide a session */
-		_SCErrorSet(kSCStatusNoStoreSession);
-		return NULL;
-	}
-
-	if (storePrivate->server == MACH_PORT_NULL) {
-		_SCErrorSet(kSCStatusNoStoreServer);
-		return NULL;
-	}
-
     retry :
 
 	/* send the key & fetch the associated data from the server */
@@ -91,3 +86,49 @@ SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store)
 
 	return allKeys;
 }
+
+
+CFArrayRef
+SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	if (store == NULL) {
+		/* sorry, you must provide a session */
+		_SCErrorSet(kSCStatusNoStoreSession);
+		return NULL;
+	}
+
+	if (storePrivate->server == MACH_PORT_NULL) {
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return NULL;
+	}
+
+	if (storePrivate->notifyRing != NULL) {
+		/* if the changes are delivered via the [shared] notification ring */
+		return __SCDynamicStoreNotifyRingCopyChangedKeys(store);
+	}
+
+	return __SCDynamicStoreCopyNotifiedKeys(store);
+}
+
+
+CFDictionaryRef
+SCDynamicStoreCopyNotifiedValues(SCDynamicStoreRef store)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	if (store == NULL) {
+		/* sorry, you must provide a session */
+		_SCErrorSet(kSCStatusNoStoreSession);
+		return NULL;
+	}
+
+	if (storePrivate->notifiedValues == NULL) {
+		/* if no values were delivered with the notification */
+		_SCErrorSet(kSCStatusNoKey);
+		return NULL;
+	}
+
+	return CFRetain(storePrivate->notifiedValues);
+}
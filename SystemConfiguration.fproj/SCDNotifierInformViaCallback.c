@@ -37,6 +37,7 @@
 #include <dispatch/dispatch.h>
 #include <mach/mach.h>
 #include <mach/mach_error.h>
+#include <libkern/OSAtomic.h>
 
 #include <SystemConfiguration/SystemConfiguration.h>
 #include <SystemConfiguration/SCPrivate.h>
@@ -47,6 +48,8 @@
 #define HAVE_MACHPORT_GUARDS
 #endif
 
+#define	N_QUICK	32
+
 
 static CFStringRef
 notifyMPCopyDescription(const void *info)
@@ -60,6 +63,323 @@ notifyMPCopyDescription(const void *info)
 }
 
 
+/*
+ * notifyValuesReceive
+ *   collects any changed keys/values delivered with a notification
+ *   message (see kSCDynamicStoreNotificationValues).  Any other message
+ *   means that the changed keys must be fetched from the server.
+ */
+static void
+notifyValuesReceive(SCDynamicStorePrivateRef storePrivate, mach_msg_header_t *hdr)
+{
+	CFIndex				i;
+	CFIndex				n;
+	__SCDynamicStoreNotifyValuesMsg	*msg		= (__SCDynamicStoreNotifyValuesMsg *)hdr;
+	const void *			keys_q[N_QUICK];
+	const void **			keys		= keys_q;
+	CFDictionaryRef			values		= NULL;
+	const void *			values_q[N_QUICK];
+	const void **			xmlValues	= values_q;
+
+	if (!storePrivate->notifyValues) {
+		return;
+	}
+
+	if (((hdr->msgh_bits & MACH_MSGH_BITS_COMPLEX) == 0) ||
+	    (hdr->msgh_size < sizeof(__SCDynamicStoreNotifyValuesMsg)) ||
+	    (msg->body.msgh_descriptor_count != 1) ||
+	    (msg->values.type != MACH_MSG_OOL_DESCRIPTOR)) {
+		/* if just a notification */
+		if ((hdr->msgh_bits & MACH_MSGH_BITS_COMPLEX) != 0) {
+			mach_msg_destroy(hdr);
+		}
+		storePrivate->notifyKeysPending = TRUE;
+		return;
+	}
+
+	/* un-serialize the changed keys/values */
+	if (!_SCUnserialize((CFPropertyListRef *)&values, NULL, msg->values.address, msg->values.size) ||
+	    !isA_CFDictionary(values)) {
+		if (values != NULL) CFRelease(values);
+		storePrivate->notifyKeysPending = TRUE;
+		return;
+	}
+
+	if (storePrivate->notifyValuesPending == NULL) {
+		storePrivate->notifyValuesPending = CFDictionaryCreateMutable(NULL,
+									      0,
+									      &kCFTypeDictionaryKeyCallBacks,
+									      &kCFTypeDictionaryValueCallBacks);
+	}
+
+	n = CFDictionaryGetCount(values);
+	if (n > (CFIndex)(sizeof(keys_q) / sizeof(CFTypeRef))) {
+		keys      = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+		xmlValues = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	}
+	CFDictionaryGetKeysAndValues(values, keys, xmlValues);
+	for (i = 0; i < n; i++) {
+		CFPropertyListRef	value	= NULL;
+
+		if (!isA_CFData(xmlValues[i])) {
+			continue;
+		}
+
+		if (CFDataGetLength(xmlValues[i]) == 0) {
+			/* if the key was removed */
+			CFDictionarySetValue(storePrivate->notifyValuesPending, keys[i], kCFNull);
+		} else if (_SCUnserialize(&value, xmlValues[i], NULL, 0)) {
+			CFDictionarySetValue(storePrivate->notifyValuesPending, keys[i], value);
+			CFRelease(value);
+		} else {
+			/* if we could not use the value, have the client fetch it */
+			CFDictionaryRemoveValue(storePrivate->notifyValuesPending, keys[i]);
+			storePrivate->notifyKeysPending = TRUE;
+		}
+	}
+	if (keys != keys_q) {
+		CFAllocatorDeallocate(NULL, keys);
+		CFAllocatorDeallocate(NULL, xmlValues);
+	}
+	CFRelease(values);
+
+	return;
+}
+
+
+/*
+ * notifyValuesCopyChangedKeys
+ *   returns the keys which have changed, only asking the server if
+ *   the changed values were not [all] delivered with the notification(s).
+ */
+static CFArrayRef
+notifyValuesCopyChangedKeys(SCDynamicStoreRef store)
+{
+	CFMutableArrayRef		changedKeys;
+	CFIndex				i;
+	CFIndex				n;
+	const void *			keys_q[N_QUICK];
+	const void **			keys		= keys_q;
+	CFArrayRef			notifiedKeys	= NULL;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	CFMutableDictionaryRef		values;
+
+	/* release the values delivered with the previous callback */
+	if (storePrivate->notifiedValues != NULL) {
+		CFRelease(storePrivate->notifiedValues);
+		storePrivate->notifiedValues = NULL;
+	}
+
+	values = storePrivate->notifyValuesPending;
+	storePrivate->notifyValuesPending = NULL;
+
+	if ((values == NULL) || storePrivate->notifyKeysPending) {
+		storePrivate->notifyKeysPending = FALSE;
+		notifiedKeys = SCDynamicStoreCopyNotifiedKeys(store);
+		if (values == NULL) {
+			return notifiedKeys;
+		}
+	}
+
+	/* the changed keys are those delivered with values (and any others) */
+	changedKeys = (notifiedKeys != NULL)
+		? CFArrayCreateMutableCopy(NULL, 0, notifiedKeys)
+		: CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	n = CFDictionaryGetCount(values);
+	if (n > (CFIndex)(sizeof(keys_q) / sizeof(CFTypeRef)))
+		keys = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	CFDictionaryGetKeysAndValues(values, keys, NULL);
+	for (i = 0; i < n; i++) {
+		if ((notifiedKeys == NULL) ||
+		    !CFArrayContainsValue(notifiedKeys, CFRangeMake(0, CFArrayGetCount(notifiedKeys)), keys[i])) {
+			CFArrayAppendValue(changedKeys, keys[i]);
+		}
+	}
+	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
+	if (notifiedKeys != NULL) CFRelease(notifiedKeys);
+
+	storePrivate->notifiedValues = values;
+	return changedKeys;
+}
+
+
+/*
+ * __SCDynamicStoreNotifyRingMap
+ *   asks the server for the [shared] notification ring and maps it.
+ *   The session must be notified via a mach port or a file descriptor.
+ */
+__private_extern__
+void
+__SCDynamicStoreNotifyRingMap(SCDynamicStoreRef store)
+{
+	vm_address_t			addr		= 0;
+	kern_return_t			kr;
+	mach_port_t			ring		= MACH_PORT_NULL;
+	int				sc_status;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+    retry :
+
+	kr = notifyviaring(storePrivate->server, &ring, (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     kr,
+						     &sc_status,
+						     "__SCDynamicStoreNotifyRingMap notifyviaring()")) {
+		goto retry;
+	}
+
+	if ((kr != KERN_SUCCESS) || (sc_status != kSCStatusOK)) {
+		/* continue with the usual notifications */
+		return;
+	}
+
+	kr = vm_map(mach_task_self(),
+		    &addr,
+		    sizeof(struct __SCDynamicStoreNotifyRing),
+		    0,
+		    VM_FLAGS_ANYWHERE,
+		    ring,
+		    0,
+		    FALSE,
+		    VM_PROT_READ|VM_PROT_WRITE,
+		    VM_PROT_READ|VM_PROT_WRITE,
+		    VM_INHERIT_NONE);
+	(void) mach_port_deallocate(mach_task_self(), ring);
+	if (kr != KERN_SUCCESS) {
+		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreNotifyRingMap vm_map() failed: %s"), mach_error_string(kr));
+		return;
+	}
+
+	storePrivate->notifyRing       = (struct __SCDynamicStoreNotifyRing *)addr;
+	storePrivate->notifyRingOffset = 0;
+	return;
+}
+
+
+__private_extern__
+void
+__SCDynamicStoreNotifyRingUnmap(SCDynamicStoreRef store)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	if (storePrivate->notifyRing != NULL) {
+		(void) vm_deallocate(mach_task_self(),
+				     (vm_address_t)storePrivate->notifyRing,
+				     sizeof(struct __SCDynamicStoreNotifyRing));
+		storePrivate->notifyRing       = NULL;
+		storePrivate->notifyRingOffset = 0;
+	}
+
+	return;
+}
+
+
+/*
+ * __SCDynamicStoreNotifyRingCopyChangedKeys
+ *   drains the [shared] notification ring, returning the keys which have
+ *   changed.  The server is only asked for the changed keys if the ring
+ *   overflowed.
+ */
+__private_extern__
+CFArrayRef
+__SCDynamicStoreNotifyRingCopyChangedKeys(SCDynamicStoreRef store)
+{
+	CFMutableSetRef			changed;
+	CFArrayRef			changedKeys;
+	uint64_t			head;
+	CFIndex				n;
+	const void *			keys_q[N_QUICK];
+	const void **			keys		= keys_q;
+	Boolean				overflow	= FALSE;
+	struct __SCDynamicStoreNotifyRing	*ring;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	changed = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
+	ring = storePrivate->notifyRing;
+	head = storePrivate->notifyRingOffset;
+	while (TRUE) {
+		uint64_t	tail;
+
+		tail = ring->tail;
+		OSMemoryBarrier();
+		if ((tail - head) > NOTIFY_RING_DATA_SIZE) {
+			/* if the ring is not usable */
+			overflow = TRUE;
+			break;
+		}
+
+		while (head != tail) {
+			uint32_t			len;
+			size_t				pos	= (size_t)(head & (NOTIFY_RING_DATA_SIZE - 1));
+			__SCDynamicStoreNotifyRecord	*rec	= (__SCDynamicStoreNotifyRecord *)(void *)&ring->records[pos];
+
+			len = rec->length;
+			if ((len < sizeof(__SCDynamicStoreNotifyRecord)) ||
+			    ((len % NOTIFY_RING_RECORD_ALIGN) != 0) ||
+			    (len > NOTIFY_RING_DATA_SIZE - pos) ||
+			    (len > tail - head)) {
+				/* if the record is not valid, skip the rest */
+				overflow = TRUE;
+				head = tail;
+				break;
+			}
+
+			if ((rec->op != kNotifyRingOpPad) &&
+			    (rec->keyLen <= len - sizeof(__SCDynamicStoreNotifyRecord))) {
+				CFStringRef	key;
+
+				key = CFStringCreateWithBytes(NULL,
+							      rec->key,
+							      rec->keyLen,
+							      kCFStringEncodingUTF8,
+							      FALSE);
+				if (key != NULL) {
+					CFSetAddValue(changed, key);
+					CFRelease(key);
+				}
+			}
+
+			head += len;
+		}
+
+		/* release the consumed records, checking for any new ones */
+		OSMemoryBarrier();
+		ring->head = head;
+		OSMemoryBarrier();
+		if (ring->tail == head) {
+			break;
+		}
+	}
+	storePrivate->notifyRingOffset = head;
+
+	if ((OSAtomicAnd32OrigBarrier(0, &ring->overflow) != 0) || overflow) {
+		CFIndex		i;
+		CFArrayRef	notifiedKeys;
+
+		/* if some of the changes did not fit */
+		notifiedKeys = __SCDynamicStoreCopyNotifiedKeys(store);
+		if (notifiedKeys != NULL) {
+			n = CFArrayGetCount(notifiedKeys);
+			for (i = 0; i < n; i++) {
+				CFSetAddValue(changed, CFArrayGetValueAtIndex(notifiedKeys, i));
+			}
+			CFRelease(notifiedKeys);
+		}
+	}
+
+	n = CFSetGetCount(changed);
+	if (n > (CFIndex)(sizeof(keys_q) / sizeof(CFTypeRef)))
+		keys = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	CFSetGetValues(changed, keys);
+	changedKeys = CFArrayCreate(NULL, keys, n, &kCFTypeArrayCallBacks);
+	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
+	CFRelease(changed);
+
+	return changedKeys;
+}
+
+
 static void
 rlsCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
 {
@@ -84,6 +404,9 @@ rlsCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
 		(void)__SCDynamicStoreReconnectNotifications(store);
 	}
 
+	/* collect any changed values delivered with the notification */
+	notifyValuesReceive(storePrivate, &buf->not_header);
+
 	/* signal the real runloop source */
 	if (storePrivate->rls != NULL) {
 		CFRunLoopSourceSignal(storePrivate->rls);
@@ -228,6 +551,11 @@ rlsSchedule(void *info, CFRunLoopRef rl, CFStringRef mode)
 									   &context);
 		storePrivate->rlsNotifyRLS = CFMachPortCreateRunLoopSource(NULL, storePrivate->rlsNotifyPort, 0);
 
+		if (storePrivate->useNotifyRing) {
+			/* deliver the changed keys via the [shared] notification ring */
+			__SCDynamicStoreNotifyRingMap(store);
+		}
+
 		storePrivate->rlList = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
 	}
 
@@ -320,6 +648,9 @@ rlsCancel(void *info, CFRunLoopRef rl, CFStringRef mode)
 #endif	// HAVE_MACHPORT_GUARDS
 		}
 
+		/* and the [shared] notification ring */
+		__SCDynamicStoreNotifyRingUnmap(store);
+
 		if (storePrivate->server != MACH_PORT_NULL) {
 			kr = notifycancel(storePrivate->server, (int *)&sc_status);
 
@@ -352,7 +683,12 @@ rlsPerform(void *info)
 	SCLog(_sc_verbose, LOG_DEBUG, CFSTR("  executing notification function"));
 #endif	/* DEBUG */
 
-	changedKeys = SCDynamicStoreCopyNotifiedKeys(store);
+	if ((storePrivate->notifyRing == NULL) && storePrivate->notifyValues) {
+		changedKeys = notifyValuesCopyChangedKeys(store);
+	} else {
+		/* (drains the [shared] notification ring, if mapped) */
+		changedKeys = SCDynamicStoreCopyNotifiedKeys(store);
+	}
 	if (storePrivate->disconnectForceCallBack) {
 		storePrivate->disconnectForceCallBack = FALSE;
 		if (changedKeys == NULL) {
@@ -617,9 +953,10 @@ SCDynamicStoreSetDispatchQueue(SCDynamicStoreRef store, dispatch_queue_t queue)
 		kern_return_t	kr;
 		mach_msg_id_t	msgid;
 		union {
-			u_int8_t			buf[sizeof(mach_msg_empty_t) + MAX_TRAILER_SIZE];
+			u_int8_t			buf[sizeof(__SCDynamicStoreNotifyValuesMsg) + MAX_TRAILER_SIZE];
 			mach_msg_empty_rcv_t		msg;
 			mach_no_senders_notification_t	no_senders;
+			__SCDynamicStoreNotifyValuesMsg	values;
 		} notify_msg;
 
 		kr = mach_msg(&notify_msg.msg.header,	// msg
@@ -638,6 +975,9 @@ SCDynamicStoreSetDispatchQueue(SCDynamicStoreRef store, dispatch_queue_t queue)
 
 		msgid = notify_msg.msg.header.msgh_id;
 
+		// collect any changed values delivered with the notification
+		notifyValuesReceive(storePrivate, &notify_msg.msg.header);
+
 		CFRetain(store);
 		dispatch_group_async(group, queue, ^{
 			if (msgid == MACH_NOTIFY_NO_SENDERS) {
@@ -161,5 +161,14 @@ SCDynamicStoreNotifyFileDescriptor(SCDynamicStoreRef	store,
 	/* set notifier active */
 	storePrivate->notifyStatus = Using_NotifierInformViaFD;
 
+	if (storePrivate->useNotifyRing) {
+		/*
+		 * deliver the changed keys (see SCDynamicStoreCopyNotifiedKeys)
+		 * via the [shared] notification ring; the identifier is only
+		 * written when the ring transitions from empty.
+		 */
+		__SCDynamicStoreNotifyRingMap(store);
+	}
+
 	return TRUE;
 }
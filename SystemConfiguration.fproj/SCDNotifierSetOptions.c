@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+#include <mach/mach.h>
+#include <mach/mach_error.h>
+
+#include <SystemConfiguration/SystemConfiguration.h>
+#include <SystemConfiguration/SCPrivate.h>
+#include "SCDynamicStoreInternal.h"
+#include "config.h"		/* MiG generated file */
+
+
+const CFStringRef	kSCDynamicStoreNotificationCoalesce	= CFSTR("NotificationCoalesce");
+const CFStringRef	kSCDynamicStoreNotificationRateLimit	= CFSTR("NotificationRateLimit");
+const CFStringRef	kSCDynamicStoreNotificationRateBurst	= CFSTR("NotificationRateBurst");
+
+
+Boolean
+SCDynamicStoreSetNotificationOptions(SCDynamicStoreRef	store,
+				     CFDictionaryRef	options)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	kern_return_t			status;
+	CFDataRef			xmlOptions	= NULL;	/* options (XML serialized) */
+	xmlData_t			myOptionsRef	= NULL;	/* options (serialized) */
+	CFIndex				myOptionsLen	= 0;
+	int				sc_status;
+	CFDictionaryRef			tmp;
+
+	if (store == NULL) {
+		/* sorry, you must provide a session */
+		_SCErrorSet(kSCStatusNoStoreSession);
+		return FALSE;
+	}
+
+	if (storePrivate->server == MACH_PORT_NULL) {
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return FALSE;	/* you must have an open session to play */
+	}
+
+	/* serialize the options */
+	if (options != NULL) {
+		if (!_SCSerialize(options, &xmlOptions, (void **)&myOptionsRef, &myOptionsLen)) {
+			_SCErrorSet(kSCStatusFailed);
+			return FALSE;
+		}
+	}
+
+    retry :
+
+	/* send the options, fetch the associated result from the server */
+	status = notifyoptions(storePrivate->server,
+			       myOptionsRef,
+			       (mach_msg_type_number_t)myOptionsLen,
+			       (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreSetNotificationOptions notifyoptions()")) {
+		goto retry;
+	}
+
+	/* clean up */
+	if (xmlOptions != NULL)	CFRelease(xmlOptions);
+
+	if (sc_status != kSCStatusOK) {
+		_SCErrorSet(sc_status);
+		return FALSE;
+	}
+
+	/* in case we need to re-connect, save the options */
+	tmp = (options != NULL) ? CFDictionaryCreateCopy(NULL, options) : NULL;
+	if (storePrivate->notifyOptions != NULL) CFRelease(storePrivate->notifyOptions);
+	storePrivate->notifyOptions = tmp;
+
+	return TRUE;
+}
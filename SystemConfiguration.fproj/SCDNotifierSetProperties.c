@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+#include <mach/mach.h>
+#include <mach/mach_error.h>
+
+#include <SystemConfiguration/SystemConfiguration.h>
+#include <SystemConfiguration/SCPrivate.h>
+#include "SCDynamicStoreInternal.h"
+#include "config.h"		/* MiG generated file */
+
+
+
+Boolean
+SCDynamicStoreSetWatchedKeyProperties(SCDynamicStoreRef	store,
+				      CFStringRef	key,
+				      Boolean		isRegex,
+				      CFArrayRef	properties)
+{
+	CFMutableDictionaryRef		*keyPropertiesP;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	kern_return_t			status;
+	CFDataRef			utfKey;			/* serialized key */
+	xmlData_t			myKeyRef;
+	CFIndex				myKeyLen;
+	CFDataRef			xmlProperties	= NULL;	/* properties (XML serialized) */
+	xmlData_t			myPropertiesRef	= NULL;	/* properties (serialized) */
+	CFIndex				myPropertiesLen	= 0;
+	int				sc_status;
+
+	if (store == NULL) {
+		/* sorry, you must provide a session */
+		_SCErrorSet(kSCStatusNoStoreSession);
+		return FALSE;
+	}
+
+	if (storePrivate->server == MACH_PORT_NULL) {
+		/* sorry, you must have an open session to play */
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return FALSE;
+	}
+
+	/* serialize the key */
+	if (!_SCSerializeString(key, &utfKey, (void **)&myKeyRef, &myKeyLen)) {
+		_SCErrorSet(kSCStatusFailed);
+		return FALSE;
+	}
+
+	/* serialize the properties */
+	if (properties != NULL) {
+		if (!_SCSerialize(properties, &xmlProperties, (void **)&myPropertiesRef, &myPropertiesLen)) {
+			CFRelease(utfKey);
+			_SCErrorSet(kSCStatusFailed);
+			return FALSE;
+		}
+	}
+
+    retry :
+
+	/* send the key and properties to the server */
+	status = notifyprops(storePrivate->server,
+			     myKeyRef,
+			     (mach_msg_type_number_t)myKeyLen,
+			     isRegex,
+			     myPropertiesRef,
+			     (mach_msg_type_number_t)myPropertiesLen,
+			     (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreSetWatchedKeyProperties notifyprops()")) {
+		goto retry;
+	}
+
+	/* clean up */
+	CFRelease(utfKey);
+	if (xmlProperties != NULL)	CFRelease(xmlProperties);
+
+	if (sc_status != kSCStatusOK) {
+		_SCErrorSet(sc_status);
+		return FALSE;
+	}
+
+	/* in case we need to re-connect, save the properties */
+	keyPropertiesP = isRegex ? &storePrivate->patternProperties : &storePrivate->keyProperties;
+	if (properties != NULL) {
+		CFArrayRef	tmp;
+
+		if (*keyPropertiesP == NULL) {
+			*keyPropertiesP = CFDictionaryCreateMutable(NULL,
+								    0,
+								    &kCFTypeDictionaryKeyCallBacks,
+								    &kCFTypeDictionaryValueCallBacks);
+		}
+		tmp = CFArrayCreateCopy(NULL, properties);
+		CFDictionarySetValue(*keyPropertiesP, key, tmp);
+		CFRelease(tmp);
+	} else if (*keyPropertiesP != NULL) {
+		CFDictionaryRemoveValue(*keyPropertiesP, key);
+	}
+
+	return TRUE;
+}
@@ -161,6 +161,18 @@ __SCDynamicStoreDeallocate(CFTypeRef cf)
 	/* release any keys being watched */
 	if (storePrivate->keys != NULL) CFRelease(storePrivate->keys);
 	if (storePrivate->patterns != NULL) CFRelease(storePrivate->patterns);
+	if (storePrivate->watchedKeys != NULL) CFRelease(storePrivate->watchedKeys);
+	if (storePrivate->watchedPatterns != NULL) CFRelease(storePrivate->watchedPatterns);
+	if (storePrivate->sessionKeys != NULL) CFRelease(storePrivate->sessionKeys);
+	if (storePrivate->keyProperties != NULL) CFRelease(storePrivate->keyProperties);
+	if (storePrivate->patternProperties != NULL) CFRelease(storePrivate->patternProperties);
+
+	/* release any notification options */
+	if (storePrivate->notifyOptions != NULL) CFRelease(storePrivate->notifyOptions);
+
+	/* release any notification values */
+	if (storePrivate->notifyValuesPending != NULL) CFRelease(storePrivate->notifyValuesPending);
+	if (storePrivate->notifiedValues != NULL) CFRelease(storePrivate->notifiedValues);
 
 	/* release any client info */
 	if (storePrivate->name != NULL) CFRelease(storePrivate->name);
@@ -317,6 +329,8 @@ __SCDynamicStoreCreatePrivate(CFAllocatorRef		allocator,
 
 	/* flags */
 	storePrivate->useSessionKeys			= FALSE;
+	storePrivate->notifyValues			= FALSE;
+	storePrivate->useNotifyRing			= FALSE;
 
 	/* Notification status */
 	storePrivate->notifyStatus			= NotifierNotRegistered;
@@ -347,9 +361,22 @@ __SCDynamicStoreCreatePrivate(CFAllocatorRef		allocator,
 	storePrivate->disconnectFunction		= NULL;
 	storePrivate->disconnectForceCallBack		= FALSE;
 
+	/* "client" information associated with kSCDynamicStoreNotificationValues */
+	storePrivate->notifyValuesPending		= NULL;
+	storePrivate->notifyKeysPending			= FALSE;
+	storePrivate->notifiedValues			= NULL;
+
 	/* "server" information associated with SCDynamicStoreSetNotificationKeys() */
 	storePrivate->keys				= NULL;
 	storePrivate->patterns				= NULL;
+	storePrivate->watchedKeys			= NULL;
+	storePrivate->watchedPatterns			= NULL;
+	storePrivate->sessionKeys			= NULL;
+	storePrivate->keyProperties			= NULL;
+	storePrivate->patternProperties			= NULL;
+
+	/* "server" information associated with SCDynamicStoreSetNotificationOptions() */
+	storePrivate->notifyOptions			= NULL;
 
 	/* "server" information associated with SCDynamicStoreNotifyMachPort(); */
 	storePrivate->notifyPort			= MACH_PORT_NULL;
@@ -363,6 +390,10 @@ __SCDynamicStoreCreatePrivate(CFAllocatorRef		allocator,
 	storePrivate->notifySignal			= 0;
 	storePrivate->notifySignalTask			= TASK_NULL;
 
+	/* information associated with kSCDynamicStoreNotificationRing */
+	storePrivate->notifyRing			= NULL;
+	storePrivate->notifyRingOffset			= 0;
+
 	return storePrivate;
 }
 
@@ -606,6 +637,47 @@ pushDisconnect(SCDynamicStoreRef store)
 }
 
 
+typedef struct {
+	SCDynamicStoreRef	store;
+	Boolean			isRegex;
+	Boolean			ok;
+} reconnectPropertiesContext;
+
+
+static void
+reconnectProperties(const void *key, const void *value, void *context)
+{
+	reconnectPropertiesContext	*myContext	= (reconnectPropertiesContext *)context;
+
+	if (myContext->ok) {
+		myContext->ok = SCDynamicStoreSetWatchedKeyProperties(myContext->store,
+								      (CFStringRef)key,
+								      myContext->isRegex,
+								      (CFArrayRef)value);
+	}
+
+	return;
+}
+
+
+static Boolean
+reconnectAllProperties(SCDynamicStoreRef store, CFDictionaryRef keyProperties, Boolean isRegex)
+{
+	reconnectPropertiesContext	context		= { store, isRegex, TRUE };
+	CFDictionaryRef			properties;
+
+	if (keyProperties == NULL) {
+		return TRUE;
+	}
+
+	/* (the properties are saved again as they are sent) */
+	properties = CFDictionaryCreateCopy(NULL, keyProperties);
+	CFDictionaryApplyFunction(properties, reconnectProperties, &context);
+	CFRelease(properties);
+	return context.ok;
+}
+
+
 __private_extern__
 Boolean
 __SCDynamicStoreReconnectNotifications(SCDynamicStoreRef store)
@@ -656,6 +728,27 @@ __SCDynamicStoreReconnectNotifications(SCDynamicStoreRef store)
 		}
 	}
 
+	// set notification key & pattern properties
+	ok = reconnectAllProperties(store, storePrivate->keyProperties, FALSE) &&
+	     reconnectAllProperties(store, storePrivate->patternProperties, TRUE);
+	if (!ok) {
+		SCLog((SCError() != BOOTSTRAP_UNKNOWN_SERVICE),
+		      LOG_ERR,
+		      CFSTR("__SCDynamicStoreReconnectNotifications: SCDynamicStoreSetWatchedKeyProperties() failed"));
+		goto done;
+	}
+
+	// set notification options
+	if (storePrivate->notifyOptions != NULL) {
+		ok = SCDynamicStoreSetNotificationOptions(store, storePrivate->notifyOptions);
+		if (!ok) {
+			SCLog((SCError() != BOOTSTRAP_UNKNOWN_SERVICE),
+			      LOG_ERR,
+			      CFSTR("__SCDynamicStoreReconnectNotifications: SCDynamicStoreSetNotificationOptions() failed"));
+			goto done;
+		}
+	}
+
 	switch (notifyStatus) {
 		case Using_NotifierInformViaRunLoop : {
 			CFIndex			i;
@@ -727,6 +820,8 @@ __SCDynamicStoreReconnectNotifications(SCDynamicStoreRef store)
 
 
 const CFStringRef	kSCDynamicStoreUseSessionKeys	= CFSTR("UseSessionKeys");	/* CFBoolean */
+const CFStringRef	kSCDynamicStoreNotificationValues	= CFSTR("NotificationValues");	/* CFBoolean */
+const CFStringRef	kSCDynamicStoreNotificationRing		= CFSTR("NotificationRing");	/* CFBoolean */
 
 
 
@@ -756,7 +851,20 @@ SCDynamicStoreCreateWithOptions(CFAllocatorRef		allocator,
 	// set "options"
 
 	if (storeOptions != NULL) {
+		CFBooleanRef	notifyRing;
+		CFBooleanRef	notifyValues;
+
 		storePrivate->options = CFRetain(storeOptions);
+
+		notifyValues = CFDictionaryGetValue(storeOptions, kSCDynamicStoreNotificationValues);
+		if (isA_CFBoolean(notifyValues) && CFBooleanGetValue(notifyValues)) {
+			storePrivate->notifyValues = TRUE;
+		}
+
+		notifyRing = CFDictionaryGetValue(storeOptions, kSCDynamicStoreNotificationRing);
+		if (isA_CFBoolean(notifyRing) && CFBooleanGetValue(notifyRing)) {
+			storePrivate->useNotifyRing = TRUE;
+		}
 	}
 
 	// establish SCDynamicStore session
@@ -80,3 +80,119 @@ SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 
 	return TRUE;
 }
+
+
+Boolean
+SCDynamicStoreSnapshotStream(SCDynamicStoreRef store, Boolean delta, uint64_t *generation)
+{
+	uint64_t			newGeneration	= 0;
+	SCDynamicStorePrivateRef	storePrivate;
+	kern_return_t			status;
+	int				sc_status;
+
+	if (store == NULL) {
+		store = __SCDynamicStoreNullSession();
+		if (store == NULL) {
+			/* sorry, you must provide a session */
+			_SCErrorSet(kSCStatusNoStoreSession);
+			return FALSE;
+		}
+	}
+
+	storePrivate = (SCDynamicStorePrivateRef)store;
+	if (storePrivate->server == MACH_PORT_NULL) {
+		/* sorry, you must have an open session to play */
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return FALSE;
+	}
+
+    retry :
+
+	status = snapshotstream(storePrivate->server,
+				delta ? 1 : 0,
+				&newGeneration,
+				(int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreSnapshotStream snapshotstream()")) {
+		goto retry;
+	}
+
+	if (sc_status != kSCStatusOK) {
+		_SCErrorSet(sc_status);
+		return FALSE;
+	}
+
+	if (generation != NULL) {
+		*generation = newGeneration;
+	}
+
+	return TRUE;
+}
+
+
+CFDictionaryRef
+SCDynamicStoreCopyStatistics(SCDynamicStoreRef store, Boolean reset)
+{
+	SCDynamicStorePrivateRef	storePrivate;
+	kern_return_t			status;
+	int				sc_status;
+	CFDictionaryRef			stats		= NULL;
+	xmlDataOut_t			xmlStatsRef	= NULL;		/* serialized stats */
+	mach_msg_type_number_t		xmlStatsLen	= 0;
+
+	if (store == NULL) {
+		store = __SCDynamicStoreNullSession();
+		if (store == NULL) {
+			/* sorry, you must provide a session */
+			_SCErrorSet(kSCStatusNoStoreSession);
+			return NULL;
+		}
+	}
+
+	storePrivate = (SCDynamicStorePrivateRef)store;
+	if (storePrivate->server == MACH_PORT_NULL) {
+		/* sorry, you must have an open session to play */
+		_SCErrorSet(kSCStatusNoStoreServer);
+		return NULL;
+	}
+
+    retry :
+
+	status = configstats(storePrivate->server,
+			     reset ? 1 : 0,
+			     &xmlStatsRef,
+			     &xmlStatsLen,
+			     (int *)&sc_status);
+
+	if (__SCDynamicStoreCheckRetryAndHandleError(store,
+						     status,
+						     &sc_status,
+						     "SCDynamicStoreCopyStatistics configstats()")) {
+		goto retry;
+	}
+
+	if (sc_status != kSCStatusOK) {
+		if (xmlStatsRef != NULL) {
+			(void) vm_deallocate(mach_task_self(), (vm_address_t)xmlStatsRef, xmlStatsLen);
+		}
+		_SCErrorSet(sc_status);
+		return NULL;
+	}
+
+	/* un-serialize the statistics */
+	if (!_SCUnserialize((CFPropertyListRef *)&stats, NULL, xmlStatsRef, xmlStatsLen)) {
+		_SCErrorSet(kSCStatusFailed);
+		return NULL;
+	}
+
+	if (!isA_CFDictionary(stats)) {
+		if (stats != NULL) CFRelease(stats);
+		_SCErrorSet(kSCStatusFailed);
+		return NULL;
+	}
+
+	return stats;
+}
@@ -64,6 +64,8 @@ typedef struct {
 
 	/* per-session flags */
 	Boolean				useSessionKeys;
+	Boolean				notifyValues;
+	Boolean				useNotifyRing;
 
 	/* current status of notification requests */
 	__SCDynamicStoreNotificationStatus	notifyStatus;
@@ -85,10 +87,29 @@ typedef struct {
 	SCDynamicStoreDisconnectCallBack	disconnectFunction;
 	Boolean					disconnectForceCallBack;
 
+	/* "client" information associated with kSCDynamicStoreNotificationValues */
+	CFMutableDictionaryRef		notifyValuesPending;	/* values received, not yet delivered */
+	Boolean				notifyKeysPending;	/* if changed keys must be fetched */
+	CFDictionaryRef			notifiedValues;		/* values delivered with the last callback */
+
 	/* SCDynamicStoreKeys being watched */
 	CFMutableArrayRef		keys;
 	CFMutableArrayRef		patterns;
 
+	/* "server" information associated with the SCDynamicStoreKeys being watched */
+	CFMutableSetRef			watchedKeys;
+	CFMutableSetRef			watchedPatterns;
+
+	/* "server" information associated with per-session keys (removed on close) */
+	CFMutableSetRef			sessionKeys;
+
+	/* watched key/pattern --> value properties of interest (SCDynamicStoreSetWatchedKeyProperties) */
+	CFMutableDictionaryRef		keyProperties;
+	CFMutableDictionaryRef		patternProperties;
+
+	/* notification options (SCDynamicStoreSetNotificationOptions) */
+	CFDictionaryRef			notifyOptions;
+
 	/* "server" information associated with mach port based notifications */
 	mach_port_t			notifyPort;
 	mach_msg_id_t			notifyPortIdentifier;
@@ -101,9 +122,76 @@ typedef struct {
 	int				notifySignal;
 	task_t				notifySignalTask;
 
+	/* information associated with kSCDynamicStoreNotificationRing (mapped by both sides) */
+	struct __SCDynamicStoreNotifyRing	*notifyRing;
+	uint64_t				notifyRingOffset;	/* the [private] producer/consumer offset */
+
 } SCDynamicStorePrivate, *SCDynamicStorePrivateRef;
 
 
+/*
+ * The notification message sent to a session created with the
+ * kSCDynamicStoreNotificationValues option.  The message carries
+ * a serialized CFDictionary of the changed keys and their [serialized]
+ * values.  A removed key is represented by an empty CFData value.
+ *
+ * Changes that will not fit (see NOTIFY_VALUES_MAX) are posted with
+ * the usual (empty) notification message.
+ */
+typedef struct {
+	mach_msg_header_t		header;
+	mach_msg_body_t			body;
+	mach_msg_ool_descriptor_t	values;
+} __SCDynamicStoreNotifyValuesMsg;
+
+#define	NOTIFY_VALUES_MAX	(64 * 1024)
+
+
+/*
+ * The shared memory notification ring mapped by (and shared between)
+ * configd and a session created with the kSCDynamicStoreNotificationRing
+ * option.
+ *
+ * The ring is a single-producer (configd) / single-consumer (client)
+ * queue of variable length change records.  The "head" and "tail" are
+ * free running byte offsets; only configd advances the tail and only the
+ * client advances the head.  configd posts the usual (empty) notification
+ * message, or writes the identifier to the session's file descriptor, (the
+ * "doorbell") only when the ring transitions from empty.
+ * Changes that do not fit are left for SCDynamicStoreCopyNotifiedKeys()
+ * and flagged with "overflow".
+ *
+ * Neither side trusts the offsets (or records) written by the other.
+ */
+#define	NOTIFY_RING_DATA_SIZE	(16 * 1024)	/* must be a power of 2 */
+#define	NOTIFY_RING_KEY_MAX	1024
+
+struct __SCDynamicStoreNotifyRing {
+	volatile uint64_t	head;		/* consumer (client) offset */
+	uint8_t			_pad1[56];
+	volatile uint64_t	tail;		/* producer (configd) offset */
+	volatile uint32_t	overflow;	/* non-zero if changes were not queued */
+	uint8_t			_pad2[52];
+	uint8_t			records[NOTIFY_RING_DATA_SIZE];
+};
+
+typedef struct {
+	uint32_t		length;		/* record length (a multiple of 16) */
+	uint16_t		op;		/* kNotifyRingOp* */
+	uint16_t		keyLen;		/* length of the UTF-8 key */
+	uint64_t		generation;	/* the store generation of the change */
+	uint8_t			key[];
+} __SCDynamicStoreNotifyRecord;
+
+enum {
+	kNotifyRingOpPad	= 0,		/* skip to the start of the ring */
+	kNotifyRingOpSet	= 1,		/* key added / updated / notified */
+	kNotifyRingOpRemove	= 2		/* key removed */
+};
+
+#define	NOTIFY_RING_RECORD_ALIGN	16
+
+
 __BEGIN_DECLS
 
 SCDynamicStorePrivateRef
@@ -124,6 +212,19 @@ __SCDynamicStoreCheckRetryAndHandleError(SCDynamicStoreRef		store,
 Boolean
 __SCDynamicStoreReconnectNotifications	(SCDynamicStoreRef		store);
 
+CFArrayRef
+__SCDynamicStoreCopyNotifiedKeys	(SCDynamicStoreRef		store);
+
+void
+__SCDynamicStoreNotifyRingMap		(SCDynamicStoreRef		store);
+
+void
+__SCDynamicStoreNotifyRingUnmap		(SCDynamicStoreRef		store);
+
+CFArrayRef
+__SCDynamicStoreNotifyRingCopyChangedKeys
+					(SCDynamicStoreRef		store);
+
 __END_DECLS
 
 #endif /* _SCDYNAMICSTOREINTERNAL_H */
@@ -228,6 +228,261 @@ SCDynamicStoreSetDisconnectCallBack	(
 Boolean
 SCDynamicStoreSnapshot			(SCDynamicStoreRef		store);
 
+/*!
+	@function SCDynamicStoreSnapshotStream
+	@discussion Writes the contents of the "dynamic store" to
+		/var/tmp/configd-store.records as a stream of (key, serialized
+		value, generation) records, in key order.  Unlike
+		SCDynamicStoreSnapshot, the values are written as stored and
+		the server never builds the entire store as a single property
+		list.
+
+		The snapshot is taken when the request is processed but the
+		file is written in the background and then renamed into
+		place; the generation in the file header can be compared with
+		the returned generation to check that the file is current.
+	@param store The "dynamic store" session.
+	@param delta TRUE if only the keys changed (or removed) since the
+		previously streamed snapshot should be written.  A complete
+		snapshot is written if there is no previous snapshot (or if
+		the previous snapshot could not be written).
+	@param generation If not NULL, returns the "generation" of the store
+		that will be written.
+	@result Returns TRUE if the snapshot was taken; FALSE if an error
+		was encountered.
+ */
+Boolean
+SCDynamicStoreSnapshotStream		(SCDynamicStoreRef		store,
+					 Boolean			delta,
+					 uint64_t			*generation)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@function SCDynamicStoreCopyStatistics
+	@discussion Returns the server's statistics for each type of
+		request processed since configd was started (or since the
+		statistics were last reset).
+	@param store The "dynamic store" session.
+	@param reset TRUE if the statistics should be reset (after being
+		returned).  Only root may reset the statistics.
+	@result Returns a dictionary with the time the statistics were
+		started ("Since", a CFDate) and the statistics for each type
+		of request ("Requests", keyed by the MiG request name).  The
+		statistics for a request are :
+		"Count", the number of requests;
+		"BytesIn" and "BytesOut", the total size of the request and
+		reply messages (including out-of-line data);
+		"Time" and "TimeMax", the total and maximum time (in nsecs)
+		taken to process and reply to a request; and
+		"Histogram", the distribution of those times as an array of
+		[ limit (nsecs), count ] pairs, in increasing order, where
+		each count is the number of requests that took less than the
+		limit (and at least the previous limit).
+		The dictionary also includes the sessions that have used the
+		most server time ("Sessions", an array, most time first).  For
+		each session :
+		"Name", "PID" and "Port", identifying the session;
+		"Requests", the number of "Read", "Write", "Watch" and "Other"
+		requests;
+		"BytesIn", "BytesOut" and "Time", as above;
+		"Notifications", the number of notifications delivered; and
+		"WatchedKeys" and "WatchedPatterns", the number of keys and
+		patterns being watched; and, if the session has exceeded its
+		budget (see configd -L), "Delayed", "Rejected" and
+		"Deprioritized", the number of times each action was taken.
+		If per-session budgets are configured, the dictionary also
+		includes "Admission" with the "Policy" and the total number of
+		requests "Delayed", "Rejected" and "Deprioritized" (and the
+		requests to watch too many patterns, "PatternsRejected").
+		The session statistics are kept for the life of the session
+		(and are not reset).  A summary of the sessions that used the
+		most server time over each minute is also published in the
+		dynamic store as "State:/configd/Sessions".
+		You must release the returned value.
+ */
+CFDictionaryRef
+SCDynamicStoreCopyStatistics		(SCDynamicStoreRef		store,
+					 Boolean			reset)		__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@function SCDynamicStoreCopyMultipleWithGeneration
+	@discussion Returns a dictionary of key-value pairs for the specified keys
+		(and the keys matching the specified patterns), all taken from a
+		single version ("generation") of the "dynamic store".  Unlike
+		SCDynamicStoreCopyMultiple, the returned values will never reflect
+		a partially applied update.
+	@param store The "dynamic store" session.
+	@param keys The keys associated with the values to be returned; NULL
+		if no specific keys are requested.
+	@param patterns The regex(3) patterns of the keys to be returned; NULL
+		if no key patterns are requested.
+	@param asOf The generation of the "dynamic store" the values should be
+		returned as of (a value previously returned by this function); 0
+		to return the current values.  Only the most recent generations
+		are retained, kSCStatusStale is reported if the requested
+		generation is no longer available.
+	@param generation If non-NULL, returns the generation of the "dynamic store"
+		the values were taken from.
+	@result A dictionary containing the specified key-value pairs; NULL if an
+		error was encountered.  You must release the returned value.
+ */
+CFDictionaryRef
+SCDynamicStoreCopyMultipleWithGeneration(SCDynamicStoreRef		store,
+					 CFArrayRef			keys,
+					 CFArrayRef			patterns,
+					 uint64_t			asOf,
+					 uint64_t			*generation)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@function SCDynamicStoreCopyMultipleIfChanged
+	@discussion Returns a dictionary of key-value pairs for the specified keys
+		(and the keys matching the specified patterns), all taken from a
+		single version ("generation") of the "dynamic store".  Only
+		those values that have been added or changed since the
+		previously returned dictionary are copied from the server, the
+		unchanged values are taken from the previous dictionary.
+	@param store The "dynamic store" session.
+	@param keys The keys associated with the values to be returned; NULL
+		if no specific keys are requested.
+	@param patterns The regex(3) patterns of the keys to be returned; NULL
+		if no key patterns are requested.
+	@param previous The dictionary previously returned by this function
+		for the same keys and patterns; NULL if not available.  If
+		the previous dictionary is missing any of the unchanged
+		values, all of the values are fetched from the server.
+	@param generation On input, the generation returned with the previous
+		dictionary (ignored if previous is NULL).  On output, the
+		generation of the "dynamic store" the values were taken from.
+	@result A dictionary containing the specified key-value pairs; NULL if an
+		error was encountered.  If nothing has changed since the
+		previous generation, a [retained] reference to the previous
+		dictionary is returned.  You must release the returned value.
+ */
+CFDictionaryRef
+SCDynamicStoreCopyMultipleIfChanged	(SCDynamicStoreRef		store,
+					 CFArrayRef			keys,
+					 CFArrayRef			patterns,
+					 CFDictionaryRef		previous,
+					 uint64_t			*generation)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@const kSCDynamicStoreNotificationValues
+	@discussion A session option (CFBoolean) which, when TRUE, requests
+		that the values of the changed keys be delivered along with
+		the change notifications posted to the callback function of a
+		session scheduled with SCDynamicStoreCreateRunLoopSource or
+		SCDynamicStoreSetDispatchQueue (see
+		SCDynamicStoreCopyNotifiedValues).
+ */
+extern const CFStringRef	kSCDynamicStoreNotificationValues	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);	/* CFBoolean */
+
+/*!
+	@const kSCDynamicStoreNotificationRing
+	@discussion A session option (CFBoolean) which, when TRUE, requests
+		that the changed keys be delivered to the callback function of
+		a session scheduled with SCDynamicStoreCreateRunLoopSource or
+		SCDynamicStoreSetDispatchQueue through a ring buffer shared
+		(mapped) with the server.  A notification message is only
+		posted when the ring transitions from empty.  This option
+		takes precedence over kSCDynamicStoreNotificationValues.
+		A session notified with SCDynamicStoreNotifyFileDescriptor
+		also uses the ring : the identifier is only written when the
+		ring transitions from empty and SCDynamicStoreCopyNotifiedKeys
+		drains the ring.
+ */
+extern const CFStringRef	kSCDynamicStoreNotificationRing		__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);	/* CFBoolean */
+
+/*!
+	@function SCDynamicStoreCopyNotifiedValues
+	@discussion Returns the values of the changed keys that were delivered
+		with the notification being processed by the session's
+		callback function.  The session must have been created with
+		the kSCDynamicStoreNotificationValues option.  Only valid from
+		within the callback function.
+	@param store The "dynamic store" session.
+	@result A dictionary of the changed keys and their new values; NULL if
+		no values were delivered with the notification.  Removed keys
+		have a value of kCFNull.  Any changed key that is not present
+		in the dictionary (e.g. when the changes were too large to be
+		delivered with the notification) must be fetched with
+		SCDynamicStoreCopyValue or SCDynamicStoreCopyMultiple.
+		You must release the returned value.
+ */
+CFDictionaryRef
+SCDynamicStoreCopyNotifiedValues	(SCDynamicStoreRef		store)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@const kSCDynamicStoreNotificationCoalesce
+	@discussion A notification option (CFNumber, 0 to 1000 milliseconds)
+		specifying how long the changed keys are allowed to accumulate
+		(from the first change) before the session is notified.  The
+		default is 0 (notify as soon as possible).
+ */
+extern const CFStringRef	kSCDynamicStoreNotificationCoalesce	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);	/* CFNumber */
+
+/*!
+	@const kSCDynamicStoreNotificationRateLimit
+	@discussion A notification option (CFNumber) specifying the maximum
+		[sustained] rate, in notifications per second, at which the
+		session is notified.  Changes that arrive while the session is
+		being held back are coalesced into the next notification.  The
+		default is 0 (no limit).
+ */
+extern const CFStringRef	kSCDynamicStoreNotificationRateLimit	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);	/* CFNumber */
+
+/*!
+	@const kSCDynamicStoreNotificationRateBurst
+	@discussion A notification option (CFNumber) specifying the number of
+		notifications that can be posted back-to-back before the
+		kSCDynamicStoreNotificationRateLimit rate applies.  The
+		default is 1.
+ */
+extern const CFStringRef	kSCDynamicStoreNotificationRateBurst	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);	/* CFNumber */
+
+/*!
+	@function SCDynamicStoreSetNotificationOptions
+	@discussion Specifies how (and how often) the session is to be notified
+		of changes to the watched keys.  Sessions that only need to be
+		eventually consistent can use these options to reduce the
+		number of notifications posted during a burst of changes.
+	@param store The "dynamic store" session.
+	@param options A dictionary of notification options (see
+		kSCDynamicStoreNotificationCoalesce,
+		kSCDynamicStoreNotificationRateLimit, and
+		kSCDynamicStoreNotificationRateBurst); NULL to restore the
+		defaults.
+	@result TRUE if the options were accepted; FALSE if an error was
+		encountered.
+ */
+Boolean
+SCDynamicStoreSetNotificationOptions	(SCDynamicStoreRef		store,
+					 CFDictionaryRef		options)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
+/*!
+	@function SCDynamicStoreSetWatchedKeyProperties
+	@discussion Limits the notifications for a watched key (or pattern)
+		to those changes that affect the specified properties of
+		the value.  A change is posted if any of the properties was
+		added, changed, or removed (or if the key was added or
+		removed).  The key (or pattern) must also be watched (see
+		SCDynamicStoreAddWatchedKey or SCDynamicStoreSetNotificationKeys)
+		for any notifications to be posted.
+	@param store The "dynamic store" session being watched.
+	@param key The watched key (or regex(3) pattern string).
+	@param isRegex A booolean indicating whether the key is a specific
+		key or a regex(3) pattern string of keys.
+	@param properties An array of the properties of interest.  Each
+		property is named by a CFString (a top-level dictionary key
+		of the value) or by a CFArray of CFStrings (a path through
+		nested dictionaries).  NULL to be notified of any change.
+	@result TRUE if the properties were accepted; FALSE if an error was
+		encountered.
+ */
+Boolean
+SCDynamicStoreSetWatchedKeyProperties	(SCDynamicStoreRef		store,
+					 CFStringRef			key,
+					 Boolean			isRegex,
+					 CFArrayRef			properties)	__OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0/*SPI*/);
+
 __END_DECLS
 
 #endif /* _SCDYNAMICSTOREPRIVATE_H */
@@ -409,6 +409,10 @@ typedef struct {
 static ReachabilityStoreInfo	S_storeInfo		= { 0 };
 static Boolean			S_storeInfoActive	= FALSE;
 
+// the most recently fetched SCDynamicStore info (and its generation)
+static CFDictionaryRef		S_storeInfoLast		= NULL;
+static uint64_t			S_storeInfoGeneration	= 0;
+
 
 static dispatch_queue_t
 _storeInfo_queue()
@@ -639,15 +643,25 @@ ReachabilityStoreInfo_fill(ReachabilityStoreInfoRef store_info)
 	CFMutableArrayRef	keys;
 	CFMutableArrayRef	patterns;
 
-	// get the SCDynamicStore info
+	// get the SCDynamicStore info (only fetching what has changed)
 	ReachabilityStoreInfo_keys(&keys, &patterns);
-	store_info->dict = SCDynamicStoreCopyMultiple(store_info->store, keys, patterns);
+	store_info->dict = SCDynamicStoreCopyMultipleIfChanged(store_info->store,
+							       keys,
+							       patterns,
+							       S_storeInfoLast,
+							       &S_storeInfoGeneration);
 	CFRelease(keys);
 	CFRelease(patterns);
 	if (store_info->dict == NULL) {
 		return FALSE;
 	}
 
+	// and remember it for the next time around
+	if (S_storeInfoLast != store_info->dict) {
+		if (S_storeInfoLast != NULL) CFRelease(S_storeInfoLast);
+		S_storeInfoLast = CFRetain(store_info->dict);
+	}
+
 	// and extract the keys/values for post-processing
 	store_info->n = CFDictionaryGetCount(store_info->dict);
 	if (store_info->n > 0) {
@@ -306,6 +306,125 @@ CF_RETURNS_RETAINED
 CFDictionaryRef	_SCUnserializeMultiple		(CFDictionaryRef	dict);
 
 
+#pragma mark -
+#pragma mark Encoded values
+
+
+/*!
+	@typedef _SCEncodedValue
+	@discussion A reference to a value within a buffer created by
+		_SCEncodedValueCreateData.  The buffer is read in place
+		(no CF objects are created) and must remain valid while
+		the reference is in use.
+ */
+typedef struct {
+	const uint8_t	*bytes;
+	uint32_t	length;
+	uint32_t	offset;
+} _SCEncodedValue;
+
+/*!
+	@function _SCEncodedValueCreateData
+	@discussion Encodes a property list (CFDictionary, CFArray, CFString,
+		CFData, CFNumber, and CFBoolean values only) into a compact
+		buffer that can be read in place.
+	@param value The property list to encode.
+	@result The encoded value; NULL if the property list includes any
+		unsupported types.
+ */
+CF_RETURNS_RETAINED
+CFDataRef	_SCEncodedValueCreateData	(CFPropertyListRef	value);
+
+/*!
+	@function _SCEncodedValueInit
+	@discussion Initializes a reference to the [root] value of an
+		encoded buffer.
+	@param value The reference to be initialized.
+	@param bytes The encoded buffer.
+	@param length The length of the encoded buffer.
+	@result TRUE if the buffer holds an encoded value.
+ */
+Boolean		_SCEncodedValueInit		(_SCEncodedValue	*value,
+						 const void		*bytes,
+						 CFIndex		length);
+
+/*!
+	@function _SCEncodedValueGetTypeID
+	@result The CFTypeID of the referenced value, 0 if not valid.
+ */
+CFTypeID	_SCEncodedValueGetTypeID	(const _SCEncodedValue	*value);
+
+/*!
+	@function _SCEncodedValueGetCount
+	@result The # of array elements or dictionary entries, or the
+		length (in bytes) of a string or data value.
+ */
+CFIndex		_SCEncodedValueGetCount		(const _SCEncodedValue	*value);
+
+/*!
+	@function _SCEncodedValueGetCString
+	@result A pointer to the [NUL terminated] UTF-8 bytes of a string
+		value, NULL if not a string.
+ */
+const char *	_SCEncodedValueGetCString	(const _SCEncodedValue	*value,
+						 CFIndex		*length);
+
+/*!
+	@function _SCEncodedValueGetBytePtr
+	@result A pointer to the bytes of a data value, NULL if not data.
+ */
+const UInt8 *	_SCEncodedValueGetBytePtr	(const _SCEncodedValue	*value,
+						 CFIndex		*length);
+
+Boolean		_SCEncodedValueGetInt64		(const _SCEncodedValue	*value,
+						 int64_t		*i);
+
+Boolean		_SCEncodedValueGetFloat64	(const _SCEncodedValue	*value,
+						 Float64		*d);
+
+Boolean		_SCEncodedValueGetBoolean	(const _SCEncodedValue	*value,
+						 Boolean		*b);
+
+/*!
+	@function _SCEncodedValueGetArrayValue
+	@discussion Returns a reference to an element of an array value.
+ */
+Boolean		_SCEncodedValueGetArrayValue	(const _SCEncodedValue	*array,
+						 CFIndex		index,
+						 _SCEncodedValue	*value);
+
+/*!
+	@function _SCEncodedValueGetDictionaryValue
+	@discussion Returns a reference to the value associated with
+		a [UTF-8] key of a dictionary value.
+ */
+Boolean		_SCEncodedValueGetDictionaryValue
+						(const _SCEncodedValue	*dict,
+						 const char		*key,
+						 _SCEncodedValue	*value);
+
+/*!
+	@function _SCEncodedValueGetDictionaryEntry
+	@discussion Returns references to the key and value of a
+		dictionary entry (the entries are sorted by key).
+ */
+Boolean		_SCEncodedValueGetDictionaryEntry
+						(const _SCEncodedValue	*dict,
+						 CFIndex		index,
+						 _SCEncodedValue	*key,
+						 _SCEncodedValue	*value);
+
+/*!
+	@function _SCEncodedValueCopyPropertyList
+	@result The referenced value (as a property list), NULL if the
+		value could not be decoded (including values nested more
+		than 64 levels deep).
+ */
+CF_RETURNS_RETAINED
+CFPropertyListRef
+		_SCEncodedValueCopyPropertyList	(const _SCEncodedValue	*value);
+
+
 #pragma mark -
 #pragma mark String conversion
 
@@ -58,6 +58,7 @@
 	@constant kSCStatusNoStoreSession	Configuration daemon session not active
 	@constant kSCStatusNoStoreServer	Configuration daemon not (or no longer) available
 	@constant kSCStatusNotifierActive	Notifier is currently active
+	@constant kSCStatusLimitExceeded	Configuration daemon session limit exceeded
 	@constant kSCStatusNoPrefsSession	Preferences session not active
 	@constant kSCStatusPrefsBusy		Preferences update currently in progress
 	@constant kSCStatusNoConfigFile		Configuration file not found
@@ -90,6 +91,9 @@ enum {
 	kSCStatusNoStoreSession			= 2001,	/* Configuration daemon session not active */
 	kSCStatusNoStoreServer			= 2002,	/* Configuration daemon not (no longer) available */
 	kSCStatusNotifierActive			= 2003,	/* Notifier is currently active */
+	kSCStatusLimitExceeded			= 2004,	/* Configuration daemon session limit exceeded
+							   __OSX_AVAILABLE_STARTING(__MAC_10_10,__IPHONE_8_0)
+							 */
 	/*
 	 * SCPreferences error codes
 	 */
@@ -32,104 +32,38 @@
  */
 
 
-#include <unistd.h>
-
 #include "configd.h"
-#include "configd_server.h"
 #include "session.h"
 
 
 __private_extern__ CFMutableDictionaryRef	sessionData		= NULL;
 
-__private_extern__ CFMutableDictionaryRef	storeData		= NULL;
-
 __private_extern__ CFMutableDictionaryRef	patternData		= NULL;
 
 __private_extern__ CFMutableSetRef		changedKeys		= NULL;
 
 __private_extern__ CFMutableSetRef		deferredRemovals	= NULL;
 
-__private_extern__ CFMutableSetRef		removedSessionKeys	= NULL;
-
 __private_extern__ CFMutableSetRef		needsNotification	= NULL;
 
+__private_extern__ CFMutableDictionaryRef	previousValues		= NULL;
+
 
 __private_extern__
 void
 _addWatcher(CFNumberRef sessionNum, CFStringRef watchedKey)
 {
-	CFDictionaryRef		dict;
-	CFMutableDictionaryRef	newDict;
-	CFArrayRef		watchers;
-	CFMutableArrayRef	newWatchers;
-	CFArrayRef		watcherRefs;
-	CFMutableArrayRef	newWatcherRefs;
-	CFIndex			i;
-	int			refCnt;
-	CFNumberRef		refNum;
+	storeEntryRef	entry;
+	int		server;
 
-	/*
-	 * Get the dictionary associated with this key out of the store
-	 */
-	dict = CFDictionaryGetValue(storeData, watchedKey);
-	if (dict) {
-		newDict = CFDictionaryCreateMutableCopy(NULL, 0, dict);
-	} else {
-		newDict = CFDictionaryCreateMutable(NULL,
-						    0,
-						    &kCFTypeDictionaryKeyCallBacks,
-						    &kCFTypeDictionaryValueCallBacks);
-	}
+	(void) CFNumberGetValue(sessionNum, kCFNumberIntType, &server);
 
 	/*
-	 * Get the set of watchers out of the keys dictionary
+	 * Get the entry associated with this key out of the store
+	 * and add my session to the set of watchers
 	 */
-	watchers    = CFDictionaryGetValue(newDict, kSCDWatchers);
-	watcherRefs = CFDictionaryGetValue(newDict, kSCDWatcherRefs);
-	if (watchers) {
-		newWatchers    = CFArrayCreateMutableCopy(NULL, 0, watchers);
-		newWatcherRefs = CFArrayCreateMutableCopy(NULL, 0, watcherRefs);
-	} else {
-		newWatchers    = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-		newWatcherRefs = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-	}
-
-	/*
-	 * Add my session to the set of watchers
-	 */
-	i = CFArrayGetFirstIndexOfValue(newWatchers,
-					CFRangeMake(0, CFArrayGetCount(newWatchers)),
-					sessionNum);
-	if (i == kCFNotFound) {
-		/* if this is the first instance of this session watching this key */
-		CFArrayAppendValue(newWatchers, sessionNum);
-		refCnt = 1;
-		refNum = CFNumberCreate(NULL, kCFNumberIntType, &refCnt);
-		CFArrayAppendValue(newWatcherRefs, refNum);
-		CFRelease(refNum);
-	} else {
-		/* if this is another instance of this session watching this key */
-		refNum = CFArrayGetValueAtIndex(newWatcherRefs, i);
-		CFNumberGetValue(refNum, kCFNumberIntType, &refCnt);
-		refCnt++;
-		refNum = CFNumberCreate(NULL, kCFNumberIntType, &refCnt);
-		CFArraySetValueAtIndex(newWatcherRefs, i, refNum);
-		CFRelease(refNum);
-	}
-
-	/*
-	 * Update the keys dictionary
-	 */
-	CFDictionarySetValue(newDict, kSCDWatchers, newWatchers);
-	CFRelease(newWatchers);
-	CFDictionarySetValue(newDict, kSCDWatcherRefs, newWatcherRefs);
-	CFRelease(newWatcherRefs);
-
-	/*
-	 * Update the store for this key
-	 */
-	CFDictionarySetValue(storeData, watchedKey, newDict);
-	CFRelease(newDict);
+	entry = storeLookupOrAdd(watchedKey);
+	(void) storeAddWatcher(entry, server);
 
 #ifdef	DEBUG
 	SCLog(_configd_verbose, LOG_DEBUG, CFSTR("  _addWatcher: %@, %@"), sessionNum, watchedKey);
@@ -143,86 +77,32 @@ __private_extern__
 void
 _removeWatcher(CFNumberRef sessionNum, CFStringRef watchedKey)
 {
-	CFDictionaryRef		dict;
-	CFMutableDictionaryRef	newDict;
-	CFArrayRef		watchers;
-	CFMutableArrayRef	newWatchers;
-	CFArrayRef		watcherRefs;
-	CFMutableArrayRef	newWatcherRefs;
-	CFIndex			i;
-	int			refCnt;
-	CFNumberRef		refNum;
+	storeEntryRef	entry;
+	int		server;
 
 	/*
-	 * Get the dictionary associated with this key out of the store
+	 * Get the entry associated with this key out of the store
 	 */
-	dict = CFDictionaryGetValue(storeData, watchedKey);
-	if ((dict == NULL) || (CFDictionaryContainsKey(dict, kSCDWatchers) == FALSE)) {
+	entry = storeLookup(watchedKey);
+	if ((entry == NULL) || (entry->nWatchers == 0)) {
 		/* key doesn't exist (isn't this really fatal?) */
 #ifdef	DEBUG
 		SCLog(_configd_verbose, LOG_DEBUG, CFSTR("  _removeWatcher: %@, %@, key not watched"), sessionNum, watchedKey);
 #endif	/* DEBUG */
 		return;
 	}
-	newDict = CFDictionaryCreateMutableCopy(NULL, 0, dict);
-
-	/*
-	 * Get the set of watchers out of the keys dictionary and
-	 * remove this session from the list.
-	 */
-	watchers       = CFDictionaryGetValue(newDict, kSCDWatchers);
-	newWatchers    = CFArrayCreateMutableCopy(NULL, 0, watchers);
-
-	watcherRefs    = CFDictionaryGetValue(newDict, kSCDWatcherRefs);
-	newWatcherRefs = CFArrayCreateMutableCopy(NULL, 0, watcherRefs);
 
-	/* locate the session reference */
-	i = CFArrayGetFirstIndexOfValue(newWatchers,
-					CFRangeMake(0, CFArrayGetCount(newWatchers)),
-					sessionNum);
-	if (i == kCFNotFound) {
+	/* remove one session reference */
+	(void) CFNumberGetValue(sessionNum, kCFNumberIntType, &server);
+	if (!storeRemoveWatcher(entry, server)) {
 #ifdef	DEBUG
 		SCLog(_configd_verbose, LOG_DEBUG, CFSTR("  _removeWatcher: %@, %@, session not watching"), sessionNum, watchedKey);
 #endif	/* DEBUG */
-		CFRelease(newDict);
-		CFRelease(newWatchers);
-		CFRelease(newWatcherRefs);
 		return;
 	}
 
-	/* remove one session reference */
-	refNum = CFArrayGetValueAtIndex(newWatcherRefs, i);
-	CFNumberGetValue(refNum, kCFNumberIntType, &refCnt);
-	if (--refCnt > 0) {
-		refNum = CFNumberCreate(NULL, kCFNumberIntType, &refCnt);
-		CFArraySetValueAtIndex(newWatcherRefs, i, refNum);
-		CFRelease(refNum);
-	} else {
-		/* if this was the last reference */
-		CFArrayRemoveValueAtIndex(newWatchers, i);
-		CFArrayRemoveValueAtIndex(newWatcherRefs, i);
-	}
-
-	if (CFArrayGetCount(newWatchers) > 0) {
-		/* if this key is still being "watched" */
-		CFDictionarySetValue(newDict, kSCDWatchers, newWatchers);
-		CFDictionarySetValue(newDict, kSCDWatcherRefs, newWatcherRefs);
-	} else {
-		/* no watchers left, remove the empty set */
-		CFDictionaryRemoveValue(newDict, kSCDWatchers);
-		CFDictionaryRemoveValue(newDict, kSCDWatcherRefs);
-	}
-	CFRelease(newWatchers);
-	CFRelease(newWatcherRefs);
-
-	if (CFDictionaryGetCount(newDict) > 0) {
-		/* if this key is still active */
-		CFDictionarySetValue(storeData, watchedKey, newDict);
-	} else {
-		/* no information left, remove the empty dictionary */
-		CFDictionaryRemoveValue(storeData, watchedKey);
-	}
-	CFRelease(newDict);
+	/* if no information left, remove the entry */
+	storeRemoveIfUnused(entry);
 
 #ifdef	DEBUG
 	SCLog(_configd_verbose, LOG_DEBUG, CFSTR("  _removeWatcher: %@, %@"), sessionNum, watchedKey);
@@ -232,147 +112,94 @@ _removeWatcher(CFNumberRef sessionNum, CFStringRef watchedKey)
 }
 
 
-#define N_QUICK	64
+/*
+ * _addSessionKey
+ *   adds a key to the set of per-session keys to be removed when the
+ *   session is closed.
+ */
+__private_extern__
+void
+_addSessionKey(SCDynamicStoreRef store, CFStringRef key)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	if (storePrivate->sessionKeys == NULL) {
+		storePrivate->sessionKeys = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
+	}
+
+	CFSetAddValue(storePrivate->sessionKeys, key);
+	return;
+}
 
 
+/*
+ * _removeSessionKey
+ *   removes a key from the set of per-session keys of the session which
+ *   created it (after the key was removed or updated by another session).
+ */
 __private_extern__
 void
-pushNotifications(FILE *_configd_trace)
+_removeSessionKey(mach_port_t server, CFStringRef key)
 {
-	CFIndex				notifyCnt;
-	int				server;
-	const void *			sessionsToNotify_q[N_QUICK];
-	const void **			sessionsToNotify	= sessionsToNotify_q;
+	serverSessionRef		mySession;
 	SCDynamicStorePrivateRef	storePrivate;
-	serverSessionRef		theSession;
 
-	if (needsNotification == NULL)
-		return;		/* if no sessions need to be kicked */
-
-	notifyCnt = CFSetGetCount(needsNotification);
-	if (notifyCnt > (CFIndex)(sizeof(sessionsToNotify_q) / sizeof(CFNumberRef)))
-		sessionsToNotify = CFAllocatorAllocate(NULL, notifyCnt * sizeof(CFNumberRef), 0);
-	CFSetGetValues(needsNotification, sessionsToNotify);
-	while (--notifyCnt >= 0) {
-		(void) CFNumberGetValue(sessionsToNotify[notifyCnt],
-					kCFNumberIntType,
-					&server);
-		theSession = getSession(server);
-		storePrivate = (SCDynamicStorePrivateRef)theSession->store;
-
-		/*
-		 * deliver notifications to client sessions
-		 */
-		if ((storePrivate->notifyStatus == Using_NotifierInformViaMachPort) &&
-		    (storePrivate->notifyPort != MACH_PORT_NULL)) {
-			/*
-			 * Post notification as mach message
-			 */
-			if (_configd_trace != NULL) {
-				SCTrace(TRUE, _configd_trace,
-					CFSTR("%s : %5d : port = %d, msgid = %d\n"),
-					"-->port",
-					storePrivate->server,
-					storePrivate->notifyPort,
-					storePrivate->notifyPortIdentifier);
-			}
-
-			_SC_sendMachMessage(storePrivate->notifyPort, storePrivate->notifyPortIdentifier);
-		}
-
-		if ((storePrivate->notifyStatus == Using_NotifierInformViaFD) &&
-		    (storePrivate->notifyFile >= 0)) {
-			ssize_t		written;
-
-			if (_configd_trace != NULL) {
-				SCTrace(TRUE, _configd_trace,
-					CFSTR("%s : %5d : fd = %d, msgid = %d\n"),
-					"-->fd  ",
-					storePrivate->server,
-					storePrivate->notifyFile,
-					storePrivate->notifyFileIdentifier);
-			}
-
-			written = write(storePrivate->notifyFile,
-					&storePrivate->notifyFileIdentifier,
-					sizeof(storePrivate->notifyFileIdentifier));
-			if (written == -1) {
-				if (errno == EWOULDBLOCK) {
-#ifdef	DEBUG
-					SCLog(_configd_verbose, LOG_DEBUG,
-					      CFSTR("sorry, only one outstanding notification per session."));
-#endif	/* DEBUG */
-				} else {
-#ifdef	DEBUG
-					SCLog(_configd_verbose, LOG_DEBUG,
-					      CFSTR("could not send notification, write() failed: %s"),
-					      strerror(errno));
-#endif	/* DEBUG */
-					storePrivate->notifyFile = -1;
-				}
-			} else if (written != sizeof(storePrivate->notifyFileIdentifier)) {
-#ifdef	DEBUG
-				SCLog(_configd_verbose, LOG_DEBUG,
-				      CFSTR("could not send notification, incomplete write()"));
-#endif	/* DEBUG */
-				storePrivate->notifyFile = -1;
-			}
-		}
-
-		if ((storePrivate->notifyStatus == Using_NotifierInformViaSignal) &&
-		    (storePrivate->notifySignal > 0)) {
-			kern_return_t	status;
-			pid_t		pid;
-			/*
-			 * Post notification as signal
-			 */
-			status = pid_for_task(storePrivate->notifySignalTask, &pid);
-			if (status == KERN_SUCCESS) {
-				if (_configd_trace != NULL) {
-					SCTrace(TRUE, _configd_trace,
-						CFSTR("%s : %5d : pid = %d, signal = sig%s (%d)\n"),
-						"-->sig ",
-						storePrivate->server,
-						pid,
-						sys_signame[storePrivate->notifySignal],
-						storePrivate->notifySignal);
-				}
-
-				if (kill(pid, storePrivate->notifySignal) != 0) {
-					if (errno != ESRCH) {
-						SCLog(TRUE, LOG_ERR,
-						      CFSTR("could not send sig%s to PID %d: %s"),
-						      sys_signame[storePrivate->notifySignal],
-						      pid,
-						      strerror(errno));
-					}
-				}
-			} else {
-				mach_port_type_t	pt;
-
-				__MACH_PORT_DEBUG(TRUE, "*** pushNotifications pid_for_task failed: releasing task", storePrivate->notifySignalTask);
-				if (mach_port_type(mach_task_self(), storePrivate->notifySignalTask, &pt) == KERN_SUCCESS) {
-					if ((pt & MACH_PORT_TYPE_DEAD_NAME) != 0) {
-						SCLog(TRUE, LOG_ERR, CFSTR("pushNotifications pid_for_task() failed: %s"), mach_error_string(status));
-					}
-				} else {
-					SCLog(TRUE, LOG_ERR, CFSTR("pushNotifications mach_port_type() failed: %s"), mach_error_string(status));
-				}
-
-				/* don't bother with any more attempts */
-				(void) mach_port_deallocate(mach_task_self(), storePrivate->notifySignalTask);
-				storePrivate->notifySignal     = 0;
-				storePrivate->notifySignalTask = TASK_NULL;
-			}
-	       }
+	mySession = getSession(server);
+	if ((mySession == NULL) || (mySession->store == NULL)) {
+		/* if no session */
+		return;
 	}
-	if (sessionsToNotify != sessionsToNotify_q) CFAllocatorDeallocate(NULL, sessionsToNotify);
 
+	storePrivate = (SCDynamicStorePrivateRef)mySession->store;
+	if (storePrivate->sessionKeys != NULL) {
+		CFSetRemoveValue(storePrivate->sessionKeys, key);
+	}
+
+	return;
+}
+
+
+/*
+ * _savePreviousValue
+ *   saves the value of a watched key before its first change in the
+ *   current commit so that any watchers only interested in some of the
+ *   value's properties can later check if those properties changed.
+ */
+__private_extern__
+void
+_savePreviousValue(storeEntryRef entry)
+{
+	if (entry->nWatchers == 0) {
+		/* if nobody cares */
+		return;
+	}
+
+	if (previousValues == NULL) {
+		previousValues = CFDictionaryCreateMutable(NULL,
+							   0,
+							   &kCFTypeDictionaryKeyCallBacks,
+							   &kCFTypeDictionaryValueCallBacks);
+	}
+
+	if (!CFDictionaryContainsKey(previousValues, entry->key)) {
+		CFDictionarySetValue(previousValues,
+				     entry->key,
+				     (entry->data != NULL) ? (CFTypeRef)entry->data : (CFTypeRef)kCFNull);
+	}
+
+	return;
+}
+
+
+__private_extern__
+void
+_setNeedsNotification(mach_port_t server)
+{
 	/*
-	 * this list of notifications have been posted, wait for some more.
+	 * flag this session as needing a kick
 	 */
-	CFRelease(needsNotification);
-	needsNotification = NULL;
-
+	if (needsNotification == NULL)
+		needsNotification = CFSetCreateMutable(NULL, 0, NULL);	/* set of mach_port_t */
+	CFSetAddValue(needsNotification, (const void *)(uintptr_t)server);
 	return;
 }
@@ -37,9 +37,12 @@
 
 #include <sys/cdefs.h>
 
+#include "store.h"
+
 
 /*
- * keys in the "storeData" dictionary
+ * keys in the per-key "store" information dictionary (as reported
+ * by a snapshot)
  */
 
 /*
@@ -57,6 +60,10 @@
  * client session id for per-session keys.
  */
 #define	kSCDSession	CFSTR("session")
+/*
+ * store generation in which the data associated with a key last changed
+ */
+#define	kSCDGeneration	CFSTR("generation")
 
 
 /*
@@ -68,22 +75,51 @@
  */
 #define	kSCDName	CFSTR("name")
 /*
- * keys which have changed since last call to SCDNotifierGetChanges()
- */
-#define	kSCDChangedKeys	CFSTR("changedKeys")
-/*
- * keys which are to be removed when the session is closed
+ * keys which are to be removed when the session is closed (only
+ * present in a snapshot, see _addSessionKey())
  */
 #define	kSCDSessionKeys	CFSTR("sessionKeys")
 
 
-extern CFMutableDictionaryRef	storeData;
 extern CFMutableDictionaryRef	sessionData;
 extern CFMutableDictionaryRef	patternData;
 extern CFMutableSetRef		changedKeys;
 extern CFMutableSetRef		deferredRemovals;
-extern CFMutableSetRef		removedSessionKeys;
-extern CFMutableSetRef		needsNotification;
+extern CFMutableSetRef		needsNotification;	/* set of session (mach_port_t) */
+extern CFMutableDictionaryRef	previousValues;		/* changed key --> data (or kCFNull) before the change */
+
+
+/*
+ * a change to a [watched] key (see __SCDynamicStoreWatcherWantsChange)
+ */
+typedef struct {
+	storeEntryRef		entry;		/* the changed key */
+	CFDataRef		previous;	/* serialized value before the change, kCFNull if none, NULL if unknown */
+	CFDataRef		current;	/* serialized value after the change, NULL if removed */
+
+	/* decoded values (filled in as needed) */
+	Boolean			decoded;
+	CFPropertyListRef	previousValue;
+	CFPropertyListRef	currentValue;
+} storeValueChange, *storeValueChangeRef;
+
+
+/*
+ * The store "engine" (the __SCDynamicStore*() functions below, the store,
+ * and the pattern / watcher bookkeeping) does not depend on how requests
+ * arrive or how sessions are notified.  A session is identified by an
+ * opaque id (in configd, the session's mach port) and the "transport"
+ * driving the engine is responsible for :
+ *
+ *   - mapping session ids to a serverSession (see getSession()),
+ *   - opening a session with __SCDynamicStoreOpen() and then
+ *     associating it with its id (see __SCDynamicStoreAttachSession()),
+ *   - notifying the sessions in "needsNotification" once a request has
+ *     been processed (in configd, see pushNotifications()).
+ *
+ * The MiG server (configd) and the replay driver (tests/replay) are the
+ * two transports.
+ */
 
 
 __BEGIN_DECLS
@@ -91,6 +127,11 @@ __BEGIN_DECLS
 int
 __SCDynamicStoreOpen			(SCDynamicStoreRef	*store,
 					 CFStringRef		name);
+
+void
+__SCDynamicStoreAttachSession		(SCDynamicStoreRef	store,
+					 mach_port_t		server,
+					 CFStringRef		name);
 int
 __SCDynamicStoreClose			(SCDynamicStoreRef	*store);
 
@@ -103,6 +144,12 @@ __SCDynamicStoreCopyKeyList		(SCDynamicStoreRef	store,
 					 Boolean		isRegex,
 					 CFArrayRef		*subKeys);
 
+int
+__SCDynamicStoreSnapshotCopyKeyList	(storeSnapshotRef	snapshot,
+					 CFStringRef		prefix,
+					 Boolean		isRegex,
+					 CFArrayRef		*subKeys);
+
 int
 __SCDynamicStoreAddValue		(SCDynamicStoreRef	store,
 					 CFStringRef		key,
@@ -114,12 +161,36 @@ __SCDynamicStoreCopyValue		(SCDynamicStoreRef	store,
 					 CFDataRef		*value,
 					 Boolean		internal);
 
+int
+__SCDynamicStoreSnapshotCopyValue	(storeSnapshotRef	snapshot,
+					 mach_port_t		server,
+					 CFStringRef		key,
+					 CFDataRef		*value,
+					 Boolean		internal);
+
 int
 __SCDynamicStoreCopyMultiple		(SCDynamicStoreRef	store,
 					 CFArrayRef		keys,
 					 CFArrayRef		patterns,
 					 CFDictionaryRef	*values);
 
+int
+__SCDynamicStoreSnapshotCopyMultiple	(storeSnapshotRef	snapshot,
+					 mach_port_t		server,
+					 CFArrayRef		keys,
+					 CFArrayRef		patterns,
+					 CFDictionaryRef	*values);
+
+int
+__SCDynamicStoreSnapshotCopyMultipleSince
+					(storeSnapshotRef	snapshot,
+					 mach_port_t		server,
+					 CFArrayRef		keys,
+					 CFArrayRef		patterns,
+					 uint64_t		since,
+					 CFDictionaryRef	*values,
+					 CFArrayRef		*unchanged);
+
 int
 __SCDynamicStoreSetValue		(SCDynamicStoreRef	store,
 					 CFStringRef		key,
@@ -145,6 +216,11 @@ __SCDynamicStoreNotifyValue		(SCDynamicStoreRef	store,
 int
 __SCDynamicStoreSnapshot		(SCDynamicStoreRef	store);
 
+int
+__SCDynamicStoreSnapshotStream		(SCDynamicStoreRef	store,
+					 Boolean		delta,
+					 uint64_t		*generation);
+
 int
 __SCDynamicStoreAddWatchedKey		(SCDynamicStoreRef	store,
 					 CFStringRef		key,
@@ -184,6 +260,30 @@ __SCDynamicStoreNotifySignal		(SCDynamicStoreRef	store,
 int
 __SCDynamicStoreNotifyCancel		(SCDynamicStoreRef	store);
 
+int
+__SCDynamicStoreNotifyRing		(SCDynamicStoreRef	store,
+					 mach_port_t		*ring);
+
+Boolean
+__SCDynamicStoreNotifyRingPush		(SCDynamicStoreRef	store);
+
+void
+__SCDynamicStoreNotifyRingRelease	(SCDynamicStoreRef	store);
+
+int
+__SCDynamicStoreSetWatchedKeyProperties	(SCDynamicStoreRef	store,
+					 CFStringRef		key,
+					 Boolean		isRegex,
+					 CFArrayRef		properties);
+
+Boolean
+__SCDynamicStoreWatcherWantsChange	(SCDynamicStoreRef	store,
+					 CFStringRef		key,
+					 storeValueChangeRef	change);
+
+void
+_savePreviousValue			(storeEntryRef		entry);
+
 void
 _addWatcher				(CFNumberRef		sessionNum,
 					 CFStringRef		watchedKey);
@@ -193,7 +293,18 @@ _removeWatcher				(CFNumberRef		sessionNum,
 					 CFStringRef		watchedKey);
 
 void
-pushNotifications			(FILE			*_configd_trace);
+_addSessionKey				(SCDynamicStoreRef	store,
+					 CFStringRef		key);
+
+void
+_removeSessionKey			(mach_port_t		server,
+					 CFStringRef		key);
+
+void
+_setNeedsNotification			(mach_port_t		server);
+
+void
+pushNotifications			(void);
 
 __END_DECLS
 
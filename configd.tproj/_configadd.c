@@ -33,6 +33,7 @@
 
 #include "configd.h"
 #include "session.h"
+#include "trace.h"
 
 __private_extern__
 int
@@ -41,15 +42,7 @@ __SCDynamicStoreAddValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef val
 	int				sc_status	= kSCStatusOK;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
 	CFDataRef			tempValue;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s%s : %5d : %@\n"),
-			"add  ",
-			storePrivate->useSessionKeys ? "t " : "  ",
-			storePrivate->server,
-			key);
-	}
+	uint64_t			traceTime	= traceStart();
 
 	/*
 	 * Ensure that this is a new key.
@@ -83,6 +76,13 @@ __SCDynamicStoreAddValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef val
 
     done:
 
+	traceRecordOp(kTraceOpAdd,
+		      storePrivate->useSessionKeys ? kTraceFlagSessionKey : 0,
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -134,6 +134,12 @@ _configadd(mach_port_t 			server,
 		}
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (!hasWriteAccess(mySession, key)) {
 		*sc_status = kSCStatusAccessError;
 		goto done;
@@ -197,6 +203,12 @@ _configadd_s(mach_port_t 		server,
 		goto done;
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (!hasWriteAccess(mySession, key)) {
 		*sc_status = kSCStatusAccessError;
 		goto done;
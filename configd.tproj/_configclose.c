@@ -35,26 +35,27 @@
 
 #include "configd.h"
 #include "session.h"
+#include "pattern.h"
+#include "journal.h"
+#include "trace.h"
 
 static Boolean
-isMySessionKey(CFStringRef sessionKey, CFStringRef key)
+isMySessionKey(mach_port_t server, CFStringRef key)
 {
-	CFDictionaryRef	dict;
-	CFStringRef	storeSessionKey;
+	storeEntryRef	entry;
 
-	dict = CFDictionaryGetValue(storeData, key);
-	if (!dict) {
+	entry = storeLookup(key);
+	if ((entry == NULL) || (entry->data == NULL)) {
 		/* if key no longer exists */
 		return FALSE;
 	}
 
-	storeSessionKey = CFDictionaryGetValue(dict, kSCDSession);
-	if (!storeSessionKey) {
+	if (entry->session == MACH_PORT_NULL) {
 		/* if this is not a session key */
 		return FALSE;
 	}
 
-	if (!CFEqual(sessionKey, storeSessionKey)) {
+	if (entry->session != server) {
 		/* if this is not "my" session key */
 		return FALSE;
 	}
@@ -63,27 +64,80 @@ isMySessionKey(CFStringRef sessionKey, CFStringRef key)
 }
 
 
+/*
+ * "context" argument for removeWatchedKey() and removeSessionKey()
+ */
+typedef struct {
+	SCDynamicStoreRef	store;
+	CFNumberRef		sessionNum;
+	Boolean			isRegex;
+	Boolean			push;
+} removeKeysContext, *removeKeysContextRef;
+
+
+static void
+removeWatchedKey(const void *value, void *context)
+{
+	CFStringRef		key		= (CFStringRef)value;
+	removeKeysContextRef	myContextRef	= (removeKeysContextRef)context;
+
+	if (myContextRef->isRegex) {
+		/* remove this session as a pattern watcher */
+		patternRemoveSession(key, myContextRef->sessionNum);
+	} else {
+		/* remove our interest in any changes to the key */
+		_removeWatcher(myContextRef->sessionNum, key);
+	}
+
+	return;
+}
+
+
 static void
 removeAllKeys(SCDynamicStoreRef store, Boolean isRegex)
 {
+	CFMutableSetRef			keys;
+	removeKeysContext		myContext;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
-	CFArrayRef			keys;
-	CFIndex				n;
-
-	keys = isRegex ? storePrivate->patterns : storePrivate->keys;
-	n = (keys != NULL) ? CFArrayGetCount(keys) : 0;
-	if (n > 0) {
-		CFIndex		i;
-		CFArrayRef	keysToRemove;
-
-		keysToRemove = CFArrayCreateCopy(NULL, keys);
-		for (i = 0; i < n; i++) {
-			(void) __SCDynamicStoreRemoveWatchedKey(store,
-								CFArrayGetValueAtIndex(keysToRemove, i),
-								isRegex,
-								TRUE);
-		}
-		CFRelease(keysToRemove);
+
+	/*
+	 * detach the notifier list from the session and drop all of the
+	 * session's watches at once (vs. one __SCDynamicStoreRemoveWatchedKey()
+	 * per key).
+	 */
+	if (isRegex) {
+		keys = storePrivate->watchedPatterns;
+		storePrivate->watchedPatterns = NULL;
+	} else {
+		keys = storePrivate->watchedKeys;
+		storePrivate->watchedKeys = NULL;
+	}
+	if (keys == NULL) {
+		return;
+	}
+
+	myContext.store      = store;
+	myContext.sessionNum = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
+	myContext.isRegex    = isRegex;
+	myContext.push       = FALSE;
+	CFSetApplyFunction(keys, removeWatchedKey, &myContext);
+	CFRelease(myContext.sessionNum);
+	CFRelease(keys);
+
+	return;
+}
+
+
+static void
+removeSessionKey(const void *value, void *context)
+{
+	CFStringRef			key		= (CFStringRef)value;
+	removeKeysContextRef		myContextRef	= (removeKeysContextRef)context;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)myContextRef->store;
+
+	if (isMySessionKey(storePrivate->server, key)) {
+		(void) __SCDynamicStoreRemoveValue(myContextRef->store, key, TRUE);
+		myContextRef->push = TRUE;
 	}
 
 	return;
@@ -94,18 +148,12 @@ __private_extern__
 int
 __SCDynamicStoreClose(SCDynamicStoreRef *store)
 {
-	CFDictionaryRef			dict;
-	CFArrayRef			keys;
-	CFIndex				keyCnt;
+	CFMutableSetRef			keys;
 	serverSessionRef		mySession;
-	CFStringRef			sessionKey;
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)*store;
+	uint64_t			traceTime	= traceStart();
 
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("close   : %5d\n"),
-			storePrivate->server);
-	}
+	journalAppend(kJournalClose, storePrivate->server, FALSE, NULL, NULL);
 
 	/* Remove all notification keys and patterns */
 	removeAllKeys(*store, FALSE);	// keys
@@ -115,28 +163,28 @@ __SCDynamicStoreClose(SCDynamicStoreRef *store)
 	__MACH_PORT_DEBUG(storePrivate->notifyPort != MACH_PORT_NULL, "*** __SCDynamicStoreClose", storePrivate->notifyPort);
 	(void) __SCDynamicStoreNotifyCancel(*store);
 
-	/* Remove any session keys */
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
-	dict = CFDictionaryGetValue(sessionData, sessionKey);
-	keys = CFDictionaryGetValue(dict, kSCDSessionKeys);
-	if (keys && ((keyCnt = CFArrayGetCount(keys)) > 0)) {
-		CFIndex	i;
-		Boolean	push	= FALSE;
-
-		/* remove session keys */
-		for (i = 0; i < keyCnt; i++) {
-			if (isMySessionKey(sessionKey, CFArrayGetValueAtIndex(keys, i))) {
-				(void) __SCDynamicStoreRemoveValue(*store, CFArrayGetValueAtIndex(keys, i), TRUE);
-				push = TRUE;
-			}
-		}
-
-		if (push) {
+	/*
+	 * Remove any session keys (detaching the list first, there is no
+	 * need to update it as each key is removed) and push all of the
+	 * changes at once.
+	 */
+	keys = storePrivate->sessionKeys;
+	storePrivate->sessionKeys = NULL;
+	if (keys != NULL) {
+		removeKeysContext	myContext;
+
+		myContext.store      = *store;
+		myContext.sessionNum = NULL;
+		myContext.isRegex    = FALSE;
+		myContext.push       = FALSE;
+		CFSetApplyFunction(keys, removeSessionKey, &myContext);
+		CFRelease(keys);
+
+		if (myContext.push) {
 			/* push changes */
 			(void) __SCDynamicStorePush();
 		}
 	}
-	CFRelease(sessionKey);
 
 	/*
 	 * invalidate and release our run loop source on the server
@@ -154,6 +202,8 @@ __SCDynamicStoreClose(SCDynamicStoreRef *store)
 		mySession->serverPort = NULL;
 	}
 
+	traceRecordOp(kTraceOpClose, 0, storePrivate->server, NULL, kSCStatusOK, traceTime, 0);
+
 	storePrivate->server = MACH_PORT_NULL;
 	CFRelease(*store);
 	*store = NULL;
@@ -32,33 +32,74 @@
  */
 
 #include "configd.h"
+#include "configd_server.h"
 #include "session.h"
+#include "checkpoint.h"
+#include "trace.h"
+
+#define	N_QUICK	32
 
 __private_extern__
 int
 __SCDynamicStoreCopyValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef *value, Boolean internal)
 {
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-	CFDictionaryRef			dict;
+	storeEntryRef			entry;
+	int				sc_status	= kSCStatusOK;
+	uint64_t			traceTime	= traceStart();
 
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s : %5d : %@\n"),
-			internal ? "*copy  " : "copy   ",
-			storePrivate->server,
-			key);
+	entry = storeLookup(key);
+	if ((entry == NULL) || (entry->data == NULL)) {
+		/* key doesn't exist (or data never defined) */
+		sc_status = kSCStatusNoKey;
+		goto done;
 	}
 
-	dict = CFDictionaryGetValue(storeData, key);
-	if ((dict == NULL) || (CFDictionaryContainsKey(dict, kSCDData) == FALSE)) {
+	/* Return the data associated with the key */
+	*value = CFRetain(entry->data);
+	checkpointNoteRead();
+
+    done :
+
+	traceRecordOp(kTraceOpCopy,
+		      internal ? kTraceFlagInternal : 0,
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
+	return sc_status;
+}
+
+__private_extern__
+int
+__SCDynamicStoreSnapshotCopyValue(storeSnapshotRef snapshot, mach_port_t server, CFStringRef key, CFDataRef *value, Boolean internal)
+{
+	CFDataRef	data;
+	int		sc_status	= kSCStatusOK;
+	uint64_t	traceTime	= traceStart();
+
+	data = storeSnapshotGetData(snapshot, key, NULL);
+	if (data == NULL) {
 		/* key doesn't exist (or data never defined) */
-		return kSCStatusNoKey;
+		sc_status = kSCStatusNoKey;
+		goto done;
 	}
 
 	/* Return the data associated with the key */
-	*value = CFRetain(CFDictionaryGetValue(dict, kSCDData));
+	*value = CFRetain(data);
+	checkpointNoteRead();
 
-	return kSCStatusOK;
+    done :
+
+	traceRecordOp(kTraceOpCopy,
+		      kTraceFlagSnapshot | (internal ? kTraceFlagInternal : 0),
+		      server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
+	return sc_status;
 }
 
 __private_extern__
@@ -76,6 +117,7 @@ _configget(mach_port_t			server,
 	CFIndex			len;
 	serverSessionRef	mySession;
 	Boolean			ok;
+	storeSnapshotRef	snapshot;
 	CFDataRef		value;
 
 	*dataRef = NULL;
@@ -92,17 +134,23 @@ _configget(mach_port_t			server,
 		goto done;
 	}
 
-	mySession = getSession(server);
-	if (mySession == NULL) {
-		mySession = tempSession(server, CFSTR("SCDynamicStoreCopyValue"), audit_token);
+	snapshot = serverReaderSnapshot();
+	if (snapshot != NULL) {
+		/* if this request is being serviced by a reader thread */
+		*sc_status = __SCDynamicStoreSnapshotCopyValue(snapshot, server, key, &value, FALSE);
+	} else {
+		mySession = getSession(server);
 		if (mySession == NULL) {
-			/* you must have an open session to play */
-			*sc_status = kSCStatusNoStoreSession;
-			goto done;
+			mySession = tempSession(server, CFSTR("SCDynamicStoreCopyValue"), audit_token);
+			if (mySession == NULL) {
+				/* you must have an open session to play */
+				*sc_status = kSCStatusNoStoreSession;
+				goto done;
+			}
 		}
-	}
 
-	*sc_status = __SCDynamicStoreCopyValue(mySession->store, key, &value, FALSE);
+		*sc_status = __SCDynamicStoreCopyValue(mySession->store, key, &value, FALSE);
+	}
 	if (*sc_status != kSCStatusOK) {
 		goto done;
 	}
@@ -132,7 +180,11 @@ _configget(mach_port_t			server,
  */
 typedef struct {
 	SCDynamicStoreRef	store;
+	storeSnapshotRef	snapshot;	/* non-NULL if reading from a store snapshot */
+	mach_port_t		server;
 	CFMutableDictionaryRef	dict;
+	uint64_t		since;
+	CFMutableSetRef		unchanged;	/* non-NULL if only returning values changed since "since" */
 } addSpecific, *addSpecificRef;
 
 static void
@@ -147,7 +199,32 @@ addSpecificKey(const void *value, void *context)
 		return;
 	}
 
-	sc_status = __SCDynamicStoreCopyValue(myContextRef->store, key, &data, TRUE);
+	if (myContextRef->unchanged != NULL) {
+		uint64_t	generation;
+
+		data = storeSnapshotGetData(myContextRef->snapshot, key, &generation);
+		if (data == NULL) {
+			/* key doesn't exist (or data never defined) */
+			return;
+		}
+
+		if (generation <= myContextRef->since) {
+			/* if the caller already has this value */
+			CFSetAddValue(myContextRef->unchanged, key);
+			return;
+		}
+
+		CFRetain(data);
+		sc_status = kSCStatusOK;
+	} else if (myContextRef->snapshot != NULL) {
+		sc_status = __SCDynamicStoreSnapshotCopyValue(myContextRef->snapshot,
+							      myContextRef->server,
+							      key,
+							      &data,
+							      TRUE);
+	} else {
+		sc_status = __SCDynamicStoreCopyValue(myContextRef->store, key, &data, TRUE);
+	}
 	if (sc_status == kSCStatusOK) {
 		CFDictionaryAddValue(myContextRef->dict, key, data);
 		CFRelease(data);
@@ -168,7 +245,11 @@ addSpecificPattern(const void *value, void *context)
 		return;
 	}
 
-	sc_status = __SCDynamicStoreCopyKeyList(myContextRef->store, pattern, TRUE, &keys);
+	if (myContextRef->snapshot != NULL) {
+		sc_status = __SCDynamicStoreSnapshotCopyKeyList(myContextRef->snapshot, pattern, TRUE, &keys);
+	} else {
+		sc_status = __SCDynamicStoreCopyKeyList(myContextRef->store, pattern, TRUE, &keys);
+	}
 	if (sc_status == kSCStatusOK) {
 		CFArrayApplyFunction(keys,
 				     CFRangeMake(0, CFArrayGetCount(keys)),
@@ -180,43 +261,169 @@ addSpecificPattern(const void *value, void *context)
 	return;
 }
 
-__private_extern__
-int
-__SCDynamicStoreCopyMultiple(SCDynamicStoreRef store, CFArrayRef keys, CFArrayRef patterns, CFDictionaryRef *values)
+static void
+copyMultiple(addSpecificRef myContextRef, CFArrayRef keys, CFArrayRef patterns, CFDictionaryRef *values)
 {
-	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-	addSpecific			myContext;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("copy m  : %5d : %ld keys, %ld patterns\n"),
-			storePrivate->server,
-			keys     ? CFArrayGetCount(keys)     : 0,
-			patterns ? CFArrayGetCount(patterns) : 0);
-	}
-
-	myContext.store = store;
-	myContext.dict  = CFDictionaryCreateMutable(NULL,
-						    0,
-						    &kCFTypeDictionaryKeyCallBacks,
-						    &kCFTypeDictionaryValueCallBacks);
+	myContextRef->dict = CFDictionaryCreateMutable(NULL,
+						       0,
+						       &kCFTypeDictionaryKeyCallBacks,
+						       &kCFTypeDictionaryValueCallBacks);
 
 	if (keys) {
 		CFArrayApplyFunction(keys,
 				     CFRangeMake(0, CFArrayGetCount(keys)),
 				     addSpecificKey,
-				     &myContext);
+				     myContextRef);
 	}
 
 	if (patterns) {
 		CFArrayApplyFunction(patterns,
 				     CFRangeMake(0, CFArrayGetCount(patterns)),
 				     addSpecificPattern,
-				     &myContext);
+				     myContextRef);
 	}
 
 	/* Return the keys/values associated with the key */
-	*values = myContext.dict;
+	*values = myContextRef->dict;
+	if (CFDictionaryGetCount(myContextRef->dict) > 0) {
+		checkpointNoteRead();
+	}
+
+	return;
+}
+
+__private_extern__
+int
+__SCDynamicStoreCopyMultiple(SCDynamicStoreRef store, CFArrayRef keys, CFArrayRef patterns, CFDictionaryRef *values)
+{
+	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
+	addSpecific			myContext;
+	uint64_t			traceTime	= traceStart();
+
+	myContext.store     = store;
+	myContext.snapshot  = NULL;
+	myContext.server    = storePrivate->server;
+	myContext.since     = 0;
+	myContext.unchanged = NULL;
+	copyMultiple(&myContext, keys, patterns, values);
+
+	traceRecordOp(kTraceOpCopyMultiple,
+		      0,
+		      storePrivate->server,
+		      NULL,
+		      kSCStatusOK,
+		      traceTime,
+		      traceArgCounts(keys     ? CFArrayGetCount(keys)     : 0,
+				     patterns ? CFArrayGetCount(patterns) : 0));
+	return kSCStatusOK;
+}
+
+__private_extern__
+int
+__SCDynamicStoreSnapshotCopyMultiple(storeSnapshotRef snapshot, mach_port_t server, CFArrayRef keys, CFArrayRef patterns, CFDictionaryRef *values)
+{
+	addSpecific	myContext;
+	uint64_t	traceTime	= traceStart();
+
+	myContext.store     = NULL;
+	myContext.snapshot  = snapshot;
+	myContext.server    = server;
+	myContext.since     = 0;
+	myContext.unchanged = NULL;
+	copyMultiple(&myContext, keys, patterns, values);
+
+	traceRecordOp(kTraceOpCopyMultiple,
+		      kTraceFlagSnapshot,
+		      server,
+		      NULL,
+		      kSCStatusOK,
+		      traceTime,
+		      traceArgCounts(keys     ? CFArrayGetCount(keys)     : 0,
+				     patterns ? CFArrayGetCount(patterns) : 0));
+	return kSCStatusOK;
+}
+
+__private_extern__
+int
+__SCDynamicStoreSnapshotCopyMultipleSince(storeSnapshotRef	snapshot,
+					  mach_port_t		server,
+					  CFArrayRef		keys,
+					  CFArrayRef		patterns,
+					  uint64_t		since,
+					  CFDictionaryRef	*values,
+					  CFArrayRef		*unchanged)
+{
+	CFIndex		n;
+	addSpecific	myContext;
+	const void *	unchanged_q[N_QUICK];
+	const void **	unchangedKeys	= unchanged_q;
+	uint64_t	traceTime	= traceStart();
+
+	myContext.store     = NULL;
+	myContext.snapshot  = snapshot;
+	myContext.server    = server;
+	myContext.since     = since;
+	myContext.unchanged = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
+	copyMultiple(&myContext, keys, patterns, values);
+
+	/* Return the keys whose values have not changed */
+	n = CFSetGetCount(myContext.unchanged);
+	if (n > (CFIndex)(sizeof(unchanged_q) / sizeof(CFStringRef)))
+		unchangedKeys = CFAllocatorAllocate(NULL, n * sizeof(CFStringRef), 0);
+	CFSetGetValues(myContext.unchanged, unchangedKeys);
+	*unchanged = CFArrayCreate(NULL, unchangedKeys, n, &kCFTypeArrayCallBacks);
+	if (unchangedKeys != unchanged_q) CFAllocatorDeallocate(NULL, unchangedKeys);
+	CFRelease(myContext.unchanged);
+
+	traceRecordOp(kTraceOpCopyMultiple,
+		      kTraceFlagSnapshot,
+		      server,
+		      NULL,
+		      kSCStatusOK,
+		      traceTime,
+		      traceArgCounts(keys     ? CFArrayGetCount(keys)     : 0,
+				     patterns ? CFArrayGetCount(patterns) : 0));
+	return kSCStatusOK;
+}
+
+static int
+unserializeKeysAndPatterns(xmlData_t			keysRef,
+			   mach_msg_type_number_t	keysLen,
+			   xmlData_t			patternsRef,
+			   mach_msg_type_number_t	patternsLen,
+			   CFArrayRef			*keys,
+			   CFArrayRef			*patterns)
+{
+	int	sc_status	= kSCStatusOK;
+
+	*keys     = NULL;
+	*patterns = NULL;
+
+	if (keysRef && (keysLen > 0)) {
+		/* un-serialize the keys */
+		if (!_SCUnserialize((CFPropertyListRef *)keys, NULL, (void *)keysRef, keysLen)) {
+			sc_status = kSCStatusFailed;
+		}
+	}
+
+	if (patternsRef && (patternsLen > 0)) {
+		/* un-serialize the patterns */
+		if (!_SCUnserialize((CFPropertyListRef *)patterns, NULL, (void *)patternsRef, patternsLen)) {
+			sc_status = kSCStatusFailed;
+		}
+	}
+
+	if (sc_status != kSCStatusOK) {
+		return sc_status;
+	}
+
+	if ((*keys != NULL) && !isA_CFArray(*keys)) {
+		return kSCStatusInvalidArgument;
+	}
+
+	if ((*patterns != NULL) && !isA_CFArray(*patterns)) {
+		return kSCStatusInvalidArgument;
+	}
 
 	return kSCStatusOK;
 }
@@ -239,57 +446,206 @@ _configget_m(mach_port_t		server,
 	serverSessionRef	mySession;
 	Boolean			ok;
 	CFArrayRef		patterns	= NULL;	/* patterns (un-serialized) */
+	storeSnapshotRef	snapshot;
 
 	*dataRef = NULL;
 	*dataLen = 0;
 
-	*sc_status = kSCStatusOK;
+	*sc_status = unserializeKeysAndPatterns(keysRef, keysLen, patternsRef, patternsLen, &keys, &patterns);
+	if (*sc_status != kSCStatusOK) {
+		goto done;
+	}
 
-	if (keysRef && (keysLen > 0)) {
-		/* un-serialize the keys */
-		if (!_SCUnserialize((CFPropertyListRef *)&keys, NULL, (void *)keysRef, keysLen)) {
-			*sc_status = kSCStatusFailed;
+	snapshot = serverReaderSnapshot();
+	if (snapshot != NULL) {
+		/* if this request is being serviced by a reader thread */
+		*sc_status = __SCDynamicStoreSnapshotCopyMultiple(snapshot, server, keys, patterns, &dict);
+	} else {
+		mySession = getSession(server);
+		if (mySession == NULL) {
+			mySession = tempSession(server, CFSTR("SCDynamicStoreCopyMultiple"), audit_token);
+			if (mySession == NULL) {
+				/* you must have an open session to play */
+				*sc_status = kSCStatusNoStoreSession;
+				goto done;
+			}
 		}
+
+		/* fetch the requested information */
+		*sc_status = __SCDynamicStoreCopyMultiple(mySession->store, keys, patterns, &dict);
 	}
 
-	if (patternsRef && (patternsLen > 0)) {
-		/* un-serialize the patterns */
-		if (!_SCUnserialize((CFPropertyListRef *)&patterns, NULL, (void *)patternsRef, patternsLen)) {
-			*sc_status = kSCStatusFailed;
+	/* serialize the dictionary of matching keys/patterns */
+	ok = _SCSerialize(dict, NULL, (void **)dataRef, &len);
+	*dataLen = (mach_msg_type_number_t)len;
+	CFRelease(dict);
+	if (!ok) {
+		*sc_status = kSCStatusFailed;
+	}
+
+    done :
+
+	if (keys)	CFRelease(keys);
+	if (patterns)	CFRelease(patterns);
+	return KERN_SUCCESS;
+}
+
+/*
+ * copyRequestSnapshot
+ *   returns the [retained] store snapshot against which a versioned
+ *   request should be serviced.  All of the values returned by such a
+ *   request come from a single (immutable) version of the store.
+ */
+static int
+copyRequestSnapshot(mach_port_t		server,
+		    CFStringRef		name,
+		    audit_token_t	audit_token,
+		    uint64_t		asOf,
+		    storeSnapshotRef	*snapshot)
+{
+	serverSessionRef	mySession;
+	storeSnapshotRef	readerSnapshot;
+
+	readerSnapshot = serverReaderSnapshot();
+	if (readerSnapshot == NULL) {
+		/* if this request is being serviced by the server thread */
+		mySession = getSession(server);
+		if (mySession == NULL) {
+			mySession = tempSession(server, name, audit_token);
+			if (mySession == NULL) {
+				/* you must have an open session to play */
+				return kSCStatusNoStoreSession;
+			}
+		}
+	}
+
+	if (asOf != 0) {
+		*snapshot = storeSnapshotCopyGeneration(asOf);
+		if (*snapshot == NULL) {
+			/* if that generation is no longer available */
+			return kSCStatusStale;
 		}
+	} else if (readerSnapshot != NULL) {
+		*snapshot = storeSnapshotRetain(readerSnapshot);
+	} else {
+		*snapshot = storeSnapshotCopy();
 	}
 
+	return kSCStatusOK;
+}
+
+__private_extern__
+kern_return_t
+_configget_m_gen(mach_port_t			server,
+		 xmlData_t			keysRef,
+		 mach_msg_type_number_t		keysLen,
+		 xmlData_t			patternsRef,
+		 mach_msg_type_number_t		patternsLen,
+		 uint64_t			asOf,
+		 xmlDataOut_t			*dataRef,
+		 mach_msg_type_number_t		*dataLen,
+		 uint64_t			*generation,
+		 int				*sc_status,
+		 audit_token_t			audit_token)
+{
+	CFDictionaryRef		dict		= NULL;	/* keys/values (un-serialized) */
+	CFArrayRef		keys		= NULL;	/* keys (un-serialized) */
+	CFIndex			len;
+	Boolean			ok;
+	CFArrayRef		patterns	= NULL;	/* patterns (un-serialized) */
+	storeSnapshotRef	snapshot;
+
+	*dataRef = NULL;
+	*dataLen = 0;
+	*generation = 0;
+
+	*sc_status = unserializeKeysAndPatterns(keysRef, keysLen, patternsRef, patternsLen, &keys, &patterns);
 	if (*sc_status != kSCStatusOK) {
 		goto done;
 	}
 
-	if ((keys != NULL) && !isA_CFArray(keys)) {
-		*sc_status = kSCStatusInvalidArgument;
+	*sc_status = copyRequestSnapshot(server, CFSTR("SCDynamicStoreCopyMultiple"), audit_token, asOf, &snapshot);
+	if (*sc_status != kSCStatusOK) {
 		goto done;
 	}
 
-	if ((patterns != NULL) && !isA_CFArray(patterns)) {
-		*sc_status = kSCStatusInvalidArgument;
+	/* fetch the requested information */
+	*sc_status = __SCDynamicStoreSnapshotCopyMultiple(snapshot, server, keys, patterns, &dict);
+	*generation = storeSnapshotGetGeneration(snapshot);
+	storeSnapshotRelease(snapshot);
+
+	/* serialize the dictionary of matching keys/patterns */
+	ok = _SCSerialize(dict, NULL, (void **)dataRef, &len);
+	*dataLen = (mach_msg_type_number_t)len;
+	CFRelease(dict);
+	if (!ok) {
+		*sc_status = kSCStatusFailed;
+	}
+
+    done :
+
+	if (keys)	CFRelease(keys);
+	if (patterns)	CFRelease(patterns);
+	return KERN_SUCCESS;
+}
+
+__private_extern__
+kern_return_t
+_configget_m_since(mach_port_t			server,
+		   xmlData_t			keysRef,
+		   mach_msg_type_number_t	keysLen,
+		   xmlData_t			patternsRef,
+		   mach_msg_type_number_t	patternsLen,
+		   uint64_t			since,
+		   xmlDataOut_t			*dataRef,
+		   mach_msg_type_number_t	*dataLen,
+		   xmlDataOut_t			*unchangedRef,
+		   mach_msg_type_number_t	*unchangedLen,
+		   uint64_t			*generation,
+		   int				*sc_status,
+		   audit_token_t		audit_token)
+{
+	CFDictionaryRef		dict		= NULL;	/* keys/values (un-serialized) */
+	CFArrayRef		keys		= NULL;	/* keys (un-serialized) */
+	CFIndex			len;
+	Boolean			ok;
+	CFArrayRef		patterns	= NULL;	/* patterns (un-serialized) */
+	storeSnapshotRef	snapshot;
+	CFArrayRef		unchanged	= NULL;	/* unchanged keys (un-serialized) */
+
+	*dataRef = NULL;
+	*dataLen = 0;
+	*unchangedRef = NULL;
+	*unchangedLen = 0;
+	*generation = 0;
+
+	*sc_status = unserializeKeysAndPatterns(keysRef, keysLen, patternsRef, patternsLen, &keys, &patterns);
+	if (*sc_status != kSCStatusOK) {
 		goto done;
 	}
 
-	mySession = getSession(server);
-	if (mySession == NULL) {
-		mySession = tempSession(server, CFSTR("SCDynamicStoreCopyMultiple"), audit_token);
-		if (mySession == NULL) {
-			/* you must have an open session to play */
-			*sc_status = kSCStatusNoStoreSession;
-			goto done;
-		}
+	*sc_status = copyRequestSnapshot(server, CFSTR("SCDynamicStoreCopyMultipleIfChanged"), audit_token, 0, &snapshot);
+	if (*sc_status != kSCStatusOK) {
+		goto done;
 	}
 
-	/* fetch the requested information */
-	*sc_status = __SCDynamicStoreCopyMultiple(mySession->store, keys, patterns, &dict);
+	/* fetch the values which have changed since the caller's generation */
+	*sc_status = __SCDynamicStoreSnapshotCopyMultipleSince(snapshot, server, keys, patterns, since, &dict, &unchanged);
+	*generation = storeSnapshotGetGeneration(snapshot);
+	storeSnapshotRelease(snapshot);
 
-	/* serialize the dictionary of matching keys/patterns */
+	/* serialize the dictionary of changed keys/values */
 	ok = _SCSerialize(dict, NULL, (void **)dataRef, &len);
 	*dataLen = (mach_msg_type_number_t)len;
 	CFRelease(dict);
+	if (!ok) {
+		*sc_status = kSCStatusFailed;
+		goto done;
+	}
+
+	/* serialize the list of unchanged keys */
+	ok = _SCSerialize(unchanged, NULL, (void **)unchangedRef, &len);
+	*unchangedLen = (mach_msg_type_number_t)len;
 	if (!ok) {
 		*sc_status = kSCStatusFailed;
 	}
@@ -298,5 +654,6 @@ _configget_m(mach_port_t		server,
 
 	if (keys)	CFRelease(keys);
 	if (patterns)	CFRelease(patterns);
+	if (unchanged)	CFRelease(unchanged);
 	return KERN_SUCCESS;
 }
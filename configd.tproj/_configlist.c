@@ -32,61 +32,71 @@
  */
 
 #include "configd.h"
+#include "configd_server.h"
 #include "session.h"
 #include "pattern.h"
 
-#define	N_QUICK	64
+
+static void
+addKey(storeEntryRef entry, void *context)
+{
+	CFMutableArrayRef	keys	= (CFMutableArrayRef)context;
+
+	CFArrayAppendValue(keys, entry->key);
+	return;
+}
+
 
 __private_extern__
 int
 __SCDynamicStoreCopyKeyList(SCDynamicStoreRef store, CFStringRef key, Boolean isRegex, CFArrayRef *subKeys)
 {
-	CFMutableArrayRef		keyArray;
-	CFIndex				storeCnt;
-	CFStringRef			storeStr;
-	CFDictionaryRef			storeValue;
+	CFMutableArrayRef	keys;
 
 	if (isRegex) {
 		*subKeys = patternCopyMatches(key);
 		return (*subKeys != NULL) ? kSCStatusOK : kSCStatusFailed;
 	}
 
-	storeCnt = CFDictionaryGetCount(storeData);
-	keyArray = CFArrayCreateMutable(NULL, storeCnt, &kCFTypeArrayCallBacks);
-	if (storeCnt > 0) {
-		int		i;
-		const void *	storeKeys_q[N_QUICK];
-		const void **	storeKeys	= storeKeys_q;
-		const void *	storeValues_q[N_QUICK];
-		const void **	storeValues	= storeValues_q;
-
-		if (storeCnt > (CFIndex)(sizeof(storeKeys_q) / sizeof(CFStringRef))) {
-			storeKeys   = CFAllocatorAllocate(NULL, storeCnt * sizeof(CFStringRef), 0);
-			storeValues = CFAllocatorAllocate(NULL, storeCnt * sizeof(CFStringRef), 0);
-		}
+	/*
+	 * return (in order) those keys which are prefixed by the
+	 * provided key string and have data.
+	 */
+	keys = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	storeApplyPrefixFunction(key, addKey, keys);
 
-		CFDictionaryGetKeysAndValues(storeData, storeKeys, storeValues);
-		for (i = 0; i < storeCnt; i++) {
-			storeStr   = (CFStringRef)storeKeys[i];
-			storeValue = (CFDictionaryRef)storeValues[i];
-			/*
-			 * only return those keys which are prefixed by the
-			 * provided key string and have data.
-			 */
-			if (((CFStringGetLength(key) == 0) || CFStringHasPrefix(storeStr, key)) &&
-			    CFDictionaryContainsKey(storeValue, kSCDData)) {
-				CFArrayAppendValue(keyArray, storeStr);
-			}
-		}
+	*subKeys = CFArrayCreateCopy(NULL, keys);
+	CFRelease(keys);
+	return kSCStatusOK;
+}
 
-		if (storeKeys != storeKeys_q) {
-			CFAllocatorDeallocate(NULL, storeKeys);
-			CFAllocatorDeallocate(NULL, storeValues);
-		}
+
+static void
+addSnapshotKey(CFStringRef key, CFDataRef data, void *context)
+{
+	CFMutableArrayRef	keys	= (CFMutableArrayRef)context;
+
+	CFArrayAppendValue(keys, key);
+	return;
+}
+
+
+__private_extern__
+int
+__SCDynamicStoreSnapshotCopyKeyList(storeSnapshotRef snapshot, CFStringRef key, Boolean isRegex, CFArrayRef *subKeys)
+{
+	CFMutableArrayRef	keys;
+
+	if (isRegex) {
+		*subKeys = patternCopySnapshotMatches(key, snapshot);
+		return (*subKeys != NULL) ? kSCStatusOK : kSCStatusFailed;
 	}
 
-	*subKeys = CFArrayCreateCopy(NULL, keyArray);
-	CFRelease(keyArray);
+	keys = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	storeSnapshotApplyPrefixFunction(snapshot, key, addSnapshotKey, keys);
+
+	*subKeys = CFArrayCreateCopy(NULL, keys);
+	CFRelease(keys);
 	return kSCStatusOK;
 }
 
@@ -106,6 +116,7 @@ _configlist(mach_port_t			server,
 	CFIndex			len;
 	serverSessionRef	mySession;
 	Boolean			ok;
+	storeSnapshotRef	snapshot;
 	CFArrayRef		subKeys;			/* array of CFStringRef's */
 
 	*listRef = NULL;
@@ -122,17 +133,23 @@ _configlist(mach_port_t			server,
 		goto done;
 	}
 
-	mySession = getSession(server);
-	if (mySession == NULL) {
-		mySession = tempSession(server, CFSTR("SCDynamicStoreCopyKeyList"), audit_token);
+	snapshot = serverReaderSnapshot();
+	if (snapshot != NULL) {
+		/* if this request is being serviced by a reader thread */
+		*sc_status = __SCDynamicStoreSnapshotCopyKeyList(snapshot, key, isRegex != 0, &subKeys);
+	} else {
+		mySession = getSession(server);
 		if (mySession == NULL) {
-			/* you must have an open session to play */
-			*sc_status = kSCStatusNoStoreSession;
-			goto done;
+			mySession = tempSession(server, CFSTR("SCDynamicStoreCopyKeyList"), audit_token);
+			if (mySession == NULL) {
+				/* you must have an open session to play */
+				*sc_status = kSCStatusNoStoreSession;
+				goto done;
+			}
 		}
-	}
 
-	*sc_status = __SCDynamicStoreCopyKeyList(mySession->store, key, isRegex != 0, &subKeys);
+		*sc_status = __SCDynamicStoreCopyKeyList(mySession->store, key, isRegex != 0, &subKeys);
+	}
 	if (*sc_status != kSCStatusOK) {
 		goto done;
 	}
@@ -30,30 +30,29 @@
 
 #include "configd.h"
 #include "session.h"
+#include "journal.h"
+#include "trace.h"
 
 __private_extern__
 int
 __SCDynamicStoreNotifyValue(SCDynamicStoreRef store, CFStringRef key, Boolean internal)
 {
-	CFDictionaryRef			dict;
+	storeEntryRef			entry;
 	Boolean				newValue	= FALSE;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
 	int				sc_status	= kSCStatusOK;
 	CFDataRef			value;
+	uint64_t			traceTime	= traceStart();
 
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s : %5d : %@\n"),
-			internal ? "*notify" : "notify ",
-			storePrivate->server,
-			key);
-	}
+	journalAppend(kJournalNotify, storePrivate->server, internal, key, NULL);
 
 	/*
 	 * Tickle the value in the dynamic store
 	 */
-	dict = CFDictionaryGetValue(storeData, key);
-	if (!dict || !CFDictionaryGetValueIfPresent(dict, kSCDData, (const void **)&value)) {
+	entry = storeLookup(key);
+	if ((entry != NULL) && (entry->data != NULL)) {
+		value = entry->data;
+	} else {
 		/* key doesn't exist (or data never defined) */
 		(void)_SCSerialize(kCFBooleanTrue, &value, NULL, NULL);
 		newValue = TRUE;
@@ -73,6 +72,13 @@ __SCDynamicStoreNotifyValue(SCDynamicStoreRef store, CFStringRef key, Boolean in
 		__SCDynamicStorePush();
 	}
 
+	traceRecordOp(kTraceOpNotify,
+		      internal ? kTraceFlagInternal : 0,
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -109,6 +115,12 @@ _confignotify(mach_port_t 		server,
 		}
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (!hasWriteAccess(mySession, key)) {
 		*sc_status = kSCStatusAccessError;
 		goto done;
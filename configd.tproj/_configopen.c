@@ -34,6 +34,8 @@
 #include "configd.h"
 #include "configd_server.h"
 #include "session.h"
+#include "journal.h"
+#include "trace.h"
 
 #include <bsm/libbsm.h>
 #include <sys/types.h>
@@ -51,15 +53,11 @@ __SCDynamicStoreOpen(SCDynamicStoreRef *store, CFStringRef name)
 	/*
 	 * If necessary, initialize the store and session data dictionaries
 	 */
-	if (storeData == NULL) {
+	if (sessionData == NULL) {
 		sessionData        = CFDictionaryCreateMutable(NULL,
 							       0,
 							       &kCFTypeDictionaryKeyCallBacks,
 							       &kCFTypeDictionaryValueCallBacks);
-		storeData          = CFDictionaryCreateMutable(NULL,
-							       0,
-							       &kCFTypeDictionaryKeyCallBacks,
-							       &kCFTypeDictionaryValueCallBacks);
 		patternData        = CFDictionaryCreateMutable(NULL,
 							       0,
 							       &kCFTypeDictionaryKeyCallBacks,
@@ -70,15 +68,50 @@ __SCDynamicStoreOpen(SCDynamicStoreRef *store, CFStringRef name)
 		deferredRemovals   = CFSetCreateMutable(NULL,
 							0,
 							&kCFTypeSetCallBacks);
-		removedSessionKeys = CFSetCreateMutable(NULL,
-							0,
-							&kCFTypeSetCallBacks);
+		storeInitialize();
 	}
 
 	return kSCStatusOK;
 }
 
 
+__private_extern__
+void
+__SCDynamicStoreAttachSession(SCDynamicStoreRef store, mach_port_t server, CFStringRef name)
+{
+	CFDictionaryRef			info;
+	CFMutableDictionaryRef		newInfo;
+	CFStringRef			sessionKey;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	/*
+	 * Make the session id accessible to the framework routines.
+	 * ... and be sure to clear before calling CFRelease(store)
+	 */
+	storePrivate->server = server;
+
+	/*
+	 * Save the name of the calling application / plug-in with the session data.
+	 */
+	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), server);
+	info = CFDictionaryGetValue(sessionData, sessionKey);
+	if (info != NULL) {
+		newInfo = CFDictionaryCreateMutableCopy(NULL, 0, info);
+	} else {
+		newInfo = CFDictionaryCreateMutable(NULL,
+						    0,
+						    &kCFTypeDictionaryKeyCallBacks,
+						    &kCFTypeDictionaryValueCallBacks);
+	}
+	CFDictionarySetValue(newInfo, kSCDName, name);
+	CFDictionarySetValue(sessionData, sessionKey, newInfo);
+	CFRelease(newInfo);
+	CFRelease(sessionKey);
+
+	return;
+}
+
+
 static CFStringRef
 openMPCopyDescription(const void *info)
 {
@@ -97,16 +130,15 @@ _configopen(mach_port_t			server,
 	    int				*sc_status,
 	    audit_token_t		audit_token)
 {
-	CFDictionaryRef			info;
 	serverSessionRef		mySession;
 	CFStringRef			name		= NULL;	/* name (un-serialized) */
-	CFMutableDictionaryRef		newInfo;
 	mach_port_t			oldNotify;
 	CFDictionaryRef			options		= NULL;	/* options (un-serialized) */
-	CFStringRef			sessionKey;
 	kern_return_t 			status;
 	SCDynamicStorePrivateRef	storePrivate;
 	CFBooleanRef			useSessionKeys	= NULL;
+	CFBooleanRef			notifyValues	= NULL;
+	uint64_t			traceTime	= traceStart();
 
 	*sc_status = kSCStatusOK;
 
@@ -147,6 +179,14 @@ _configopen(mach_port_t			server,
 				goto done;
 			}
 		}
+
+		notifyValues = CFDictionaryGetValue(options, kSCDynamicStoreNotificationValues);
+		if (notifyValues != NULL) {
+			if (!isA_CFBoolean(notifyValues)) {
+				*sc_status = kSCStatusInvalidArgument;
+				goto done;
+			}
+		}
 	}
 
 	/*
@@ -173,22 +213,13 @@ _configopen(mach_port_t			server,
 			   mySession->serverRunLoopSource,
 			   kCFRunLoopDefaultMode);
 
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("open    : %5d : %@\n"),
-			*newServer,
-			name);
-	}
+	journalAppend(kJournalOpen, *newServer, FALSE, name, NULL);
 
 	*sc_status = __SCDynamicStoreOpen(&mySession->store, name);
+	__SCDynamicStoreAttachSession(mySession->store, *newServer, name);
+	traceRecordOp(kTraceOpOpen, 0, *newServer, NULL, *sc_status, traceTime, 0);
 	storePrivate = (SCDynamicStorePrivateRef)mySession->store;
 
-	/*
-	 * Make the server port accessible to the framework routines.
-	 * ... and be sure to clear before calling CFRelease(store)
-	 */
-	storePrivate->server = *newServer;
-
 	/*
 	 * Process any provided [session] options
 	 */
@@ -196,6 +227,10 @@ _configopen(mach_port_t			server,
 		storePrivate->useSessionKeys = CFBooleanGetValue(useSessionKeys);
 	}
 
+	if (notifyValues != NULL) {
+		storePrivate->notifyValues = CFBooleanGetValue(notifyValues);
+	}
+
 	/* Request a notification when/if the client dies */
 	status = mach_port_request_notification(mach_task_self(),
 						*newServer,
@@ -217,24 +252,6 @@ _configopen(mach_port_t			server,
 		SCLog(TRUE, LOG_ERR, CFSTR("_configopen(): oldNotify != MACH_PORT_NULL"));
 	}
 
-	/*
-	 * Save the name of the calling application / plug-in with the session data.
-	 */
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), *newServer);
-	info = CFDictionaryGetValue(sessionData, sessionKey);
-	if (info != NULL) {
-		newInfo = CFDictionaryCreateMutableCopy(NULL, 0, info);
-	} else {
-		newInfo = CFDictionaryCreateMutable(NULL,
-						    0,
-						    &kCFTypeDictionaryKeyCallBacks,
-						    &kCFTypeDictionaryValueCallBacks);
-	}
-	CFDictionarySetValue(newInfo, kSCDName, name);
-	CFDictionarySetValue(sessionData, sessionKey, newInfo);
-	CFRelease(newInfo);
-	CFRelease(sessionKey);
-
 	/*
 	 * Note: at this time we should be holding ONE send right and
 	 *       ONE receive right to the server.  The send right is
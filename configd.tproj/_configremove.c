@@ -33,35 +33,29 @@
 
 #include "configd.h"
 #include "session.h"
+#include "journal.h"
+#include "trace.h"
 
 __private_extern__
 int
 __SCDynamicStoreRemoveValue(SCDynamicStoreRef store, CFStringRef key, Boolean internal)
 {
-	CFDictionaryRef			dict;
-	CFMutableDictionaryRef		newDict;
+	storeEntryRef			entry;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
 	int				sc_status	= kSCStatusOK;
-	CFStringRef			sessionKey;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s : %5d : %@\n"),
-			internal ? "*remove" : "remove ",
-			storePrivate->server,
-			key);
-	}
+	uint64_t			traceTime	= traceStart();
+
+	journalAppend(kJournalRemove, storePrivate->server, internal, key, NULL);
 
 	/*
 	 * Ensure that this key exists.
 	 */
-	dict = CFDictionaryGetValue(storeData, key);
-	if ((dict == NULL) || (CFDictionaryContainsKey(dict, kSCDData) == FALSE)) {
+	entry = storeLookup(key);
+	if ((entry == NULL) || (entry->data == NULL)) {
 		/* key doesn't exist (or data never defined) */
 		sc_status = kSCStatusNoKey;
 		goto done;
 	}
-	newDict = CFDictionaryCreateMutableCopy(NULL, 0, dict);
 
 	/*
 	 * Mark this key as "changed". Any "watchers" will be
@@ -77,34 +71,22 @@ __SCDynamicStoreRemoveValue(SCDynamicStoreRef store, CFStringRef key, Boolean in
 	CFSetAddValue(deferredRemovals, key);
 
 	/*
-	 * Check if this is a session key and, if so, add it
-	 * to the (session) removal list
+	 * Check if this is a session key and, if so, remove it
+	 * from the session's remove-on-close list
 	 */
-	sessionKey = CFDictionaryGetValue(newDict, kSCDSession);
-	if (sessionKey) {
-		CFStringRef	removedKey;
+	if (entry->session != MACH_PORT_NULL) {
+		_removeSessionKey(entry->session, key);
 
 		/* We are no longer a session key! */
-		CFDictionaryRemoveValue(newDict, kSCDSession);
-
-		/* add this session key to the (session) removal list */
-		removedKey = CFStringCreateWithFormat(NULL, 0, CFSTR("%@:%@"), sessionKey, key);
-		CFSetAddValue(removedSessionKeys, removedKey);
-		CFRelease(removedKey);
+		storeSetSession(entry, MACH_PORT_NULL);
 	}
 
 	/*
-	 * Remove data and update/remove the dictionary store entry.
+	 * Remove data and update/remove the store entry.
 	 */
-	CFDictionaryRemoveValue(newDict, kSCDData);
-	if (CFDictionaryGetCount(newDict) > 0) {
-		/* this key is still being "watched" */
-		CFDictionarySetValue(storeData, key, newDict);
-	} else {
-		/* no information left, remove the empty dictionary */
-		CFDictionaryRemoveValue(storeData, key);
-	}
-	CFRelease(newDict);
+	_savePreviousValue(entry);
+	storeSetData(entry, NULL);
+	storeRemoveIfUnused(entry);
 
 	if (!internal) {
 		/* push changes */
@@ -113,6 +95,13 @@ __SCDynamicStoreRemoveValue(SCDynamicStoreRef store, CFStringRef key, Boolean in
 
     done:
 
+	traceRecordOp(kTraceOpRemove,
+		      internal ? kTraceFlagInternal : 0,
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -149,6 +138,12 @@ _configremove(mach_port_t		server,
 		}
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (!hasWriteAccess(mySession, key)) {
 		*sc_status = kSCStatusAccessError;
 		goto done;
@@ -35,112 +35,53 @@
 #include "configd.h"
 #include "session.h"
 #include "pattern.h"
+#include "journal.h"
+#include "trace.h"
 
 
 __private_extern__
 int
 __SCDynamicStoreSetValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef value, Boolean internal)
 {
-	CFDictionaryRef			dict;
-	CFMutableDictionaryRef		newDict;
+	storeEntryRef			entry;
 	Boolean				newEntry	= FALSE;
 	int				sc_status	= kSCStatusOK;
-	CFStringRef			sessionKey;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
-	CFStringRef			storeSessionKey;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s%s : %5d : %@\n"),
-			internal ? "*set " : "set  ",
-			storePrivate->useSessionKeys ? "t " : "  ",
-			storePrivate->server,
-			key);
-	}
+	uint64_t			traceTime	= traceStart();
 
-	/*
-	 * Grab the current (or establish a new) dictionary for this key.
-	 */
-
-	dict = CFDictionaryGetValue(storeData, key);
-	if (dict) {
-		newDict = CFDictionaryCreateMutableCopy(NULL,
-							0,
-							dict);
-	} else {
-		newDict = CFDictionaryCreateMutable(NULL,
-						    0,
-						    &kCFTypeDictionaryKeyCallBacks,
-						    &kCFTypeDictionaryValueCallBacks);
-	}
+	journalAppend(kJournalSet, storePrivate->server, internal, key, value);
 
 	/*
-	 * Update the dictionary entry to be saved to the store.
+	 * Grab the current (or establish a new) entry for this key.
 	 */
-	newEntry = !CFDictionaryContainsKey(newDict, kSCDData);
-	CFDictionarySetValue(newDict, kSCDData, value);
-
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
+	entry = storeLookupOrAdd(key);
+	newEntry = (entry->data == NULL);
 
 	/*
 	 * Manage per-session keys.
 	 */
 	if (storePrivate->useSessionKeys) {
 		if (newEntry) {
-			CFArrayRef		keys;
-			CFMutableDictionaryRef	newSession;
-			CFMutableArrayRef	newKeys;
-			CFDictionaryRef		session;
-
 			/*
 			 * Add this key to my list of per-session keys
 			 */
-			session = CFDictionaryGetValue(sessionData, sessionKey);
-			keys = CFDictionaryGetValue(session, kSCDSessionKeys);
-			if ((keys == NULL) ||
-			    (CFArrayGetFirstIndexOfValue(keys,
-							 CFRangeMake(0, CFArrayGetCount(keys)),
-							 key) == kCFNotFound)) {
-				/*
-				 * if no session keys defined "or" keys defined but not
-				 * this one...
-				 */
-				if (keys != NULL) {
-					/* this is the first session key */
-					newKeys = CFArrayCreateMutableCopy(NULL, 0, keys);
-				} else {
-					/* this is an additional session key */
-					newKeys = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-				}
-				CFArrayAppendValue(newKeys, key);
-
-				/* update session dictionary */
-				newSession = CFDictionaryCreateMutableCopy(NULL, 0, session);
-				CFDictionarySetValue(newSession, kSCDSessionKeys, newKeys);
-				CFRelease(newKeys);
-				CFDictionarySetValue(sessionData, sessionKey, newSession);
-				CFRelease(newSession);
-			}
+			_addSessionKey(store, entry->key);
 
 			/*
 			 * Mark the key as a "session" key and track the creator.
 			 */
-			CFDictionarySetValue(newDict, kSCDSession, sessionKey);
+			storeSetSession(entry, storePrivate->server);
 		} else {
 			/*
 			 * Since we are using per-session keys and this key already
 			 * exists, check if it was created by "our" session
 			 */
-			dict = CFDictionaryGetValue(storeData, key);
-			if (!CFDictionaryGetValueIfPresent(dict, kSCDSession, (void *)&storeSessionKey) ||
-			    !CFEqual(sessionKey, storeSessionKey)) {
+			if (entry->session != storePrivate->server) {
 				/*
 				 * if the key exists and is not a session key or
 				 * if the key exists it's not "our" session.
 				 */
 				sc_status = kSCStatusKeyExists;
-				CFRelease(sessionKey);
-				CFRelease(newDict);
 				goto done;
 			}
 		}
@@ -151,28 +92,35 @@ __SCDynamicStoreSetValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef val
 		* another session's remove-on-close list.
 		*/
 		if (!newEntry &&
-		    CFDictionaryGetValueIfPresent(newDict, kSCDSession, (void *)&storeSessionKey) &&
-		    !CFEqual(sessionKey, storeSessionKey)) {
-			CFStringRef	removedKey;
+		    (entry->session != MACH_PORT_NULL) &&
+		    (entry->session != storePrivate->server)) {
+			/* remove this key from the other session's remove-on-close list */
+			_removeSessionKey(entry->session, key);
 
 			/* We are no longer a session key! */
-			CFDictionaryRemoveValue(newDict, kSCDSession);
-
-			/* add this session key to the (session) removal list */
-			removedKey = CFStringCreateWithFormat(NULL, 0, CFSTR("%@:%@"), storeSessionKey, key);
-			CFSetAddValue(removedSessionKeys, removedKey);
-			CFRelease(removedKey);
+			storeSetSession(entry, MACH_PORT_NULL);
 		}
 	}
 
-	CFRelease(sessionKey);
-
 	/*
-	 * Update the dictionary entry in the store.
+	 * Any set (even of the same value) confirms a key that was
+	 * restored from a checkpoint.
 	 */
+	entry->restored = FALSE;
 
-	CFDictionarySetValue(storeData, key, newDict);
-	CFRelease(newDict);
+	if (!newEntry && CFEqual(entry->data, value)) {
+		/*
+		 * The value has not changed, there is nothing to update
+		 * (and nobody to notify).
+		 */
+		goto done;
+	}
+
+	/*
+	 * Update the entry in the store.
+	 */
+	_savePreviousValue(entry);
+	storeSetData(entry, value);
 
 	/*
 	 * For "new" entries to the store, check the deferred cleanup
@@ -205,6 +153,14 @@ __SCDynamicStoreSetValue(SCDynamicStoreRef store, CFStringRef key, CFDataRef val
 		__SCDynamicStorePush();
 	}
 
+	traceRecordOp(kTraceOpSet,
+		      (internal ? kTraceFlagInternal : 0) |
+		      (storePrivate->useSessionKeys ? kTraceFlagSessionKey : 0),
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -255,6 +211,12 @@ _configset(mach_port_t			server,
 		}
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (!hasWriteAccess(mySession, key)) {
 		*sc_status = kSCStatusAccessError;
 		goto done;
@@ -326,15 +288,12 @@ __SCDynamicStoreSetMultiple(SCDynamicStoreRef store, CFDictionaryRef keysToSet,
 {
 	int				sc_status	= kSCStatusOK;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	uint64_t			traceTime	= traceStart();
 
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("set m   : %5d : %ld set, %ld remove, %ld notify\n"),
-			storePrivate->server,
-			keysToSet    ? CFDictionaryGetCount(keysToSet)    : 0,
-			keysToRemove ? CFArrayGetCount     (keysToRemove) : 0,
-			keysToNotify ? CFArrayGetCount     (keysToNotify) : 0);
-	}
+	journalAppendSetMultiple(storePrivate->server,
+				 keysToSet    ? CFDictionaryGetCount(keysToSet)    : 0,
+				 keysToRemove ? CFArrayGetCount     (keysToRemove) : 0,
+				 keysToNotify ? CFArrayGetCount     (keysToNotify) : 0);
 
 	/*
 	 * Set the new/updated keys
@@ -368,6 +327,15 @@ __SCDynamicStoreSetMultiple(SCDynamicStoreRef store, CFDictionaryRef keysToSet,
 	/* push changes */
 	__SCDynamicStorePush();
 
+	traceRecordOp(kTraceOpSetMultiple,
+		      0,
+		      storePrivate->server,
+		      NULL,
+		      sc_status,
+		      traceTime,
+		      (uint32_t)((keysToSet    ? CFDictionaryGetCount(keysToSet)    : 0) +
+				 (keysToRemove ? CFArrayGetCount     (keysToRemove) : 0) +
+				 (keysToNotify ? CFArrayGetCount     (keysToNotify) : 0)));
 	return sc_status;
 }
 
@@ -442,6 +410,12 @@ _configset_m(mach_port_t		server,
 		}
 	}
 
+	if (mySession->admitReject) {
+		/* the session is over its budget */
+		*sc_status = kSCStatusLimitExceeded;
+		goto done;
+	}
+
 	if (dict != NULL) {
 		const void *	keys_q[N_QUICK];
 		const void **	keys	= keys_q;
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#include "configd.h"
+#include "configd_server.h"
+#include "request_stats.h"
+#include "session.h"
+
+__private_extern__
+kern_return_t
+_configstats(mach_port_t		server,
+	     int			reset,
+	     xmlDataOut_t		*statsRef,	/* raw XML bytes */
+	     mach_msg_type_number_t	*statsLen,
+	     int			*sc_status,
+	     audit_token_t		audit_token)
+{
+	CFIndex			len;
+	serverSessionRef	mySession;
+	Boolean			ok;
+	CFDictionaryRef		stats;
+
+	*statsRef = NULL;
+	*statsLen = 0;
+
+	mySession = getSession(server);
+	if (mySession == NULL) {
+		mySession = tempSession(server, CFSTR("SCDynamicStoreCopyStatistics"), audit_token);
+		if (mySession == NULL) {
+			/* you must have an open session to play */
+			*sc_status = kSCStatusNoStoreSession;
+			return KERN_SUCCESS;
+		}
+	}
+
+	if ((reset != 0) && !hasRootAccess(mySession)) {
+		/* only root can start over */
+		*sc_status = kSCStatusAccessError;
+		return KERN_SUCCESS;
+	}
+
+	stats = requestStatsCopy(reset != 0);
+
+	/* serialize the statistics */
+	ok = _SCSerialize(stats, NULL, (void **)statsRef, &len);
+	*statsLen = (mach_msg_type_number_t)len;
+	CFRelease(stats);
+	*sc_status = ok ? kSCStatusOK : kSCStatusFailed;
+
+	return KERN_SUCCESS;
+}
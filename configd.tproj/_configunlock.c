@@ -58,81 +58,54 @@ _notifyWatchers()
 	CFSetGetValues(changedKeys, keys);
 
 	while (--keyCnt >= 0) {
-		CFArrayRef		changes;
-		CFDictionaryRef		dict;
-		CFDictionaryRef		info;
-		CFMutableDictionaryRef	newInfo;
-		CFMutableArrayRef	newChanges;
-		CFArrayRef		sessionsWatchingKey;
+		storeValueChange	change;
+		storeEntryRef		entry;
 		CFIndex			watcherCnt;
-		const void *		watchers_q[N_QUICK];
-		const void **		watchers	= watchers_q;
 
-		dict = CFDictionaryGetValue(storeData, (CFStringRef)keys[keyCnt]);
-		if ((dict == NULL) || (CFDictionaryContainsKey(dict, kSCDWatchers) == FALSE)) {
+		entry = storeLookup((CFStringRef)keys[keyCnt]);
+		if ((entry == NULL) || (entry->nWatchers == 0)) {
 			/* key doesn't exist or nobody cares if it changed */
 			continue;
 		}
 
+		bzero(&change, sizeof(change));
+		change.entry    = entry;
+		change.previous = (previousValues != NULL) ? CFDictionaryGetValue(previousValues, entry->key) : NULL;
+		change.current  = entry->data;
+
 		/*
-		 * Add this key to the list of changes for each of the
+		 * Add this key to the set of changes for each of the
 		 * sessions which is "watching".
 		 */
-		sessionsWatchingKey = CFDictionaryGetValue(dict, kSCDWatchers);
-		watcherCnt = CFArrayGetCount(sessionsWatchingKey);
-		if (watcherCnt == 0) {
-			/* if no watchers */
-			continue;
-		}
-
-		if (watcherCnt > (CFIndex)(sizeof(watchers_q) / sizeof(CFNumberRef)))
-			watchers = CFAllocatorAllocate(NULL, watcherCnt * sizeof(CFNumberRef), 0);
-
-		CFArrayGetValues(sessionsWatchingKey, CFRangeMake(0, watcherCnt), watchers);
-
+		watcherCnt = entry->nWatchers;
 		while (--watcherCnt >= 0) {
-			CFStringRef	sessionKey;
-
-			sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%@"), watchers[watcherCnt]);
-			info = CFDictionaryGetValue(sessionData, sessionKey);
-			if (info) {
-				newInfo = CFDictionaryCreateMutableCopy(NULL, 0, info);
-			} else {
-				newInfo = CFDictionaryCreateMutable(NULL,
-								    0,
-								    &kCFTypeDictionaryKeyCallBacks,
-								    &kCFTypeDictionaryValueCallBacks);
+			mach_port_t		server	= entry->watchers[watcherCnt].session;
+			serverSessionRef	session;
+
+			session = getSession(server);
+			if (session == NULL) {
+				/* if the session is gone */
+				continue;
 			}
 
-			changes = CFDictionaryGetValue(newInfo, kSCDChangedKeys);
-			if (changes) {
-				newChanges = CFArrayCreateMutableCopy(NULL, 0, changes);
-			} else {
-				newChanges = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+			if (!__SCDynamicStoreWatcherWantsChange(session->store, entry->key, &change)) {
+				/* if none of the properties of interest changed */
+				continue;
 			}
 
-			if (CFArrayContainsValue(newChanges,
-						 CFRangeMake(0, CFArrayGetCount(newChanges)),
-						 (CFStringRef)keys[keyCnt]) == FALSE) {
-				CFArrayAppendValue(newChanges, (CFStringRef)keys[keyCnt]);
+			if (session->changedKeys == NULL) {
+				session->changedKeys = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
 			}
-			CFDictionarySetValue(newInfo, kSCDChangedKeys, newChanges);
-			CFRelease(newChanges);
-			CFDictionarySetValue(sessionData, sessionKey, newInfo);
-			CFRelease(newInfo);
-			CFRelease(sessionKey);
+			CFSetAddValue(session->changedKeys, entry->key);
 
 			/*
 			 * flag this session as needing a kick
 			 */
-			if (needsNotification == NULL)
-				needsNotification = CFSetCreateMutable(NULL,
-								       0,
-								       &kCFTypeSetCallBacks);
-			CFSetAddValue(needsNotification, watchers[watcherCnt]);
+			_setNeedsNotification(server);
 		}
 
-		if (watchers != watchers_q) CFAllocatorDeallocate(NULL, watchers);
+		if (change.previousValue != NULL)	CFRelease(change.previousValue);
+		if (change.currentValue != NULL)	CFRelease(change.currentValue);
 	}
 
 	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
@@ -143,6 +116,7 @@ _notifyWatchers()
 	 * the "configd" server, is to push out any needed notifications.
 	 */
 	CFSetRemoveAllValues(changedKeys);
+	if (previousValues != NULL) CFDictionaryRemoveAllValues(previousValues);
 
 }
 
@@ -179,75 +153,6 @@ _processDeferredRemovals()
 }
 
 
-static void
-_cleanupRemovedSessionKeys(const void *value, void *context)
-{
-	CFStringRef		removedKey = (CFStringRef)value;
-	CFRange			dRange;
-	CFStringRef		sessionKey;
-	CFStringRef		key;
-	CFDictionaryRef		sessionDict;
-	CFArrayRef		sessionKeys;
-	CFIndex			i;
-	CFMutableDictionaryRef	newSessionDict;
-
-	dRange     = CFStringFind(removedKey, CFSTR(":"), 0);
-	sessionKey = CFStringCreateWithSubstring(NULL,
-						 removedKey,
-						 CFRangeMake(0, dRange.location));
-	key        = CFStringCreateWithSubstring(NULL,
-						 removedKey,
-						 CFRangeMake(dRange.location+dRange.length,
-							     CFStringGetLength(removedKey)-dRange.location-dRange.length));
-
-	/*
-	 * remove the key from the session key list
-	 */
-	sessionDict = CFDictionaryGetValue(sessionData, sessionKey);
-	if (!sessionDict) {
-		/* if no session */
-		goto done;
-	}
-
-	sessionKeys = CFDictionaryGetValue(sessionDict, kSCDSessionKeys);
-	if (!sessionKeys) {
-		/* if no session keys */
-		goto done;
-	}
-
-	i = CFArrayGetFirstIndexOfValue(sessionKeys,
-					CFRangeMake(0, CFArrayGetCount(sessionKeys)),
-					key);
-	if (i == kCFNotFound) {
-		/* if this session key has already been removed */
-		goto done;
-	}
-
-	newSessionDict = CFDictionaryCreateMutableCopy(NULL, 0, sessionDict);
-	if (CFArrayGetCount(sessionKeys) == 1) {
-		/* remove the last (session) key */
-		CFDictionaryRemoveValue(newSessionDict, kSCDSessionKeys);
-	} else {
-		CFMutableArrayRef	newSessionKeys;
-
-		/* remove the (session) key */
-		newSessionKeys = CFArrayCreateMutableCopy(NULL, 0, sessionKeys);
-		CFArrayRemoveValueAtIndex(newSessionKeys, i);
-		CFDictionarySetValue(newSessionDict, kSCDSessionKeys, newSessionKeys);
-		CFRelease(newSessionKeys);
-	}
-	CFDictionarySetValue(sessionData, sessionKey, newSessionDict);
-	CFRelease(newSessionDict);
-
-    done:
-
-	CFRelease(sessionKey);
-	CFRelease(key);
-
-	return;
-}
-
-
 __private_extern__
 int
 __SCDynamicStorePush(void)
@@ -264,10 +169,9 @@ __SCDynamicStorePush(void)
 	_processDeferredRemovals();
 
 	/*
-	 * clean up any removed session keys
+	 * and, with all of the changes applied, advance the store generation.
 	 */
-	CFSetApplyFunction(removedSessionKeys, _cleanupRemovedSessionKeys, NULL);
-	CFSetRemoveAllValues(removedSessionKeys);
+	storeCommit();
 
 	return kSCStatusOK;
 }
@@ -32,37 +32,18 @@
  */
 
 #include "configd.h"
+#include "admission.h"
 #include "session.h"
 #include "pattern.h"
-
-
-static __inline__ void
-my_CFArrayApplyFunction(CFArrayRef		theArray,
-			CFArrayApplierFunction	applier,
-			void			*context)
-{
-	CFAllocatorRef	myAllocator;
-	CFArrayRef	myArray;
-
-	myAllocator = CFGetAllocator(theArray);
-	myArray     = CFArrayCreateCopy(myAllocator, theArray);
-	CFArrayApplyFunction(myArray, CFRangeMake(0, CFArrayGetCount(myArray)), applier, context);
-	CFRelease(myArray);
-	return;
-}
+#include "trace.h"
 
 
 static int
-hasKey(CFMutableArrayRef keys, CFStringRef key)
+hasKey(CFMutableSetRef keys, CFStringRef key)
 {
-	if (keys != NULL) {
-		CFIndex	n;
-
-		n = CFArrayGetCount(keys);
-		if (CFArrayContainsValue(keys, CFRangeMake(0, n), key)) {
-			/* sorry, pattern already exists in notifier list */
-			return kSCStatusKeyExists;
-		}
+	if ((keys != NULL) && CFSetContainsValue(keys, key)) {
+		/* sorry, key (or pattern) already exists in notifier list */
+		return kSCStatusKeyExists;
 	}
 
 	return kSCStatusOK;
@@ -70,13 +51,13 @@ hasKey(CFMutableArrayRef keys, CFStringRef key)
 
 
 static void
-addKey(CFMutableArrayRef *keysP, CFStringRef key)
+addKey(CFMutableSetRef *keysP, CFStringRef key)
 {
 	if (*keysP == NULL) {
-		*keysP = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+		*keysP = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
 	}
 
-	CFArrayAppendValue(*keysP, key);
+	CFSetAddValue(*keysP, key);
 	return;
 }
 
@@ -88,20 +69,12 @@ __SCDynamicStoreAddWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boolean
 	int				sc_status	= kSCStatusOK;
 	CFNumberRef			sessionNum	= NULL;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s : %5d : %s : %@\n"),
-			internal ? "*watch+" : "watch+ ",
-			storePrivate->server,
-			isRegex  ? "pattern" : "key",
-			key);
-	}
+	uint64_t			traceTime	= traceStart();
 
 	sessionNum = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
 
 	if (isRegex) {
-		sc_status = hasKey(storePrivate->patterns, key);
+		sc_status = hasKey(storePrivate->watchedPatterns, key);
 		if (sc_status != kSCStatusOK) {
 			goto done;
 		}
@@ -115,9 +88,9 @@ __SCDynamicStoreAddWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boolean
 		}
 
 		/* add pattern to this sessions notifier list */
-		addKey(&storePrivate->patterns, key);
+		addKey(&storePrivate->watchedPatterns, key);
 	} else {
-		sc_status = hasKey(storePrivate->keys, key);
+		sc_status = hasKey(storePrivate->watchedKeys, key);
 		if (sc_status != kSCStatusOK) {
 			goto done;
 		}
@@ -129,12 +102,20 @@ __SCDynamicStoreAddWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boolean
 		_addWatcher(sessionNum, key);
 
 		/* add key to this sessions notifier list */
-		addKey(&storePrivate->keys, key);
+		addKey(&storePrivate->watchedKeys, key);
 	}
 
     done :
 
 	if (sessionNum != NULL)	CFRelease(sessionNum);
+	traceRecordOp(kTraceOpWatchAdd,
+		      (internal ? kTraceFlagInternal : 0) |
+		      (isRegex  ? kTraceFlagPattern  : 0),
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -168,6 +149,17 @@ _notifyadd(mach_port_t 			server,
 		goto done;
 	}
 
+	if (isRegex) {
+		SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)mySession->store;
+		CFIndex				n;
+
+		n = (storePrivate->watchedPatterns != NULL) ? CFSetGetCount(storePrivate->watchedPatterns) : 0;
+		*sc_status = admissionCheckPatterns(mySession, n + 1);
+		if (*sc_status != kSCStatusOK) {
+			goto done;
+		}
+	}
+
 	*sc_status = __SCDynamicStoreAddWatchedKey(mySession->store, key, isRegex != 0, FALSE);
 
     done :
@@ -182,8 +174,8 @@ _notifyadd(mach_port_t 			server,
  */
 typedef struct {
 	SCDynamicStoreRef       store;
-	CFArrayRef		oldKeys;	/* for addNewKey */
-	CFArrayRef		newKeys;	/* for removeOldKey */
+	CFSetRef		oldKeys;	/* for addNewKey */
+	CFSetRef		newKeys;	/* for removeOldKey */
 	Boolean			isRegex;
 	int			sc_status;
 } updateKeysContext, *updateKeysContextRef;
@@ -200,9 +192,7 @@ removeOldKey(const void *value, void *context)
 	}
 
 	if ((myContextRef->newKeys == NULL) ||
-	    !CFArrayContainsValue(myContextRef->newKeys,
-				  CFRangeMake(0, CFArrayGetCount(myContextRef->newKeys)),
-				  oldKey)) {
+	    !CFSetContainsValue(myContextRef->newKeys, oldKey)) {
 		/* the old notification key is not being retained, remove it */
 		myContextRef->sc_status = __SCDynamicStoreRemoveWatchedKey(myContextRef->store,
 									   oldKey,
@@ -225,9 +215,7 @@ addNewKey(const void *value, void *context)
 	}
 
 	if ((myContextRef->oldKeys == NULL) ||
-	    !CFArrayContainsValue(myContextRef->oldKeys,
-				  CFRangeMake(0, CFArrayGetCount(myContextRef->oldKeys)),
-				  newKey)) {
+	    !CFSetContainsValue(myContextRef->oldKeys, newKey)) {
 		/* if this is a new notification key */
 		myContextRef->sc_status = __SCDynamicStoreAddWatchedKey(myContextRef->store,
 									newKey,
@@ -239,56 +227,72 @@ addNewKey(const void *value, void *context)
 }
 
 
+static void
+updateKeys(updateKeysContextRef myContextRef, CFSetRef watched, CFArrayRef keys, Boolean isRegex)
+{
+	CFIndex		n;
+
+	n = (keys != NULL) ? CFArrayGetCount(keys) : 0;
+
+	myContextRef->oldKeys = NULL;
+	myContextRef->newKeys = NULL;
+	myContextRef->isRegex = isRegex;
+
+	if (n > 0) {
+		CFIndex		i;
+		CFMutableSetRef	newKeys;
+
+		newKeys = CFSetCreateMutable(NULL, n, &kCFTypeSetCallBacks);
+		for (i = 0; i < n; i++) {
+			CFSetAddValue(newKeys, CFArrayGetValueAtIndex(keys, i));
+		}
+		myContextRef->newKeys = newKeys;
+	}
+
+	if (watched != NULL) {
+		/*
+		 * iterate over a copy, __SCDynamicStoreRemoveWatchedKey() updates
+		 * the set being watched.
+		 */
+		myContextRef->oldKeys = CFSetCreateCopy(NULL, watched);
+		CFSetApplyFunction(myContextRef->oldKeys, removeOldKey, myContextRef);
+	}
+
+	if (n > 0) {
+		CFArrayApplyFunction(keys, CFRangeMake(0, n), addNewKey, myContextRef);
+	}
+
+	if (myContextRef->oldKeys != NULL)	CFRelease(myContextRef->oldKeys);
+	if (myContextRef->newKeys != NULL)	CFRelease(myContextRef->newKeys);
+	return;
+}
+
+
 __private_extern__
 int
 __SCDynamicStoreSetNotificationKeys(SCDynamicStoreRef store, CFArrayRef keys, CFArrayRef patterns)
 {
 	updateKeysContext		myContext;
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("watch   : %5d : %ld keys, %ld patterns\n"),
-			storePrivate->server,
-			keys     ? CFArrayGetCount(keys)     : 0,
-			patterns ? CFArrayGetCount(patterns) : 0);
-	}
+	uint64_t			traceTime	= traceStart();
 
 	myContext.store     = store;
 	myContext.sc_status = kSCStatusOK;
 
 	/* remove any previously registered keys, register any new keys */
-	myContext.oldKeys = NULL;
-	myContext.newKeys = keys;
-	myContext.isRegex = FALSE;
-	if (storePrivate->keys != NULL) {
-		myContext.oldKeys = CFArrayCreateCopy(NULL, storePrivate->keys);
-		my_CFArrayApplyFunction(storePrivate->keys, removeOldKey, &myContext);
-	}
-	if (keys != NULL) {
-		CFArrayApplyFunction(keys,
-				     CFRangeMake(0, CFArrayGetCount(keys)),
-				     addNewKey,
-				     &myContext);
-	}
-	if (myContext.oldKeys != NULL) CFRelease(myContext.oldKeys);
+	updateKeys(&myContext, storePrivate->watchedKeys, keys, FALSE);
 
 	/* remove any previously registered patterns, register any new patterns */
-	myContext.oldKeys = NULL;
-	myContext.newKeys = patterns;
-	myContext.isRegex = TRUE;
-	if (storePrivate->patterns != NULL) {
-		myContext.oldKeys = CFArrayCreateCopy(NULL, storePrivate->patterns);
-		my_CFArrayApplyFunction(storePrivate->patterns, removeOldKey, &myContext);
-	}
-	if (patterns != NULL) {
-		CFArrayApplyFunction(patterns,
-				     CFRangeMake(0, CFArrayGetCount(patterns)),
-				     addNewKey,
-				     &myContext);
-	}
-	if (myContext.oldKeys != NULL) CFRelease(myContext.oldKeys);
-
+	updateKeys(&myContext, storePrivate->watchedPatterns, patterns, TRUE);
+
+	traceRecordOp(kTraceOpWatchSet,
+		      0,
+		      storePrivate->server,
+		      NULL,
+		      myContext.sc_status,
+		      traceTime,
+		      traceArgCounts(keys     ? CFArrayGetCount(keys)     : 0,
+				     patterns ? CFArrayGetCount(patterns) : 0));
 	return myContext.sc_status;
 }
 
@@ -344,6 +348,11 @@ _notifyset(mach_port_t 			server,
 		goto done;
 	}
 
+	*sc_status = admissionCheckPatterns(mySession, (patterns != NULL) ? CFArrayGetCount(patterns) : 0);
+	if (*sc_status != kSCStatusOK) {
+		goto done;
+	}
+
 	*sc_status = __SCDynamicStoreSetNotificationKeys(mySession->store, keys, patterns);
 
     done :
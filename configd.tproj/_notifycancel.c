@@ -52,6 +52,11 @@ __SCDynamicStoreNotifyCancel(SCDynamicStoreRef store)
 		storePrivate->notifyPort = MACH_PORT_NULL;
 	}
 
+	/*
+	 * cleanup any [shared] notification ring.
+	 */
+	__SCDynamicStoreNotifyRingRelease(store);
+
 	/*
 	 * cleanup any file based notifications.
 	 */
@@ -68,16 +73,12 @@ __SCDynamicStoreNotifyCancel(SCDynamicStoreRef store)
 		__MACH_PORT_DEBUG(TRUE, "*** __SCDynamicStoreNotifyCancel (signal)", storePrivate->notifySignalTask);
 		(void) mach_port_deallocate(mach_task_self(), storePrivate->notifySignalTask);
 		storePrivate->notifySignal     = 0;
-		storePrivate->notifySignalTask = TASK_NULL;
+		setSessionSignalTask(store, TASK_NULL);
 	}
 
 	/* remove this session from the to-be-notified list */
 	if (needsNotification) {
-		CFNumberRef	num;
-
-		num = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
-		CFSetRemoveValue(needsNotification, num);
-		CFRelease(num);
+		CFSetRemoveValue(needsNotification, (const void *)(uintptr_t)storePrivate->server);
 
 		if (CFSetGetCount(needsNotification) == 0) {
 			CFRelease(needsNotification);
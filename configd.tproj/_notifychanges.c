@@ -34,36 +34,33 @@
 #include "configd.h"
 #include "session.h"
 
+#define N_QUICK	64
+
 __private_extern__
 int
 __SCDynamicStoreCopyNotifiedKeys(SCDynamicStoreRef store, CFArrayRef *notifierKeys)
 {
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-	CFStringRef			sessionKey;
-	CFDictionaryRef			info;
-	CFMutableDictionaryRef		newInfo;
+	CFIndex				keyCnt;
+	const void *			keys_q[N_QUICK];
+	const void **			keys	= keys_q;
+	serverSessionRef		mySession;
 
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
-	info = CFDictionaryGetValue(sessionData, sessionKey);
-	if ((info == NULL) ||
-	    (CFDictionaryContainsKey(info, kSCDChangedKeys) == FALSE)) {
-		CFRelease(sessionKey);
+	mySession = getSession(storePrivate->server);
+	if ((mySession == NULL) || (mySession->changedKeys == NULL)) {
 		*notifierKeys = CFArrayCreate(NULL, NULL, 0, &kCFTypeArrayCallBacks);
 		return kSCStatusOK;
 	}
-	newInfo = CFDictionaryCreateMutableCopy(NULL, 0, info);
 
-	*notifierKeys = CFDictionaryGetValue(newInfo, kSCDChangedKeys);
-	CFRetain(*notifierKeys);
+	keyCnt = CFSetGetCount(mySession->changedKeys);
+	if (keyCnt > (CFIndex)(sizeof(keys_q) / sizeof(CFStringRef)))
+		keys = CFAllocatorAllocate(NULL, keyCnt * sizeof(CFStringRef), 0);
+	CFSetGetValues(mySession->changedKeys, keys);
+	*notifierKeys = CFArrayCreate(NULL, keys, keyCnt, &kCFTypeArrayCallBacks);
+	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
 
-	CFDictionaryRemoveValue(newInfo, kSCDChangedKeys);
-	if (CFDictionaryGetCount(newInfo) > 0) {
-		CFDictionarySetValue(sessionData, sessionKey, newInfo);
-	} else {
-		CFDictionaryRemoveValue(sessionData, sessionKey);
-	}
-	CFRelease(newInfo);
-	CFRelease(sessionKey);
+	CFRelease(mySession->changedKeys);
+	mySession->changedKeys = NULL;
 
 	return kSCStatusOK;
 }
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#include <float.h>
+
+#include "configd.h"
+#include "configd_server.h"
+#include "session.h"
+
+#define	NOTIFY_COALESCE_MAX	1000	/* milliseconds */
+
+
+static Boolean
+getOption(CFDictionaryRef options, CFStringRef key, double min, double max, double *value)
+{
+	CFNumberRef	num;
+
+	num = CFDictionaryGetValue(options, key);
+	if (num == NULL) {
+		/* use the default */
+		return TRUE;
+	}
+
+	/* Note: written so that a NaN is out of range */
+	if (!isA_CFNumber(num) ||
+	    !CFNumberGetValue(num, kCFNumberDoubleType, value) ||
+	    !((*value >= min) && (*value <= max))) {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+__private_extern__
+kern_return_t
+_notifyoptions(mach_port_t		server,
+	       xmlData_t		optionsRef,	/* raw XML bytes */
+	       mach_msg_type_number_t	optionsLen,
+	       int			*sc_status
+)
+{
+	double			burst		= 1;
+	double			coalesce	= 0;
+	serverSessionRef	mySession	= getSession(server);
+	CFDictionaryRef		options		= NULL;	/* options (un-serialized) */
+	double			rate		= 0;
+
+	*sc_status = kSCStatusOK;
+
+	/* un-serialize the options */
+	if ((optionsRef != NULL) && (optionsLen > 0)) {
+		if (!_SCUnserialize((CFPropertyListRef *)&options, NULL, (void *)optionsRef, optionsLen)) {
+			*sc_status = kSCStatusFailed;
+		}
+	}
+
+	if (*sc_status != kSCStatusOK) {
+		goto done;
+	}
+
+	if (mySession == NULL) {
+		/* sorry, you must have an open session to play */
+		*sc_status = kSCStatusNoStoreSession;
+		goto done;
+	}
+
+	if (options != NULL) {
+		if (!isA_CFDictionary(options) ||
+		    !getOption(options, kSCDynamicStoreNotificationCoalesce, 0, NOTIFY_COALESCE_MAX, &coalesce) ||
+		    !getOption(options, kSCDynamicStoreNotificationRateLimit, 0, DBL_MAX, &rate) ||
+		    !getOption(options, kSCDynamicStoreNotificationRateBurst, 1, DBL_MAX, &burst)) {
+			*sc_status = kSCStatusInvalidArgument;
+			goto done;
+		}
+	}
+
+	mySession->notifyCoalesce      = coalesce / 1000.0;
+	mySession->notifyRate          = rate;
+	mySession->notifyBurst         = burst;
+	mySession->notifyTokens        = burst;
+	mySession->notifyTokensUpdated = CFAbsoluteTimeGetCurrent();
+
+	/* in case notifications were being held back */
+	if (mySession->changedKeys != NULL) {
+		_setNeedsNotification(server);
+	}
+
+    done :
+
+	if (options != NULL)	CFRelease(options);
+	return KERN_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#include "configd.h"
+#include "configd_server.h"
+#include "session.h"
+#include "pattern.h"
+#include "trace.h"
+
+
+static Boolean
+validProperties(CFArrayRef properties)
+{
+	CFIndex	i;
+	CFIndex	n;
+
+	if (!isA_CFArray(properties)) {
+		return FALSE;
+	}
+
+	n = CFArrayGetCount(properties);
+	for (i = 0; i < n; i++) {
+		CFIndex		j;
+		CFIndex		nPath;
+		CFArrayRef	path;
+
+		path = CFArrayGetValueAtIndex(properties, i);
+		if (isA_CFString(path)) {
+			continue;
+		}
+
+		if (!isA_CFArray(path) || ((nPath = CFArrayGetCount(path)) == 0)) {
+			return FALSE;
+		}
+
+		for (j = 0; j < nPath; j++) {
+			if (!isA_CFString(CFArrayGetValueAtIndex(path, j))) {
+				return FALSE;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+
+__private_extern__
+int
+__SCDynamicStoreSetWatchedKeyProperties(SCDynamicStoreRef	store,
+					CFStringRef		key,
+					Boolean			isRegex,
+					CFArrayRef		properties)
+{
+	CFMutableDictionaryRef		*keyPropertiesP;
+	int				sc_status	= kSCStatusOK;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	uint64_t			traceTime	= traceStart();
+
+	if ((properties != NULL) && !validProperties(properties)) {
+		sc_status = kSCStatusInvalidArgument;
+		goto done;
+	}
+
+	keyPropertiesP = isRegex ? &storePrivate->patternProperties : &storePrivate->keyProperties;
+	if (properties != NULL) {
+		if (*keyPropertiesP == NULL) {
+			*keyPropertiesP = CFDictionaryCreateMutable(NULL,
+								    0,
+								    &kCFTypeDictionaryKeyCallBacks,
+								    &kCFTypeDictionaryValueCallBacks);
+		}
+		CFDictionarySetValue(*keyPropertiesP, key, properties);
+	} else if (*keyPropertiesP != NULL) {
+		CFDictionaryRemoveValue(*keyPropertiesP, key);
+		if (CFDictionaryGetCount(*keyPropertiesP) == 0) {
+			CFRelease(*keyPropertiesP);
+			*keyPropertiesP = NULL;
+		}
+	}
+
+    done :
+
+	traceRecordOp(kTraceOpWatchProps,
+		      isRegex ? kTraceFlagPattern : 0,
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      isA_CFArray(properties) ? (uint32_t)CFArrayGetCount(properties) : 0);
+	return sc_status;
+}
+
+
+static CFTypeRef
+getProperty(CFPropertyListRef value, CFTypeRef property)
+{
+	CFIndex	i;
+	CFIndex	n;
+
+	if (isA_CFString(property)) {
+		return isA_CFDictionary(value) ? CFDictionaryGetValue(value, property) : NULL;
+	}
+
+	n = CFArrayGetCount(property);
+	for (i = 0; (value != NULL) && (i < n); i++) {
+		value = isA_CFDictionary(value) ? CFDictionaryGetValue(value, CFArrayGetValueAtIndex(property, i)) : NULL;
+	}
+
+	return value;
+}
+
+
+static Boolean
+propertiesChanged(CFArrayRef properties, storeValueChangeRef change)
+{
+	CFIndex	i;
+	CFIndex	n;
+
+	if ((change->previous == NULL) || (change->previous == (CFDataRef)kCFNull) || (change->current == NULL)) {
+		/* if the previous value is not known or the key was added or removed */
+		return TRUE;
+	}
+
+	if (!change->decoded) {
+		/* decode (once) the previous and current values */
+		change->decoded = TRUE;
+		(void) _SCUnserialize(&change->previousValue, change->previous, NULL, 0);
+		change->currentValue = storeCopyValue(change->entry);
+	}
+
+	if ((change->previousValue == NULL) || (change->currentValue == NULL)) {
+		/* if the value(s) could not be decoded */
+		return TRUE;
+	}
+
+	n = CFArrayGetCount(properties);
+	for (i = 0; i < n; i++) {
+		CFTypeRef	property	= CFArrayGetValueAtIndex(properties, i);
+
+		if (!_SC_CFEqual(getProperty(change->previousValue, property),
+				 getProperty(change->currentValue,  property))) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+
+/*
+ * __SCDynamicStoreWatcherWantsChange
+ *   returns TRUE if the session should be notified of the change to
+ *   the [watched] key.  Sessions without any key (or pattern) properties
+ *   are notified of all changes.
+ */
+__private_extern__
+Boolean
+__SCDynamicStoreWatcherWantsChange(SCDynamicStoreRef	store,
+				   CFStringRef		key,
+				   storeValueChangeRef	change)
+{
+	CFArrayRef			candidates;
+	CFIndex				i;
+	CFIndex				n;
+	CFArrayRef			properties;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	Boolean				wants		= FALSE;
+
+	if ((storePrivate->keyProperties == NULL) && (storePrivate->patternProperties == NULL)) {
+		return TRUE;
+	}
+
+	if ((storePrivate->watchedKeys != NULL) &&
+	    CFSetContainsValue(storePrivate->watchedKeys, key)) {
+		properties = (storePrivate->keyProperties != NULL)
+			     ? CFDictionaryGetValue(storePrivate->keyProperties, key)
+			     : NULL;
+		if ((properties == NULL) || propertiesChanged(properties, change)) {
+			return TRUE;
+		}
+	}
+
+	if ((storePrivate->watchedPatterns == NULL) ||
+	    (CFSetGetCount(storePrivate->watchedPatterns) == 0)) {
+		return FALSE;
+	}
+
+	/*
+	 * only check the watched patterns that can match the key (those
+	 * whose literal prefix begins the key, see the pattern index)
+	 */
+	candidates = patternCopyKeyCandidates(key);
+	n = CFArrayGetCount(candidates);
+	for (i = 0; i < n; i++) {
+		CFStringRef	pattern	= CFArrayGetValueAtIndex(candidates, i);
+
+		if (!CFSetContainsValue(storePrivate->watchedPatterns, pattern)) {
+			/* if not watched by this session */
+			continue;
+		}
+
+		properties = (storePrivate->patternProperties != NULL)
+			     ? CFDictionaryGetValue(storePrivate->patternProperties, pattern)
+			     : NULL;
+		if ((properties != NULL) && !propertiesChanged(properties, change)) {
+			/* if no change of interest (no need to check for a match) */
+			continue;
+		}
+
+		if (patternKeyMatches(pattern, key)) {
+			wants = TRUE;
+			break;
+		}
+	}
+	CFRelease(candidates);
+
+	return wants;
+}
+
+
+__private_extern__
+kern_return_t
+_notifyprops(mach_port_t		server,
+	     xmlData_t			keyRef,		/* raw XML bytes */
+	     mach_msg_type_number_t	keyLen,
+	     int			isRegex,
+	     xmlData_t			propertiesRef,	/* raw XML bytes */
+	     mach_msg_type_number_t	propertiesLen,
+	     int			*sc_status
+)
+{
+	CFStringRef		key		= NULL;	/* key  (un-serialized) */
+	serverSessionRef	mySession;
+	CFArrayRef		properties	= NULL;	/* properties (un-serialized) */
+
+	*sc_status = kSCStatusOK;
+
+	/* un-serialize the key */
+	if (!_SCUnserializeString(&key, NULL, (void *)keyRef, keyLen)) {
+		*sc_status = kSCStatusFailed;
+	}
+
+	/* un-serialize the properties */
+	if ((propertiesRef != NULL) && (propertiesLen > 0)) {
+		if (!_SCUnserialize((CFPropertyListRef *)&properties, NULL, (void *)propertiesRef, propertiesLen)) {
+			*sc_status = kSCStatusFailed;
+		}
+	}
+
+	if (*sc_status != kSCStatusOK) {
+		goto done;
+	}
+
+	if (!isA_CFString(key)) {
+		*sc_status = kSCStatusInvalidArgument;
+		goto done;
+	}
+
+	mySession = getSession(server);
+	if (mySession == NULL) {
+		*sc_status = kSCStatusNoStoreSession;	/* you must have an open session to play */
+		goto done;
+	}
+
+	*sc_status = __SCDynamicStoreSetWatchedKeyProperties(mySession->store, key, isRegex != 0, properties);
+
+    done :
+
+	if (key)	CFRelease(key);
+	if (properties)	CFRelease(properties);
+	return KERN_SUCCESS;
+}
@@ -35,28 +35,24 @@
 #include "configd.h"
 #include "session.h"
 #include "pattern.h"
+#include "trace.h"
 
 
 static int
-removeKey(CFMutableArrayRef keys, CFStringRef key)
+removeKey(CFMutableSetRef keys, CFStringRef key)
 {
-	CFIndex	i;
-	CFIndex	n;
-
 	if (keys == NULL) {
 		/* sorry, empty notifier list */
 		return kSCStatusNoKey;
 	}
 
-	n = CFArrayGetCount(keys);
-	i = CFArrayGetFirstIndexOfValue(keys, CFRangeMake(0, n), key);
-	if (i == kCFNotFound) {
+	if (!CFSetContainsValue(keys, key)) {
 		/* sorry, key does not exist in notifier list */
 		return kSCStatusNoKey;
 	}
 
 	/* remove key from this sessions notifier list */
-	CFArrayRemoveValueAtIndex(keys, i);
+	CFSetRemoveValue(keys, key);
 	return kSCStatusOK;
 }
 
@@ -68,22 +64,14 @@ __SCDynamicStoreRemoveWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boole
 	int				sc_status	= kSCStatusOK;
 	CFNumberRef			sessionNum;
 	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
-
-	if (_configd_trace) {
-		SCTrace(TRUE, _configd_trace,
-			CFSTR("%s : %5d : %s : %@\n"),
-			internal ? "*watch-" : "watch- ",
-			storePrivate->server,
-			isRegex  ? "pattern" : "key",
-			key);
-	}
+	uint64_t			traceTime	= traceStart();
 
 	/*
 	 * remove key from this sessions notifier list after checking that
 	 * it was previously defined.
 	 */
 	if (isRegex) {
-		sc_status = removeKey(storePrivate->patterns, key);
+		sc_status = removeKey(storePrivate->watchedPatterns, key);
 		if (sc_status != kSCStatusOK) {
 			goto done;
 		}
@@ -93,7 +81,7 @@ __SCDynamicStoreRemoveWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boole
 		patternRemoveSession(key, sessionNum);
 		CFRelease(sessionNum);
 	} else {
-		sc_status = removeKey(storePrivate->keys, key);
+		sc_status = removeKey(storePrivate->watchedKeys, key);
 		if (sc_status != kSCStatusOK) {
 			goto done;
 		}
@@ -109,6 +97,14 @@ __SCDynamicStoreRemoveWatchedKey(SCDynamicStoreRef store, CFStringRef key, Boole
 
     done :
 
+	traceRecordOp(kTraceOpWatchRemove,
+		      (internal ? kTraceFlagInternal : 0) |
+		      (isRegex  ? kTraceFlagPattern  : 0),
+		      storePrivate->server,
+		      key,
+		      sc_status,
+		      traceTime,
+		      0);
 	return sc_status;
 }
 
@@ -50,8 +50,7 @@ __SCDynamicStoreNotifyFileDescriptor(SCDynamicStoreRef	store,
 {
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
 	int				sock;
-	CFStringRef			sessionKey;
-	CFDictionaryRef			info;
+	serverSessionRef		mySession;
 
 	if (storePrivate->notifyStatus != NotifierNotRegistered) {
 		/* sorry, you can only have one notification registered at once */
@@ -66,20 +65,9 @@ __SCDynamicStoreNotifyFileDescriptor(SCDynamicStoreRef	store,
 	*fd = sock;
 
 	/* push out a notification if any changes are pending */
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
-	info = CFDictionaryGetValue(sessionData, sessionKey);
-	CFRelease(sessionKey);
-	if (info && CFDictionaryContainsKey(info, kSCDChangedKeys)) {
-		CFNumberRef	sessionNum;
-
-		if (needsNotification == NULL)
-			needsNotification = CFSetCreateMutable(NULL,
-							       0,
-							       &kCFTypeSetCallBacks);
-
-		sessionNum = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
-		CFSetAddValue(needsNotification, sessionNum);
-		CFRelease(sessionNum);
+	mySession = getSession(storePrivate->server);
+	if ((mySession != NULL) && (mySession->changedKeys != NULL)) {
+		_setNeedsNotification(storePrivate->server);
 	}
 
 	return kSCStatusOK;
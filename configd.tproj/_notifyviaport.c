@@ -41,8 +41,7 @@ __SCDynamicStoreNotifyMachPort(SCDynamicStoreRef	store,
 			       mach_port_t		port)
 {
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-	CFStringRef			sessionKey;
-	CFDictionaryRef			info;
+	serverSessionRef		mySession;
 
 	if (storePrivate->notifyStatus != NotifierNotRegistered) {
 		/* sorry, you can only have one notification registered at once */
@@ -55,20 +54,9 @@ __SCDynamicStoreNotifyMachPort(SCDynamicStoreRef	store,
 	}
 
 	/* push out a notification if any changes are pending */
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
-	info = CFDictionaryGetValue(sessionData, sessionKey);
-	CFRelease(sessionKey);
-	if (info && CFDictionaryContainsKey(info, kSCDChangedKeys)) {
-		CFNumberRef	sessionNum;
-
-		if (needsNotification == NULL)
-			needsNotification = CFSetCreateMutable(NULL,
-							       0,
-							       &kCFTypeSetCallBacks);
-
-		sessionNum = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
-		CFSetAddValue(needsNotification, sessionNum);
-		CFRelease(sessionNum);
+	mySession = getSession(storePrivate->server);
+	if ((mySession != NULL) && (mySession->changedKeys != NULL)) {
+		_setNeedsNotification(storePrivate->server);
 	}
 
 	return kSCStatusOK;
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+#include "configd.h"
+#include "session.h"
+
+#include <libkern/OSAtomic.h>
+
+#define N_QUICK	64
+
+
+__private_extern__
+int
+__SCDynamicStoreNotifyRing(SCDynamicStoreRef	store,
+			   mach_port_t		*ring)
+{
+	vm_address_t			addr	= 0;
+	memory_object_size_t		size	= sizeof(struct __SCDynamicStoreNotifyRing);
+	kern_return_t			status;
+	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
+
+	if ((storePrivate->notifyStatus != Using_NotifierInformViaMachPort) &&
+	    (storePrivate->notifyStatus != Using_NotifierInformViaFD)) {
+		/* sorry, the ring is only used with mach port and file descriptor notifications */
+		return kSCStatusInvalidArgument;
+	}
+
+	if (storePrivate->notifyRing != NULL) {
+		/* sorry, you can only have one ring */
+		return kSCStatusNotifierActive;
+	}
+
+	status = vm_allocate(mach_task_self(), &addr, (vm_size_t)size, VM_FLAGS_ANYWHERE);
+	if (status != KERN_SUCCESS) {
+		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreNotifyRing vm_allocate() failed: %s"), mach_error_string(status));
+		return kSCStatusFailed;
+	}
+
+	status = mach_make_memory_entry_64(mach_task_self(),
+					   &size,
+					   (memory_object_offset_t)addr,
+					   VM_PROT_READ|VM_PROT_WRITE,
+					   ring,
+					   MACH_PORT_NULL);
+	if (status != KERN_SUCCESS) {
+		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreNotifyRing mach_make_memory_entry_64() failed: %s"), mach_error_string(status));
+		(void) vm_deallocate(mach_task_self(), addr, (vm_size_t)size);
+		return kSCStatusFailed;
+	}
+
+	storePrivate->notifyRing       = (struct __SCDynamicStoreNotifyRing *)addr;
+	storePrivate->notifyRingOffset = 0;
+
+	return kSCStatusOK;
+}
+
+
+__private_extern__
+void
+__SCDynamicStoreNotifyRingRelease(SCDynamicStoreRef store)
+{
+	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
+
+	if (storePrivate->notifyRing != NULL) {
+		(void) vm_deallocate(mach_task_self(),
+				     (vm_address_t)storePrivate->notifyRing,
+				     sizeof(struct __SCDynamicStoreNotifyRing));
+		storePrivate->notifyRing       = NULL;
+		storePrivate->notifyRingOffset = 0;
+	}
+
+	return;
+}
+
+
+/*
+ * __SCDynamicStoreNotifyRingPush
+ *   moves the session's changed keys into the notification ring (in
+ *   the order they are enumerated).  Any keys which do not fit are left
+ *   in the session's set of changed keys (to be fetched by the client)
+ *   and the ring is flagged as having overflowed.  Returns TRUE if the
+ *   client should be signaled (the "doorbell").
+ */
+__private_extern__
+Boolean
+__SCDynamicStoreNotifyRingPush(SCDynamicStoreRef store)
+{
+	uint8_t				buf[sizeof(__SCDynamicStoreNotifyRecord) + NOTIFY_RING_KEY_MAX];
+	Boolean				doorbell	= FALSE;
+	uint64_t			head;
+	CFIndex				i;
+	CFIndex				keyCnt;
+	const void *			keys_q[N_QUICK];
+	const void **			keys		= keys_q;
+	serverSessionRef		mySession;
+	struct __SCDynamicStoreNotifyRing	*ring;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+	uint64_t			tail;
+
+	ring = storePrivate->notifyRing;
+	tail = storePrivate->notifyRingOffset;
+
+	mySession = getSession(storePrivate->server);
+	if ((mySession == NULL) || (mySession->changedKeys == NULL)) {
+		/* if no changes */
+		return FALSE;
+	}
+
+	keyCnt = CFSetGetCount(mySession->changedKeys);
+	if (keyCnt > (CFIndex)(sizeof(keys_q) / sizeof(CFStringRef)))
+		keys = CFAllocatorAllocate(NULL, keyCnt * sizeof(CFStringRef), 0);
+	CFSetGetValues(mySession->changedKeys, keys);
+
+	head = ring->head;
+	for (i = 0; i < keyCnt; i++) {
+		storeEntryRef			entry;
+		CFIndex				keyLen	= 0;
+		size_t				len;
+		size_t				pos;
+		__SCDynamicStoreNotifyRecord	*rec	= (__SCDynamicStoreNotifyRecord *)(void *)buf;
+		CFIndex				used;
+
+		used = (CFIndex)(tail - head);
+		if ((used < 0) || (used > NOTIFY_RING_DATA_SIZE)) {
+			/* if the client has scribbled on the ring */
+			goto overflow;
+		}
+
+		if (CFStringGetBytes(keys[i],
+				     CFRangeMake(0, CFStringGetLength(keys[i])),
+				     kCFStringEncodingUTF8,
+				     0,
+				     FALSE,
+				     rec->key,
+				     NOTIFY_RING_KEY_MAX,
+				     &keyLen) != CFStringGetLength(keys[i])) {
+			/* if the key is too long for a record */
+			goto overflow;
+		}
+
+		entry = storeLookup(keys[i]);
+		len = sizeof(__SCDynamicStoreNotifyRecord) + keyLen;
+		len = (len + NOTIFY_RING_RECORD_ALIGN - 1) & ~(NOTIFY_RING_RECORD_ALIGN - 1);
+		rec->length     = (uint32_t)len;
+		rec->op         = ((entry != NULL) && (entry->data != NULL)) ? kNotifyRingOpSet : kNotifyRingOpRemove;
+		rec->keyLen     = (uint16_t)keyLen;
+		rec->generation = (entry != NULL) ? entry->generation : storeGeneration;
+
+		pos = (size_t)(tail & (NOTIFY_RING_DATA_SIZE - 1));
+		if (len > NOTIFY_RING_DATA_SIZE - pos) {
+			__SCDynamicStoreNotifyRecord	pad;
+
+			/* if the record does not fit before the end of the ring */
+			if ((size_t)used + (NOTIFY_RING_DATA_SIZE - pos) + len > NOTIFY_RING_DATA_SIZE) {
+				goto overflow;
+			}
+
+			bzero(&pad, sizeof(pad));
+			pad.length = (uint32_t)(NOTIFY_RING_DATA_SIZE - pos);
+			pad.op     = kNotifyRingOpPad;
+			memcpy(&ring->records[pos], &pad, sizeof(pad));
+			tail += NOTIFY_RING_DATA_SIZE - pos;
+			used += NOTIFY_RING_DATA_SIZE - pos;
+			pos = 0;
+		}
+
+		if ((size_t)used + len > NOTIFY_RING_DATA_SIZE) {
+			/* if the ring is full */
+			goto overflow;
+		}
+
+		memcpy(&ring->records[pos], rec, len);
+		tail += len;
+
+		/* this change will be delivered via the ring */
+		CFSetRemoveValue(mySession->changedKeys, keys[i]);
+	}
+
+	goto done;
+
+    overflow :
+
+	OSAtomicOr32Barrier(1, &ring->overflow);
+	doorbell = TRUE;
+
+    done :
+
+	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
+
+	if (CFSetGetCount(mySession->changedKeys) == 0) {
+		CFRelease(mySession->changedKeys);
+		mySession->changedKeys = NULL;
+	}
+
+	if (tail != storePrivate->notifyRingOffset) {
+		/*
+		 * publish the new records and then check if the client had
+		 * already caught up (i.e. the ring was empty); if so, the
+		 * client needs to be signaled.
+		 */
+		OSMemoryBarrier();
+		ring->tail = tail;
+		OSMemoryBarrier();
+		if (ring->head == storePrivate->notifyRingOffset) {
+			doorbell = TRUE;
+		}
+		storePrivate->notifyRingOffset = tail;
+	}
+
+	return doorbell;
+}
+
+
+__private_extern__
+kern_return_t
+_notifyviaring(mach_port_t	server,
+	       mach_port_t	*ring,
+	       int		*sc_status
+)
+{
+	serverSessionRef	mySession	= getSession(server);
+
+	*ring = MACH_PORT_NULL;
+
+	if (mySession == NULL) {
+		/* sorry, you must have an open session to play */
+		*sc_status = kSCStatusNoStoreSession;
+		return KERN_SUCCESS;
+	}
+
+	*sc_status = __SCDynamicStoreNotifyRing(mySession->store, ring);
+	if (*sc_status != kSCStatusOK) {
+		return KERN_SUCCESS;
+	}
+
+	/* push out a notification if any changes are pending */
+	if (mySession->changedKeys != NULL) {
+		_setNeedsNotification(server);
+	}
+
+	return KERN_SUCCESS;
+}
@@ -43,8 +43,7 @@ int
 __SCDynamicStoreNotifySignal(SCDynamicStoreRef store, pid_t pid, int sig)
 {
 	SCDynamicStorePrivateRef	storePrivate = (SCDynamicStorePrivateRef)store;
-	CFStringRef			sessionKey;
-	CFDictionaryRef			info;
+	serverSessionRef		mySession;
 
 	if (storePrivate->notifyStatus != NotifierNotRegistered) {
 		/* sorry, you can only have one notification registered at once */
@@ -62,20 +61,9 @@ __SCDynamicStoreNotifySignal(SCDynamicStoreRef store, pid_t pid, int sig)
 	}
 
 	/* push out a notification if any changes are pending */
-	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), storePrivate->server);
-	info = CFDictionaryGetValue(sessionData, sessionKey);
-	CFRelease(sessionKey);
-	if (info && CFDictionaryContainsKey(info, kSCDChangedKeys)) {
-		CFNumberRef	sessionNum;
-
-		if (needsNotification == NULL)
-			needsNotification = CFSetCreateMutable(NULL,
-							       0,
-							       &kCFTypeSetCallBacks);
-
-		sessionNum = CFNumberCreate(NULL, kCFNumberIntType, &storePrivate->server);
-		CFSetAddValue(needsNotification, sessionNum);
-		CFRelease(sessionNum);
+	mySession = getSession(storePrivate->server);
+	if ((mySession != NULL) && (mySession->changedKeys != NULL)) {
+		_setNeedsNotification(storePrivate->server);
 	}
 
 	return kSCStatusOK;
@@ -128,7 +116,7 @@ _notifyviasignal(mach_port_t	server,
 	__MACH_PORT_DEBUG(TRUE, "*** _notifyviasignal", task);
 	storePrivate->notifyStatus     = Using_NotifierInformViaSignal;
 	storePrivate->notifySignal     = sig;
-	storePrivate->notifySignalTask = task;
+	setSessionSignalTask(mySession->store, task);
 
 	return KERN_SUCCESS;
 }
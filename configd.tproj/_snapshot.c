@@ -38,6 +38,7 @@
 #include "configd.h"
 #include "configd_server.h"
 #include "session.h"
+#include "notify_delivery.h"
 #include "plugin_support.h"
 
 
@@ -45,76 +46,174 @@
 #define	SNAPSHOT_PATH_STORE	_PATH_VARTMP "configd-store.plist"
 #define	SNAPSHOT_PATH_PATTERN	_PATH_VARTMP "configd-pattern.plist"
 #define	SNAPSHOT_PATH_SESSION	_PATH_VARTMP "configd-session.plist"
+#define	SNAPSHOT_PATH_RECORDS	_PATH_VARTMP "configd-store.records"
+#define	SNAPSHOT_PATH_RECORDS_TMP	_PATH_VARTMP "configd-store.records.tmp"
 
 
-#define N_QUICK	100
+/*
+ * The streamed store snapshot ("configd-store.records") is written one
+ * key at a time, directly from an immutable store snapshot, so that the
+ * [serialized] values never need to be decoded or collected into a
+ * single property list.  The file contains (in host byte order) :
+ *
+ *   snapshotStreamHeader
+ *   snapshotStreamRecord, key bytes (UTF-8), data bytes	(repeated, in key order)
+ *   snapshotStreamRecord with keyLen == 0			(end marker)
+ *
+ * The data bytes are the serialized value, as stored.  A "delta" stream
+ * only contains the keys that were changed (or removed) since the
+ * previously streamed snapshot.
+ *
+ * The snapshot (and, for a delta, the list of removed keys) is taken on
+ * the server thread but the file is written on a background queue and
+ * then renamed into place.  While the file is being written the nodes
+ * of the snapshot that have since been changed in the store are kept
+ * alive so the extra memory used is proportional to the number of keys
+ * changed during the write (plus, for a delta, the removed keys).
+ */
+#define	SNAPSHOT_STREAM_MAGIC	0x53435352	/* 'SCSR' */
+#define	SNAPSHOT_STREAM_VERSION	1
+#define	SNAPSHOT_STREAM_REMOVED	UINT32_MAX	/* dataLen of a removed key */
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	generation;	/* store generation of the snapshot */
+	uint64_t	since;		/* generation of the previously streamed snapshot, 0 if complete */
+} snapshotStreamHeader;
+
+typedef struct {
+	uint32_t	keyLen;		/* 0 for the end marker */
+	uint32_t	dataLen;
+	uint64_t	generation;	/* generation in which the key last changed (# of records in the end marker) */
+} snapshotStreamRecord;
+
+
+/* the generation of the most recently streamed snapshot (the base for the next "delta") */
+static uint64_t			streamGeneration	= 0;
+
+/* the queue on which the streamed snapshots are written */
+static dispatch_queue_t		streamQueue		= NULL;
+
+/* TRUE if the last write failed (the next stream must be complete), only accessed on the streamQueue */
+static Boolean			streamFailed		= FALSE;
+
+
+static void
+_expandEntry(storeEntryRef entry, void *context)
+{
+	CFMutableDictionaryRef	newStoreData	= (CFMutableDictionaryRef)context;
+	CFDictionaryRef		info;
+
+	info = storeCopyEntryInfo(entry, TRUE);
+	CFDictionarySetValue(newStoreData, entry->key, info);
+	CFRelease(info);
+	return;
+}
+
 
 static CF_RETURNS_RETAINED CFDictionaryRef
-_expandStore(CFDictionaryRef storeData)
+_expandStore(void)
 {
-	const void *		keys_q[N_QUICK];
-	const void **		keys		= keys_q;
-	CFIndex			nElements;
-	CFDictionaryRef		newStoreData	= NULL;
-	const void *		nValues_q[N_QUICK];
-	const void **		nValues		= nValues_q;
-	const void *		oValues_q[N_QUICK];
-	const void **		oValues		= oValues_q;
-
-	nElements = CFDictionaryGetCount(storeData);
-	if (nElements > 0) {
-		CFIndex	i;
-
-		if (nElements > (CFIndex)(sizeof(keys_q) / sizeof(CFTypeRef))) {
-			keys    = CFAllocatorAllocate(NULL, nElements * sizeof(CFTypeRef), 0);
-			oValues = CFAllocatorAllocate(NULL, nElements * sizeof(CFTypeRef), 0);
-			nValues = CFAllocatorAllocate(NULL, nElements * sizeof(CFTypeRef), 0);
-		}
-		bzero(nValues, nElements * sizeof(CFTypeRef));
-
-		CFDictionaryGetKeysAndValues(storeData, keys, oValues);
-		for (i = 0; i < nElements; i++) {
-			CFDataRef		data;
-
-			data = CFDictionaryGetValue(oValues[i], kSCDData);
-			if (data) {
-				CFPropertyListRef	plist;
-
-				nValues[i] = CFDictionaryCreateMutableCopy(NULL, 0, oValues[i]);
-
-				_SCUnserialize(&plist, data, NULL, 0);
-				CFDictionarySetValue((CFMutableDictionaryRef)nValues[i],
-						     kSCDData,
-						     plist);
-				CFRelease(plist);
-			} else {
-				nValues[i] = CFRetain(oValues[i]);
-			}
-		}
+	CFMutableDictionaryRef	newStoreData;
+
+	newStoreData = CFDictionaryCreateMutable(NULL,
+						 storeGetCount(),
+						 &kCFTypeDictionaryKeyCallBacks,
+						 &kCFTypeDictionaryValueCallBacks);
+	storeApplyFunction(_expandEntry, newStoreData);
+	return newStoreData;
+}
+
+
+static void
+_expandSession(const void *key, const void *value, void *context)
+{
+	serverSessionRef		mySession;
+	CFMutableDictionaryRef		newSessionData	= (CFMutableDictionaryRef)context;
+	CFMutableDictionaryRef		newInfo;
+	CFIndex				n;
+	CFArrayRef			sessionKeys;
+	SCDynamicStorePrivateRef	storePrivate;
+	const void			**values;
+
+	mySession = getSession(CFStringGetIntValue((CFStringRef)key));
+	storePrivate = (mySession != NULL) ? (SCDynamicStorePrivateRef)mySession->store : NULL;
+	n = ((storePrivate != NULL) && (storePrivate->sessionKeys != NULL))
+	    ? CFSetGetCount(storePrivate->sessionKeys)
+	    : 0;
+	if (n == 0) {
+		CFDictionarySetValue(newSessionData, key, value);
+		return;
 	}
 
-	newStoreData = CFDictionaryCreate(NULL,
-				     keys,
-				     nValues,
-				     nElements,
-				     &kCFTypeDictionaryKeyCallBacks,
-				     &kCFTypeDictionaryValueCallBacks);
+	/* add the session keys (a set, not a property list type) as an array */
+	values = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	CFSetGetValues(storePrivate->sessionKeys, values);
+	sessionKeys = CFArrayCreate(NULL, values, n, &kCFTypeArrayCallBacks);
+	CFAllocatorDeallocate(NULL, values);
+
+	newInfo = CFDictionaryCreateMutableCopy(NULL, 0, (CFDictionaryRef)value);
+	CFDictionarySetValue(newInfo, kSCDSessionKeys, sessionKeys);
+	CFRelease(sessionKeys);
+	CFDictionarySetValue(newSessionData, key, newInfo);
+	CFRelease(newInfo);
+	return;
+}
 
-	if (nElements > 0) {
-		CFIndex	i;
 
-		for (i = 0; i < nElements; i++) {
-			CFRelease(nValues[i]);
-		}
+static CF_RETURNS_RETAINED CFDictionaryRef
+_expandSessions(void)
+{
+	CFMutableDictionaryRef	newSessionData;
+
+	newSessionData = CFDictionaryCreateMutable(NULL,
+						   CFDictionaryGetCount(sessionData),
+						   &kCFTypeDictionaryKeyCallBacks,
+						   &kCFTypeDictionaryValueCallBacks);
+	CFDictionaryApplyFunction(sessionData, _expandSession, newSessionData);
+	return newSessionData;
+}
 
-		if (keys != keys_q) {
-			CFAllocatorDeallocate(NULL, keys);
-			CFAllocatorDeallocate(NULL, oValues);
-			CFAllocatorDeallocate(NULL, nValues);
-		}
-	}
 
-	return newStoreData;
+static void
+_expandPattern(const void *key, const void *value, void *context)
+{
+	CFIndex			n;
+	CFMutableDictionaryRef	newPatternData	= (CFMutableDictionaryRef)context;
+	CFMutableArrayRef	newInfo;
+	CFArrayRef		pKeys;
+	CFSetRef		pKeysSet;
+	const void		**values;
+
+	/* add the matching keys (a set, not a property list type) as an array */
+	pKeysSet = CFArrayGetValueAtIndex((CFArrayRef)value, 2);
+	n = CFSetGetCount(pKeysSet);
+	values = CFAllocatorAllocate(NULL, (n > 0 ? n : 1) * sizeof(CFTypeRef), 0);
+	CFSetGetValues(pKeysSet, values);
+	pKeys = CFArrayCreate(NULL, values, n, &kCFTypeArrayCallBacks);
+	CFAllocatorDeallocate(NULL, values);
+
+	newInfo = CFArrayCreateMutableCopy(NULL, 0, (CFArrayRef)value);
+	CFArraySetValueAtIndex(newInfo, 2, pKeys);
+	CFRelease(pKeys);
+	CFDictionarySetValue(newPatternData, key, newInfo);
+	CFRelease(newInfo);
+	return;
+}
+
+
+static CF_RETURNS_RETAINED CFDictionaryRef
+_expandPatterns(void)
+{
+	CFMutableDictionaryRef	newPatternData;
+
+	newPatternData = CFDictionaryCreateMutable(NULL,
+						   CFDictionaryGetCount(patternData),
+						   &kCFTypeDictionaryKeyCallBacks,
+						   &kCFTypeDictionaryValueCallBacks);
+	CFDictionaryApplyFunction(patternData, _expandPattern, newPatternData);
+	return newPatternData;
 }
 
 
@@ -122,9 +221,18 @@ __private_extern__
 int
 __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 {
+	int32_t				depth;
+	CFDictionaryRef			expandedPatternData;
+	CFDictionaryRef			expandedSessionData;
 	CFDictionaryRef			expandedStoreData;
 	FILE				*f;
 	int				fd;
+	int32_t				maxDepth;
+	CFIndex				valuesCount;
+	uint64_t			valuesHits;
+	size_t				valuesLimit;
+	uint64_t			valuesMisses;
+	size_t				valuesSize;
 	CFDataRef			xmlData;
 
 	/* Save a snapshot of configd's "state" */
@@ -144,6 +252,15 @@ __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 		SCPrint(TRUE, f, CFSTR("Plug-in thread :\n\n"));
 		SCPrint(TRUE, f, CFSTR("%@\n"), plugin_runLoop);
 	}
+	notifyDeliveryGetQueueDepth(&depth, &maxDepth);
+	SCPrint(TRUE, f, CFSTR("Notification delivery queue : depth = %d, max = %d\n\n"), depth, maxDepth);
+	storeGetValueCacheInfo(&valuesCount, &valuesSize, &valuesLimit, &valuesHits, &valuesMisses);
+	SCPrint(TRUE, f, CFSTR("Decoded value cache : count = %ld, size = %zu, limit = %zu, hits = %llu, misses = %llu\n\n"),
+		valuesCount,
+		valuesSize,
+		valuesLimit,
+		valuesHits,
+		valuesMisses);
 	listSessions(f);
 	(void) fclose(f);
 
@@ -155,7 +272,7 @@ __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 		return kSCStatusFailed;
 	}
 
-	expandedStoreData = _expandStore(storeData);
+	expandedStoreData = _expandStore();
 	xmlData = CFPropertyListCreateData(NULL, expandedStoreData, kCFPropertyListXMLFormat_v1_0, 0, NULL);
 	CFRelease(expandedStoreData);
 	if (xmlData == NULL) {
@@ -175,7 +292,9 @@ __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 		return kSCStatusFailed;
 	}
 
-	xmlData = CFPropertyListCreateData(NULL, patternData, kCFPropertyListXMLFormat_v1_0, 0, NULL);
+	expandedPatternData = _expandPatterns();
+	xmlData = CFPropertyListCreateData(NULL, expandedPatternData, kCFPropertyListXMLFormat_v1_0, 0, NULL);
+	CFRelease(expandedPatternData);
 	if (xmlData == NULL) {
 		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreSnapshot CFPropertyListCreateData() failed"));
 		close(fd);
@@ -193,7 +312,9 @@ __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 		return kSCStatusFailed;
 	}
 
-	xmlData = CFPropertyListCreateData(NULL, sessionData, kCFPropertyListXMLFormat_v1_0, 0, NULL);
+	expandedSessionData = _expandSessions();
+	xmlData = CFPropertyListCreateData(NULL, expandedSessionData, kCFPropertyListXMLFormat_v1_0, 0, NULL);
+	CFRelease(expandedSessionData);
 	if (xmlData == NULL) {
 		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreSnapshot CFPropertyListCreateData() failed"));
 		close(fd);
@@ -207,6 +328,156 @@ __SCDynamicStoreSnapshot(SCDynamicStoreRef store)
 }
 
 
+typedef struct {
+	FILE		*f;
+	uint64_t	count;
+	Boolean		ok;
+} streamContext;
+
+
+typedef struct {
+	storeSnapshotRef	snapshot;
+	uint64_t		since;		/* 0 if complete */
+	CFArrayRef		removed;	/* keys removed since "since" (UTF-8 bytes) */
+} streamRequest, *streamRequestRef;
+
+
+static void
+_streamRecord(const UInt8 *keyBytes, CFIndex keyLen, CFDataRef data, uint64_t generation, void *context)
+{
+	streamContext		*myContextRef	= (streamContext *)context;
+	snapshotStreamRecord	record;
+
+	if (!myContextRef->ok) {
+		return;
+	}
+
+	record.keyLen     = (uint32_t)keyLen;
+	record.dataLen    = (data != NULL) ? (uint32_t)CFDataGetLength(data) : SNAPSHOT_STREAM_REMOVED;
+	record.generation = generation;
+	if ((fwrite(&record, sizeof(record), 1, myContextRef->f) != 1) ||
+	    (fwrite(keyBytes, keyLen, 1, myContextRef->f) != 1) ||
+	    ((data != NULL) &&
+	     (CFDataGetLength(data) > 0) &&
+	     (fwrite(CFDataGetBytePtr(data), CFDataGetLength(data), 1, myContextRef->f) != 1))) {
+		myContextRef->ok = FALSE;
+		return;
+	}
+
+	myContextRef->count++;
+	return;
+}
+
+
+/* write a streamed snapshot (on the streamQueue) */
+static void
+_streamWrite(void *context)
+{
+	streamContext		myContext;
+	int			fd;
+	snapshotStreamHeader	header;
+	snapshotStreamRecord	marker;
+	streamRequestRef	request		= (streamRequestRef)context;
+
+	if (streamFailed) {
+		/*
+		 * if the previous stream was not written then a delta
+		 * relative to it would be of no use, write everything
+		 */
+		request->since = 0;
+		if (request->removed != NULL) {
+			CFRelease(request->removed);
+			request->removed = NULL;
+		}
+	}
+
+	myContext.count = 0;
+	myContext.ok    = FALSE;
+
+	(void) unlink(SNAPSHOT_PATH_RECORDS_TMP);
+	fd = open(SNAPSHOT_PATH_RECORDS_TMP, O_WRONLY|O_CREAT|O_TRUNC|O_EXCL, 0644);
+	if (fd == -1) {
+		goto done;
+	}
+	myContext.f = fdopen(fd, "w");
+	if (myContext.f == NULL) {
+		close(fd);
+		goto done;
+	}
+	myContext.ok = TRUE;
+
+	header.magic      = SNAPSHOT_STREAM_MAGIC;
+	header.version    = SNAPSHOT_STREAM_VERSION;
+	header.generation = storeSnapshotGetGeneration(request->snapshot);
+	header.since      = request->since;
+	if (fwrite(&header, sizeof(header), 1, myContext.f) != 1) {
+		myContext.ok = FALSE;
+	}
+
+	storeSnapshotApplyChangesFunction(request->snapshot, request->since, request->removed, _streamRecord, &myContext);
+
+	marker.keyLen     = 0;
+	marker.dataLen    = 0;
+	marker.generation = myContext.count;
+	if (myContext.ok && (fwrite(&marker, sizeof(marker), 1, myContext.f) != 1)) {
+		myContext.ok = FALSE;
+	}
+
+	if (fclose(myContext.f) != 0) {
+		myContext.ok = FALSE;
+	}
+
+	if (myContext.ok && (rename(SNAPSHOT_PATH_RECORDS_TMP, SNAPSHOT_PATH_RECORDS) == -1)) {
+		myContext.ok = FALSE;
+	}
+
+    done :
+
+	if (!myContext.ok) {
+		SCLog(TRUE, LOG_ERR, CFSTR("__SCDynamicStoreSnapshotStream write() failed"));
+		(void) unlink(SNAPSHOT_PATH_RECORDS_TMP);
+	}
+	streamFailed = !myContext.ok;
+
+	if (request->removed != NULL) CFRelease(request->removed);
+	storeSnapshotRelease(request->snapshot);
+	free(request);
+	return;
+}
+
+
+__private_extern__
+int
+__SCDynamicStoreSnapshotStream(SCDynamicStoreRef store, Boolean delta, uint64_t *generation)
+{
+	streamRequestRef	request;
+
+	if (streamQueue == NULL) {
+		streamQueue = dispatch_queue_create("SCDynamicStore snapshot stream", NULL);
+	}
+
+	request = calloc(1, sizeof(*request));
+	request->snapshot = storeSnapshotCopy();
+	if (delta && (streamGeneration != 0)) {
+		/*
+		 * the removal log is only available on the server thread so
+		 * collect the keys removed since the previous stream now
+		 */
+		request->removed = storeCopyRemovedKeys(streamGeneration);
+		if (request->removed != NULL) {
+			request->since = streamGeneration;
+		}
+	}
+
+	/* the next "delta" is relative to this snapshot */
+	streamGeneration = storeSnapshotGetGeneration(request->snapshot);
+	*generation = streamGeneration;
+
+	dispatch_async_f(streamQueue, request, _streamWrite);
+	return kSCStatusOK;
+}
+
+
 __private_extern__
 kern_return_t
 _snapshot(mach_port_t server, int *sc_status, audit_token_t audit_token)
@@ -229,3 +500,35 @@ _snapshot(mach_port_t server, int *sc_status, audit_token_t audit_token)
 	*sc_status = __SCDynamicStoreSnapshot(mySession->store);
 	return KERN_SUCCESS;
 }
+
+
+__private_extern__
+kern_return_t
+_snapshotstream(mach_port_t		server,
+		int			delta,
+		uint64_t		*generation,
+		int			*sc_status,
+		audit_token_t		audit_token)
+{
+	serverSessionRef	mySession;
+
+	*generation = 0;
+
+	mySession = getSession(server);
+	if (mySession == NULL) {
+		mySession = tempSession(server, CFSTR("SCDynamicStoreSnapshotStream"), audit_token);
+		if (mySession == NULL) {
+			/* you must have an open session to play */
+			*sc_status = kSCStatusNoStoreSession;
+			return KERN_SUCCESS;
+		}
+	}
+
+	if (!hasRootAccess(mySession)) {
+		*sc_status = kSCStatusAccessError;
+		return KERN_SUCCESS;
+	}
+
+	*sc_status = __SCDynamicStoreSnapshotStream(mySession->store, (delta != 0), generation);
+	return KERN_SUCCESS;
+}
@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+/*
+ * admission control
+ *
+ * Each session can be given a budget of requests (and request bytes) per
+ * second, enforced with a token bucket (holding up to one second's worth
+ * of tokens), and a limit on the number of patterns it may watch.  When a
+ * session is over its budget the configured policy is applied :
+ *
+ *   delay		stop receiving requests from the session until its
+ *			budget has been replenished (the requests are queued
+ *			by the kernel and, once the queue is full, the client
+ *			blocks)
+ *   reject		reject write requests with kSCStatusLimitExceeded
+ *			(requests that are rejected are not charged)
+ *   deprioritize	only receive requests from the session when there are
+ *			no other requests pending (or, at most, after
+ *			ADMISSION_DELAY_MAX seconds)
+ *
+ * Requests to watch more patterns than allowed are always rejected.
+ */
+
+#include "configd.h"
+#include "configd_server.h"
+#include "admission.h"
+#include "request_stats.h"
+#include "session.h"
+
+
+#define	ADMISSION_DELAY_MAX	1.0	/* seconds */
+
+typedef enum {
+	kAdmissionPolicyDelay	= 0,
+	kAdmissionPolicyReject,
+	kAdmissionPolicyDeprioritize
+} admissionPolicy;
+
+static const char		*policyNames[]	= {
+	"delay",
+	"reject",
+	"deprioritize"
+};
+
+/* the per-session budgets (0 == no limit) */
+static double			budgetOps	= 0;	/* requests / second */
+static double			budgetBytes	= 0;	/* bytes / second */
+static CFIndex			budgetPatterns	= 0;
+static admissionPolicy		policy		= kAdmissionPolicyDelay;
+
+/* the number of times each action was taken */
+static uint64_t			nDelayed		= 0;
+static uint64_t			nRejected		= 0;
+static uint64_t			nDeprioritized		= 0;
+static uint64_t			nPatternsRejected	= 0;
+
+/* the [session] ports of the deprioritized sessions */
+static CFMutableArrayRef	deprioritized	= NULL;
+
+
+static Boolean
+parseBudget(const char *str, double *budget)
+{
+	char	*end;
+	double	val;
+
+	val = strtod(str, &end);
+	if ((end == str) || (*end != '\0') || (val < 0)) {
+		return FALSE;
+	}
+
+	*budget = val;
+	return TRUE;
+}
+
+
+__private_extern__
+Boolean
+admissionConfigure(const char *limits)
+{
+	char	*buf;
+	char	*cp;
+	char	*limit;
+	Boolean	ok	= TRUE;
+
+	buf = strdup(limits);
+	cp = buf;
+	while (ok && ((limit = strsep(&cp, ",")) != NULL)) {
+		double	patterns;
+		char	*val;
+
+		val = strchr(limit, '=');
+		if (val == NULL) {
+			ok = FALSE;
+			break;
+		}
+		*val++ = '\0';
+
+		if (strcmp(limit, "ops") == 0) {
+			ok = parseBudget(val, &budgetOps);
+		} else if (strcmp(limit, "bytes") == 0) {
+			ok = parseBudget(val, &budgetBytes);
+		} else if (strcmp(limit, "patterns") == 0) {
+			ok = parseBudget(val, &patterns);
+			budgetPatterns = (CFIndex)patterns;
+		} else if (strcmp(limit, "policy") == 0) {
+			if (strcmp(val, "delay") == 0) {
+				policy = kAdmissionPolicyDelay;
+			} else if (strcmp(val, "reject") == 0) {
+				policy = kAdmissionPolicyReject;
+			} else if (strcmp(val, "deprioritize") == 0) {
+				policy = kAdmissionPolicyDeprioritize;
+			} else {
+				ok = FALSE;
+			}
+		} else {
+			ok = FALSE;
+		}
+	}
+	free(buf);
+
+	return ok;
+}
+
+
+static void
+refill(double *tokens, double budget, CFTimeInterval elapsed)
+{
+	/* the bucket holds (at most) one second's worth of tokens */
+	*tokens += elapsed * budget;
+	if (*tokens > budget) {
+		*tokens = budget;
+	}
+	return;
+}
+
+
+static void
+charge(double *tokens, double budget, double cost)
+{
+	/* ... and owes (at most) one second's worth */
+	*tokens -= cost;
+	if (*tokens < -budget) {
+		*tokens = -budget;
+	}
+	return;
+}
+
+
+__private_extern__
+void
+admissionCheck(serverSessionRef session, mach_msg_id_t msgid, size_t bytesIn)
+{
+	CFTimeInterval	delay	= 0;
+	CFAbsoluteTime	now;
+	Boolean		over	= FALSE;
+
+	if ((budgetOps <= 0) && (budgetBytes <= 0)) {
+		/* if no budget */
+		return;
+	}
+
+	now = CFAbsoluteTimeGetCurrent();
+	if (budgetOps > 0) {
+		refill(&session->admitOps, budgetOps, now - session->admitUpdated);
+		if (session->admitOps < 1.0) {
+			over = TRUE;
+		}
+	}
+	if (budgetBytes > 0) {
+		refill(&session->admitBytes, budgetBytes, now - session->admitUpdated);
+		if (session->admitBytes < (double)bytesIn) {
+			over = TRUE;
+		}
+	}
+	session->admitUpdated = now;
+
+	if (over &&
+	    (policy == kAdmissionPolicyReject) &&
+	    (requestStatsType(msgid) == kRequestTypeWrite)) {
+		session->admitReject = TRUE;
+		session->admitRejected++;
+		nRejected++;
+		return;
+	}
+
+	if (budgetOps > 0) {
+		charge(&session->admitOps, budgetOps, 1.0);
+	}
+	if (budgetBytes > 0) {
+		charge(&session->admitBytes, budgetBytes, (double)bytesIn);
+	}
+
+	if (!over) {
+		return;
+	}
+
+	switch (policy) {
+		case kAdmissionPolicyDelay :
+			/* wait until the session is back within budget */
+			if ((budgetOps > 0) && (session->admitOps < 0)) {
+				delay = -session->admitOps / budgetOps;
+			}
+			if ((budgetBytes > 0) && (-session->admitBytes / budgetBytes > delay)) {
+				delay = -session->admitBytes / budgetBytes;
+			}
+			if (delay > ADMISSION_DELAY_MAX) {
+				delay = ADMISSION_DELAY_MAX;
+			}
+			session->admitDelay = (delay > 0) ? delay : 0.001;
+			break;
+		case kAdmissionPolicyDeprioritize :
+			session->admitDeprioritize = TRUE;
+			break;
+		default :
+			break;
+	}
+
+	return;
+}
+
+
+static void
+resumeSession(mach_port_t server)
+{
+	serverSessionRef	mySession;
+
+	mySession = getSession(server);
+	if ((mySession == NULL) || !mySession->admitSuspended) {
+		/* if the session has been closed (or already resumed) */
+		return;
+	}
+
+	mySession->admitSuspended = FALSE;
+	if (mySession->serverRunLoopSource != NULL) {
+		CFRunLoopAddSource(CFRunLoopGetCurrent(),
+				   mySession->serverRunLoopSource,
+				   kCFRunLoopDefaultMode);
+	}
+
+	return;
+}
+
+
+static void
+resumeTimer(CFRunLoopTimerRef timer, void *info)
+{
+	resumeSession((mach_port_t)(uintptr_t)info);
+	return;
+}
+
+
+static void
+suspendSession(serverSessionRef session, CFTimeInterval delay)
+{
+	CFRunLoopTimerContext	context	= { 0, NULL, NULL, NULL, NULL };
+	CFRunLoopTimerRef	timer;
+
+	if (session->admitSuspended || (session->serverRunLoopSource == NULL)) {
+		return;
+	}
+
+	/* stop receiving requests ... */
+	CFRunLoopRemoveSource(CFRunLoopGetCurrent(),
+			      session->serverRunLoopSource,
+			      kCFRunLoopDefaultMode);
+	session->admitSuspended = TRUE;
+
+	/* ... until later */
+	context.info = (void *)(uintptr_t)session->key;
+	timer = CFRunLoopTimerCreate(NULL,
+				     CFAbsoluteTimeGetCurrent() + delay,
+				     0,
+				     0,
+				     0,
+				     resumeTimer,
+				     &context);
+	CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
+	CFRelease(timer);
+
+	return;
+}
+
+
+__private_extern__
+void
+admissionDone(mach_port_t server)
+{
+	serverSessionRef	mySession;
+
+	mySession = getSession(server);
+	if (mySession == NULL) {
+		/* if the session was closed */
+		return;
+	}
+
+	mySession->admitReject = FALSE;
+
+	if (mySession->admitDelay > 0) {
+		suspendSession(mySession, mySession->admitDelay);
+		mySession->admitDelay = 0;
+		mySession->admitDelayed++;
+		nDelayed++;
+	} else if (mySession->admitDeprioritize) {
+		suspendSession(mySession, ADMISSION_DELAY_MAX);
+		mySession->admitDeprioritize = FALSE;
+		mySession->admitDeprioritized++;
+		nDeprioritized++;
+
+		if (deprioritized == NULL) {
+			deprioritized = CFArrayCreateMutable(NULL, 0, NULL);
+		}
+		CFArrayAppendValue(deprioritized, (const void *)(uintptr_t)server);
+	}
+
+	return;
+}
+
+
+__private_extern__
+Boolean
+admissionPending(void)
+{
+	return ((deprioritized != NULL) && (CFArrayGetCount(deprioritized) > 0));
+}
+
+
+__private_extern__
+void
+admissionIdle(void)
+{
+	CFIndex	i;
+	CFIndex	n;
+
+	if (deprioritized == NULL) {
+		return;
+	}
+
+	n = CFArrayGetCount(deprioritized);
+	for (i = 0; i < n; i++) {
+		resumeSession((mach_port_t)(uintptr_t)CFArrayGetValueAtIndex(deprioritized, i));
+	}
+	CFArrayRemoveAllValues(deprioritized);
+
+	return;
+}
+
+
+__private_extern__
+int
+admissionCheckPatterns(serverSessionRef session, CFIndex nPatterns)
+{
+	if ((budgetPatterns > 0) && (nPatterns > budgetPatterns)) {
+		session->admitRejected++;
+		nPatternsRejected++;
+		return kSCStatusLimitExceeded;
+	}
+
+	return kSCStatusOK;
+}
+
+
+static void
+addNumber(CFMutableDictionaryRef dict, CFStringRef key, uint64_t val)
+{
+	CFNumberRef	num;
+
+	num = CFNumberCreate(NULL, kCFNumberSInt64Type, &val);
+	CFDictionarySetValue(dict, key, num);
+	CFRelease(num);
+	return;
+}
+
+
+__private_extern__
+CFDictionaryRef
+admissionCopyStatistics(void)
+{
+	CFMutableDictionaryRef	dict;
+	CFStringRef		str;
+
+	if ((budgetOps <= 0) && (budgetBytes <= 0) && (budgetPatterns <= 0)) {
+		/* if no budget */
+		return NULL;
+	}
+
+	dict = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+	str = CFStringCreateWithCString(NULL, policyNames[policy], kCFStringEncodingASCII);
+	CFDictionarySetValue(dict, CFSTR("Policy"), str);
+	CFRelease(str);
+	addNumber(dict, CFSTR("Delayed"), nDelayed);
+	addNumber(dict, CFSTR("Rejected"), nRejected);
+	addNumber(dict, CFSTR("Deprioritized"), nDeprioritized);
+	addNumber(dict, CFSTR("PatternsRejected"), nPatternsRejected);
+
+	return dict;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_ADMISSION_H
+#define _S_ADMISSION_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+#include "session.h"
+
+
+__BEGIN_DECLS
+
+/*
+ * admissionConfigure
+ *   sets the per-session budgets and the policy applied to sessions
+ *   that exceed them (see configd -L).  Returns FALSE if the limits
+ *   could not be parsed.
+ */
+Boolean		admissionConfigure	(const char		*limits);
+
+/*
+ * admissionCheck
+ *   charges a request (received on the session's port) against the
+ *   session's budget and decides what should be done if the session
+ *   is over budget.  Called before the request is processed.
+ */
+void		admissionCheck		(serverSessionRef	session,
+					 mach_msg_id_t		msgid,
+					 size_t			bytesIn);
+
+/*
+ * admissionDone
+ *   applies any delay (or deprioritization) decided by admissionCheck.
+ *   Called after the request has been processed (or handed off to a
+ *   reader thread).
+ */
+void		admissionDone		(mach_port_t		server);
+
+/*
+ * admissionPending
+ *   returns TRUE if any deprioritized sessions are waiting for the
+ *   server to be idle.
+ */
+Boolean		admissionPending	(void);
+
+/*
+ * admissionIdle
+ *   resumes receiving requests from the deprioritized sessions.  Called
+ *   when there are no other requests pending.
+ */
+void		admissionIdle		(void);
+
+/*
+ * admissionCheckPatterns
+ *   returns kSCStatusOK if the session may watch "nPatterns" patterns,
+ *   kSCStatusLimitExceeded if not.
+ */
+int		admissionCheckPatterns	(serverSessionRef	session,
+					 CFIndex		nPatterns);
+
+/*
+ * admissionCopyStatistics
+ *   returns a dictionary with the number of times each action was taken,
+ *   NULL if no budgets have been configured.
+ */
+CFDictionaryRef	admissionCopyStatistics	(void);
+
+__END_DECLS
+
+#endif /* !_S_ADMISSION_H */
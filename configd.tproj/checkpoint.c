@@ -0,0 +1,522 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+/*
+ * store checkpoint
+ *
+ * When configd is restarted the store starts out empty and stays that
+ * way until the plug-ins have re-posted their state (and the clients
+ * have re-fetched it).  To shorten that window, when configd is started
+ * with "-c", the store content (the keys and serialized values; but not
+ * the sessions or the session keys) is periodically written to a
+ * checkpoint file and, when configd is started with "-w", loaded before
+ * any plug-ins are started.
+ *
+ * Restored keys that have not been set by the time the plug-ins have
+ * had a chance to reconcile their state are removed.
+ *
+ * The checkpoint is written on a background queue, from a snapshot of the
+ * store, to a temporary file that is flushed to disk and then renamed into
+ * place so that a reader never sees a partial checkpoint.  The file lives in
+ * /var/run (which does not survive a reboot) and contains (in host byte
+ * order) :
+ *
+ *   checkpointHeader
+ *   checkpointRecord		(x count)
+ *   key and data bytes		(referenced by offset from the records)
+ *
+ * so that it can be mapped and used without any parsing.
+ */
+
+#include "configd.h"
+#include "checkpoint.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <paths.h>
+#include <unistd.h>
+#include <libkern/OSAtomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysctl.h>
+
+
+#define	CHECKPOINT_PATH		_PATH_VARRUN "configd-store.checkpoint"
+#define	CHECKPOINT_PATH_TEMP	_PATH_VARRUN "configd-store.checkpoint.tmp"
+
+#define	CHECKPOINT_MAGIC	0x5343434b	/* 'SCCK' */
+#define	CHECKPOINT_VERSION	2
+
+#define	CHECKPOINT_INTERVAL	30.0		/* seconds between checkpoints (if the store changed) */
+#define	CHECKPOINT_RECONCILE	60.0		/* seconds before stale restored keys are removed */
+
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	generation;	/* store generation at the time of the checkpoint */
+	uint64_t	length;		/* file length */
+	uint32_t	count;		/* # of records */
+	uint32_t	reserved;
+} checkpointHeader;
+
+typedef struct {
+	uint32_t	keyOffset;	/* offset (from the start of the file) of the UTF-8 key bytes */
+	uint32_t	keyLen;
+	uint32_t	dataOffset;	/* offset of the serialized data */
+	uint32_t	dataLen;
+} checkpointRecord;
+
+
+/* the queue on which checkpoints are written, NULL if not checkpointing */
+static dispatch_queue_t		checkpointQueue		= NULL;
+
+/* store generation of the last checkpoint */
+static uint64_t			checkpointGeneration	= 0;
+
+/* non-zero if the last checkpoint could not be written (and should be retried) */
+static int32_t			checkpointFailed	= 0;
+
+/* the keys restored from the checkpoint (until reconciled) */
+static CFMutableArrayRef	restoredKeys		= NULL;
+
+/* internal session used to restore (and reconcile) the checkpoint */
+static SCDynamicStoreRef	restoreStore		= NULL;
+
+/* # of keys restored (for the "first valid read" report) */
+static CFIndex			restoredCount		= 0;
+
+
+#pragma mark -
+#pragma mark Write
+
+
+typedef struct {
+	checkpointRecord	*records;
+	CFIndex			count;
+	CFIndex			max;
+	uint64_t		offset;		/* of the next key (or data) bytes, from the end of the records */
+	FILE			*f;
+	Boolean			ok;
+} checkpointContext;
+
+
+/* lay out the record for a key (first pass) */
+static void
+addRecord(const UInt8 *keyBytes, CFIndex keyLen, CFDataRef data, uint64_t generation, void *context)
+{
+	checkpointContext	*myContextRef	= (checkpointContext *)context;
+	checkpointRecord	*record;
+
+	if (myContextRef->count >= myContextRef->max) {
+		return;
+	}
+
+	record = &myContextRef->records[myContextRef->count++];
+	record->keyOffset  = (uint32_t)myContextRef->offset;
+	record->keyLen     = (uint32_t)keyLen;
+	myContextRef->offset += keyLen;
+	record->dataOffset = (uint32_t)myContextRef->offset;
+	record->dataLen    = (uint32_t)CFDataGetLength(data);
+	myContextRef->offset += record->dataLen;
+	return;
+}
+
+
+/* write the key and data bytes (second pass) */
+static void
+writeRecord(const UInt8 *keyBytes, CFIndex keyLen, CFDataRef data, uint64_t generation, void *context)
+{
+	checkpointContext	*myContextRef	= (checkpointContext *)context;
+
+	if (!myContextRef->ok) {
+		return;
+	}
+
+	if ((fwrite(keyBytes, keyLen, 1, myContextRef->f) != 1) ||
+	    ((CFDataGetLength(data) > 0) &&
+	     (fwrite(CFDataGetBytePtr(data), CFDataGetLength(data), 1, myContextRef->f) != 1))) {
+		myContextRef->ok = FALSE;
+	}
+
+	return;
+}
+
+
+/* write a checkpoint (on the checkpointQueue) */
+static void
+checkpointWriteSnapshot(void *info)
+{
+	uint64_t		base;
+	checkpointContext	context;
+	int			fd;
+	checkpointHeader	header;
+	CFIndex			i;
+	storeSnapshotRef	snapshot	= (storeSnapshotRef)info;
+
+	bzero(&context, sizeof(context));
+	context.max = storeSnapshotGetCount(snapshot);
+	if (context.max > 0) {
+		context.records = malloc(context.max * sizeof(checkpointRecord));
+	}
+
+	/* layout the records (the per-session keys would not outlive their sessions) */
+	storeSnapshotApplyRecordsFunction(snapshot, FALSE, addRecord, &context);
+	base = sizeof(header) + (context.count * sizeof(checkpointRecord));
+	if (base + context.offset > UINT32_MAX) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointWrite(): store too large"));
+		goto done;
+	}
+	for (i = 0; i < context.count; i++) {
+		context.records[i].keyOffset  += (uint32_t)base;
+		context.records[i].dataOffset += (uint32_t)base;
+	}
+
+	header.magic      = CHECKPOINT_MAGIC;
+	header.version    = CHECKPOINT_VERSION;
+	header.generation = storeSnapshotGetGeneration(snapshot);
+	header.length     = base + context.offset;
+	header.count      = (uint32_t)context.count;
+	header.reserved   = 0;
+
+	(void) unlink(CHECKPOINT_PATH_TEMP);
+	fd = open(CHECKPOINT_PATH_TEMP, O_WRONLY|O_CREAT|O_TRUNC|O_EXCL, 0600);
+	if (fd == -1) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointWrite open() failed: %s"), strerror(errno));
+		goto done;
+	}
+	context.f = fdopen(fd, "w");
+	if (context.f == NULL) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointWrite fdopen() failed: %s"), strerror(errno));
+		(void) close(fd);
+		goto done;
+	}
+
+	context.ok = (fwrite(&header, sizeof(header), 1, context.f) == 1);
+	if (context.ok && (context.count > 0)) {
+		context.ok = (fwrite(context.records, sizeof(checkpointRecord), context.count, context.f) == (size_t)context.count);
+	}
+	storeSnapshotApplyRecordsFunction(snapshot, FALSE, writeRecord, &context);
+
+	/* make sure that the checkpoint is on disk before it replaces the last one */
+	if (context.ok && ((fflush(context.f) != 0) || (fsync(fd) == -1))) {
+		context.ok = FALSE;
+	}
+	if (fclose(context.f) != 0) {
+		context.ok = FALSE;
+	}
+
+	if (context.ok && (rename(CHECKPOINT_PATH_TEMP, CHECKPOINT_PATH) == -1)) {
+		context.ok = FALSE;
+	}
+	if (!context.ok) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointWrite(): could not write checkpoint: %s"), strerror(errno));
+		(void) unlink(CHECKPOINT_PATH_TEMP);
+	}
+
+    done :
+
+	if (!context.ok) {
+		/* try again at the next interval */
+		(void) OSAtomicCompareAndSwap32Barrier(0, 1, &checkpointFailed);
+	}
+
+	if (context.records != NULL) free(context.records);
+	storeSnapshotRelease(snapshot);
+	return;
+}
+
+
+__private_extern__
+void
+checkpointWrite(Boolean wait)
+{
+	if (checkpointQueue == NULL) {
+		/* if not checkpointing */
+		return;
+	}
+
+	storeCommit();
+	if (!OSAtomicCompareAndSwap32Barrier(1, 0, &checkpointFailed) &&
+	    (storeGeneration == checkpointGeneration)) {
+		/* if no changes since the last checkpoint */
+		goto done;
+	}
+	checkpointGeneration = storeGeneration;
+
+	/* the snapshot is taken now, the checkpoint is written in the background */
+	dispatch_async_f(checkpointQueue, storeSnapshotCopy(), checkpointWriteSnapshot);
+
+    done :
+
+	if (wait) {
+		/* wait for the checkpoint(s) to be written */
+		dispatch_sync(checkpointQueue, ^{});
+	}
+
+	return;
+}
+
+
+static void
+checkpointTimer(CFRunLoopTimerRef timer, void *info)
+{
+	checkpointWrite(FALSE);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Restore
+
+
+static CFAbsoluteTime
+launchTime(void)
+{
+	struct kinfo_proc	info;
+	int			mib[]	= { CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid() };
+	size_t			len	= sizeof(info);
+
+	if ((sysctl(mib, sizeof(mib) / sizeof(mib[0]), &info, &len, NULL, 0) == -1) || (len == 0)) {
+		return 0;
+	}
+
+	return (CFAbsoluteTime)info.kp_proc.p_starttime.tv_sec
+	       + ((CFAbsoluteTime)info.kp_proc.p_starttime.tv_usec / USEC_PER_SEC)
+	       - kCFAbsoluteTimeIntervalSince1970;
+}
+
+
+static void
+checkpointReconcile(CFRunLoopTimerRef timer, void *info)
+{
+	CFIndex	i;
+	CFIndex	n;
+	CFIndex	nRemoved	= 0;
+
+	/*
+	 * remove any restored keys that have not been [re-]set since the
+	 * checkpoint was loaded (these reflect state that no plug-in or
+	 * client has confirmed).
+	 */
+	n = CFArrayGetCount(restoredKeys);
+	for (i = 0; i < n; i++) {
+		storeEntryRef	entry;
+		CFStringRef	key	= CFArrayGetValueAtIndex(restoredKeys, i);
+
+		entry = storeLookup(key);
+		if ((entry != NULL) && entry->restored) {
+			(void) __SCDynamicStoreRemoveValue(restoreStore, key, TRUE);
+			nRemoved++;
+		}
+	}
+	if (nRemoved > 0) {
+		__SCDynamicStorePush();
+	}
+
+	SCLog(TRUE, LOG_INFO,
+	      CFSTR("checkpoint reconciled: %ld of %ld restored keys removed"),
+	      nRemoved,
+	      n);
+
+	CFRelease(restoredKeys);
+	restoredKeys = NULL;
+	CFRelease(restoreStore);
+	restoreStore = NULL;
+	return;
+}
+
+
+static void
+checkpointLoad(void)
+{
+	const UInt8		*bytes;
+	CFIndex			i;
+	int			fd;
+	const checkpointHeader	*header;
+	const checkpointRecord	*records;
+	CFAbsoluteTime		start;
+	struct stat		statbuf;
+
+	start = CFAbsoluteTimeGetCurrent();
+
+	fd = open(CHECKPOINT_PATH, O_RDONLY, 0);
+	if (fd == -1) {
+		if (errno != ENOENT) {
+			SCLog(TRUE, LOG_ERR, CFSTR("checkpointLoad open() failed: %s"), strerror(errno));
+		}
+		return;
+	}
+	if ((fstat(fd, &statbuf) == -1) || (statbuf.st_size < (off_t)sizeof(checkpointHeader))) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointLoad(): checkpoint not valid"));
+		(void) close(fd);
+		return;
+	}
+	bytes = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	(void) close(fd);
+	if (bytes == MAP_FAILED) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointLoad mmap() failed: %s"), strerror(errno));
+		return;
+	}
+
+	header  = (const checkpointHeader *)(const void *)bytes;
+	records = (const checkpointRecord *)(const void *)(bytes + sizeof(checkpointHeader));
+	if ((header->magic != CHECKPOINT_MAGIC) ||
+	    (header->version != CHECKPOINT_VERSION) ||
+	    (header->length != (uint64_t)statbuf.st_size) ||
+	    ((uint64_t)header->count > ((uint64_t)statbuf.st_size - sizeof(checkpointHeader)) / sizeof(checkpointRecord))) {
+		SCLog(TRUE, LOG_ERR, CFSTR("checkpointLoad(): checkpoint not valid"));
+		goto done;
+	}
+
+	(void) __SCDynamicStoreOpen(&restoreStore, CFSTR("configd checkpoint"));
+	restoredKeys = CFArrayCreateMutable(NULL, header->count, &kCFTypeArrayCallBacks);
+
+	for (i = 0; i < (CFIndex)header->count; i++) {
+		CFDataRef		data;
+		CFStringRef		key;
+		const checkpointRecord	*record	= &records[i];
+
+		if (((uint64_t)record->keyOffset + record->keyLen > header->length) ||
+		    ((uint64_t)record->dataOffset + record->dataLen > header->length)) {
+			/* if not a valid record */
+			continue;
+		}
+
+		key = CFStringCreateWithBytes(NULL,
+					      bytes + record->keyOffset,
+					      record->keyLen,
+					      kCFStringEncodingUTF8,
+					      FALSE);
+		if (key == NULL) {
+			continue;
+		}
+
+		data = CFDataCreate(NULL, bytes + record->dataOffset, record->dataLen);
+		if (__SCDynamicStoreSetValue(restoreStore, key, data, TRUE) == kSCStatusOK) {
+			storeEntryRef	entry;
+
+			entry = storeLookup(key);
+			if (entry != NULL) {
+				entry->restored = TRUE;
+			}
+			CFArrayAppendValue(restoredKeys, key);
+		}
+		CFRelease(data);
+		CFRelease(key);
+	}
+	__SCDynamicStorePush();
+
+	restoredCount = CFArrayGetCount(restoredKeys);
+	SCLog(TRUE, LOG_INFO,
+	      CFSTR("checkpoint restored: %ld keys (generation %llu) in %.3f ms"),
+	      restoredCount,
+	      header->generation,
+	      (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+
+    done :
+
+	(void) munmap((void *)bytes, (size_t)statbuf.st_size);
+	return;
+}
+
+
+__private_extern__
+void
+checkpointNoteRead(void)
+{
+	static dispatch_once_t	once;
+
+	dispatch_once(&once, ^{
+		CFAbsoluteTime	launch;
+
+		launch = launchTime();
+		if (launch == 0) {
+			return;
+		}
+
+		SCLog(TRUE, LOG_INFO,
+		      CFSTR("first valid read %.3f ms after launch (%ld keys restored from checkpoint)"),
+		      (CFAbsoluteTimeGetCurrent() - launch) * 1000.0,
+		      restoredCount);
+	});
+
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Initialization
+
+
+__private_extern__
+void
+checkpointInit(Boolean load, Boolean save)
+{
+	CFRunLoopTimerRef	timer;
+
+	if (load) {
+		checkpointLoad();
+		if (restoredKeys != NULL) {
+			timer = CFRunLoopTimerCreate(NULL,
+						     CFAbsoluteTimeGetCurrent() + CHECKPOINT_RECONCILE,
+						     0,
+						     0,
+						     0,
+						     checkpointReconcile,
+						     NULL);
+			CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
+			CFRelease(timer);
+		}
+	}
+
+	if (!save) {
+		return;
+	}
+
+	checkpointQueue = dispatch_queue_create("configd checkpoint", NULL);
+
+	/* the restored content is already in the checkpoint */
+	storeCommit();
+	checkpointGeneration = storeGeneration;
+
+	timer = CFRunLoopTimerCreate(NULL,
+				     CFAbsoluteTimeGetCurrent() + CHECKPOINT_INTERVAL,
+				     CHECKPOINT_INTERVAL,
+				     0,
+				     0,
+				     checkpointTimer,
+				     NULL);
+	CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
+	CFRelease(timer);
+
+	return;
+}
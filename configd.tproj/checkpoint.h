@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_CHECKPOINT_H
+#define _S_CHECKPOINT_H
+
+#include <sys/cdefs.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+
+__BEGIN_DECLS
+
+/*
+ * checkpointInit
+ *   loads the last checkpoint (before any plug-ins have been started) and
+ *   starts the periodic checkpoint of the store, as requested.  Must be
+ *   called from the server thread.
+ */
+void		checkpointInit		(Boolean	load,
+					 Boolean	save);
+
+/*
+ * checkpointWrite
+ *   starts writing a checkpoint of the store (if checkpointing and the
+ *   store has changed since the last checkpoint) and, if requested, waits
+ *   for it to be written.  Must be called from the server thread.
+ */
+void		checkpointWrite		(Boolean	wait);
+
+/*
+ * checkpointNoteRead
+ *   notes that a read request returned data (used to report the time from
+ *   launch to the first valid read).  May be called from any thread.
+ */
+void		checkpointNoteRead	(void);
+
+__END_DECLS
+
+#endif /* !_S_CHECKPOINT_H */
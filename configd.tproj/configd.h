@@ -52,7 +52,7 @@
 #include "_SCD.h"
 
 extern Boolean		_configd_verbose;	/* TRUE if verbose logging enabled */
-extern FILE		*_configd_trace;	/* non-NULL if tracing enabled */
+extern int		_configd_readers;	/* # of reader threads (0 if disabled) */
 extern CFMutableSetRef	_plugins_allowed;	/* bundle identifiers to allow when loading */
 extern CFMutableSetRef	_plugins_exclude;	/* bundle identifiers to exclude from loading */
 extern CFMutableSetRef	_plugins_verbose;	/* bundle identifiers to enable verbose logging */
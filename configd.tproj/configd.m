@@ -53,7 +53,11 @@
 
 #include "configd.h"
 #include "configd_server.h"
+#include "admission.h"
 #include "plugin_support.h"
+#include "checkpoint.h"
+#include "journal.h"
+#include "trace.h"
 
 #if	TARGET_OS_EMBEDDED && !defined(DO_NOT_INFORM)
 #include <CoreFoundation/CFUserNotification.h>
@@ -63,7 +67,7 @@ __private_extern__
 Boolean	_configd_verbose		= FALSE;	/* TRUE if verbose logging enabled */
 
 __private_extern__
-FILE	*_configd_trace			= NULL;		/* non-NULL if tracing enabled */
+int	_configd_readers		= 0;		/* # of reader threads (0 if disabled) */
 
 __private_extern__
 CFMutableSetRef	_plugins_allowed	= NULL;		/* bundle identifiers to allow when loading */
@@ -81,10 +85,16 @@ static const struct option longopts[] = {
 //	{ "include-plugin",	required_argument,	0,	'A' },
 //	{ "no-bundles",		no_argument,		0,	'b' },
 //	{ "exclude-plugin",	required_argument,	0,	'B' },
+//	{ "checkpoint",		no_argument,		0,	'c' },
 //	{ "no-fork",		no_argument,		0,	'd' },
+//	{ "journal",		required_argument,	0,	'j' },
+//	{ "limits",		required_argument,	0,	'L' },
+//	{ "readers",		required_argument,	0,	'R' },
 //	{ "test-bundle",	required_argument,      0,	't' },
+//	{ "trace",		required_argument,	0,	'T' },
 //	{ "verbose",		no_argument,		0,	'v' },
 //	{ "verbose-bundle",	required_argument,	0,	'V' },
+//	{ "warm-start",		no_argument,		0,	'w' },
 	{ "help",		no_argument,		0,	'?' },
 	{ 0,			0,                      0,	0 }
 };
@@ -93,7 +103,7 @@ static const struct option longopts[] = {
 static void
 usage(const char *prog)
 {
-	SCPrint(TRUE, stderr, CFSTR("%s: [-d] [-v] [-V bundleID] [-b] [-B bundleID] [-A bundleID] [-t bundle-path]\n"), prog);
+	SCPrint(TRUE, stderr, CFSTR("%s: [-d] [-v] [-V bundleID] [-b] [-B bundleID] [-A bundleID] [-t bundle-path] [-R count] [-j KB] [-T KB] [-L limits] [-c] [-w]\n"), prog);
 	SCPrint(TRUE, stderr, CFSTR("options:\n"));
 	SCPrint(TRUE, stderr, CFSTR("\t-d\tdisable daemon/run in foreground\n"));
 	SCPrint(TRUE, stderr, CFSTR("\t-v\tenable verbose logging\n"));
@@ -104,6 +114,14 @@ usage(const char *prog)
 	SCPrint(TRUE, stderr, CFSTR("\t-A\tenable loading of the specified plug-in\n"));
 	SCPrint(TRUE, stderr, CFSTR("\t-t\tload/test the specified plug-in\n"));
 	SCPrint(TRUE, stderr, CFSTR("\t\t  (Note: only the plug-in will be started)\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-R\tprocess read-only requests with the specified # of reader threads\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-j\tjournal store mutations to a ring of the specified size (in KB)\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-T\ttrace requests to per-thread rings of the specified size (in KB)\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-L\tlimit each session to the specified budget\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t\t  (ops=<requests/sec>,bytes=<bytes/sec>,patterns=<count>,\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t\t   policy=delay|reject|deprioritize)\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-c\tcheckpoint the store periodically (and when terminated)\n"));
+	SCPrint(TRUE, stderr, CFSTR("\t-w\tload the last store checkpoint before starting the plug-ins\n"));
 	exit (EX_USAGE);
 }
 
@@ -197,24 +215,15 @@ init_fds()
 		}
 	}
 
-	SCTrace(TRUE, stdout, CFSTR("start\n"));
 	return;
 }
 
 
-static void
-set_trace()
+static Boolean
+check_trace()
 {
-	int	fd;
-
-	/* set _configd_trace */
-	fd = open("/var/log/configd.trace", O_WRONLY|O_APPEND, 0);
-	if (fd != -1) {
-		_configd_trace = fdopen(fd, "a");
-		SCTrace(TRUE, _configd_trace, CFSTR("start\n"));
-	}
-
-	return;
+	/* requests are traced (see traceInit) if /var/log/configd.trace exists */
+	return (access("/var/log/configd.trace", F_OK) == 0);
 }
 
 
@@ -277,8 +286,10 @@ main(int argc, char * const argv[])
 						  , NULL
 						  , termMPCopyDescription
 						  };
+	Boolean			checkpoint	= FALSE;
 	Boolean			forceForeground	= FALSE;
 	Boolean			forcePlugin	= FALSE;
+	int			journalSize	= 0;
 	int64_t			is_launchd_job	= 0;
 	mach_port_limits_t	limits;
 	Boolean			loadBundles	= TRUE;
@@ -290,6 +301,9 @@ main(int argc, char * const argv[])
 	kern_return_t		status;
 	CFStringRef		str;
 	const char		*testBundle	= NULL;
+	Boolean			traceLog	= FALSE;
+	int			traceSize	= 0;
+	Boolean			warmStart	= FALSE;
 
 	_plugins_allowed = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
 	_plugins_exclude = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
@@ -297,7 +311,7 @@ main(int argc, char * const argv[])
 
 	/* process any arguments */
 
-	while ((opt = getopt_long(argc, argv, "A:bB:dt:vV:", longopts, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "A:bB:cdj:L:R:t:T:vV:w", longopts, NULL)) != -1) {
 		switch(opt) {
 			case 'A':
 				str = CFStringCreateWithCString(NULL, optarg, kCFStringEncodingMacRoman);
@@ -312,12 +326,29 @@ main(int argc, char * const argv[])
 				CFSetSetValue(_plugins_exclude, str);
 				CFRelease(str);
 				break;
+			case 'c':
+				checkpoint = TRUE;
+				break;
 			case 'd':
 				forceForeground = TRUE;
 				break;
+			case 'j':
+				journalSize = atoi(optarg);
+				break;
+			case 'L':
+				if (!admissionConfigure(optarg)) {
+					usage(prog);
+				}
+				break;
+			case 'R':
+				_configd_readers = atoi(optarg);
+				break;
 			case 't':
 				testBundle = optarg;
 				break;
+			case 'T':
+				traceSize = atoi(optarg);
+				break;
 			case 'v':
 				_configd_verbose = TRUE;
 				break;
@@ -330,6 +361,9 @@ main(int argc, char * const argv[])
 					CFRelease(str);
 				}
 				break;
+			case 'w':
+				warmStart = TRUE;
+				break;
 			case '?':
 			default :
 				usage(prog);
@@ -427,7 +461,7 @@ main(int argc, char * const argv[])
 	}
 
 	/* check/enable trace logging */
-	set_trace();
+	traceLog = check_trace();
 
 	/* add signal handler to catch a SIGHUP */
 	nact.sa_handler = catcher;
@@ -483,6 +517,24 @@ main(int argc, char * const argv[])
 		/* initialize primary (store management) thread */
 		server_init();
 
+		/* start journaling store mutations */
+		if (journalSize > 0) {
+			journalInit((size_t)journalSize * 1024);
+		}
+
+		/* start tracing requests */
+		if ((traceSize == 0) && traceLog) {
+			traceSize = 64;		/* if trace logging was enabled */
+		}
+		if (traceSize > 0) {
+			traceInit((size_t)traceSize * 1024, (_configd_readers > 0) ? (uint32_t)_configd_readers : 0);
+		}
+
+		/* restore and/or start checkpointing the store (if requested) */
+		if (warmStart || checkpoint) {
+			checkpointInit(warmStart, checkpoint);
+		}
+
 		if (!forceForeground && !is_launchd_job) {
 			/* synchronize with parent process */
 			kill(getppid(), SIGTERM);
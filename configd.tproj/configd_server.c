@@ -37,12 +37,19 @@
 #include <TargetConditionals.h>
 #include <sysexits.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <servers/bootstrap.h>
+#include <mach/mach_time.h>
+#include <libkern/OSAtomic.h>
 
 #include "configd.h"
 #include "configd_server.h"
+#include "admission.h"
+#include "checkpoint.h"
+#include "notify_delivery.h"
 #include "notify_server.h"
+#include "request_stats.h"
 #include "session.h"
 
 /* MiG generated externals and functions */
@@ -52,6 +59,36 @@ extern boolean_t		config_server(mach_msg_header_t *, mach_msg_header_t *);
 /* configd server port (for new session requests) */
 static CFMachPortRef		configd_port		= NULL;
 
+/*
+ * reader threads
+ *
+ * When enabled, the read-only requests (SCDynamicStoreCopyValue,
+ * SCDynamicStoreCopyMultiple[WithGeneration|IfChanged], and
+ * SCDynamicStoreCopyKeyList) are handed off to a pool of reader
+ * threads.  Each request is serviced from an
+ * immutable snapshot of the store taken (on the server thread) when the
+ * request was received so that a client always sees the results of its
+ * own (earlier) changes.  All other requests, including any read-only
+ * requests received while all of the reader threads are busy, continue
+ * to be processed on the server thread.
+ */
+static dispatch_queue_t		readerQueue		= NULL;
+static pthread_key_t		readerSnapshotKey;
+static int32_t			readersActive		= 0;
+
+typedef struct {
+	storeSnapshotRef	snapshot;	/* the store, as of when the request was received */
+	sessionUsageRef		usage;		/* the session's resource usage */
+	uint64_t		msg[];		/* the request message (and trailer) */
+} readerRequest, *readerRequestRef;
+
+/* offsets (from the subsystem base) of the read-only request message IDs */
+#define	CONFIG_CONFIGLIST_ID	8
+#define	CONFIG_CONFIGGET_ID	10
+#define	CONFIG_CONFIGGET_M_ID	16
+#define	CONFIG_CONFIGGET_M_GEN_ID	26
+#define	CONFIG_CONFIGGET_M_SINCE_ID	27
+
 __private_extern__
 boolean_t
 config_demux(mach_msg_header_t *request, mach_msg_header_t *reply)
@@ -93,37 +130,12 @@ config_demux(mach_msg_header_t *request, mach_msg_header_t *reply)
 #define	MACH_MSG_BUFFER_SIZE	128
 
 
-__private_extern__
-void
-configdCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
+static void
+serverSendReply(mig_reply_error_t *bufRequest, mig_reply_error_t *bufReply)
 {
-	mig_reply_error_t *	bufRequest	= msg;
-	uint32_t		bufReply_q[MACH_MSG_BUFFER_SIZE/sizeof(uint32_t)];
-	mig_reply_error_t *	bufReply	= (mig_reply_error_t *)bufReply_q;
-	static CFIndex		bufSize		= 0;
 	mach_msg_return_t	mr;
 	int			options;
 
-	if (bufSize == 0) {
-		// get max size for MiG reply buffers
-		bufSize = _config_subsystem.maxsize;
-
-		// check if our on-the-stack reply buffer will be big enough
-		if (bufSize > sizeof(bufReply_q)) {
-			SCLog(TRUE, LOG_NOTICE,
-			      CFSTR("configdCallback(): buffer size should be increased > %d"),
-			      _config_subsystem.maxsize);
-		}
-	}
-
-	if (bufSize > sizeof(bufReply_q)) {
-		bufReply = CFAllocatorAllocate(NULL, _config_subsystem.maxsize, 0);
-	}
-	bufReply->RetCode = 0;
-
-	/* we have a request message */
-	(void) config_demux(&bufRequest->Head, &bufReply->Head);
-
 	if (!(bufReply->Head.msgh_bits & MACH_MSGH_BITS_COMPLEX)) {
 		if (bufReply->RetCode == MIG_NO_REPLY) {
 			bufReply->Head.msgh_remote_port = MACH_PORT_NULL;
@@ -169,7 +181,7 @@ configdCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
 				break;
 			default :
 				/* Includes success case.  */
-				goto done;
+				return;
 		}
 	}
 
@@ -177,7 +189,185 @@ configdCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
 		mach_msg_destroy(&bufReply->Head);
 	}
 
-    done :
+	return;
+}
+
+
+static Boolean
+isReaderRequest(mach_msg_header_t *request)
+{
+	switch (request->msgh_id - _config_subsystem.start) {
+		case CONFIG_CONFIGLIST_ID :
+		case CONFIG_CONFIGGET_ID :
+		case CONFIG_CONFIGGET_M_ID :
+		case CONFIG_CONFIGGET_M_GEN_ID :
+		case CONFIG_CONFIGGET_M_SINCE_ID :
+			return TRUE;
+		default :
+			return FALSE;
+	}
+}
+
+
+__private_extern__
+storeSnapshotRef
+serverReaderSnapshot(void)
+{
+	if (readerQueue == NULL) {
+		/* if no reader threads */
+		return NULL;
+	}
+
+	return pthread_getspecific(readerSnapshotKey);
+}
+
+
+static void
+readerProcess(void *context)
+{
+	mig_reply_error_t *	bufRequest;
+	uint32_t		bufReply_q[MACH_MSG_BUFFER_SIZE/sizeof(uint32_t)];
+	mig_reply_error_t *	bufReply	= (mig_reply_error_t *)bufReply_q;
+	size_t			bytesIn;
+	size_t			bytesOut;
+	mach_msg_id_t		msgid;
+	readerRequestRef	request		= (readerRequestRef)context;
+	uint64_t		start;
+
+	start = mach_absolute_time();
+	bufRequest = (mig_reply_error_t *)(void *)request->msg;
+	msgid = bufRequest->Head.msgh_id;
+	bytesIn = requestStatsMessageSize(&bufRequest->Head);
+
+	if (_config_subsystem.maxsize > sizeof(bufReply_q)) {
+		bufReply = CFAllocatorAllocate(NULL, _config_subsystem.maxsize, 0);
+	}
+	bufReply->RetCode = 0;
+
+	/* process the request against the snapshot */
+	(void) pthread_setspecific(readerSnapshotKey, request->snapshot);
+	(void) config_demux(&bufRequest->Head, &bufReply->Head);
+	(void) pthread_setspecific(readerSnapshotKey, NULL);
+
+	/* send the reply */
+	bytesOut = requestStatsMessageSize(&bufReply->Head);
+	serverSendReply(bufRequest, bufReply);
+	requestStatsRecord(msgid, start, bytesIn, bytesOut, request->usage);
+
+	if (bufReply != (mig_reply_error_t *)bufReply_q)
+		CFAllocatorDeallocate(NULL, bufReply);
+	sessionUsageRelease(request->usage);
+	storeSnapshotRelease(request->snapshot);
+	free(request);
+	(void) OSAtomicDecrement32Barrier(&readersActive);
+	return;
+}
+
+
+static Boolean
+readerDispatch(mach_msg_header_t *msg, sessionUsageRef usage)
+{
+	size_t			len;
+	readerRequestRef	request;
+	mach_msg_trailer_t	*trailer;
+
+	if (OSAtomicIncrement32Barrier(&readersActive) > _configd_readers) {
+		/* if all of the reader threads are busy */
+		(void) OSAtomicDecrement32Barrier(&readersActive);
+		return FALSE;
+	}
+
+	/*
+	 * copy the request (and the trailer, which carries the audit
+	 * token) since the message buffer is owned by CF.
+	 */
+	trailer = (mach_msg_trailer_t *)(void *)((uint8_t *)msg + round_msg(msg->msgh_size));
+	len = round_msg(msg->msgh_size) + trailer->msgh_trailer_size;
+	request = malloc(sizeof(readerRequest) + len);
+	request->snapshot = storeSnapshotCopy();
+	request->usage = sessionUsageRetain(usage);
+	memcpy(request->msg, msg, len);
+
+	dispatch_async_f(readerQueue, request, readerProcess);
+	return TRUE;
+}
+
+
+__private_extern__
+void
+configdCallback(CFMachPortRef port, void *msg, CFIndex size, void *info)
+{
+	mig_reply_error_t *	bufRequest	= msg;
+	uint32_t		bufReply_q[MACH_MSG_BUFFER_SIZE/sizeof(uint32_t)];
+	mig_reply_error_t *	bufReply	= (mig_reply_error_t *)bufReply_q;
+	static CFIndex		bufSize		= 0;
+	size_t			bytesIn;
+	size_t			bytesOut;
+	mach_msg_id_t		msgid;
+	serverSessionRef	mySession	= NULL;
+	mach_port_t		server		= bufRequest->Head.msgh_local_port;
+	uint64_t		start;
+	sessionUsageRef		usage		= NULL;
+
+	if (bufSize == 0) {
+		// get max size for MiG reply buffers
+		bufSize = _config_subsystem.maxsize;
+
+		// check if our on-the-stack reply buffer will be big enough
+		if (bufSize > sizeof(bufReply_q)) {
+			SCLog(TRUE, LOG_NOTICE,
+			      CFSTR("configdCallback(): buffer size should be increased > %d"),
+			      _config_subsystem.maxsize);
+		}
+	}
+
+	if (port != configd_port) {
+		mySession = getSession(server);
+		if (mySession != NULL) {
+			/* charge the request to the session (and against its budget) */
+			usage = mySession->usage;
+			admissionCheck(mySession,
+				       bufRequest->Head.msgh_id,
+				       requestStatsMessageSize(&bufRequest->Head));
+		}
+	}
+
+	if ((readerQueue != NULL) &&
+	    (port != configd_port) &&
+	    isReaderRequest(&bufRequest->Head) &&
+	    readerDispatch(&bufRequest->Head, usage)) {
+		/* if the request will be processed by a reader thread */
+		if (mySession != NULL) {
+			admissionDone(server);
+		}
+		return;
+	}
+
+	if (bufSize > sizeof(bufReply_q)) {
+		bufReply = CFAllocatorAllocate(NULL, _config_subsystem.maxsize, 0);
+	}
+	bufReply->RetCode = 0;
+
+	start = mach_absolute_time();
+	msgid = bufRequest->Head.msgh_id;
+	bytesIn = requestStatsMessageSize(&bufRequest->Head);
+
+	/* hold the usage (the session may be closed while processing the request) */
+	usage = sessionUsageRetain(usage);
+
+	/* we have a request message */
+	(void) config_demux(&bufRequest->Head, &bufReply->Head);
+
+	/* send the reply */
+	bytesOut = requestStatsMessageSize(&bufReply->Head);
+	serverSendReply(bufRequest, bufReply);
+	requestStatsRecord(msgid, start, bytesIn, bytesOut, usage);
+	sessionUsageRelease(usage);
+
+	if (mySession != NULL) {
+		/* apply any delay (note: the session may have been closed) */
+		admissionDone(server);
+	}
 
 	if (bufReply != (mig_reply_error_t *)bufReply_q)
 		CFAllocatorDeallocate(NULL, bufReply);
@@ -207,6 +397,9 @@ server_init()
 		service_name = SCD_SERVER;
 	}
 
+	/* Start collecting the per-request statistics */
+	requestStatsInit();
+
 	/* Check "configd" server status */
 	status = bootstrap_check_in(bootstrap_port, service_name, &service_port);
 	switch (status) {
@@ -241,6 +434,15 @@ server_init()
 	CFRunLoopAddSource(CFRunLoopGetCurrent(), rls, kCFRunLoopDefaultMode);
 	CFRelease(rls);
 
+	/* Start the notification delivery thread */
+	notifyDeliveryInit();
+
+	/* Create the pool of reader threads */
+	if (_configd_readers > 0) {
+		(void) pthread_key_create(&readerSnapshotKey, NULL);
+		readerQueue = dispatch_queue_create("SCDynamicStore readers", DISPATCH_QUEUE_CONCURRENT);
+	}
+
 	return;
 }
 
@@ -249,6 +451,9 @@ __private_extern__
 int
 server_shutdown()
 {
+	/* save the store for the next [warm] start */
+	checkpointWrite(TRUE);
+
 	if (configd_port != NULL) {
 		mach_port_t	service_port	= CFMachPortGetPort(configd_port);
 
@@ -278,12 +483,20 @@ server_loop()
 		/*
 		 * process one run loop event
 		 */
-		CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1.0e10, TRUE);
+		if (!admissionPending()) {
+			CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1.0e10, TRUE);
+		} else if (CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0.0, TRUE) == kCFRunLoopRunTimedOut) {
+			/*
+			 * if no other requests are pending, resume the
+			 * deprioritized sessions.
+			 */
+			admissionIdle();
+		}
 
 		/*
 		 * check for, and if necessary, push out change notifications
-		 * to other processes.
+		 * to other processes (via the delivery thread).
 		 */
-		pushNotifications(_configd_trace);
+		pushNotifications();
 	}
 }
@@ -38,6 +38,8 @@
 #include <mach/mach.h>
 #include <CoreFoundation/CoreFoundation.h>
 
+#include "store.h"
+
 __BEGIN_DECLS
 
 void		configdCallback	(CFMachPortRef		port,
@@ -51,10 +53,30 @@ int		server_shutdown	(void);
 
 void		server_loop	(void);
 
+/*
+ * serverReaderSnapshot
+ *   returns the store snapshot against which the current request should
+ *   be serviced, NULL if not running on a reader thread.
+ */
+storeSnapshotRef	serverReaderSnapshot	(void);
+
 kern_return_t	_snapshot	(mach_port_t		server,
 				 int			*sc_status,
 				 audit_token_t		audit_token);
 
+kern_return_t	_snapshotstream	(mach_port_t		server,
+				 int			delta,
+				 uint64_t		*generation,
+				 int			*sc_status,
+				 audit_token_t		audit_token);
+
+kern_return_t	_configstats	(mach_port_t		server,
+				 int			reset,
+				 xmlDataOut_t		*statsRef,
+				 mach_msg_type_number_t	*statsLen,
+				 int			*sc_status,
+				 audit_token_t		audit_token);
+
 kern_return_t	_configopen	(mach_port_t		server,
 				 xmlData_t		nameRef,
 				 mach_msg_type_number_t	nameLen,
@@ -130,6 +152,32 @@ kern_return_t	_configget_m	(mach_port_t		server,
 				 int			*sc_status,
 				 audit_token_t		audit_token);
 
+kern_return_t	_configget_m_gen(mach_port_t		server,
+				 xmlData_t		keysRef,
+				 mach_msg_type_number_t	keysLen,
+				 xmlData_t		patternsRef,
+				 mach_msg_type_number_t	patternsLen,
+				 uint64_t		asOf,
+				 xmlDataOut_t		*dataRef,
+				 mach_msg_type_number_t	*dataLen,
+				 uint64_t		*generation,
+				 int			*sc_status,
+				 audit_token_t		audit_token);
+
+kern_return_t	_configget_m_since(mach_port_t		server,
+				 xmlData_t		keysRef,
+				 mach_msg_type_number_t	keysLen,
+				 xmlData_t		patternsRef,
+				 mach_msg_type_number_t	patternsLen,
+				 uint64_t		since,
+				 xmlDataOut_t		*dataRef,
+				 mach_msg_type_number_t	*dataLen,
+				 xmlDataOut_t		*unchangedRef,
+				 mach_msg_type_number_t	*unchangedLen,
+				 uint64_t		*generation,
+				 int			*sc_status,
+				 audit_token_t		audit_token);
+
 kern_return_t	_configset_m	(mach_port_t		server,
 				 xmlData_t		dataRef,
 				 mach_msg_type_number_t	dataLen,
@@ -162,6 +210,23 @@ kern_return_t	_notifyviaport	(mach_port_t		server,
 				 mach_msg_id_t		msgid,
 				 int			*status);
 
+kern_return_t	_notifyviaring	(mach_port_t		server,
+				 mach_port_t		*ring,
+				 int			*status);
+
+kern_return_t	_notifyoptions	(mach_port_t		server,
+				 xmlData_t		optionsRef,
+				 mach_msg_type_number_t	optionsLen,
+				 int			*status);
+
+kern_return_t	_notifyprops	(mach_port_t		server,
+				 xmlData_t		keyRef,
+				 mach_msg_type_number_t	keyLen,
+				 int			isRegex,
+				 xmlData_t		propertiesRef,
+				 mach_msg_type_number_t	propertiesLen,
+				 int			*status);
+
 kern_return_t	_notifyviafd	(mach_port_t		server,
 				 xmlData_t		pathRef,
 				 mach_msg_type_number_t	pathLen,
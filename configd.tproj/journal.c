@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+/*
+ * store mutation journal
+ *
+ * When enabled (configd "-j <KB>"), every store mutation (set, remove,
+ * notify, set multiple) and every session open / close is appended to
+ * a memory-mapped ring file (see journal_format.h).  Appending a record
+ * is a copy into the mapping; the file is never explicitly written or
+ * synced, the kernel writes the dirty pages back and the content
+ * survives a configd crash.
+ */
+
+#include "configd.h"
+#include "journal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <paths.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <libkern/OSAtomic.h>
+
+
+#define	JOURNAL_PATH		_PATH_VARRUN "configd-journal"
+#define	JOURNAL_PATH_OLD	_PATH_VARRUN "configd-journal.old"
+
+#define	JOURNAL_HEADER_SIZE	64		/* space reserved for the journalHeader */
+#define	JOURNAL_SIZE_MIN	(64 * 1024)
+#define	JOURNAL_SIZE_MAX	(256 * 1024 * 1024)
+
+
+static journalHeader		*journal	= NULL;
+static UInt8			*journalRing	= NULL;
+
+
+static uint64_t
+journalTime(void)
+{
+	struct timeval	tv;
+
+	(void) gettimeofday(&tv, NULL);
+	return ((uint64_t)tv.tv_sec * USEC_PER_SEC) + tv.tv_usec;
+}
+
+
+static void
+journalMakeRoom(uint64_t len)
+{
+	/* drop the oldest records until there is room for "len" more bytes */
+	while ((journal->head + len - journal->tail) > journal->ringSize) {
+		journalRecord	*oldest;
+
+		oldest = (journalRecord *)(void *)(journalRing + (journal->tail % journal->ringSize));
+		journal->tail += oldest->length;
+		if (oldest->type != kJournalPad) {
+			journal->dropped++;
+		}
+	}
+
+	return;
+}
+
+
+static journalRecord *
+journalReserve(uint32_t len)
+{
+	uint32_t	offset;
+	journalRecord	*record;
+	uint32_t	remaining;
+
+	offset    = (uint32_t)(journal->head % journal->ringSize);
+	remaining = journal->ringSize - offset;
+	if (remaining < len) {
+		/* if the record would not fit before the end of the ring */
+		journalMakeRoom(remaining);
+		record = (journalRecord *)(void *)(journalRing + offset);
+		record->length = remaining;
+		record->type   = kJournalPad;
+		record->flags  = 0;
+		journal->head += remaining;
+		offset = 0;
+	}
+
+	journalMakeRoom(len);
+	record = (journalRecord *)(void *)(journalRing + offset);
+	return record;
+}
+
+
+static void
+journalAppendBytes(journalRecordType	type,
+		   mach_port_t		server,
+		   uint16_t		flags,
+		   CFStringRef		key,
+		   const UInt8		*data,
+		   CFIndex		dataLen)
+{
+	CFIndex		keyLen		= 0;
+	uint64_t	len;
+	journalRecord	*record;
+	uint32_t	size		= (uint32_t)dataLen;
+
+	if (key != NULL) {
+		(void) CFStringGetBytes(key,
+					CFRangeMake(0, CFStringGetLength(key)),
+					kCFStringEncodingUTF8,
+					0,
+					FALSE,
+					NULL,
+					0,
+					&keyLen);
+	}
+
+	/* a record may not take more than 1/4 of the ring */
+	len = JOURNAL_ALIGN(sizeof(journalRecord) + keyLen + dataLen);
+	if (len > (journal->ringSize / 4)) {
+		flags  |= kJournalFlagTruncated;
+		dataLen = 0;
+		len     = JOURNAL_ALIGN(sizeof(journalRecord) + keyLen);
+		if (len > (journal->ringSize / 4)) {
+			/* if the key, alone, is too large */
+			return;
+		}
+	}
+
+	record = journalReserve((uint32_t)len);
+	record->length   = (uint32_t)len;
+	record->type     = type;
+	record->flags    = flags;
+	record->time     = journalTime();
+	record->session  = server;
+	record->keyLen   = (uint32_t)keyLen;
+	record->dataLen  = (uint32_t)dataLen;
+	record->dataSize = size;
+	if (keyLen > 0) {
+		(void) CFStringGetBytes(key,
+					CFRangeMake(0, CFStringGetLength(key)),
+					kCFStringEncodingUTF8,
+					0,
+					FALSE,
+					(UInt8 *)(record + 1),
+					keyLen,
+					NULL);
+	}
+	if (dataLen > 0) {
+		memcpy((UInt8 *)(record + 1) + keyLen, data, dataLen);
+	}
+
+	/* and make the record visible to a reader */
+	OSMemoryBarrier();
+	journal->head += len;
+	return;
+}
+
+
+__private_extern__
+void
+journalAppend(journalRecordType	type,
+	      mach_port_t	server,
+	      Boolean		internal,
+	      CFStringRef	key,
+	      CFDataRef		data)
+{
+	if (journal == NULL) {
+		/* if not journaling */
+		return;
+	}
+
+	journalAppendBytes(type,
+			   server,
+			   internal ? kJournalFlagInternal : 0,
+			   key,
+			   (data != NULL) ? CFDataGetBytePtr(data) : NULL,
+			   (data != NULL) ? CFDataGetLength(data)  : 0);
+	return;
+}
+
+
+__private_extern__
+void
+journalAppendSetMultiple(mach_port_t	server,
+			 CFIndex	nSet,
+			 CFIndex	nRemove,
+			 CFIndex	nNotify)
+{
+	uint32_t	counts[3];
+
+	if (journal == NULL) {
+		/* if not journaling */
+		return;
+	}
+
+	counts[0] = (uint32_t)nSet;
+	counts[1] = (uint32_t)nRemove;
+	counts[2] = (uint32_t)nNotify;
+	journalAppendBytes(kJournalSetMultiple, server, 0, NULL, (const UInt8 *)counts, sizeof(counts));
+	return;
+}
+
+
+__private_extern__
+void
+journalInit(size_t size)
+{
+	int	fd;
+	size_t	fileSize;
+	void	*map;
+
+	if (size < JOURNAL_SIZE_MIN) {
+		size = JOURNAL_SIZE_MIN;
+	} else if (size > JOURNAL_SIZE_MAX) {
+		size = JOURNAL_SIZE_MAX;
+	}
+	size = (size_t)JOURNAL_ALIGN(size);
+	fileSize = JOURNAL_HEADER_SIZE + size;
+
+	/* keep the previous journal (e.g. for a post-mortem after a crash) */
+	(void) rename(JOURNAL_PATH, JOURNAL_PATH_OLD);
+
+	fd = open(JOURNAL_PATH, O_RDWR|O_CREAT|O_TRUNC|O_EXCL, 0600);
+	if (fd == -1) {
+		SCLog(TRUE, LOG_ERR, CFSTR("journalInit open() failed: %s"), strerror(errno));
+		return;
+	}
+	if (ftruncate(fd, fileSize) == -1) {
+		SCLog(TRUE, LOG_ERR, CFSTR("journalInit ftruncate() failed: %s"), strerror(errno));
+		(void) close(fd);
+		return;
+	}
+	map = mmap(NULL, fileSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	(void) close(fd);
+	if (map == MAP_FAILED) {
+		SCLog(TRUE, LOG_ERR, CFSTR("journalInit mmap() failed: %s"), strerror(errno));
+		return;
+	}
+
+	journal     = (journalHeader *)map;
+	journalRing = (UInt8 *)map + JOURNAL_HEADER_SIZE;
+
+	journal->magic      = JOURNAL_MAGIC;
+	journal->version    = JOURNAL_VERSION;
+	journal->headerSize = JOURNAL_HEADER_SIZE;
+	journal->ringSize   = (uint32_t)size;
+	journal->head       = 0;
+	journal->tail       = 0;
+	journal->created    = journalTime();
+	journal->dropped    = 0;
+
+	return;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_JOURNAL_H
+#define _S_JOURNAL_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+#include "journal_format.h"
+
+
+__BEGIN_DECLS
+
+/*
+ * journalInit
+ *   creates the mutation journal (a ring of the specified size) and
+ *   starts journaling.  Any previous journal is preserved as
+ *   "configd-journal.old".  Must be called from the server thread.
+ */
+void		journalInit		(size_t			size);
+
+/*
+ * journalAppend
+ *   appends a record to the journal (if enabled).  Must be called from
+ *   the server thread.
+ */
+void		journalAppend		(journalRecordType	type,
+					 mach_port_t		server,
+					 Boolean		internal,
+					 CFStringRef		key,
+					 CFDataRef		data);
+
+/*
+ * journalAppendSetMultiple
+ *   appends a "set multiple" record (if enabled).
+ */
+void		journalAppendSetMultiple(mach_port_t		server,
+					 CFIndex		nSet,
+					 CFIndex		nRemove,
+					 CFIndex		nNotify);
+
+__END_DECLS
+
+#endif /* !_S_JOURNAL_H */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_JOURNAL_FORMAT_H
+#define _S_JOURNAL_FORMAT_H
+
+/*
+ * The store mutation journal
+ *
+ * The journal is a memory-mapped file holding a fixed size ring of
+ * variable length records.  Each record is 8-byte aligned and is never
+ * split across the end of the ring; when a record does not fit before
+ * the end, a "pad" record fills the remaining space and the record
+ * starts over at the beginning.  When the ring is full, the oldest
+ * records are dropped.
+ *
+ * The "head" and "tail" are byte positions since the journal was
+ * created (the offset in the ring is the position modulo the ring
+ * size).  The records from "tail" to "head" are valid.
+ *
+ * All values are in host byte order.  This header has no dependencies
+ * so that the journal can be decoded on any host.
+ */
+
+#include <stdint.h>
+
+#define	JOURNAL_MAGIC		0x53434a4e	/* 'SCJN' */
+#define	JOURNAL_VERSION		1
+
+typedef struct {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		headerSize;	/* offset (from the start of the file) of the ring */
+	uint32_t		ringSize;	/* size of the ring (a multiple of 8 bytes) */
+	volatile uint64_t	head;		/* position of the next record */
+	volatile uint64_t	tail;		/* position of the oldest record */
+	uint64_t		created;	/* time (usecs since 1970) the journal was created */
+	uint64_t		dropped;	/* # of records dropped (overwritten) */
+} journalHeader;
+
+typedef enum {
+	kJournalPad		= 0,		/* filler (at the end of the ring) */
+	kJournalSet		= 1,		/* key, serialized data */
+	kJournalRemove		= 2,		/* key */
+	kJournalNotify		= 3,		/* key */
+	kJournalSetMultiple	= 4,		/* data : uint32_t # set, # remove, # notify */
+	kJournalOpen		= 5,		/* key : session name */
+	kJournalClose		= 6,
+} journalRecordType;
+
+#define	kJournalFlagInternal	0x0001		/* request made within configd */
+#define	kJournalFlagTruncated	0x0002		/* data omitted (too large) */
+
+typedef struct {
+	uint32_t		length;		/* record length (including this header, 8-byte aligned) */
+	uint16_t		type;		/* journalRecordType */
+	uint16_t		flags;
+	uint64_t		time;		/* usecs since 1970 */
+	uint32_t		session;	/* session (server port) */
+	uint32_t		keyLen;		/* # of UTF-8 key bytes (following the header) */
+	uint32_t		dataLen;	/* # of data bytes (following the key) */
+	uint32_t		dataSize;	/* original # of data bytes (if kJournalFlagTruncated) */
+} journalRecord;
+
+#define	JOURNAL_ALIGN(n)	(((n) + 7) & ~((uint64_t)7))
+
+#endif /* !_S_JOURNAL_FORMAT_H */
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+/*
+ * notification delivery
+ *
+ * Posting a notification to a client (a mach message, a write() to a
+ * file descriptor, or a signal) can stall when the client is not keeping
+ * up.  Rather than have the server thread (and, with it, all of the other
+ * clients) wait, the notifications are handed off to a dedicated delivery
+ * thread.
+ *
+ * The server thread queues a "delivery" (the session, the mechanism to
+ * use, and references to the port / task / file descriptor) and the
+ * delivery thread posts it, queues it back as "completed", and wakes the
+ * server thread.  The server thread then updates the session (and the
+ * per-session statistics).  A session has at most one delivery in flight;
+ * any changes that arrive in the meantime are coalesced into the next
+ * delivery.
+ *
+ * Both queues are lock-free, multiple producer / single consumer, lists :
+ * the producers push onto a [LIFO] list and the consumer takes the whole
+ * list (and reverses it) when it runs out of queued entries.
+ */
+
+#include "configd.h"
+#include "notify_delivery.h"
+
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <mach/mach_time.h>
+#include <libkern/OSAtomic.h>
+
+
+typedef struct {
+	notifyDeliveryRef volatile	head;		/* [LIFO] list, pushed by the producers */
+	notifyDeliveryRef		pending;	/* [FIFO] list, owned by the consumer */
+} deliveryQueue;
+
+
+/* the queue of notifications to be delivered */
+static deliveryQueue		notifyQueue		= { NULL, NULL };
+static dispatch_semaphore_t	notifyQueueSemaphore	= NULL;
+static int32_t			notifyQueueDepth	= 0;
+static int32_t			notifyQueueMaxDepth	= 0;
+
+/* the queue of delivered notifications (to be processed by the server thread) */
+static deliveryQueue		completedQueue		= { NULL, NULL };
+static CFRunLoopSourceRef	completedRls		= NULL;
+static CFRunLoopRef		completedRunLoop	= NULL;
+
+
+static void
+queuePush(deliveryQueue *queue, notifyDeliveryRef delivery)
+{
+	notifyDeliveryRef	head;
+
+	do {
+		head = queue->head;
+		delivery->next = head;
+	} while (!OSAtomicCompareAndSwapPtrBarrier(head, delivery, (void * volatile *)&queue->head));
+
+	return;
+}
+
+
+static notifyDeliveryRef
+queuePop(deliveryQueue *queue)
+{
+	notifyDeliveryRef	delivery;
+
+	if (queue->pending == NULL) {
+		notifyDeliveryRef	list;
+
+		/* take everything that has been pushed ... */
+		do {
+			list = queue->head;
+			if (list == NULL) {
+				/* if nothing queued */
+				return NULL;
+			}
+		} while (!OSAtomicCompareAndSwapPtrBarrier(list, NULL, (void * volatile *)&queue->head));
+
+		/* ... and put it back into the order it was pushed */
+		while (list != NULL) {
+			notifyDeliveryRef	next	= list->next;
+
+			list->next = queue->pending;
+			queue->pending = list;
+			list = next;
+		}
+	}
+
+	delivery = queue->pending;
+	queue->pending = delivery->next;
+	delivery->next = NULL;
+	return delivery;
+}
+
+
+static void
+deliverValues(notifyDeliveryRef delivery)
+{
+	__SCDynamicStoreNotifyValuesMsg	msg;
+
+	bzero(&msg, sizeof(msg));
+	msg.header.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, 0) | MACH_MSGH_BITS_COMPLEX;
+	msg.header.msgh_size = sizeof(msg);
+	msg.header.msgh_remote_port = delivery->port;
+	msg.header.msgh_local_port = MACH_PORT_NULL;
+	msg.header.msgh_id = delivery->msgid;
+	msg.body.msgh_descriptor_count = 1;
+	msg.values.address = (void *)CFDataGetBytePtr(delivery->values);
+	msg.values.size = (mach_msg_size_t)CFDataGetLength(delivery->values);
+	msg.values.deallocate = FALSE;
+	msg.values.copy = MACH_MSG_VIRTUAL_COPY;
+	msg.values.type = MACH_MSG_OOL_DESCRIPTOR;
+	delivery->status = mach_msg(&msg.header,		/* msg */
+				    MACH_SEND_MSG|MACH_SEND_TIMEOUT,	/* options */
+				    msg.header.msgh_size,	/* send_size */
+				    0,				/* rcv_size */
+				    MACH_PORT_NULL,		/* rcv_name */
+				    0,				/* timeout */
+				    MACH_PORT_NULL);		/* notify */
+	if (delivery->status == MACH_SEND_TIMED_OUT) {
+		/*
+		 * the client's queue is full; the message (and a copy
+		 * of the data) was returned to us.
+		 */
+		mach_msg_destroy(&msg.header);
+	}
+
+	return;
+}
+
+
+static void
+deliverFD(notifyDeliveryRef delivery)
+{
+	ssize_t		written;
+
+	written = write(delivery->fd, &delivery->msgid, sizeof(delivery->msgid));
+	if (written == -1) {
+		delivery->status = KERN_FAILURE;
+		delivery->error  = errno;
+	} else if (written != sizeof(delivery->msgid)) {
+		/* if incomplete write() */
+		delivery->status = KERN_FAILURE;
+	}
+
+	return;
+}
+
+
+static void
+deliverSignal(notifyDeliveryRef delivery)
+{
+	delivery->status = pid_for_task(delivery->port, &delivery->pid);
+	if (delivery->status == KERN_SUCCESS) {
+		if (kill(delivery->pid, delivery->signal) != 0) {
+			delivery->error = errno;
+		}
+	}
+
+	return;
+}
+
+
+static void
+deliver(notifyDeliveryRef delivery)
+{
+	switch (delivery->type) {
+		case kNotifyDeliveryPort :
+			_SC_sendMachMessage(delivery->port, delivery->msgid);
+			break;
+		case kNotifyDeliveryValues :
+			deliverValues(delivery);
+			break;
+		case kNotifyDeliveryFD :
+			deliverFD(delivery);
+			break;
+		case kNotifyDeliverySignal :
+			deliverSignal(delivery);
+			break;
+	}
+
+	/* release our references to the port / task / file descriptor */
+	if (delivery->port != MACH_PORT_NULL) {
+		(void) mach_port_deallocate(mach_task_self(), delivery->port);
+	}
+	if (delivery->fd != -1) {
+		(void) close(delivery->fd);
+		delivery->fd = -1;
+	}
+
+	delivery->delivered = mach_absolute_time();
+	queuePush(&completedQueue, delivery);
+	return;
+}
+
+
+static void
+completedPerform(void *info)
+{
+	/*
+	 * nothing to do here; the completed deliveries are processed
+	 * by pushNotifications(), which is called after each run loop
+	 * event has been handled.
+	 */
+	return;
+}
+
+
+static void *
+deliveryThread(void *arg)
+{
+	pthread_setname_np("SCDynamicStore notifications");
+
+	while (TRUE) {
+		notifyDeliveryRef	delivery;
+		Boolean			delivered	= FALSE;
+
+		(void) dispatch_semaphore_wait(notifyQueueSemaphore, DISPATCH_TIME_FOREVER);
+
+		while ((delivery = queuePop(&notifyQueue)) != NULL) {
+			(void) OSAtomicDecrement32Barrier(&notifyQueueDepth);
+			deliver(delivery);
+			delivered = TRUE;
+		}
+
+		if (delivered) {
+			/* wake the server thread */
+			CFRunLoopSourceSignal(completedRls);
+			CFRunLoopWakeUp(completedRunLoop);
+		}
+	}
+
+	return NULL;
+}
+
+
+__private_extern__
+void
+notifyDeliveryInit(void)
+{
+	CFRunLoopSourceContext	context	= { 0			// version
+					  , NULL		// info
+					  , NULL		// retain
+					  , NULL		// release
+					  , NULL		// copyDescription
+					  , NULL		// equal
+					  , NULL		// hash
+					  , NULL		// schedule
+					  , NULL		// cancel
+					  , completedPerform	// perform
+					  };
+	pthread_attr_t		tattr;
+	pthread_t		tid;
+
+	/* the server thread is woken when notifications have been delivered */
+	completedRunLoop = CFRunLoopGetCurrent();
+	completedRls = CFRunLoopSourceCreate(NULL, 0, &context);
+	CFRunLoopAddSource(completedRunLoop, completedRls, kCFRunLoopDefaultMode);
+
+	notifyQueueSemaphore = dispatch_semaphore_create(0);
+
+	pthread_attr_init(&tattr);
+	pthread_attr_setscope(&tattr, PTHREAD_SCOPE_SYSTEM);
+	pthread_attr_setdetachstate(&tattr, PTHREAD_CREATE_DETACHED);
+	if (pthread_create(&tid, &tattr, deliveryThread, NULL) != 0) {
+		SCLog(TRUE, LOG_ERR, CFSTR("notifyDeliveryInit pthread_create() failed"));
+		CFRunLoopSourceInvalidate(completedRls);
+		CFRelease(completedRls);
+		completedRls = NULL;
+		dispatch_release(notifyQueueSemaphore);
+		notifyQueueSemaphore = NULL;
+	}
+	pthread_attr_destroy(&tattr);
+
+	return;
+}
+
+
+__private_extern__
+notifyDeliveryRef
+notifyDeliveryCreate(mach_port_t server, notifyDeliveryType type)
+{
+	notifyDeliveryRef	delivery;
+
+	delivery = calloc(1, sizeof(notifyDelivery));
+	delivery->server    = server;
+	delivery->type      = type;
+	delivery->port      = MACH_PORT_NULL;
+	delivery->fd        = -1;
+	delivery->sessionFD = -1;
+	delivery->status    = KERN_SUCCESS;
+	return delivery;
+}
+
+
+__private_extern__
+void
+notifyDeliveryRelease(notifyDeliveryRef delivery)
+{
+	if (delivery->values != NULL)	CFRelease(delivery->values);
+	if (delivery->keys != NULL)	CFRelease(delivery->keys);
+	free(delivery);
+	return;
+}
+
+
+/*
+ * notifyDeliveryEnqueue
+ *   queues the notification for delivery.  The delivery thread takes
+ *   over the (caller's) references to the port / task / file descriptor.
+ */
+__private_extern__
+void
+notifyDeliveryEnqueue(notifyDeliveryRef delivery)
+{
+	int32_t	depth;
+
+	delivery->queued = mach_absolute_time();
+
+	if (notifyQueueSemaphore == NULL) {
+		/* if no delivery thread, deliver now */
+		deliver(delivery);
+		return;
+	}
+
+	depth = OSAtomicIncrement32Barrier(&notifyQueueDepth);
+	if (depth > notifyQueueMaxDepth) {
+		notifyQueueMaxDepth = depth;
+	}
+
+	queuePush(&notifyQueue, delivery);
+	(void) dispatch_semaphore_signal(notifyQueueSemaphore);
+	return;
+}
+
+
+__private_extern__
+notifyDeliveryRef
+notifyDeliveryCopyCompleted(void)
+{
+	return queuePop(&completedQueue);
+}
+
+
+/*
+ * notifyDeliveryGetLatency
+ *   returns the time (in nanoseconds) from when the notification was
+ *   queued until it was delivered.
+ */
+__private_extern__
+uint64_t
+notifyDeliveryGetLatency(notifyDeliveryRef delivery)
+{
+	static mach_timebase_info_data_t	timebase	= { 0, 0 };
+
+	if (timebase.denom == 0) {
+		(void) mach_timebase_info(&timebase);
+	}
+
+	return (delivery->delivered - delivery->queued) * timebase.numer / timebase.denom;
+}
+
+
+__private_extern__
+void
+notifyDeliveryGetQueueDepth(int32_t *depth, int32_t *maxDepth)
+{
+	*depth    = notifyQueueDepth;
+	*maxDepth = notifyQueueMaxDepth;
+	return;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#ifndef _S_NOTIFY_DELIVERY_H
+#define _S_NOTIFY_DELIVERY_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+
+/*
+ * A notification (for a single session) to be posted by the delivery
+ * thread.  Each delivery holds its own reference to the port / task /
+ * file descriptor so that a session can be closed while one of its
+ * notifications is in flight.
+ */
+typedef enum {
+	kNotifyDeliveryPort	= 0,	/* (empty) mach message */
+	kNotifyDeliveryValues,		/* mach message w/changed keys and values */
+	kNotifyDeliveryFD,		/* write to file descriptor */
+	kNotifyDeliverySignal,		/* signal to task */
+} notifyDeliveryType;
+
+typedef struct notifyDelivery {
+	struct notifyDelivery	*next;		/* queue linkage */
+
+	/* the session */
+	mach_port_t		server;
+	notifyDeliveryType	type;
+
+	/* kNotifyDeliveryPort, kNotifyDeliveryValues, kNotifyDeliverySignal */
+	mach_port_t		port;		/* [send right to] notify port or task */
+	mach_msg_id_t		msgid;
+
+	/* kNotifyDeliveryValues */
+	CFDataRef		values;		/* serialized changed keys/values */
+	CFMutableSetRef		keys;		/* the changed keys */
+
+	/* kNotifyDeliveryFD */
+	int			fd;		/* [dup of] notify file descriptor */
+	int			sessionFD;	/* the session's file descriptor */
+
+	/* kNotifyDeliverySignal */
+	int			signal;
+
+	/* results (set by the delivery thread) */
+	kern_return_t		status;
+	int			error;		/* errno (kNotifyDeliveryFD, kNotifyDeliverySignal) */
+	pid_t			pid;		/* kNotifyDeliverySignal */
+
+	/* timing (mach_absolute_time units) */
+	uint64_t		queued;
+	uint64_t		delivered;
+} notifyDelivery, *notifyDeliveryRef;
+
+
+__BEGIN_DECLS
+
+void			notifyDeliveryInit		(void);
+
+notifyDeliveryRef	notifyDeliveryCreate		(mach_port_t		server,
+							 notifyDeliveryType	type);
+
+void			notifyDeliveryRelease		(notifyDeliveryRef	delivery);
+
+void			notifyDeliveryEnqueue		(notifyDeliveryRef	delivery);
+
+notifyDeliveryRef	notifyDeliveryCopyCompleted	(void);
+
+uint64_t		notifyDeliveryGetLatency	(notifyDeliveryRef	delivery);
+
+void			notifyDeliveryGetQueueDepth	(int32_t		*depth,
+							 int32_t		*maxDepth);
+
+__END_DECLS
+
+#endif /* !_S_NOTIFY_DELIVERY_H */
@@ -0,0 +1,607 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+/*
+ * notification push
+ *
+ * After each request (see server_loop), the sessions flagged as needing
+ * a kick (see _setNeedsNotification) are notified using whichever
+ * mechanism the session registered.  This is the only part of change
+ * tracking which depends on how sessions are connected to configd; the
+ * store engine itself just accumulates the changed keys.
+ */
+
+
+#include <unistd.h>
+
+#include "configd.h"
+#include "configd_server.h"
+#include "session.h"
+#include "notify_delivery.h"
+#include "trace.h"
+
+
+#define N_QUICK	64
+
+
+/*
+ * delta ("notification values") delivery
+ *
+ * Sessions opened with the kSCDynamicStoreNotificationValues option are
+ * sent the changed keys, along with their current values, in a single
+ * message per pushNotifications() pass.  This saves the client from
+ * having to ask for the changed keys (and then the values).  Changes
+ * that will not fit within NOTIFY_VALUES_MAX are posted with the usual
+ * (empty) notification message.
+ *
+ * If the client is not keeping up (the message could not be queued) the
+ * changed keys are retained and the notification is retried shortly.
+ */
+#define	NOTIFY_VALUES_RETRY	0.05	/* seconds */
+
+
+/*
+ * notifications that could not be posted right away (the client was not
+ * keeping up or the session is being held back) are retried when this
+ * timer fires
+ */
+static CFRunLoopTimerRef	notifyTimer		= NULL;
+
+
+static void
+notifyRetry(CFRunLoopTimerRef timer, void *info)
+{
+	CFRelease(notifyTimer);
+	notifyTimer = NULL;
+
+	pushNotifications();
+	return;
+}
+
+
+static void
+notifyScheduleRetry(CFAbsoluteTime fireDate)
+{
+	if (notifyTimer != NULL) {
+		/* if a retry is already scheduled */
+		if (fireDate < CFRunLoopTimerGetNextFireDate(notifyTimer)) {
+			CFRunLoopTimerSetNextFireDate(notifyTimer, fireDate);
+		}
+		return;
+	}
+
+	notifyTimer = CFRunLoopTimerCreate(NULL,
+					   fireDate,
+					   0,
+					   0,
+					   0,
+					   notifyRetry,
+					   NULL);
+	CFRunLoopAddTimer(CFRunLoopGetCurrent(), notifyTimer, kCFRunLoopDefaultMode);
+	return;
+}
+
+
+/*
+ * notifyHoldUntil
+ *   returns the time until which a notification to the session should
+ *   be held back (to allow more changes to accumulate and/or to keep the
+ *   session within its rate limit), 0 if the notification can be posted
+ *   now.
+ */
+static CFAbsoluteTime
+notifyHoldUntil(serverSessionRef theSession, CFAbsoluteTime now)
+{
+	if (theSession->notifyCoalesce > 0) {
+		if (theSession->notifyPending == 0) {
+			/* if this is the first [un-notified] change */
+			theSession->notifyPending = now;
+		}
+
+		if (now < (theSession->notifyPending + theSession->notifyCoalesce)) {
+			return theSession->notifyPending + theSession->notifyCoalesce;
+		}
+	}
+
+	if (theSession->notifyRate > 0) {
+		/* refill the bucket */
+		theSession->notifyTokens += (now - theSession->notifyTokensUpdated) * theSession->notifyRate;
+		if (theSession->notifyTokens > theSession->notifyBurst) {
+			theSession->notifyTokens = theSession->notifyBurst;
+		}
+		theSession->notifyTokensUpdated = now;
+
+		if (theSession->notifyTokens < 1) {
+			return now + ((1 - theSession->notifyTokens) / theSession->notifyRate);
+		}
+
+		theSession->notifyTokens -= 1;
+	}
+
+	theSession->notifyPending = 0;
+	return 0;
+}
+
+
+/*
+ * copyNotificationValues
+ *   returns the serialized changed keys (and values) to be posted to
+ *   the session's notification port, NULL if the changes should be
+ *   posted with the usual (empty) notification message.
+ */
+static CFDataRef
+copyNotificationValues(serverSessionRef theSession, CFIndex *keyCnt)
+{
+	CFIndex				i;
+	const void *			keys_q[N_QUICK];
+	const void **			keys		= keys_q;
+	static CFDataRef		removed		= NULL;
+	CFIndex				size		= 0;
+	CFMutableDictionaryRef		values;
+	CFDataRef			xmlValues	= NULL;
+
+	if (theSession->changedKeys == NULL) {
+		/* if no changes to deliver */
+		return NULL;
+	}
+
+	if (removed == NULL) {
+		removed = CFDataCreate(NULL, NULL, 0);
+	}
+
+	/* collect the current values of the changed keys */
+	*keyCnt = CFSetGetCount(theSession->changedKeys);
+	if (*keyCnt > (CFIndex)(sizeof(keys_q) / sizeof(CFStringRef)))
+		keys = CFAllocatorAllocate(NULL, *keyCnt * sizeof(CFStringRef), 0);
+	CFSetGetValues(theSession->changedKeys, keys);
+	values = CFDictionaryCreateMutable(NULL,
+					   *keyCnt,
+					   &kCFTypeDictionaryKeyCallBacks,
+					   &kCFTypeDictionaryValueCallBacks);
+	for (i = 0; i < *keyCnt; i++) {
+		storeEntryRef	entry;
+
+		entry = storeLookup(keys[i]);
+		if ((entry != NULL) && (entry->data != NULL)) {
+			size += CFDataGetLength(entry->data);
+			if (size > NOTIFY_VALUES_MAX) {
+				/* if too much to send */
+				goto done;
+			}
+			CFDictionarySetValue(values, keys[i], entry->data);
+		} else {
+			CFDictionarySetValue(values, keys[i], removed);
+		}
+	}
+
+	if (_SCSerialize(values, &xmlValues, NULL, NULL) &&
+	    (CFDataGetLength(xmlValues) > NOTIFY_VALUES_MAX)) {
+		CFRelease(xmlValues);
+		xmlValues = NULL;
+	}
+
+    done :
+
+	if (keys != keys_q) CFAllocatorDeallocate(NULL, keys);
+	CFRelease(values);
+	return xmlValues;
+}
+
+
+/*
+ * deliveryCreateWithPort
+ *   returns a delivery holding a [new] reference to the provided port
+ *   (or task), NULL if the client is gone.
+ */
+static notifyDeliveryRef
+deliveryCreateWithPort(mach_port_t		server,
+		       notifyDeliveryType	type,
+		       mach_port_t		port,
+		       mach_msg_id_t		msgid)
+{
+	notifyDeliveryRef	delivery;
+	kern_return_t		status;
+
+	status = mach_port_mod_refs(mach_task_self(), port, MACH_PORT_RIGHT_SEND, +1);
+	if (status != KERN_SUCCESS) {
+		return NULL;
+	}
+
+	delivery = notifyDeliveryCreate(server, type);
+	delivery->port  = port;
+	delivery->msgid = msgid;
+	return delivery;
+}
+
+
+static void
+deliveryPost(serverSessionRef theSession, notifyDeliveryRef delivery)
+{
+	theSession->delivery = delivery;
+	notifyDeliveryEnqueue(delivery);
+	return;
+}
+
+
+static void
+addChangedKey(const void *value, void *context)
+{
+	CFMutableSetRef	keys	= (CFMutableSetRef)context;
+
+	CFSetAddValue(keys, value);
+	return;
+}
+
+
+static void
+signalTaskRelease(serverSessionRef theSession, kern_return_t status)
+{
+	mach_port_type_t		pt;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)theSession->store;
+
+	__MACH_PORT_DEBUG(TRUE, "*** pushNotifications pid_for_task failed: releasing task", storePrivate->notifySignalTask);
+	if (mach_port_type(mach_task_self(), storePrivate->notifySignalTask, &pt) == KERN_SUCCESS) {
+		if ((pt & MACH_PORT_TYPE_DEAD_NAME) != 0) {
+			SCLog(TRUE, LOG_ERR, CFSTR("pushNotifications pid_for_task() failed: %s"), mach_error_string(status));
+		}
+	} else {
+		SCLog(TRUE, LOG_ERR, CFSTR("pushNotifications mach_port_type() failed: %s"), mach_error_string(status));
+	}
+
+	/* don't bother with any more attempts */
+	(void) mach_port_deallocate(mach_task_self(), storePrivate->notifySignalTask);
+	storePrivate->notifySignal     = 0;
+	setSessionSignalTask(theSession->store, TASK_NULL);
+	return;
+}
+
+
+/*
+ * deliveryComplete
+ *   updates the session after one of its notifications has been
+ *   delivered (or the delivery failed).
+ */
+static void
+deliveryComplete(notifyDeliveryRef delivery)
+{
+	uint64_t			latency;
+	SCDynamicStorePrivateRef	storePrivate;
+	serverSessionRef		theSession;
+
+	theSession = getSession(delivery->server);
+	if ((theSession == NULL) || (theSession->delivery != delivery)) {
+		/* if the session has been closed */
+		notifyDeliveryRelease(delivery);
+		return;
+	}
+	theSession->delivery = NULL;
+	storePrivate = (SCDynamicStorePrivateRef)theSession->store;
+
+	latency = notifyDeliveryGetLatency(delivery);
+	theSession->deliveryCount++;
+	theSession->deliveryLatency += latency;
+	if (latency > theSession->deliveryLatencyMax) {
+		theSession->deliveryLatencyMax = latency;
+	}
+	traceEvent(kTraceOpDelivered, 0, delivery->server, delivery->status,
+		   (latency / NSEC_PER_USEC < UINT32_MAX) ? (uint32_t)(latency / NSEC_PER_USEC) : UINT32_MAX);
+
+	switch (delivery->type) {
+		case kNotifyDeliveryPort :
+			break;
+
+		case kNotifyDeliveryValues :
+			if (delivery->status == MACH_SEND_TIMED_OUT) {
+				/*
+				 * the client's queue is full.  Keep the changes
+				 * (along with any that arrived since) and try
+				 * again later.
+				 */
+				if (theSession->changedKeys == NULL) {
+					theSession->changedKeys = delivery->keys;
+					delivery->keys = NULL;
+				} else {
+					CFSetApplyFunction(delivery->keys, addChangedKey, theSession->changedKeys);
+				}
+				_setNeedsNotification(delivery->server);
+				notifyScheduleRetry(CFAbsoluteTimeGetCurrent() + NOTIFY_VALUES_RETRY);
+			}
+			break;
+
+		case kNotifyDeliveryFD :
+			if (delivery->status == KERN_SUCCESS) {
+				break;
+			}
+
+			if (delivery->error == EWOULDBLOCK) {
+				/*
+				 * the client has yet to read the earlier identifier(s)
+				 * and will drain the [shared] ring (or fetch the
+				 * changed keys) when it does; nothing is lost.
+				 */
+#ifdef	DEBUG
+				SCLog(_configd_verbose, LOG_DEBUG,
+				      CFSTR("sorry, only one outstanding notification per session."));
+#endif	/* DEBUG */
+				break;
+			}
+
+#ifdef	DEBUG
+			if (delivery->error != 0) {
+				SCLog(_configd_verbose, LOG_DEBUG,
+				      CFSTR("could not send notification, write() failed: %s"),
+				      strerror(delivery->error));
+			} else {
+				SCLog(_configd_verbose, LOG_DEBUG,
+				      CFSTR("could not send notification, incomplete write()"));
+			}
+#endif	/* DEBUG */
+			if (storePrivate->notifyFile == delivery->sessionFD) {
+				storePrivate->notifyFile = -1;
+			}
+			break;
+
+		case kNotifyDeliverySignal :
+			if (delivery->status == KERN_SUCCESS) {
+				if ((delivery->error != 0) && (delivery->error != ESRCH)) {
+					SCLog(TRUE, LOG_ERR,
+					      CFSTR("could not send sig%s to PID %d: %s"),
+					      sys_signame[delivery->signal],
+					      delivery->pid,
+					      strerror(delivery->error));
+				}
+			} else if ((storePrivate->notifySignal > 0) &&
+				   (storePrivate->notifySignalTask == delivery->port)) {
+				signalTaskRelease(theSession, delivery->status);
+			}
+			break;
+	}
+
+	notifyDeliveryRelease(delivery);
+	return;
+}
+
+
+__private_extern__
+void
+pushNotifications(void)
+{
+	notifyDeliveryRef		delivery;
+	CFIndex				deferCnt		= 0;
+	CFAbsoluteTime			holdUntil;
+	CFIndex				n;
+	CFAbsoluteTime			now			= 0;
+	CFIndex				notifyCnt;
+	mach_port_t			server;
+	const void *			sessionsToNotify_q[N_QUICK];
+	const void **			sessionsToNotify	= sessionsToNotify_q;
+	SCDynamicStorePrivateRef	storePrivate;
+	serverSessionRef		theSession;
+	uint64_t			traceTime;
+
+	/*
+	 * catch up with any notifications that have been delivered
+	 */
+	while ((delivery = notifyDeliveryCopyCompleted()) != NULL) {
+		deliveryComplete(delivery);
+	}
+
+	if (needsNotification == NULL)
+		return;		/* if no sessions need to be kicked */
+
+	traceTime = traceStart();
+	notifyCnt = n = CFSetGetCount(needsNotification);
+	if (notifyCnt > (CFIndex)(sizeof(sessionsToNotify_q) / sizeof(void *)))
+		sessionsToNotify = CFAllocatorAllocate(NULL, notifyCnt * sizeof(void *), 0);
+	CFSetGetValues(needsNotification, sessionsToNotify);
+	while (--notifyCnt >= 0) {
+		server = (mach_port_t)(uintptr_t)sessionsToNotify[notifyCnt];
+		theSession = getSession(server);
+		storePrivate = (SCDynamicStorePrivateRef)theSession->store;
+
+		if (theSession->delivery != NULL) {
+			/*
+			 * a notification is still in flight; save the session
+			 * [port] (in an already processed slot) and coalesce
+			 * these changes into the next notification.
+			 */
+			sessionsToNotify[n - ++deferCnt] = (const void *)(uintptr_t)server;
+			continue;
+		}
+
+		if ((theSession->notifyCoalesce > 0) || (theSession->notifyRate > 0)) {
+			if (now == 0) {
+				now = CFAbsoluteTimeGetCurrent();
+			}
+
+			holdUntil = notifyHoldUntil(theSession, now);
+			if (holdUntil > 0) {
+				/*
+				 * hold back this notification; save the session
+				 * [port] and come back when the changes should be
+				 * posted.
+				 */
+				theSession->notifyHeld++;
+				sessionsToNotify[n - ++deferCnt] = (const void *)(uintptr_t)server;
+				notifyScheduleRetry(holdUntil);
+				continue;
+			}
+		}
+
+		/*
+		 * deliver notifications to client sessions
+		 */
+		if ((storePrivate->notifyStatus == Using_NotifierInformViaMachPort) &&
+		    (storePrivate->notifyPort != MACH_PORT_NULL) &&
+		    (storePrivate->notifyRing != NULL)) {
+			/*
+			 * Queue the changes to the [shared] ring, only posting a
+			 * mach message if the client needs to be signaled
+			 */
+			if (__SCDynamicStoreNotifyRingPush(theSession->store)) {
+				traceEvent(kTraceOpPostRing, 0, storePrivate->server, kSCStatusOK,
+					   storePrivate->notifyPort);
+
+				delivery = deliveryCreateWithPort(server,
+								  kNotifyDeliveryPort,
+								  storePrivate->notifyPort,
+								  storePrivate->notifyPortIdentifier);
+				if (delivery != NULL) {
+					deliveryPost(theSession, delivery);
+				}
+			}
+			continue;
+		}
+
+		if ((storePrivate->notifyStatus == Using_NotifierInformViaMachPort) &&
+		    (storePrivate->notifyPort != MACH_PORT_NULL) &&
+		    storePrivate->notifyValues) {
+			CFIndex		keyCnt;
+			CFDataRef	values;
+
+			/*
+			 * Post notification (with the changed values) as mach message
+			 */
+			values = copyNotificationValues(theSession, &keyCnt);
+			if (values != NULL) {
+				traceEvent(kTraceOpPostValues, 0, storePrivate->server, kSCStatusOK,
+					   (uint32_t)CFDataGetLength(values));
+
+				delivery = deliveryCreateWithPort(server,
+								  kNotifyDeliveryValues,
+								  storePrivate->notifyPort,
+								  storePrivate->notifyPortIdentifier);
+				if (delivery != NULL) {
+					/* the changes go with the notification */
+					delivery->values = values;
+					delivery->keys = theSession->changedKeys;
+					theSession->changedKeys = NULL;
+					deliveryPost(theSession, delivery);
+				} else {
+					CFRelease(values);
+				}
+				continue;
+			}
+		}
+
+		if ((storePrivate->notifyStatus == Using_NotifierInformViaMachPort) &&
+		    (storePrivate->notifyPort != MACH_PORT_NULL)) {
+			/*
+			 * Post notification as mach message
+			 */
+			traceEvent(kTraceOpPostPort, 0, storePrivate->server, kSCStatusOK,
+				   storePrivate->notifyPort);
+
+			delivery = deliveryCreateWithPort(server,
+							  kNotifyDeliveryPort,
+							  storePrivate->notifyPort,
+							  storePrivate->notifyPortIdentifier);
+			if (delivery != NULL) {
+				deliveryPost(theSession, delivery);
+			}
+		}
+
+		if ((storePrivate->notifyStatus == Using_NotifierInformViaFD) &&
+		    (storePrivate->notifyFile >= 0)) {
+			int	fd;
+
+			if ((storePrivate->notifyRing != NULL) &&
+			    !__SCDynamicStoreNotifyRingPush(theSession->store)) {
+				/*
+				 * the changes have been queued to the [shared] ring
+				 * and the client has yet to drain the earlier ones,
+				 * no need to write() the identifier again
+				 */
+				continue;
+			}
+
+			traceEvent(kTraceOpPostFD, 0, storePrivate->server, kSCStatusOK,
+				   storePrivate->notifyFile);
+
+			/*
+			 * Post notification as a write() to the file descriptor
+			 */
+			fd = dup(storePrivate->notifyFile);
+			if (fd != -1) {
+				delivery = notifyDeliveryCreate(server, kNotifyDeliveryFD);
+				delivery->fd        = fd;
+				delivery->sessionFD = storePrivate->notifyFile;
+				delivery->msgid     = storePrivate->notifyFileIdentifier;
+				deliveryPost(theSession, delivery);
+			} else {
+#ifdef	DEBUG
+				SCLog(_configd_verbose, LOG_DEBUG,
+				      CFSTR("could not send notification, dup() failed: %s"),
+				      strerror(errno));
+#endif	/* DEBUG */
+			}
+		}
+
+		if ((storePrivate->notifyStatus == Using_NotifierInformViaSignal) &&
+		    (storePrivate->notifySignal > 0)) {
+			/*
+			 * Post notification as signal
+			 */
+			traceEvent(kTraceOpPostSignal, 0, storePrivate->server, kSCStatusOK,
+				   storePrivate->notifySignal);
+
+			delivery = deliveryCreateWithPort(server,
+							  kNotifyDeliverySignal,
+							  storePrivate->notifySignalTask,
+							  0);
+			if (delivery != NULL) {
+				delivery->signal = storePrivate->notifySignal;
+				deliveryPost(theSession, delivery);
+			} else {
+				/* if the task is gone */
+				signalTaskRelease(theSession, KERN_INVALID_RIGHT);
+			}
+		}
+	}
+
+	/*
+	 * this list of notifications have been posted, wait for some more.
+	 */
+	CFRelease(needsNotification);
+	needsNotification = NULL;
+	traceRecordOp(kTraceOpPush, 0, MACH_PORT_NULL, NULL, kSCStatusOK, traceTime, (uint32_t)(n - deferCnt));
+
+	/*
+	 * ... and [re-]flag any sessions that still have a notification in
+	 * flight (we will be back when that notification has been delivered)
+	 * or that are being held back (we will be back when the timer fires)
+	 */
+	while (--deferCnt >= 0) {
+		_setNeedsNotification((mach_port_t)(uintptr_t)sessionsToNotify[n - 1 - deferCnt]);
+	}
+	if (sessionsToNotify != sessionsToNotify_q) CFAllocatorDeallocate(NULL, sessionsToNotify);
+
+	return;
+}
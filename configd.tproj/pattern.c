@@ -29,8 +29,11 @@
  */
 
 
+#include <ctype.h>
+
 #include "configd.h"
 #include "pattern.h"
+#include "pattern_dfa.h"
 
 
 /*
@@ -40,57 +43,266 @@
  * - the dictionary "key" is the regular expression being matched
  * - the dictionary "value" is a CFArray with the following contents
  *     [0]   = CFData consisting of the pre-compiled regular expression
+ *             (and, if supported, the equivalent DFA)
  *     [1]   = CFArray[CFNumber] consisting of the sessions watching this pattern
- *     [2-n] = dynamic store keys which match this pattern
+ *     [2]   = CFSet[CFString] consisting of the dynamic store keys which match
+ *             this pattern.  The set is updated in place as keys are added
+ *             to (or removed from) the store.
+ * - the patterns in patternData are also indexed by their literal prefix
+ *   (see patternIndex below)
  */
 
 
 typedef struct {
-	CFMutableArrayRef	pInfo;
+	regex_t			preg;
+	dfaRef			dfa;	/* NULL if regexec() is required */
+} patternRegex;
+
+
+typedef struct {
+	CFMutableSetRef		pKeys;
+	CFMutableArrayRef	keys;
 	CFDataRef		pRegex;
 } addContext, *addContextRef;
 
 
-static __inline__ void
-my_CFDictionaryApplyFunction(CFDictionaryRef			theDict,
-			     CFDictionaryApplierFunction	applier,
-			     void				*context)
+/*
+ * pattern index
+ *
+ * Since all patterns are anchored at the start of the key, a store key can
+ * only match a pattern if it begins with that pattern's literal prefix (the
+ * characters preceding the first regex meta-character).  To avoid evaluating
+ * every active pattern each time a key is added to (or removed from) the
+ * store, the active patterns (those in patternData) are indexed by their
+ * literal prefix in a character trie.  Walking the trie with a key yields the
+ * (typically small) set of candidate patterns that need to be evaluated.
+ */
+
+typedef struct patternNode {
+	char			c;
+	struct patternNode	*children;
+	struct patternNode	*next;		/* sibling */
+	CFMutableArrayRef	patterns;	/* patterns whose prefix ends here */
+} patternNode, *patternNodeRef;
+
+static patternNode	patternIndex	= { '\0', NULL, NULL, NULL };
+
+
+static char *
+patternCopyPrefix(CFStringRef pattern)
+{
+	char		*prefix;
+	char		*p;
+	char		*q;
+
+	prefix = _SC_cfstring_to_cstring(pattern, NULL, 0, kCFStringEncodingASCII);
+	if (prefix == NULL) {
+		return NULL;
+	}
+
+	if (strchr(prefix, '|') != NULL) {
+		/* if alternation, no common prefix */
+		prefix[0] = '\0';
+		return prefix;
+	}
+
+	p = prefix;
+	q = prefix;
+	if (*p == '^') {
+		p++;
+	}
+
+	while (TRUE) {
+		char	c;
+
+		if (*p == '\\') {
+			c = p[1];
+			if ((c == '\0') || isalnum((unsigned char)c)) {
+				/* if not an escaped meta-character */
+				break;
+			}
+			p += 2;
+		} else if ((*p == '\0') || (strchr(".[]()*+?{}^$", *p) != NULL)) {
+			/* if end of pattern or meta-character */
+			break;
+		} else {
+			c = *p++;
+		}
+
+		if ((*p == '*') || (*p == '?') || (*p == '{')) {
+			/* if the literal is optional (or repeated) */
+			break;
+		}
+
+		*q++ = c;
+
+		if (*p == '+') {
+			/* if the literal is repeated */
+			break;
+		}
+	}
+	*q = '\0';
+
+	return prefix;
+}
+
+
+static void
+patternIndexAdd(CFStringRef pattern)
 {
-	CFAllocatorRef	myAllocator;
-	CFDictionaryRef	myDict;
+	patternNodeRef	node	= &patternIndex;
+	char		*p;
+	char		*prefix;
+
+	prefix = patternCopyPrefix(pattern);
+	if (prefix == NULL) {
+		return;
+	}
+
+	for (p = prefix; *p != '\0'; p++) {
+		patternNodeRef	child;
+
+		for (child = node->children; child != NULL; child = child->next) {
+			if (child->c == *p) {
+				break;
+			}
+		}
+
+		if (child == NULL) {
+			child = CFAllocatorAllocate(NULL, sizeof(patternNode), 0);
+			bzero(child, sizeof(patternNode));
+			child->c = *p;
+			child->next = node->children;
+			node->children = child;
+		}
 
-	myAllocator = CFGetAllocator(theDict);
-	myDict      = CFDictionaryCreateCopy(myAllocator, theDict);
-	CFDictionaryApplyFunction(myDict, applier, context);
-	CFRelease(myDict);
+		node = child;
+	}
+
+	if (node->patterns == NULL) {
+		node->patterns = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	}
+	CFArrayAppendValue(node->patterns, pattern);
+
+	CFAllocatorDeallocate(NULL, prefix);
 	return;
 }
 
 
 static Boolean
-keyMatchesPattern(CFStringRef key, CFDataRef pRegex)
+patternIndexRemoveNode(patternNodeRef node, const char *p, CFStringRef pattern)
 {
-	CFIndex			len;
-	Boolean			match		= FALSE;
-	regex_t			*preg;
-	int			reError;
-	char			str_q[256];
-	char *			str		= str_q;
+	if (*p == '\0') {
+		if (node->patterns != NULL) {
+			CFIndex	i;
+			CFIndex	n;
+
+			n = CFArrayGetCount(node->patterns);
+			i = CFArrayGetFirstIndexOfValue(node->patterns, CFRangeMake(0, n), pattern);
+			if (i != kCFNotFound) {
+				CFArrayRemoveValueAtIndex(node->patterns, i);
+			}
+			if (CFArrayGetCount(node->patterns) == 0) {
+				CFRelease(node->patterns);
+				node->patterns = NULL;
+			}
+		}
+	} else {
+		patternNodeRef	child;
+		patternNodeRef	*childP;
 
-	/* convert store key to C string */
-	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(key), kCFStringEncodingASCII) + 1;
-	if (len > (CFIndex)sizeof(str_q))
-		str = CFAllocatorAllocate(NULL, len, 0);
-	if (_SC_cfstring_to_cstring(key, str, len, kCFStringEncodingASCII) == NULL) {
-		SCLog(TRUE, LOG_DEBUG, CFSTR("keyMatchesPattern(): could not convert store key to C string"));
-		goto done;
+		for (childP = &node->children; *childP != NULL; childP = &(*childP)->next) {
+			if ((*childP)->c == *p) {
+				break;
+			}
+		}
+
+		child = *childP;
+		if ((child != NULL) && patternIndexRemoveNode(child, p + 1, pattern)) {
+			/* if the child node is no longer needed */
+			*childP = child->next;
+			CFAllocatorDeallocate(NULL, child);
+		}
+	}
+
+	return ((node->patterns == NULL) && (node->children == NULL));
+}
+
+
+static void
+patternIndexRemove(CFStringRef pattern)
+{
+	char		*prefix;
+
+	prefix = patternCopyPrefix(pattern);
+	if (prefix == NULL) {
+		return;
 	}
 
+	(void) patternIndexRemoveNode(&patternIndex, prefix, pattern);
+
+	CFAllocatorDeallocate(NULL, prefix);
+	return;
+}
+
+
+static CF_RETURNS_RETAINED CFArrayRef
+patternIndexCopyCandidates(const char *key)
+{
+	CFMutableArrayRef	candidates;
+	patternNodeRef		node		= &patternIndex;
+	const char		*p		= key;
+
+	candidates = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	while (TRUE) {
+		patternNodeRef	child;
+
+		if (node->patterns != NULL) {
+			CFArrayAppendArray(candidates,
+					   node->patterns,
+					   CFRangeMake(0, CFArrayGetCount(node->patterns)));
+		}
+
+		if (*p == '\0') {
+			break;
+		}
+
+		for (child = node->children; child != NULL; child = child->next) {
+			if (child->c == *p) {
+				break;
+			}
+		}
+		if (child == NULL) {
+			break;
+		}
+
+		node = child;
+		p++;
+	}
+
+	return candidates;
+}
+
+
+static Boolean
+patternMatches(CFDataRef pRegex, const char *str)
+{
+	Boolean			match		= FALSE;
+	patternRegex		*pr;
+	int			reError;
+
 	/* ALIGN: CF aligns to >8 byte boundries */
-	preg = (regex_t *)(void *)CFDataGetBytePtr(pRegex);
+	pr = (patternRegex *)(void *)CFDataGetBytePtr(pRegex);
+
+	if (pr->dfa != NULL) {
+		int	id;
+
+		/* compare key to the pattern's DFA */
+		return (dfaMatch(pr->dfa, str, &id, 1) > 0);
+	}
 
 	/* compare key to regular expression pattern */
-	reError = regexec(preg, str, 0, NULL, 0);
+	reError = regexec(&pr->preg, str, 0, NULL, 0);
 	switch (reError) {
 		case 0 :
 			match = TRUE;
@@ -101,35 +313,65 @@ keyMatchesPattern(CFStringRef key, CFDataRef pRegex)
 		default : {
 			char	reErrBuf[256];
 
-			(void)regerror(reError, preg, reErrBuf, sizeof(reErrBuf));
-			SCLog(TRUE, LOG_DEBUG, CFSTR("keyMatchesPattern regexec(): %s"), reErrBuf);
+			(void)regerror(reError, &pr->preg, reErrBuf, sizeof(reErrBuf));
+			SCLog(TRUE, LOG_DEBUG, CFSTR("patternMatches regexec(): %s"), reErrBuf);
 			break;
 		}
 	}
 
+	return match;
+}
+
+
+static Boolean
+keyMatchesPattern(CFStringRef key, CFDataRef pRegex)
+{
+	CFIndex			len;
+	Boolean			match		= FALSE;
+	const char *		str;
+	char			str_q[256];
+	char *			str_a		= NULL;
+
+	/* convert store key to C string */
+	str = CFStringGetCStringPtr(key, kCFStringEncodingASCII);
+	if (str == NULL) {
+		len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(key), kCFStringEncodingASCII) + 1;
+		if (len > (CFIndex)sizeof(str_q))
+			str_a = CFAllocatorAllocate(NULL, len, 0);
+		str = _SC_cfstring_to_cstring(key,
+					      (str_a != NULL) ? str_a : str_q,
+					      len,
+					      kCFStringEncodingASCII);
+		if (str == NULL) {
+			SCLog(TRUE, LOG_DEBUG, CFSTR("keyMatchesPattern(): could not convert store key to C string"));
+			goto done;
+		}
+	}
+
+	match = patternMatches(pRegex, str);
+
     done :
 
-	if (str != str_q) CFAllocatorDeallocate(NULL, str);
+	if (str_a != NULL) CFAllocatorDeallocate(NULL, str_a);
 	return match;
 }
 
 
 static void
-identifyKeyForPattern(const void *key, void *val, void *context)
+identifyKeyForPattern(storeEntryRef entry, void *context)
 {
-	CFStringRef		storeKey	= (CFStringRef)key;
-	CFDictionaryRef		storeValue	= (CFDictionaryRef)val;
-	CFMutableArrayRef	pInfo		= ((addContextRef)context)->pInfo;
+	CFStringRef		storeKey	= entry->key;
+	CFMutableSetRef		pKeys		= ((addContextRef)context)->pKeys;
 	CFDataRef		pRegex		= ((addContextRef)context)->pRegex;
 
-	if (!CFDictionaryContainsKey(storeValue, kSCDData)) {
+	if (entry->data == NULL) {
 		/* if no data (yet) */
 		return;
 	}
 
 	if (keyMatchesPattern(storeKey, pRegex)) {
 		/* if we've got a match */
-		CFArrayAppendValue(pInfo, storeKey);
+		CFSetAddValue(pKeys, storeKey);
 	}
 
 	return;
@@ -190,22 +432,28 @@ patternCompile(CFStringRef pattern, CFDataRef pRegex, CFStringRef *error)
 		CFRelease(pattern);
 	}
 	if (ok) {
-		regex_t	*preg;
-		int	reError;
+		patternRegex	*pr;
+		int		reError;
 
 		/* ALIGN: CF aligns to >8 byte boundries */
-		preg = (regex_t *)(void *)CFDataGetBytePtr(pRegex);
+		pr = (patternRegex *)(void *)CFDataGetBytePtr(pRegex);
+		pr->dfa = NULL;
 
-		reError = regcomp(preg, str, REG_EXTENDED);
+		reError = regcomp(&pr->preg, str, REG_EXTENDED);
 		if (reError != 0) {
 			char	reErrBuf[256];
 
-			(void)regerror(reError, preg, reErrBuf, sizeof(reErrBuf));
+			(void)regerror(reError, &pr->preg, reErrBuf, sizeof(reErrBuf));
 			*error = CFStringCreateWithCString(NULL, reErrBuf, kCFStringEncodingASCII);
 #ifdef	DEBUG
 			SCLog(_configd_verbose, LOG_DEBUG, CFSTR("patternCompile regcomp(%s) failed: %s"), str, reErrBuf);
 #endif	/* DEBUG */
 			ok = FALSE;
+		} else {
+			const char	*patterns[]	= { str };
+
+			/* also compile a DFA (if the pattern is supported) */
+			pr->dfa = dfaCreate(patterns, 1, NULL);
 		}
 	} else {
 		*error = CFRetain(CFSTR("could not convert pattern to regex string"));
@@ -222,11 +470,15 @@ patternCompile(CFStringRef pattern, CFDataRef pRegex, CFStringRef *error)
 static void
 patternRelease(CFDataRef pRegex)
 {
-	regex_t		*preg;
+	patternRegex	*pr;
 
 	/* ALIGN: CF aligns to >8 byte boundries */
-	preg = (regex_t *)(void *)CFDataGetBytePtr(pRegex);
-	regfree(preg);
+	pr = (patternRegex *)(void *)CFDataGetBytePtr(pRegex);
+	regfree(&pr->preg);
+	if (pr->dfa != NULL) {
+		dfaRelease(pr->dfa);
+		pr->dfa = NULL;
+	}
 
 	return;
 }
@@ -248,6 +500,9 @@ patternNew(CFStringRef pattern)
 	addContext		context;
 	CFStringRef		err	= NULL;
 	CFMutableArrayRef	pInfo;
+	CFMutableSetRef		pKeys;
+	CFStringRef		prefix;
+	char			*prefix_c;
 	CFMutableDataRef	pRegex;
 	CFArrayRef		pSessions;
 
@@ -255,8 +510,8 @@ patternNew(CFStringRef pattern)
 	pInfo = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
 
 	/* compile the regular expression from the pattern string. */
-	pRegex = CFDataCreateMutable(NULL, sizeof(regex_t));
-	CFDataSetLength(pRegex, sizeof(regex_t));
+	pRegex = CFDataCreateMutable(NULL, sizeof(patternRegex));
+	CFDataSetLength(pRegex, sizeof(patternRegex));
 	if (!patternCompile(pattern, pRegex, &err)) {
 		CFRelease(err);
 		CFRelease(pRegex);
@@ -272,13 +527,27 @@ patternNew(CFStringRef pattern)
 	CFArrayAppendValue(pInfo, pSessions);
 	CFRelease(pSessions);
 
-	/* identify/add all existing keys that match the specified pattern */
-	context.pInfo  = pInfo;
+	/*
+	 * identify/add all existing keys that match the specified pattern.
+	 * Only those keys that begin with the literal prefix of the pattern
+	 * need to be checked.
+	 */
+	pKeys = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
+	CFArrayAppendValue(pInfo, pKeys);
+	prefix_c = patternCopyPrefix(pattern);
+	if (prefix_c != NULL) {
+		prefix = CFStringCreateWithCString(NULL, prefix_c, kCFStringEncodingASCII);
+		CFAllocatorDeallocate(NULL, prefix_c);
+	} else {
+		prefix = CFRetain(CFSTR(""));
+	}
+	context.pKeys  = pKeys;
+	context.keys   = NULL;
 	context.pRegex = pRegex;
-	my_CFDictionaryApplyFunction(storeData,
-				     (CFDictionaryApplierFunction)identifyKeyForPattern,
-				     &context);
+	storeApplyPrefixFunction(prefix, identifyKeyForPattern, &context);
+	CFRelease(prefix);
 
+	CFRelease(pKeys);
 	CFRelease(pRegex);
 	return pInfo;
 }
@@ -289,8 +558,11 @@ CFArrayRef
 patternCopyMatches(CFStringRef pattern)
 {
 	Boolean			isNew	= FALSE;
-	CFArrayRef		keys;
+	CFMutableArrayRef	keys;
+	CFIndex			n;
 	CFMutableArrayRef	pInfo;
+	CFSetRef		pKeys;
+	const void		**values;
 
 	/* find (or create new instance of) this pattern */
 	pInfo = patternCopy(pattern);
@@ -311,14 +583,89 @@ patternCopyMatches(CFStringRef pattern)
 		patternRelease(pRegex);
 	}
 
-	CFArrayReplaceValues(pInfo, CFRangeMake(0, 2), NULL, 0);
-	keys = CFArrayCreateCopy(NULL, pInfo);
+	/* return the matching keys in key (UTF-8 byte) order */
+	pKeys = CFArrayGetValueAtIndex(pInfo, 2);
+	n = CFSetGetCount(pKeys);
+	values = CFAllocatorAllocate(NULL, (n > 0 ? n : 1) * sizeof(CFTypeRef), 0);
+	CFSetGetValues(pKeys, values);
+	keys = CFArrayCreateMutable(NULL, n, &kCFTypeArrayCallBacks);
+	CFArrayReplaceValues(keys, CFRangeMake(0, 0), values, n);
+	CFAllocatorDeallocate(NULL, values);
+	CFArraySortValues(keys, CFRangeMake(0, n), storeKeyCompare, NULL);
 	CFRelease(pInfo);
 
 	return keys;
 }
 
 
+static void
+identifySnapshotKeyForPattern(CFStringRef key, CFDataRef data, void *context)
+{
+	CFMutableArrayRef	keys	= ((addContextRef)context)->keys;
+	CFDataRef		pRegex	= ((addContextRef)context)->pRegex;
+
+	if (keyMatchesPattern(key, pRegex)) {
+		/* if we've got a match */
+		CFArrayAppendValue(keys, key);
+	}
+
+	return;
+}
+
+
+/*
+ * patternCopySnapshotMatches
+ *   returns (in order) the keys in a store snapshot which match the
+ *   specified pattern.  Unlike patternCopyMatches(), the shared pattern
+ *   information (patternData) is neither consulted nor updated so this
+ *   function may be called from any thread.
+ */
+__private_extern__
+CFArrayRef
+patternCopySnapshotMatches(CFStringRef pattern, storeSnapshotRef snapshot)
+{
+	addContext		context;
+	CFStringRef		err	= NULL;
+	CFArrayRef		keys;
+	CFMutableArrayRef	matches;
+	CFStringRef		prefix;
+	char			*prefix_c;
+	CFMutableDataRef	pRegex;
+
+	/* compile a private instance of the regular expression */
+	pRegex = CFDataCreateMutable(NULL, sizeof(patternRegex));
+	CFDataSetLength(pRegex, sizeof(patternRegex));
+	if (!patternCompile(pattern, pRegex, &err)) {
+		CFRelease(err);
+		CFRelease(pRegex);
+		return NULL;
+	}
+
+	/* only those keys that begin with the literal prefix need to be checked */
+	prefix_c = patternCopyPrefix(pattern);
+	if (prefix_c != NULL) {
+		prefix = CFStringCreateWithCString(NULL, prefix_c, kCFStringEncodingASCII);
+		CFAllocatorDeallocate(NULL, prefix_c);
+	} else {
+		prefix = CFRetain(CFSTR(""));
+	}
+
+	matches = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	context.pKeys  = NULL;
+	context.keys   = matches;
+	context.pRegex = pRegex;
+	storeSnapshotApplyPrefixFunction(snapshot, prefix, identifySnapshotKeyForPattern, &context);
+	CFRelease(prefix);
+
+	patternRelease(pRegex);
+	CFRelease(pRegex);
+
+	keys = CFArrayCreateCopy(NULL, matches);
+	CFRelease(matches);
+	return keys;
+}
+
+
 __private_extern__
 Boolean
 patternKeyMatches(CFStringRef pattern, CFStringRef key)
@@ -328,19 +675,13 @@ patternKeyMatches(CFStringRef pattern, CFStringRef key)
 	CFMutableArrayRef	pInfo;
 	CFDataRef		pRegex;
 
-	/* find (or create new instance of) this pattern */
+	/*
+	 * find (or create new instance of) this pattern.  Note: the regular
+	 * expression is evaluated even if the key is one of the pattern's
+	 * known (matched) keys since searching that list costs more.
+	 */
 	pInfo = patternCopy(pattern);
-	if (pInfo != NULL) {
-		CFIndex		n;
-
-		/* if existing pattern, check if known key */
-		n = CFArrayGetCount(pInfo);
-		match = (n > 2) &&
-			CFArrayContainsValue(pInfo, CFRangeMake(2, n - 2), key);
-		if (match) {
-			goto done;
-		}
-	} else {
+	if (pInfo == NULL) {
 		/* if new pattern */
 		pInfo = patternNew(pattern);
 		if (pInfo == NULL) {
@@ -357,20 +698,65 @@ patternKeyMatches(CFStringRef pattern, CFStringRef key)
 		patternRelease(pRegex);
 	}
 
-    done :
-
 	CFRelease(pInfo);
 
 	return match;
 }
 
 
+/*
+ * patternCopyKeyCandidates
+ *   returns the active patterns whose literal prefix begins the key (the
+ *   only patterns which can match the key).
+ */
+__private_extern__
+CFArrayRef
+patternCopyKeyCandidates(CFStringRef key)
+{
+	CFArrayRef		candidates;
+	CFIndex			len;
+	char			str_q[256];
+	char *			str		= str_q;
+
+	/* convert store key to C string */
+	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(key), kCFStringEncodingASCII) + 1;
+	if (len > (CFIndex)sizeof(str_q))
+		str = CFAllocatorAllocate(NULL, len, 0);
+	if (_SC_cfstring_to_cstring(key, str, len, kCFStringEncodingASCII) == NULL) {
+		/* if the key could not match any pattern */
+		candidates = CFArrayCreate(NULL, NULL, 0, &kCFTypeArrayCallBacks);
+		goto done;
+	}
+
+	candidates = patternIndexCopyCandidates(str);
+
+    done :
+
+	if (str != str_q) CFAllocatorDeallocate(NULL, str);
+	return candidates;
+}
+
+
+static void
+addWatcherForKey(const void *value, void *context)
+{
+	_addWatcher((CFNumberRef)context, (CFStringRef)value);
+	return;
+}
+
+
+static void
+removeWatcherForKey(const void *value, void *context)
+{
+	_removeWatcher((CFNumberRef)context, (CFStringRef)value);
+	return;
+}
+
+
 __private_extern__
 Boolean
 patternAddSession(CFStringRef pattern, CFNumberRef sessionNum)
 {
-	CFIndex                 i;
-	CFIndex                 n;
 	CFMutableArrayRef       pInfo;
 	CFMutableArrayRef	pSessions;
 
@@ -382,6 +768,9 @@ patternAddSession(CFStringRef pattern, CFNumberRef sessionNum)
 		if (pInfo == NULL) {
 			return FALSE;
 		}
+
+		/* add the pattern to the index */
+		patternIndexAdd(pattern);
 	}
 
 	/* add this session as a pattern watcher */
@@ -395,13 +784,7 @@ patternAddSession(CFStringRef pattern, CFNumberRef sessionNum)
 	CFDictionarySetValue(patternData, pattern, pInfo);
 
 	/* add this session as a watcher of any existing keys */
-	n = CFArrayGetCount(pInfo);
-	for (i = 2; i < n; i++) {
-		CFStringRef     matchingKey;
-
-		matchingKey = CFArrayGetValueAtIndex(pInfo, i);
-		_addWatcher(sessionNum, matchingKey);
-	}
+	CFSetApplyFunction(CFArrayGetValueAtIndex(pInfo, 2), addWatcherForKey, (void *)sessionNum);
 
 	CFRelease(pInfo);
 	return TRUE;
@@ -423,13 +806,7 @@ patternRemoveSession(CFStringRef pattern, CFNumberRef sessionNum)
 	assert(pInfo != NULL);
 
 	/* remove this session as a watcher from all matching keys */
-	n = CFArrayGetCount(pInfo);
-	for (i = 2; i < n; i++) {
-		CFStringRef     matchingKey;
-
-		matchingKey = CFArrayGetValueAtIndex(pInfo, i);
-		_removeWatcher(sessionNum, matchingKey);
-	}
+	CFSetApplyFunction(CFArrayGetValueAtIndex(pInfo, 2), removeWatcherForKey, (void *)sessionNum);
 
 	/* remove session from watchers */
 	pSessions = (CFMutableArrayRef)CFArrayGetValueAtIndex(pInfo, 1);
@@ -450,6 +827,7 @@ patternRemoveSession(CFStringRef pattern, CFNumberRef sessionNum)
 		pRegex = CFArrayGetValueAtIndex(pInfo, 0);
 		patternRelease(pRegex);
 		CFDictionaryRemoveValue(patternData, pattern);
+		patternIndexRemove(pattern);
 	}
 
 	CFRelease(pInfo);
@@ -458,72 +836,34 @@ patternRemoveSession(CFStringRef pattern, CFNumberRef sessionNum)
 
 
 static void
-addKeyForPattern(const void *key, void *val, void *context)
+addKeyForPattern(CFArrayRef pInfo, CFStringRef storeKey, const char *str)
 {
-	CFStringRef		pattern		= (CFStringRef)key;
-	CFArrayRef		pInfo		= (CFArrayRef)val;
-	CFStringRef		storeKey	= (CFStringRef)context;
-
-	CFIndex			len;
-	regex_t			*preg;
-	int			reError;
-	char			str_q[256];
-	char *			str		= str_q;
+	CFIndex			i;
+	CFIndex			n;
+	CFArrayRef		pSessions;
 
-	/* convert store key to C string */
-	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(storeKey), kCFStringEncodingASCII) + 1;
-	if (len > (CFIndex)sizeof(str_q))
-		str = CFAllocatorAllocate(NULL, len, 0);
-	if (_SC_cfstring_to_cstring(storeKey, str, len, kCFStringEncodingASCII) == NULL) {
-		SCLog(TRUE, LOG_DEBUG, CFSTR("addKeyForPattern(): could not convert store key to C string"));
-		goto done;
+	/* compare new store key to regular expression pattern */
+	if (!patternMatches(CFArrayGetValueAtIndex(pInfo, 0), str)) {
+		/* no match */
+		return;
 	}
 
-	/* compare new store key to regular expression pattern */
-	/* ALIGN: CF aligns to >8 byte boundries */
-	preg = (regex_t *)(void *)CFDataGetBytePtr(CFArrayGetValueAtIndex(pInfo, 0));
-	reError = regexec(preg, str, 0, NULL, 0);
-	switch (reError) {
-		case 0 : {
-			/*
-			 * we've got a match
-			 */
-			CFIndex			i;
-			CFIndex			n;
-			CFMutableArrayRef	pInfo_new;
-			CFArrayRef		pSessions;
-
-			/* add watchers */
-			pSessions = CFArrayGetValueAtIndex(pInfo, 1);
-			n = CFArrayGetCount(pSessions);
-			for (i = 0; i < n; i++) {
-				CFNumberRef	sessionNum	= CFArrayGetValueAtIndex(pSessions, i);
-
-				_addWatcher(sessionNum, storeKey);
-			}
+	/*
+	 * we've got a match
+	 */
 
-			/* add key, update pattern watcher info */
-			pInfo_new = CFArrayCreateMutableCopy(NULL, 0, pInfo);
-			CFArrayAppendValue(pInfo_new, storeKey);
-			CFDictionarySetValue(patternData, pattern, pInfo_new);
-			CFRelease(pInfo_new);
-			break;
-		}
-		case REG_NOMATCH :
-			/* no match */
-			break;
-		default : {
-			char	reErrBuf[256];
+	/* add watchers */
+	pSessions = CFArrayGetValueAtIndex(pInfo, 1);
+	n = CFArrayGetCount(pSessions);
+	for (i = 0; i < n; i++) {
+		CFNumberRef	sessionNum	= CFArrayGetValueAtIndex(pSessions, i);
 
-			(void)regerror(reError, preg, reErrBuf, sizeof(reErrBuf));
-			SCLog(TRUE, LOG_DEBUG, CFSTR("addKeyForPattern regexec(): %s"), reErrBuf);
-			break;
-		}
+		_addWatcher(sessionNum, storeKey);
 	}
 
-    done :
+	/* add key (the set of matching keys is updated in place) */
+	CFSetAddValue((CFMutableSetRef)CFArrayGetValueAtIndex(pInfo, 2), storeKey);
 
-	if (str != str_q) CFAllocatorDeallocate(NULL, str);
 	return;
 }
 
@@ -532,46 +872,63 @@ __private_extern__
 void
 patternAddKey(CFStringRef key)
 {
-	void	*context	= (void *)key;
+	CFArrayRef		candidates;
+	CFIndex			i;
+	CFIndex			len;
+	CFIndex			n;
+	char			str_q[256];
+	char *			str		= str_q;
+
+	/* convert store key to C string */
+	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(key), kCFStringEncodingASCII) + 1;
+	if (len > (CFIndex)sizeof(str_q))
+		str = CFAllocatorAllocate(NULL, len, 0);
+	if (_SC_cfstring_to_cstring(key, str, len, kCFStringEncodingASCII) == NULL) {
+		SCLog(TRUE, LOG_DEBUG, CFSTR("patternAddKey(): could not convert store key to C string"));
+		goto done;
+	}
+
+	/* evaluate only those patterns whose literal prefix matches the key */
+	candidates = patternIndexCopyCandidates(str);
+	n = CFArrayGetCount(candidates);
+	for (i = 0; i < n; i++) {
+		CFArrayRef	pInfo;
+		CFStringRef	pattern;
 
-	my_CFDictionaryApplyFunction(patternData,
-				     (CFDictionaryApplierFunction)addKeyForPattern,
-				     context);
+		pattern = CFArrayGetValueAtIndex(candidates, i);
+		pInfo = CFDictionaryGetValue(patternData, pattern);
+		if (pInfo != NULL) {
+			addKeyForPattern(pInfo, key, str);
+		}
+	}
+	CFRelease(candidates);
 
+    done :
+
+	if (str != str_q) CFAllocatorDeallocate(NULL, str);
 	return;
 }
 
 
 static void
-removeKeyFromPattern(const void *key, void *val, void *context)
+removeKeyFromPattern(CFArrayRef pInfo, CFStringRef storeKey)
 {
-	CFStringRef		pattern		= (CFStringRef)key;
-	CFArrayRef		pInfo		= (CFArrayRef)val;
-	CFStringRef		storeKey	= (CFStringRef)context;
-
 	CFIndex			i;
 	CFIndex			n;
-	CFMutableArrayRef	pInfo_new;
+	CFMutableSetRef		pKeys;
 	CFArrayRef		pSessions;
 
-	n = CFArrayGetCount(pInfo);
-	if (n <= 2) {
-		/* if no keys match this pattern */
-		return;
-	}
-
-	i = CFArrayGetFirstIndexOfValue(pInfo, CFRangeMake(2, n-2), storeKey);
-	if (i == kCFNotFound) {
+	pKeys = (CFMutableSetRef)CFArrayGetValueAtIndex(pInfo, 2);
+	if (!CFSetContainsValue(pKeys, storeKey)) {
 		/* if this key wasn't matched by this pattern */
 		return;
 	}
 
-	/* remove key from pattern info */
-	pInfo_new = CFArrayCreateMutableCopy(NULL, 0, pInfo);
-	CFArrayRemoveValueAtIndex(pInfo_new, i);
+	/* remove key from pattern info (the set is updated in place) */
+	CFSetRemoveValue(pKeys, storeKey);
 
 	/* remove watchers */
-	pSessions = CFArrayGetValueAtIndex(pInfo_new, 1);
+	pSessions = CFArrayGetValueAtIndex(pInfo, 1);
 	n = CFArrayGetCount(pSessions);
 	for (i = 0; i < n; i++) {
 		CFNumberRef	sessionNum	= CFArrayGetValueAtIndex(pSessions, i);
@@ -579,8 +936,6 @@ removeKeyFromPattern(const void *key, void *val, void *context)
 		_removeWatcher(sessionNum, storeKey);
 	}
 
-	CFDictionarySetValue(patternData, pattern, pInfo_new);
-	CFRelease(pInfo_new);
 	return;
 }
 
@@ -589,11 +944,39 @@ __private_extern__
 void
 patternRemoveKey(CFStringRef key)
 {
-	void	*context	= (void *)key;
+	CFArrayRef		candidates;
+	CFIndex			i;
+	CFIndex			len;
+	CFIndex			n;
+	char			str_q[256];
+	char *			str		= str_q;
+
+	/* convert store key to C string */
+	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(key), kCFStringEncodingASCII) + 1;
+	if (len > (CFIndex)sizeof(str_q))
+		str = CFAllocatorAllocate(NULL, len, 0);
+	if (_SC_cfstring_to_cstring(key, str, len, kCFStringEncodingASCII) == NULL) {
+		/* if the key could not have matched any pattern */
+		goto done;
+	}
 
-	my_CFDictionaryApplyFunction(patternData,
-				     (CFDictionaryApplierFunction)removeKeyFromPattern,
-				     context);
+	/* only those patterns whose literal prefix matches the key can reference it */
+	candidates = patternIndexCopyCandidates(str);
+	n = CFArrayGetCount(candidates);
+	for (i = 0; i < n; i++) {
+		CFArrayRef	pInfo;
+		CFStringRef	pattern;
 
+		pattern = CFArrayGetValueAtIndex(candidates, i);
+		pInfo = CFDictionaryGetValue(patternData, pattern);
+		if (pInfo != NULL) {
+			removeKeyFromPattern(pInfo, key);
+		}
+	}
+	CFRelease(candidates);
+
+    done :
+
+	if (str != str_q) CFAllocatorDeallocate(NULL, str);
 	return;
 }
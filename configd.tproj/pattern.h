@@ -38,9 +38,15 @@ __BEGIN_DECLS
 
 CFArrayRef		patternCopyMatches	(CFStringRef		pattern);
 
+CFArrayRef		patternCopySnapshotMatches
+						(CFStringRef		pattern,
+						 storeSnapshotRef	snapshot);
+
 Boolean			patternKeyMatches	(CFStringRef		pattern,
 						 CFStringRef		key);
 
+CFArrayRef		patternCopyKeyCandidates(CFStringRef		key);
+
 Boolean			patternAddSession	(CFStringRef		pattern,
 						 CFNumberRef		sessionNum);
 
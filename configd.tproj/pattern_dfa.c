@@ -0,0 +1,775 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern_dfa.h"
+
+
+#define	DFA_MAX_STATES	4096	/* flush the DFA cache if exceeded */
+#define	DFA_UNKNOWN	-1	/* transition not yet computed */
+
+enum {
+	NODE_EPSILON,			/* out [, out2] */
+	NODE_SET,			/* set --> out */
+	NODE_MATCH			/* pattern matched */
+};
+
+typedef struct {
+	int		type;
+	int		out;
+	int		out2;
+	int		set;		/* NODE_SET : index of the character set */
+	int		id;		/* NODE_MATCH : index of the pattern */
+} dfaNode;
+
+typedef struct {
+	uint32_t	bits[256 / 32];
+} dfaSet;
+
+typedef struct {
+	int		*nodes;		/* sorted NFA (set/match) node indices */
+	int		nNodes;
+	int		*matches;	/* matching pattern indices */
+	int		nMatches;
+	uint32_t	hash;
+	int		hashNext;
+	int		next[256];
+} dfaState;
+
+struct __dfa {
+	/* NFA */
+	dfaNode		*nodes;
+	int		nNodes;
+	int		maxNodes;
+	dfaSet		*sets;
+	int		nSets;
+	int		maxSets;
+	int		*starts;
+	int		nStarts;
+
+	/* DFA (cache) */
+	dfaState	*states;
+	int		nStates;
+	int		maxStates;
+	int		*hashHeads;
+	int		nHashHeads;
+	int		startState;
+
+	/* scratch */
+	int		*mark;
+	int		markGen;
+	int		*stack;
+	int		*scratch;
+};
+
+typedef struct {
+	int		start;
+	int		end;		/* NODE_EPSILON, out not yet set */
+} dfaFrag;
+
+typedef struct {
+	struct __dfa	*dfa;
+	const char	*p;
+	int		depth;
+	int		ok;
+} dfaParser;
+
+
+#pragma mark -
+#pragma mark NFA construction
+
+
+static int
+nodeNew(struct __dfa *dfa, int type)
+{
+	dfaNode	*node;
+
+	if (dfa->nNodes >= dfa->maxNodes) {
+		dfa->maxNodes = (dfa->maxNodes > 0) ? dfa->maxNodes * 2 : 64;
+		dfa->nodes = reallocf(dfa->nodes, dfa->maxNodes * sizeof(dfaNode));
+	}
+
+	node = &dfa->nodes[dfa->nNodes];
+	node->type = type;
+	node->out  = -1;
+	node->out2 = -1;
+	node->set  = -1;
+	node->id   = -1;
+	return dfa->nNodes++;
+}
+
+
+static int
+setNew(struct __dfa *dfa)
+{
+	if (dfa->nSets >= dfa->maxSets) {
+		dfa->maxSets = (dfa->maxSets > 0) ? dfa->maxSets * 2 : 16;
+		dfa->sets = reallocf(dfa->sets, dfa->maxSets * sizeof(dfaSet));
+	}
+
+	bzero(&dfa->sets[dfa->nSets], sizeof(dfaSet));
+	return dfa->nSets++;
+}
+
+
+static __inline__ void
+setAdd(dfaSet *set, unsigned char c)
+{
+	set->bits[c / 32] |= (1U << (c % 32));
+	return;
+}
+
+
+static __inline__ int
+setContains(const dfaSet *set, unsigned char c)
+{
+	return ((set->bits[c / 32] & (1U << (c % 32))) != 0);
+}
+
+
+static dfaFrag
+fragSet(struct __dfa *dfa, int set)
+{
+	dfaFrag	f;
+
+	f.start = nodeNew(dfa, NODE_SET);
+	f.end   = nodeNew(dfa, NODE_EPSILON);
+	dfa->nodes[f.start].set = set;
+	dfa->nodes[f.start].out = f.end;
+	return f;
+}
+
+
+static dfaFrag	parseAlternation	(dfaParser *parser);
+
+
+static int
+parseBracket(dfaParser *parser)
+{
+	dfaSet		*set;
+	int		i;
+	int		negate	= 0;
+	const char	*p	= parser->p;	/* just past the "[" */
+	int		setIndex;
+
+	setIndex = setNew(parser->dfa);
+	set = &parser->dfa->sets[setIndex];
+
+	if (*p == '^') {
+		negate = 1;
+		p++;
+	}
+
+	if (*p == ']') {
+		/* a leading "]" is a literal */
+		setAdd(set, ']');
+		p++;
+	}
+
+	while (*p != ']') {
+		unsigned char	lo;
+		unsigned char	hi;
+
+		if (*p == '\0') {
+			/* if unterminated */
+			parser->ok = 0;
+			return -1;
+		}
+
+		if ((*p == '[') && ((p[1] == ':') || (p[1] == '=') || (p[1] == '.'))) {
+			/* if character class, equivalence class, or collating symbol */
+			parser->ok = 0;
+			return -1;
+		}
+
+		lo = (unsigned char)*p++;
+		hi = lo;
+		if ((*p == '-') && (p[1] != ']') && (p[1] != '\0')) {
+			hi = (unsigned char)p[1];
+			if ((hi == '[') || (hi < lo)) {
+				parser->ok = 0;
+				return -1;
+			}
+			p += 2;
+		}
+
+		for (i = lo; i <= hi; i++) {
+			setAdd(set, (unsigned char)i);
+		}
+	}
+	parser->p = p + 1;
+
+	if (negate) {
+		for (i = 0; i < (int)(sizeof(set->bits) / sizeof(set->bits[0])); i++) {
+			set->bits[i] = ~set->bits[i];
+		}
+	}
+
+	/* NUL never matches (it terminates the key) */
+	set->bits[0] &= ~1U;
+
+	return setIndex;
+}
+
+
+static dfaFrag
+parseAtom(dfaParser *parser)
+{
+	struct __dfa	*dfa	= parser->dfa;
+	dfaFrag		f	= { -1, -1 };
+	int		set;
+	char		c	= *parser->p;
+
+	switch (c) {
+		case '(' :
+			parser->p++;
+			if (*parser->p == ')') {
+				/* if empty group */
+				parser->ok = 0;
+				return f;
+			}
+			parser->depth++;
+			f = parseAlternation(parser);
+			parser->depth--;
+			if (!parser->ok) {
+				return f;
+			}
+			if (*parser->p != ')') {
+				parser->ok = 0;
+				return f;
+			}
+			parser->p++;
+			return f;
+		case '[' :
+			parser->p++;
+			set = parseBracket(parser);
+			if (!parser->ok) {
+				return f;
+			}
+			return fragSet(dfa, set);
+		case '.' : {
+			int	i;
+
+			parser->p++;
+			set = setNew(dfa);
+			for (i = 1; i < 256; i++) {
+				setAdd(&dfa->sets[set], (unsigned char)i);
+			}
+			return fragSet(dfa, set);
+		}
+		case '\\' :
+			c = parser->p[1];
+			if ((c == '\0') ||
+			    ((c >= '0') && (c <= '9')) ||
+			    ((c >= 'a') && (c <= 'z')) ||
+			    ((c >= 'A') && (c <= 'Z'))) {
+				/* if back-reference or other (non-portable) escape */
+				parser->ok = 0;
+				return f;
+			}
+			parser->p += 2;
+			break;
+		case '\0' :
+		case ')' :
+		case '|' :
+		case '*' :
+		case '+' :
+		case '?' :
+		case '{' :
+		case '}' :
+		case '^' :
+		case '$' :
+			/* if not an atom (or anchors / bounds) */
+			parser->ok = 0;
+			return f;
+		default :
+			parser->p++;
+			break;
+	}
+
+	if ((unsigned char)c > 0x7f) {
+		/* only ASCII literals */
+		parser->ok = 0;
+		return f;
+	}
+
+	set = setNew(dfa);
+	setAdd(&dfa->sets[set], (unsigned char)c);
+	return fragSet(dfa, set);
+}
+
+
+static dfaFrag
+parseRepetition(dfaParser *parser)
+{
+	struct __dfa	*dfa	= parser->dfa;
+	dfaFrag		f;
+	dfaFrag		r;
+
+	f = parseAtom(parser);
+	if (!parser->ok) {
+		return f;
+	}
+
+	switch (*parser->p) {
+		case '*' :
+			r.start = nodeNew(dfa, NODE_EPSILON);
+			r.end   = nodeNew(dfa, NODE_EPSILON);
+			dfa->nodes[r.start].out  = f.start;
+			dfa->nodes[r.start].out2 = r.end;
+			dfa->nodes[f.end].out    = r.start;
+			break;
+		case '+' :
+			r.start = f.start;
+			r.end   = nodeNew(dfa, NODE_EPSILON);
+			dfa->nodes[f.end].out  = f.start;
+			dfa->nodes[f.end].out2 = r.end;
+			break;
+		case '?' :
+			r.start = nodeNew(dfa, NODE_EPSILON);
+			r.end   = f.end;
+			dfa->nodes[r.start].out  = f.start;
+			dfa->nodes[r.start].out2 = f.end;
+			break;
+		default :
+			return f;
+	}
+	parser->p++;
+
+	switch (*parser->p) {
+		case '*' :
+		case '+' :
+		case '?' :
+		case '{' :
+			/* if multiple (or bounded) repetition operators */
+			parser->ok = 0;
+			break;
+	}
+
+	return r;
+}
+
+
+static dfaFrag
+parseConcatenation(dfaParser *parser)
+{
+	struct __dfa	*dfa	= parser->dfa;
+	dfaFrag		f;
+
+	f.start = nodeNew(dfa, NODE_EPSILON);
+	f.end   = f.start;
+
+	while ((*parser->p != '\0') && (*parser->p != '|') && (*parser->p != ')')) {
+		dfaFrag	r;
+
+		r = parseRepetition(parser);
+		if (!parser->ok) {
+			return f;
+		}
+
+		dfa->nodes[f.end].out = r.start;
+		f.end = r.end;
+	}
+
+	return f;
+}
+
+
+static dfaFrag
+parseAlternation(dfaParser *parser)
+{
+	struct __dfa	*dfa	= parser->dfa;
+	dfaFrag		f;
+	int		n	= 0;
+
+	f.start = -1;
+	f.end   = nodeNew(dfa, NODE_EPSILON);
+
+	while (1) {
+		dfaFrag		c;
+		const char	*p	= parser->p;
+
+		c = parseConcatenation(parser);
+		if (!parser->ok) {
+			return f;
+		}
+		if (parser->p == p) {
+			/* if empty alternative */
+			parser->ok = 0;
+			return f;
+		}
+		dfa->nodes[c.end].out = f.end;
+
+		if (n++ == 0) {
+			f.start = c.start;
+		} else {
+			int	s;
+
+			s = nodeNew(dfa, NODE_EPSILON);
+			dfa->nodes[s].out  = f.start;
+			dfa->nodes[s].out2 = c.start;
+			f.start = s;
+		}
+
+		if (*parser->p != '|') {
+			break;
+		}
+
+		if (parser->depth == 0) {
+			/* if un-anchored (top-level) alternation */
+			parser->ok = 0;
+			return f;
+		}
+		parser->p++;
+	}
+
+	return f;
+}
+
+
+static int
+compilePattern(struct __dfa *dfa, const char *pattern, int id)
+{
+	dfaFrag		f;
+	size_t		len;
+	int		match;
+	dfaParser	parser;
+	char		*str;
+
+	/* the pattern must be anchored at both ends */
+	len = strlen(pattern);
+	if ((len < 2) ||
+	    (pattern[0] != '^') ||
+	    (pattern[len - 1] != '$') ||
+	    ((len > 2) && (pattern[len - 2] == '\\'))) {
+		return 0;
+	}
+
+	str = strndup(pattern + 1, len - 2);
+	parser.dfa   = dfa;
+	parser.p     = str;
+	parser.depth = 0;
+	parser.ok    = 1;
+
+	if (*str == '\0') {
+		/* if empty pattern ("^$") */
+		f.start = nodeNew(dfa, NODE_EPSILON);
+		f.end   = f.start;
+	} else {
+		f = parseAlternation(&parser);
+		if (parser.ok && (*parser.p != '\0')) {
+			/* if unbalanced ")" */
+			parser.ok = 0;
+		}
+	}
+	free(str);
+
+	if (!parser.ok) {
+		return 0;
+	}
+
+	match = nodeNew(dfa, NODE_MATCH);
+	dfa->nodes[match].id = id;
+	dfa->nodes[f.end].out = match;
+
+	dfa->starts[dfa->nStarts++] = f.start;
+	return 1;
+}
+
+
+#pragma mark -
+#pragma mark DFA construction
+
+
+static int
+intCompare(const void *a, const void *b)
+{
+	int	i	= *(const int *)a;
+	int	j	= *(const int *)b;
+
+	return (i < j) ? -1 : ((i > j) ? 1 : 0);
+}
+
+
+/*
+ * add the epsilon closure of NFA node "n" to the (scratch) list of
+ * set/match nodes.
+ */
+static void
+closureAdd(struct __dfa *dfa, int n, int *nList)
+{
+	int	sp	= 0;
+
+	dfa->stack[sp++] = n;
+	while (sp > 0) {
+		dfaNode	*node;
+
+		n = dfa->stack[--sp];
+		if ((n < 0) || (dfa->mark[n] == dfa->markGen)) {
+			continue;
+		}
+		dfa->mark[n] = dfa->markGen;
+
+		node = &dfa->nodes[n];
+		if (node->type == NODE_EPSILON) {
+			dfa->stack[sp++] = node->out;
+			dfa->stack[sp++] = node->out2;
+		} else {
+			dfa->scratch[(*nList)++] = n;
+		}
+	}
+
+	return;
+}
+
+
+static void
+stateFlush(struct __dfa *dfa)
+{
+	int	i;
+
+	for (i = 0; i < dfa->nStates; i++) {
+		free(dfa->states[i].nodes);
+		free(dfa->states[i].matches);
+	}
+	dfa->nStates = 0;
+	for (i = 0; i < dfa->nHashHeads; i++) {
+		dfa->hashHeads[i] = -1;
+	}
+	dfa->startState = -1;
+	return;
+}
+
+
+/*
+ * returns the DFA state for the (scratch) list of NFA nodes, creating a
+ * new state if needed.
+ */
+static int
+stateIntern(struct __dfa *dfa, int nList, int *flushed)
+{
+	uint32_t	hash	= 2166136261U;
+	int		i;
+	int		s;
+	dfaState	*state;
+
+	qsort(dfa->scratch, nList, sizeof(int), intCompare);
+	for (i = 0; i < nList; i++) {
+		hash = (hash ^ (uint32_t)dfa->scratch[i]) * 16777619U;
+	}
+
+	for (s = dfa->hashHeads[hash % dfa->nHashHeads]; s != -1; s = dfa->states[s].hashNext) {
+		state = &dfa->states[s];
+		if ((state->hash == hash) &&
+		    (state->nNodes == nList) &&
+		    (memcmp(state->nodes, dfa->scratch, nList * sizeof(int)) == 0)) {
+			return s;
+		}
+	}
+
+	if (dfa->nStates >= DFA_MAX_STATES) {
+		stateFlush(dfa);
+		*flushed = 1;
+	}
+
+	if (dfa->nStates >= dfa->maxStates) {
+		dfa->maxStates = (dfa->maxStates > 0) ? dfa->maxStates * 2 : 16;
+		dfa->states = reallocf(dfa->states, dfa->maxStates * sizeof(dfaState));
+	}
+
+	s = dfa->nStates++;
+	state = &dfa->states[s];
+	state->nNodes   = nList;
+	state->nodes    = malloc((nList > 0 ? nList : 1) * sizeof(int));
+	memcpy(state->nodes, dfa->scratch, nList * sizeof(int));
+	state->nMatches = 0;
+	state->matches  = NULL;
+	for (i = 0; i < nList; i++) {
+		dfaNode	*node	= &dfa->nodes[state->nodes[i]];
+
+		if (node->type == NODE_MATCH) {
+			state->matches = reallocf(state->matches, (state->nMatches + 1) * sizeof(int));
+			state->matches[state->nMatches++] = node->id;
+		}
+	}
+	for (i = 0; i < 256; i++) {
+		state->next[i] = DFA_UNKNOWN;
+	}
+	state->hash = hash;
+	state->hashNext = dfa->hashHeads[hash % dfa->nHashHeads];
+	dfa->hashHeads[hash % dfa->nHashHeads] = s;
+
+	return s;
+}
+
+
+static int
+stateStart(struct __dfa *dfa)
+{
+	int	flushed	= 0;
+	int	i;
+	int	nList	= 0;
+
+	if (dfa->startState == -1) {
+		dfa->markGen++;
+		for (i = 0; i < dfa->nStarts; i++) {
+			closureAdd(dfa, dfa->starts[i], &nList);
+		}
+		dfa->startState = stateIntern(dfa, nList, &flushed);
+	}
+
+	return dfa->startState;
+}
+
+
+static int
+stateNext(struct __dfa *dfa, int s, unsigned char c)
+{
+	int		flushed	= 0;
+	int		i;
+	int		n;
+	int		nList	= 0;
+	dfaState	*state	= &dfa->states[s];
+
+	n = state->next[c];
+	if (n != DFA_UNKNOWN) {
+		return n;
+	}
+
+	dfa->markGen++;
+	for (i = 0; i < state->nNodes; i++) {
+		dfaNode	*node	= &dfa->nodes[state->nodes[i]];
+
+		if ((node->type == NODE_SET) && setContains(&dfa->sets[node->set], c)) {
+			closureAdd(dfa, node->out, &nList);
+		}
+	}
+
+	n = stateIntern(dfa, nList, &flushed);
+	if (!flushed) {
+		dfa->states[s].next[c] = n;
+	}
+	return n;
+}
+
+
+#pragma mark -
+#pragma mark Public API
+
+
+__private_extern__
+dfaRef
+dfaCreate(const char * const *patterns, int nPatterns, int *unsupported)
+{
+	struct __dfa	*dfa;
+	int		i;
+
+	dfa = calloc(1, sizeof(struct __dfa));
+	dfa->starts = malloc((nPatterns > 0 ? nPatterns : 1) * sizeof(int));
+	for (i = 0; i < nPatterns; i++) {
+		if (!compilePattern(dfa, patterns[i], i)) {
+			if (unsupported != NULL) {
+				*unsupported = i;
+			}
+			dfaRelease(dfa);
+			return NULL;
+		}
+	}
+
+	dfa->mark    = calloc(dfa->nNodes + 1, sizeof(int));
+	dfa->stack   = malloc((2 * dfa->nNodes + 1) * sizeof(int));
+	dfa->scratch = malloc((dfa->nNodes + 1) * sizeof(int));
+
+	dfa->nHashHeads = 64;
+	dfa->hashHeads  = malloc(dfa->nHashHeads * sizeof(int));
+	for (i = 0; i < dfa->nHashHeads; i++) {
+		dfa->hashHeads[i] = -1;
+	}
+	dfa->startState = -1;
+
+	return dfa;
+}
+
+
+__private_extern__
+int
+dfaMatch(dfaRef dfa, const char *str, int *matches, int maxMatches)
+{
+	int		i;
+	int		s;
+	dfaState	*state;
+
+	s = stateStart(dfa);
+	for (; *str != '\0'; str++) {
+		s = stateNext(dfa, s, (unsigned char)*str);
+		if (dfa->states[s].nNodes == 0) {
+			/* if no possible match */
+			return 0;
+		}
+	}
+
+	state = &dfa->states[s];
+	for (i = 0; (i < state->nMatches) && (i < maxMatches); i++) {
+		matches[i] = state->matches[i];
+	}
+
+	return state->nMatches;
+}
+
+
+__private_extern__
+int
+dfaGetStateCount(dfaRef dfa)
+{
+	return dfa->nStates;
+}
+
+
+__private_extern__
+void
+dfaRelease(dfaRef dfa)
+{
+	stateFlush(dfa);
+	free(dfa->states);
+	free(dfa->hashHeads);
+	free(dfa->nodes);
+	free(dfa->sets);
+	free(dfa->starts);
+	free(dfa->mark);
+	free(dfa->stack);
+	free(dfa->scratch);
+	free(dfa);
+	return;
+}
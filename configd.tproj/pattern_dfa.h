@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#ifndef _S_PATTERN_DFA_H
+#define _S_PATTERN_DFA_H
+
+#include <sys/cdefs.h>
+
+
+/*
+ * pattern_dfa
+ *
+ * A matching engine for the restricted subset of POSIX extended regular
+ * expressions that are commonly used for dynamic store notification keys
+ * (literal characters, escaped meta-characters, ".", bracket expressions,
+ * the "*", "+", and "?" repetition operators, and parenthesized groups with
+ * alternation).  Patterns must be anchored at both ends ("^...$").
+ *
+ * One or more patterns are compiled into a single NFA that is lazily
+ * converted into a DFA as keys are matched.  A key is then matched against
+ * all of the patterns in a single pass.  Any pattern that uses a construct
+ * not supported by the engine (e.g. bounded repetition, character classes,
+ * back-references, or un-anchored alternation) is rejected so that the
+ * caller can fall back to regcomp()/regexec().
+ *
+ * Note: the engine is not thread-safe (matching updates the DFA cache)
+ *       and does not depend on CoreFoundation.
+ */
+
+typedef struct __dfa	*dfaRef;
+
+__BEGIN_DECLS
+
+/*
+ * dfaCreate
+ *   compiles the provided patterns.  Returns NULL if any of the patterns
+ *   are not supported (with the index of the first unsupported pattern
+ *   returned in "unsupported").
+ */
+dfaRef		dfaCreate		(const char * const	*patterns,
+					 int			nPatterns,
+					 int			*unsupported);
+
+/*
+ * dfaMatch
+ *   matches a (NUL terminated) string against the compiled patterns and
+ *   returns the number of matching patterns.  The indices of (up to
+ *   "maxMatches") matching patterns are returned in "matches".
+ */
+int		dfaMatch		(dfaRef			dfa,
+					 const char		*str,
+					 int			*matches,
+					 int			maxMatches);
+
+int		dfaGetStateCount	(dfaRef			dfa);
+
+void		dfaRelease		(dfaRef			dfa);
+
+__END_DECLS
+
+#endif	/* !_S_PATTERN_DFA_H */
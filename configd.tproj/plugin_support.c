@@ -48,6 +48,7 @@
 
 #include "configd.h"
 #include "configd_server.h"
+#include "trace.h"
 #include <SystemConfiguration/SCDPlugin.h>
 #include "SCNetworkReachabilityInternal.h"
 void	_SCDPluginExecInit();
@@ -185,23 +186,15 @@ static const builtin builtin_plugins[] = {
 
 #ifdef	DEBUG
 static void
-traceBundle(const char *op, CFBundleRef bundle)
+traceBundle(uint32_t event, CFBundleRef bundle)
 {
-	if (_configd_trace != NULL) {
-		if (bundle != NULL) {
-			CFStringRef	bundleID	= CFBundleGetIdentifier(bundle);
-
-			SCTrace(TRUE, _configd_trace,
-				CFSTR("bundle  : %s %@\n"),
-				op,
-				bundleID);
-		} else {
-			SCTrace(TRUE, _configd_trace,
-				CFSTR("bundle  : %s\n"),
-				op);
-		}
-	}
-
+	traceRecordOp(kTraceOpPlugin,
+		      kTraceFlagInternal,
+		      MACH_PORT_NULL,
+		      (bundle != NULL) ? CFBundleGetIdentifier(bundle) : NULL,
+		      kSCStatusOK,
+		      traceStart(),
+		      event);
 	return;
 }
 #endif	/* DEBUG */
@@ -428,7 +421,7 @@ loadBundle(const void *value, void *context) {
 		SCLog(TRUE, LOG_DEBUG, CFSTR("loading %@"), bundleID);
 
 #ifdef	DEBUG
-		traceBundle("loading", bundleInfo->bundle);
+		traceBundle(kTracePluginLoading, bundleInfo->bundle);
 #endif	/* DEBUG */
 
 		if (!CFBundleLoadExecutableAndReturnError(bundleInfo->bundle, &error)) {
@@ -484,7 +477,7 @@ callLoadFunction(const void *value, void *context) {
 	}
 
 #ifdef	DEBUG
-	traceBundle("calling load() for", bundleInfo->bundle);
+	traceBundle(kTracePluginLoad, bundleInfo->bundle);
 #endif	/* DEBUG */
 
 	(*bundleInfo->load)(bundleInfo->bundle, bundleInfo->verbose);
@@ -530,7 +523,7 @@ callStartFunction(const void *value, void *context) {
 	bundleName[len] = '\0';
 
 #ifdef	DEBUG
-	traceBundle("calling start() for", bundleInfo->bundle);
+	traceBundle(kTracePluginStart, bundleInfo->bundle);
 #endif	/* DEBUG */
 
 	(*bundleInfo->start)(bundleName, bundlePath);
@@ -557,7 +550,7 @@ callPrimeFunction(const void *value, void *context) {
 	}
 
 #ifdef	DEBUG
-	traceBundle("calling prime() for", bundleInfo->bundle);
+	traceBundle(kTracePluginPrime, bundleInfo->bundle);
 #endif	/* DEBUG */
 
 	(*bundleInfo->prime)();
@@ -798,7 +791,7 @@ timerCallback(CFRunLoopTimerRef timer, void *info)
 		return;
 	}
 
-	traceBundle("the [plugin] CFRunLoop is waiting...", NULL);
+	traceBundle(kTracePluginWaiting, NULL);
 	return;
 }
 #endif	/* DEBUG */
@@ -1053,7 +1046,7 @@ plugin_exec(void *arg)
 	}
 
 #ifdef	DEBUG
-	traceBundle("before loading any plugins", NULL);
+	traceBundle(kTracePluginBeforeLoad, NULL);
 #endif	/* DEBUG */
 
 	/*
@@ -1135,7 +1128,7 @@ plugin_exec(void *arg)
 #endif	/* DEBUG */
 
 #ifdef	DEBUG
-	traceBundle("about to start plugin CFRunLoop", NULL);
+	traceBundle(kTracePluginRunLoop, NULL);
 #endif	/* DEBUG */
 
 	/*
@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+/*
+ * request statistics
+ *
+ * Each request (by message ID) is counted, along with the bytes received
+ * and sent (including out-of-line data) and the time taken to process
+ * and reply.  Times are accumulated in a log-bucketed histogram (as with
+ * HdrHistogram) : each power of 2 (nsecs) is split into REQUEST_STATS_SUB
+ * linear buckets, so any value is known to within 1/REQUEST_STATS_SUB of
+ * the value with a fixed (and small) number of counters.
+ *
+ * Requests may be processed on the server thread and on the reader
+ * threads so all of the counters are updated atomically.
+ *
+ * Each request is also charged (by type) to the session it was received
+ * on and, every REQUEST_STATS_SUMMARY seconds, the sessions with the most
+ * server time (over the interval) are published in the store (see
+ * REQUEST_STATS_SUMMARY_KEY).
+ */
+
+#include "configd.h"
+#include "configd_server.h"
+#include "admission.h"
+#include "request_stats.h"
+#include "session.h"
+
+#include <mach/mach_time.h>
+#include <libkern/OSAtomic.h>
+
+/* MiG generated externals */
+extern struct mig_subsystem	_config_subsystem;
+
+
+#define	REQUEST_STATS_SUB_BITS	3
+#define	REQUEST_STATS_SUB	(1 << REQUEST_STATS_SUB_BITS)
+#define	REQUEST_STATS_MAX_BITS	40		/* ~18 minutes */
+#define	REQUEST_STATS_BUCKETS	((REQUEST_STATS_MAX_BITS - REQUEST_STATS_SUB_BITS + 1) * REQUEST_STATS_SUB)
+
+#define	REQUEST_STATS_SESSIONS		10	/* # of sessions reported */
+#define	REQUEST_STATS_SUMMARY		60.0	/* seconds */
+#define	REQUEST_STATS_SUMMARY_KEY	CFSTR("State:/configd/Sessions")
+
+/* the request names and types (by message ID offset from the subsystem base) */
+static const struct {
+	const char	*name;
+	requestType	type;
+} requestNames[]	= {
+	{ "configopen",		kRequestTypeOther },	/*  0 */
+	{ NULL,			kRequestTypeOther },	/*  1 : was configclose */
+	{ NULL,			kRequestTypeOther },	/*  2 : was configlock */
+	{ NULL,			kRequestTypeOther },	/*  3 : was configunlock */
+	{ NULL,			kRequestTypeOther },	/*  4 */
+	{ NULL,			kRequestTypeOther },	/*  5 */
+	{ NULL,			kRequestTypeOther },	/*  6 */
+	{ NULL,			kRequestTypeOther },	/*  7 */
+	{ "configlist",		kRequestTypeRead },	/*  8 */
+	{ "configadd",		kRequestTypeWrite },	/*  9 */
+	{ "configget",		kRequestTypeRead },	/* 10 */
+	{ "configset",		kRequestTypeWrite },	/* 11 */
+	{ "configremove",	kRequestTypeWrite },	/* 12 */
+	{ NULL,			kRequestTypeOther },	/* 13 : was configtouch */
+	{ "configadd_s",	kRequestTypeWrite },	/* 14 */
+	{ "confignotify",	kRequestTypeWrite },	/* 15 */
+	{ "configget_m",	kRequestTypeRead },	/* 16 */
+	{ "configset_m",	kRequestTypeWrite },	/* 17 */
+	{ "notifyadd",		kRequestTypeWatch },	/* 18 */
+	{ "notifyremove",	kRequestTypeWatch },	/* 19 */
+	{ "notifychanges",	kRequestTypeWatch },	/* 20 */
+	{ "notifyviaport",	kRequestTypeWatch },	/* 21 */
+	{ "notifyviafd",	kRequestTypeWatch },	/* 22 */
+	{ "notifyviasignal",	kRequestTypeWatch },	/* 23 */
+	{ "notifycancel",	kRequestTypeWatch },	/* 24 */
+	{ "notifyset",		kRequestTypeWatch },	/* 25 */
+	{ "configget_m_gen",	kRequestTypeRead },	/* 26 */
+	{ "configget_m_since",	kRequestTypeRead },	/* 27 */
+	{ NULL,			kRequestTypeOther },	/* 28 */
+	{ "snapshot",		kRequestTypeOther },	/* 29 */
+	{ "notifyviaring",	kRequestTypeWatch },	/* 30 */
+	{ "notifyoptions",	kRequestTypeWatch },	/* 31 */
+	{ "notifyprops",	kRequestTypeWatch },	/* 32 */
+	{ "snapshotstream",	kRequestTypeOther },	/* 33 */
+	{ "configstats",	kRequestTypeOther },	/* 34 */
+};
+
+#define	N_REQUESTS	(sizeof(requestNames) / sizeof(requestNames[0]))
+#define	REQUEST_OTHER	N_REQUESTS	/* any other message (e.g. a port notification) */
+
+typedef struct {
+	volatile int64_t	count;
+	volatile int64_t	bytesIn;
+	volatile int64_t	bytesOut;
+	volatile int64_t	time;		/* nsecs */
+	volatile int64_t	timeMax;	/* nsecs */
+	volatile int64_t	histogram[REQUEST_STATS_BUCKETS];
+} requestStats;
+
+static requestStats			stats[N_REQUESTS + 1];
+static CFAbsoluteTime			statsSince	= 0;
+static mach_timebase_info_data_t	timebase	= { 0, 0 };
+
+/* the session used to publish the periodic summary */
+static SCDynamicStoreRef		summaryStore	= NULL;
+static CFAbsoluteTime			summarySince	= 0;
+
+
+static int
+bucketIndex(uint64_t nsecs)
+{
+	int	e;
+	int	index;
+
+	if (nsecs < REQUEST_STATS_SUB) {
+		return (int)nsecs;
+	}
+
+	e = 63 - __builtin_clzll(nsecs);	/* floor(log2(nsecs)) */
+	index = ((e - REQUEST_STATS_SUB_BITS + 1) * REQUEST_STATS_SUB) +
+		(int)((nsecs >> (e - REQUEST_STATS_SUB_BITS)) & (REQUEST_STATS_SUB - 1));
+	return (index < REQUEST_STATS_BUCKETS) ? index : REQUEST_STATS_BUCKETS - 1;
+}
+
+
+static uint64_t
+bucketLimit(int index)
+{
+	int	group;
+
+	/* returns the smallest value in the bucket */
+	if (index < REQUEST_STATS_SUB) {
+		return (uint64_t)index;
+	}
+
+	group = index / REQUEST_STATS_SUB;
+	return (uint64_t)(REQUEST_STATS_SUB + (index % REQUEST_STATS_SUB)) << (group - 1);
+}
+
+
+static void
+summaryTimer(CFRunLoopTimerRef timer, void *info)
+{
+	CFDataRef		data;
+	CFMutableDictionaryRef	dict;
+	CFArrayRef		sessions;
+	CFDateRef		since;
+
+	sessions = copySessionUsage(REQUEST_STATS_SESSIONS, TRUE);
+	if (CFArrayGetCount(sessions) == 0) {
+		/* if nothing to report */
+		CFRelease(sessions);
+		goto done;
+	}
+
+	dict = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+	since = CFDateCreate(NULL, summarySince);
+	CFDictionarySetValue(dict, CFSTR("Since"), since);
+	CFRelease(since);
+	CFDictionarySetValue(dict, CFSTR("Sessions"), sessions);
+	CFRelease(sessions);
+
+	if (summaryStore == NULL) {
+		(void) __SCDynamicStoreOpen(&summaryStore, CFSTR("configd statistics"));
+	}
+	if (_SCSerialize(dict, &data, NULL, NULL)) {
+		(void) __SCDynamicStoreSetValue(summaryStore, REQUEST_STATS_SUMMARY_KEY, data, TRUE);
+		__SCDynamicStorePush();
+		CFRelease(data);
+	}
+	CFRelease(dict);
+
+    done :
+
+	summarySince = CFAbsoluteTimeGetCurrent();
+	return;
+}
+
+
+__private_extern__
+void
+requestStatsInit(void)
+{
+	CFRunLoopTimerRef	timer;
+
+	(void) mach_timebase_info(&timebase);
+	statsSince = CFAbsoluteTimeGetCurrent();
+	summarySince = statsSince;
+
+	/* start the periodic summary of the per-session usage */
+	timer = CFRunLoopTimerCreate(NULL,
+				     statsSince + REQUEST_STATS_SUMMARY,
+				     REQUEST_STATS_SUMMARY,
+				     0,
+				     0,
+				     summaryTimer,
+				     NULL);
+	CFRunLoopAddTimer(CFRunLoopGetCurrent(), timer, kCFRunLoopDefaultMode);
+	CFRelease(timer);
+
+	return;
+}
+
+
+__private_extern__
+sessionUsageRef
+sessionUsageCreate(void)
+{
+	sessionUsageRef	usage;
+
+	usage = calloc(1, sizeof(sessionUsage));
+	usage->refs = 1;
+	return usage;
+}
+
+
+__private_extern__
+sessionUsageRef
+sessionUsageRetain(sessionUsageRef usage)
+{
+	if (usage != NULL) {
+		(void) OSAtomicIncrement32Barrier(&usage->refs);
+	}
+	return usage;
+}
+
+
+__private_extern__
+void
+sessionUsageRelease(sessionUsageRef usage)
+{
+	if ((usage != NULL) && (OSAtomicDecrement32Barrier(&usage->refs) == 0)) {
+		free(usage);
+	}
+	return;
+}
+
+
+__private_extern__
+size_t
+requestStatsMessageSize(mach_msg_header_t *msg)
+{
+	mach_msg_body_t		*body;
+	mach_msg_descriptor_t	*desc;
+	mach_msg_size_t		i;
+	size_t			size	= msg->msgh_size;
+
+	if (!(msg->msgh_bits & MACH_MSGH_BITS_COMPLEX)) {
+		return size;
+	}
+
+	/* add any out-of-line data */
+	body = (mach_msg_body_t *)(void *)(msg + 1);
+	desc = (mach_msg_descriptor_t *)(void *)(body + 1);
+	for (i = 0; i < body->msgh_descriptor_count; i++) {
+		switch (desc->type.type) {
+			case MACH_MSG_OOL_DESCRIPTOR :
+			case MACH_MSG_OOL_VOLATILE_DESCRIPTOR :
+				size += desc->out_of_line.size;
+				desc = (mach_msg_descriptor_t *)(void *)((uint8_t *)desc + sizeof(mach_msg_ool_descriptor_t));
+				break;
+			case MACH_MSG_OOL_PORTS_DESCRIPTOR :
+				desc = (mach_msg_descriptor_t *)(void *)((uint8_t *)desc + sizeof(mach_msg_ool_ports_descriptor_t));
+				break;
+			default :
+				desc = (mach_msg_descriptor_t *)(void *)((uint8_t *)desc + sizeof(mach_msg_port_descriptor_t));
+				break;
+		}
+	}
+
+	return size;
+}
+
+
+__private_extern__
+requestType
+requestStatsType(mach_msg_id_t msgid)
+{
+	mach_msg_id_t	i;
+
+	i = msgid - _config_subsystem.start;
+	if ((i < 0) || (i >= (mach_msg_id_t)N_REQUESTS)) {
+		return kRequestTypeOther;
+	}
+
+	return requestNames[i].type;
+}
+
+
+__private_extern__
+void
+requestStatsRecord(mach_msg_id_t msgid, uint64_t start, size_t bytesIn, size_t bytesOut, sessionUsageRef usage)
+{
+	uint64_t	elapsed;
+	mach_msg_id_t	i;
+	int64_t		max;
+	requestStats	*reqStats;
+
+	elapsed = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+
+	i = msgid - _config_subsystem.start;
+	if ((i < 0) || (i >= (mach_msg_id_t)N_REQUESTS)) {
+		i = REQUEST_OTHER;
+	}
+	reqStats = &stats[i];
+
+	(void) OSAtomicIncrement64(&reqStats->count);
+	(void) OSAtomicAdd64((int64_t)bytesIn, &reqStats->bytesIn);
+	(void) OSAtomicAdd64((int64_t)bytesOut, &reqStats->bytesOut);
+	(void) OSAtomicAdd64((int64_t)elapsed, &reqStats->time);
+	(void) OSAtomicIncrement64(&reqStats->histogram[bucketIndex(elapsed)]);
+	do {
+		max = reqStats->timeMax;
+	} while (((int64_t)elapsed > max) &&
+		 !OSAtomicCompareAndSwap64(max, (int64_t)elapsed, &reqStats->timeMax));
+
+	if (usage != NULL) {
+		requestType	type;
+
+		type = (i != REQUEST_OTHER) ? requestNames[i].type : kRequestTypeOther;
+		(void) OSAtomicIncrement64(&usage->requests[type]);
+		(void) OSAtomicAdd64((int64_t)bytesIn, &usage->bytesIn);
+		(void) OSAtomicAdd64((int64_t)bytesOut, &usage->bytesOut);
+		(void) OSAtomicAdd64((int64_t)elapsed, &usage->time);
+	}
+
+	return;
+}
+
+
+static void
+addNumber(CFMutableDictionaryRef dict, CFStringRef key, int64_t val)
+{
+	CFNumberRef	num;
+
+	num = CFNumberCreate(NULL, kCFNumberSInt64Type, &val);
+	CFDictionarySetValue(dict, key, num);
+	CFRelease(num);
+	return;
+}
+
+
+static CFDictionaryRef
+copyRequestStats(requestStats *reqStats)
+{
+	CFMutableDictionaryRef	dict;
+	CFMutableArrayRef	histogram;
+	int			i;
+
+	dict = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+	addNumber(dict, CFSTR("Count"), reqStats->count);
+	addNumber(dict, CFSTR("BytesIn"), reqStats->bytesIn);
+	addNumber(dict, CFSTR("BytesOut"), reqStats->bytesOut);
+	addNumber(dict, CFSTR("Time"), reqStats->time);
+	addNumber(dict, CFSTR("TimeMax"), reqStats->timeMax);
+
+	/* the histogram, as [ limit, count ] pairs for the buckets in use */
+	histogram = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	for (i = 0; i < REQUEST_STATS_BUCKETS; i++) {
+		int64_t		bucket[2];
+		CFNumberRef	nums[2];
+		CFArrayRef	pair;
+
+		if (reqStats->histogram[i] == 0) {
+			continue;
+		}
+
+		bucket[0] = (int64_t)bucketLimit(i + 1);
+		bucket[1] = reqStats->histogram[i];
+		nums[0] = CFNumberCreate(NULL, kCFNumberSInt64Type, &bucket[0]);
+		nums[1] = CFNumberCreate(NULL, kCFNumberSInt64Type, &bucket[1]);
+		pair = CFArrayCreate(NULL, (const void **)nums, 2, &kCFTypeArrayCallBacks);
+		CFArrayAppendValue(histogram, pair);
+		CFRelease(pair);
+		CFRelease(nums[0]);
+		CFRelease(nums[1]);
+	}
+	CFDictionarySetValue(dict, CFSTR("Histogram"), histogram);
+	CFRelease(histogram);
+
+	return dict;
+}
+
+
+__private_extern__
+CFDictionaryRef
+requestStatsCopy(Boolean reset)
+{
+	CFMutableDictionaryRef	dict;
+	CFDictionaryRef		admission;
+	CFMutableDictionaryRef	requests;
+	CFArrayRef		sessions;
+	CFDateRef		since;
+	size_t			i;
+
+	requests = CFDictionaryCreateMutable(NULL,
+					     0,
+					     &kCFTypeDictionaryKeyCallBacks,
+					     &kCFTypeDictionaryValueCallBacks);
+	for (i = 0; i <= N_REQUESTS; i++) {
+		CFDictionaryRef	reqDict;
+		CFStringRef	reqName;
+
+		if (stats[i].count == 0) {
+			continue;
+		}
+
+		if (i == REQUEST_OTHER) {
+			reqName = CFStringCreateWithCString(NULL, "(other)", kCFStringEncodingASCII);
+		} else if (requestNames[i].name != NULL) {
+			reqName = CFStringCreateWithCString(NULL, requestNames[i].name, kCFStringEncodingASCII);
+		} else {
+			reqName = CFStringCreateWithFormat(NULL, NULL, CFSTR("(%d)"), (int)i);
+		}
+		reqDict = copyRequestStats(&stats[i]);
+		CFDictionarySetValue(requests, reqName, reqDict);
+		CFRelease(reqDict);
+		CFRelease(reqName);
+	}
+
+	dict = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+	CFDictionarySetValue(dict, CFSTR("Requests"), requests);
+	CFRelease(requests);
+	sessions = copySessionUsage(REQUEST_STATS_SESSIONS, FALSE);
+	CFDictionarySetValue(dict, CFSTR("Sessions"), sessions);
+	CFRelease(sessions);
+	admission = admissionCopyStatistics();
+	if (admission != NULL) {
+		CFDictionarySetValue(dict, CFSTR("Admission"), admission);
+		CFRelease(admission);
+	}
+	since = CFDateCreate(NULL, statsSince);
+	CFDictionarySetValue(dict, CFSTR("Since"), since);
+	CFRelease(since);
+
+	if (reset) {
+		/* start over (requests being processed on reader threads may be lost) */
+		bzero(stats, sizeof(stats));
+		statsSince = CFAbsoluteTimeGetCurrent();
+	}
+
+	return dict;
+}
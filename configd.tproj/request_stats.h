@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_REQUEST_STATS_H
+#define _S_REQUEST_STATS_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+
+/* the types of request (for the per-session accounting) */
+typedef enum {
+	kRequestTypeRead	= 0,	/* get, get multiple, list */
+	kRequestTypeWrite,		/* add, set, set multiple, remove, notify */
+	kRequestTypeWatch,		/* watched keys/patterns, notification requests */
+	kRequestTypeOther,
+	kRequestTypes
+} requestType;
+
+/*
+ * per-session resource usage
+ *
+ * The counters are shared with the reader threads (which hold a reference
+ * while a request is being processed) and are updated atomically.  The
+ * "summary" values (as of the last periodic summary) are only referenced
+ * from the server thread.
+ */
+typedef struct sessionUsage {
+	volatile int32_t	refs;
+	volatile int64_t	requests[kRequestTypes];
+	volatile int64_t	bytesIn;
+	volatile int64_t	bytesOut;
+	volatile int64_t	time;		/* nsecs */
+
+	int64_t			summaryRequests[kRequestTypes];
+	int64_t			summaryBytesIn;
+	int64_t			summaryBytesOut;
+	int64_t			summaryTime;
+	uint64_t		summaryNotifications;
+} sessionUsage, *sessionUsageRef;
+
+__BEGIN_DECLS
+
+/*
+ * requestStatsInit
+ *   starts collecting request statistics (and the periodic summary of
+ *   the per-session usage).  Must be called (from the server thread)
+ *   before any requests are received.
+ */
+void		requestStatsInit	(void);
+
+/*
+ * requestStatsMessageSize
+ *   returns the size of a message, including any out-of-line data.
+ */
+size_t		requestStatsMessageSize	(mach_msg_header_t	*msg);
+
+/*
+ * requestStatsType
+ *   returns the type of request (read, write, ...) for a message ID.
+ */
+requestType	requestStatsType	(mach_msg_id_t		msgid);
+
+/*
+ * requestStatsRecord
+ *   accounts for a request (started at "start", a mach_absolute_time())
+ *   and, if not NULL, charges it to the session "usage".  May be called
+ *   from any thread.
+ */
+void		requestStatsRecord	(mach_msg_id_t		msgid,
+					 uint64_t		start,
+					 size_t			bytesIn,
+					 size_t			bytesOut,
+					 sessionUsageRef	usage);
+
+/*
+ * sessionUsageCreate, sessionUsageRetain, sessionUsageRelease
+ *   manage the (reference counted) per-session usage.
+ */
+sessionUsageRef	sessionUsageCreate	(void);
+
+sessionUsageRef	sessionUsageRetain	(sessionUsageRef	usage);
+
+void		sessionUsageRelease	(sessionUsageRef	usage);
+
+/*
+ * requestStatsCopy
+ *   returns a dictionary with the statistics for each type of request
+ *   and the sessions using the most server time (see
+ *   SCDynamicStoreCopyStatistics), optionally starting over.
+ */
+CFDictionaryRef	requestStatsCopy	(Boolean		reset);
+
+__END_DECLS
+
+#endif /* !_S_REQUEST_STATS_H */
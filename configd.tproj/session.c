@@ -35,7 +35,9 @@
 #include "configd.h"
 #include "configd_server.h"
 #include "pattern.h"
+#include "request_stats.h"
 #include "session.h"
+#include "trace.h"
 
 #include <unistd.h>
 #include <bsm/libbsm.h>
@@ -50,6 +52,11 @@
 static serverSessionRef	*sessions	= NULL;
 static int		nSessions	= 0;	/* # of allocated sessions */
 static int		lastSession	= -1;	/* # of last used session */
+static int		freeSession	= 1;	/* # of first (possibly) empty slot */
+
+/* session lookup (mach port --> slot, signal task port --> slot) */
+static CFMutableDictionaryRef	sessionsByPort	= NULL;
+static CFMutableDictionaryRef	sessionsByTask	= NULL;
 
 /* CFMachPortInvalidation runloop */
 static CFRunLoopRef	sessionRunLoop	= NULL;
@@ -58,6 +65,26 @@ static CFRunLoopRef	sessionRunLoop	= NULL;
 static serverSessionRef	temp_session	= NULL;
 
 
+static __inline__ const void *
+portKey(mach_port_t port)
+{
+	return (const void *)(uintptr_t)port;
+}
+
+
+static int
+sessionSlot(CFDictionaryRef index, mach_port_t port)
+{
+	const void	*slot;
+
+	if ((index == NULL) || !CFDictionaryGetValueIfPresent(index, portKey(port), &slot)) {
+		return -1;
+	}
+
+	return (int)(intptr_t)slot;
+}
+
+
 __private_extern__
 serverSessionRef
 getSession(mach_port_t server)
@@ -70,28 +97,67 @@ getSession(mach_port_t server)
 	}
 
 	/* look for matching session (note: slot 0 is the "server" port) */
-	for (i = 1; i <= lastSession; i++) {
-		serverSessionRef	thisSession = sessions[i];
+	i = sessionSlot(sessionsByPort, server);
+	if (i > 0) {
+		/* we've seen this server before */
+		return sessions[i];
+	}
 
-		if (thisSession == NULL) {
-			/* found an empty slot, skip it */
-			continue;
-		}
+	i = sessionSlot(sessionsByTask, server);
+	if (i > 0) {
+		/* we've seen this task port before */
+		return sessions[i];
+	}
 
-		if (thisSession->key == server) {
-			/* we've seen this server before */
-			return thisSession;
-		}
+	/* no sessions available */
+	return NULL;
+}
+
+
+__private_extern__
+void
+setSessionSignalTask(SCDynamicStoreRef store, task_t task)
+{
+	int				i;
+	task_t				oldTask;
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)store;
+
+	oldTask = storePrivate->notifySignalTask;
+	storePrivate->notifySignalTask = task;
 
-		if ((thisSession->store != NULL) &&
-		    (((SCDynamicStorePrivateRef)thisSession->store)->notifySignalTask == server)) {
-			/* we've seen this task port before */
-			return thisSession;
+	i = sessionSlot(sessionsByPort, storePrivate->server);
+	if (i <= 0) {
+		/* if not a client session */
+		return;
+	}
+
+	if ((oldTask != TASK_NULL) && (sessionSlot(sessionsByTask, oldTask) == i)) {
+		int	j;
+
+		/*
+		 * remove the task port from the index and, since multiple
+		 * sessions (from the same task) may have requested signal
+		 * notifications, check if another session is using it.
+		 */
+		CFDictionaryRemoveValue(sessionsByTask, portKey(oldTask));
+		for (j = 1; j <= lastSession; j++) {
+			serverSessionRef	thisSession	= sessions[j];
+
+			if ((j != i) &&
+			    (thisSession != NULL) &&
+			    (thisSession->store != NULL) &&
+			    (((SCDynamicStorePrivateRef)thisSession->store)->notifySignalTask == oldTask)) {
+				CFDictionarySetValue(sessionsByTask, portKey(oldTask), (const void *)(intptr_t)j);
+				break;
+			}
 		}
 	}
 
-	/* no sessions available */
-	return NULL;
+	if ((task != TASK_NULL) && (sessionSlot(sessionsByTask, task) <= 0)) {
+		CFDictionarySetValue(sessionsByTask, portKey(task), (const void *)(intptr_t)i);
+	}
+
+	return;
 }
 
 
@@ -154,6 +220,9 @@ addSession(mach_port_t server, CFStringRef (*copyDescription)(const void *info))
 		nSessions = 64;
 		sessions = malloc(nSessions * sizeof(serverSessionRef));
 
+		sessionsByPort = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+		sessionsByTask = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+
 		// allocate a new session for "the" server
 		newSession = calloc(1, sizeof(serverSession));
 	} else {
@@ -162,34 +231,20 @@ addSession(mach_port_t server, CFStringRef (*copyDescription)(const void *info))
 		mach_port_options_t	opts;
 #endif	// HAVE_MACHPORT_GUARDS
 
-		/* check to see if we already have an open session (note: slot 0 is the "server" port) */
-		for (i = 1; i <= lastSession; i++) {
-			serverSessionRef	thisSession	= sessions[i];
+		/* check to see if we already have an open session */
+		if (getSession(server) != NULL) {
+			/* we've seen this server (or task port) before */
+			return NULL;
+		}
 
-			if (thisSession == NULL) {
+		/* add a new session (note: slot 0 is the "server" port) */
+		for (i = freeSession; i <= lastSession; i++) {
+			if (sessions[i] == NULL) {
 				/* found an empty slot */
-				if (n < 0) {
-					/* keep track of the first [empty] slot */
-					n = i;
-				}
-
-				/* and keep looking for a matching session */
-				continue;
-			}
-
-			if (thisSession->key == server) {
-				/* we've seen this server before */
-				return NULL;
-			}
-
-			if ((thisSession->store != NULL) &&
-				   (((SCDynamicStorePrivateRef)thisSession->store)->notifySignalTask == server)) {
-				/* we've seen this task port before */
-				return NULL;
+				n = i;
+				break;
 			}
 		}
-
-		/* add a new session */
 		if (n < 0) {
 			/* if no empty slots */
 			n = ++lastSession;
@@ -199,6 +254,7 @@ addSession(mach_port_t server, CFStringRef (*copyDescription)(const void *info))
 				sessions = reallocf(sessions, (nSessions * sizeof(serverSessionRef)));
 			}
 		}
+		freeSession = n + 1;
 
 		// allocate a session for this client
 		newSession = calloc(1, sizeof(serverSession));
@@ -271,12 +327,14 @@ addSession(mach_port_t server, CFStringRef (*copyDescription)(const void *info))
 	}
 
 	sessions[n] = newSession;
+	CFDictionarySetValue(sessionsByPort, portKey(mp), (const void *)(intptr_t)n);
 	sessions[n]->key			= mp;
 //	sessions[n]->serverRunLoopSource	= NULL;
 //	sessions[n]->store			= NULL;
 	sessions[n]->callerEUID			= 1;		/* not "root" */
 	sessions[n]->callerRootAccess		= UNKNOWN;
 	sessions[n]->callerWriteEntitlement	= kCFNull;	/* UNKNOWN */
+	sessions[n]->usage			= sessionUsageCreate();
 
 	return newSession;
 }
@@ -286,80 +344,85 @@ __private_extern__
 void
 cleanupSession(mach_port_t server)
 {
-	int		i;
-
-	for (i = 1; i <= lastSession; i++) {
-		CFStringRef		sessionKey;
-		serverSessionRef	thisSession = sessions[i];
-
-		if (thisSession == NULL) {
-			/* found an empty slot, skip it */
-			continue;
-		}
+	int			i;
+	CFStringRef		sessionKey;
+	serverSessionRef	thisSession;
+
+	i = sessionSlot(sessionsByPort, server);
+	if (i <= 0) {
+		SCLog(TRUE, LOG_ERR, CFSTR("MACH_NOTIFY_NO_SENDERS w/no session, port = %d"), server);
+		__MACH_PORT_DEBUG(TRUE, "*** cleanupSession w/no session", server);
+		return;
+	}
+	thisSession = sessions[i];
 
-		if (thisSession->key == server) {
-			/*
-			 * session entry still exists.
-			 */
+	/*
+	 * session entry still exists.
+	 */
 
-			if (_configd_trace) {
-				SCTrace(TRUE, _configd_trace, CFSTR("cleanup : %5d\n"), server);
-			}
+	traceEvent(kTraceOpCleanup, 0, server, kSCStatusOK, 0);
 
-			/*
-			 * Close any open connections including cancelling any outstanding
-			 * notification requests and releasing any locks.
-			 */
-			__MACH_PORT_DEBUG(TRUE, "*** cleanupSession", server);
-			(void) __SCDynamicStoreClose(&thisSession->store);
-			__MACH_PORT_DEBUG(TRUE, "*** cleanupSession (after __SCDynamicStoreClose)", server);
+	/*
+	 * Close any open connections including cancelling any outstanding
+	 * notification requests and releasing any locks.
+	 */
+	__MACH_PORT_DEBUG(TRUE, "*** cleanupSession", server);
+	(void) __SCDynamicStoreClose(&thisSession->store);
+	__MACH_PORT_DEBUG(TRUE, "*** cleanupSession (after __SCDynamicStoreClose)", server);
 
-			/*
-			 * Our send right has already been removed. Remove our receive right.
-			 */
+	/*
+	 * Our send right has already been removed. Remove our receive right.
+	 */
 #ifdef	HAVE_MACHPORT_GUARDS
-			(void) mach_port_destruct(mach_task_self(), server, 0, thisSession);
+	(void) mach_port_destruct(mach_task_self(), server, 0, thisSession);
 #else	// HAVE_MACHPORT_GUARDS
-			(void) mach_port_mod_refs(mach_task_self(), server, MACH_PORT_RIGHT_RECEIVE, -1);
+	(void) mach_port_mod_refs(mach_task_self(), server, MACH_PORT_RIGHT_RECEIVE, -1);
 #endif	// HAVE_MACHPORT_GUARDS
 
-			/*
-			 * release any entitlement info
-			 */
-			if ((thisSession->callerWriteEntitlement != NULL) &&
-			    (thisSession->callerWriteEntitlement != kCFNull)) {
-				CFRelease(thisSession->callerWriteEntitlement);
-			}
+	/*
+	 * release any entitlement info
+	 */
+	if ((thisSession->callerWriteEntitlement != NULL) &&
+	    (thisSession->callerWriteEntitlement != kCFNull)) {
+		CFRelease(thisSession->callerWriteEntitlement);
+	}
 
-			/*
-			 * We don't need any remaining information in the
-			 * sessionData dictionary, remove it.
-			 */
-			sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), server);
-			CFDictionaryRemoveValue(sessionData, sessionKey);
-			CFRelease(sessionKey);
+	/*
+	 * release any pending (undelivered) changes
+	 */
+	if (thisSession->changedKeys != NULL) {
+		CFRelease(thisSession->changedKeys);
+		thisSession->changedKeys = NULL;
+	}
 
-			/*
-			 * get rid of the per-session structure.
-			 */
-			free(thisSession);
-			sessions[i] = NULL;
-
-			if (i == lastSession) {
-				/* we are removing the last session, update last used slot */
-				while (--lastSession > 0) {
-					if (sessions[lastSession] != NULL) {
-						break;
-					}
-				}
-			}
+	/*
+	 * We don't need any remaining information in the
+	 * sessionData dictionary, remove it.
+	 */
+	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), server);
+	CFDictionaryRemoveValue(sessionData, sessionKey);
+	CFRelease(sessionKey);
+
+	/*
+	 * get rid of the per-session structure.
+	 */
+	CFDictionaryRemoveValue(sessionsByPort, portKey(server));
+	sessionUsageRelease(thisSession->usage);
+	free(thisSession);
+	sessions[i] = NULL;
+	if (i < freeSession) {
+		freeSession = i;
+	}
 
-			return;
+	if (i == lastSession) {
+		/* we are removing the last session, update last used slot */
+		while (--lastSession > 0) {
+			if (sessions[lastSession] != NULL) {
+				break;
+			}
 		}
 	}
 
-	SCLog(TRUE, LOG_ERR, CFSTR("MACH_NOTIFY_NO_SENDERS w/no session, port = %d"), server);
-	__MACH_PORT_DEBUG(TRUE, "*** cleanupSession w/no session", server);
 	return;
 }
 
@@ -405,6 +468,45 @@ listSessions(FILE *f)
 			}
 		}
 
+		if (thisSession->deliveryCount > 0) {
+			SCPrint(TRUE, f, CFSTR("\n\t\tnotifications = %llu, latency (usec) avg = %llu, max = %llu%s"),
+				thisSession->deliveryCount,
+				thisSession->deliveryLatency / thisSession->deliveryCount / NSEC_PER_USEC,
+				thisSession->deliveryLatencyMax / NSEC_PER_USEC,
+				(thisSession->delivery != NULL) ? ", in flight" : "");
+		}
+
+		if (thisSession->usage != NULL) {
+			sessionUsageRef	usage	= thisSession->usage;
+
+			SCPrint(TRUE, f, CFSTR("\n\t\trequests read/write/watch/other = %lld/%lld/%lld/%lld, bytes in = %lld, out = %lld, time (usec) = %lld"),
+				usage->requests[kRequestTypeRead],
+				usage->requests[kRequestTypeWrite],
+				usage->requests[kRequestTypeWatch],
+				usage->requests[kRequestTypeOther],
+				usage->bytesIn,
+				usage->bytesOut,
+				usage->time / NSEC_PER_USEC);
+		}
+
+		if ((thisSession->admitDelayed > 0) ||
+		    (thisSession->admitRejected > 0) ||
+		    (thisSession->admitDeprioritized > 0)) {
+			SCPrint(TRUE, f, CFSTR("\n\t\tover budget : delayed = %llu, rejected = %llu, deprioritized = %llu%s"),
+				thisSession->admitDelayed,
+				thisSession->admitRejected,
+				thisSession->admitDeprioritized,
+				thisSession->admitSuspended ? ", suspended" : "");
+		}
+
+		if ((thisSession->notifyCoalesce > 0) || (thisSession->notifyRate > 0)) {
+			SCPrint(TRUE, f, CFSTR("\n\t\tcoalesce (msec) = %.0f, rate = %g/sec, burst = %g, held = %llu"),
+				thisSession->notifyCoalesce * 1000.0,
+				thisSession->notifyRate,
+				thisSession->notifyBurst,
+				thisSession->notifyHeld);
+		}
+
 		if (thisSession->serverPort != NULL) {
 			SCPrint(TRUE, f, CFSTR("\n\t\t%@"), thisSession->serverPort);
 		}
@@ -505,6 +607,163 @@ sessionPid(serverSessionRef session)
 }
 
 
+static void
+addNumber(CFMutableDictionaryRef dict, CFStringRef key, int64_t val)
+{
+	CFNumberRef	num;
+
+	num = CFNumberCreate(NULL, kCFNumberSInt64Type, &val);
+	CFDictionarySetValue(dict, key, num);
+	CFRelease(num);
+	return;
+}
+
+
+static CFDictionaryRef
+copyUsage(serverSessionRef session, Boolean summary)
+{
+	CFMutableDictionaryRef		dict;
+	int				i;
+	CFMutableDictionaryRef		requests;
+	static const CFStringRef	requestTypes[kRequestTypes]	= {
+						CFSTR("Read"),
+						CFSTR("Write"),
+						CFSTR("Watch"),
+						CFSTR("Other")
+					};
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)session->store;
+	sessionUsageRef			usage		= session->usage;
+
+	dict = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+	CFDictionarySetValue(dict, CFSTR("Name"), sessionName(session));
+	addNumber(dict, CFSTR("PID"), sessionPid(session));
+	addNumber(dict, CFSTR("Port"), session->key);
+
+	requests = CFDictionaryCreateMutable(NULL,
+					     0,
+					     &kCFTypeDictionaryKeyCallBacks,
+					     &kCFTypeDictionaryValueCallBacks);
+	for (i = 0; i < kRequestTypes; i++) {
+		addNumber(requests, requestTypes[i],
+			  usage->requests[i] - (summary ? usage->summaryRequests[i] : 0));
+	}
+	CFDictionarySetValue(dict, CFSTR("Requests"), requests);
+	CFRelease(requests);
+
+	addNumber(dict, CFSTR("BytesIn"), usage->bytesIn - (summary ? usage->summaryBytesIn : 0));
+	addNumber(dict, CFSTR("BytesOut"), usage->bytesOut - (summary ? usage->summaryBytesOut : 0));
+	addNumber(dict, CFSTR("Time"), usage->time - (summary ? usage->summaryTime : 0));
+	addNumber(dict, CFSTR("Notifications"),
+		  (int64_t)(session->deliveryCount - (summary ? usage->summaryNotifications : 0)));
+
+	if ((session->admitDelayed > 0) ||
+	    (session->admitRejected > 0) ||
+	    (session->admitDeprioritized > 0)) {
+		addNumber(dict, CFSTR("Delayed"), (int64_t)session->admitDelayed);
+		addNumber(dict, CFSTR("Rejected"), (int64_t)session->admitRejected);
+		addNumber(dict, CFSTR("Deprioritized"), (int64_t)session->admitDeprioritized);
+	}
+
+	if (storePrivate != NULL) {
+		addNumber(dict, CFSTR("WatchedKeys"),
+			  (storePrivate->watchedKeys != NULL) ? CFSetGetCount(storePrivate->watchedKeys) : 0);
+		addNumber(dict, CFSTR("WatchedPatterns"),
+			  (storePrivate->watchedPatterns != NULL) ? CFSetGetCount(storePrivate->watchedPatterns) : 0);
+	}
+
+	return dict;
+}
+
+
+typedef struct {
+	serverSessionRef	session;
+	int64_t			time;
+} usageEntry;
+
+
+static int
+compareUsage(const void *a, const void *b)
+{
+	const usageEntry	*ua	= (const usageEntry *)a;
+	const usageEntry	*ub	= (const usageEntry *)b;
+
+	/* most server time first */
+	if (ua->time != ub->time) {
+		return (ua->time > ub->time) ? -1 : 1;
+	}
+	return 0;
+}
+
+
+__private_extern__
+CFArrayRef
+copySessionUsage(CFIndex max, Boolean summary)
+{
+	int			i;
+	int			n	= 0;
+	CFMutableArrayRef	report;
+	usageEntry		*sorted;
+
+	report = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	if (lastSession <= 0) {
+		return report;
+	}
+
+	/* rank the sessions (note: slot 0 is the "server" port) by server time */
+	sorted = CFAllocatorAllocate(NULL, lastSession * sizeof(usageEntry), 0);
+	for (i = 1; i <= lastSession; i++) {
+		serverSessionRef	thisSession	= sessions[i];
+		sessionUsageRef		usage;
+
+		if ((thisSession == NULL) || (thisSession->usage == NULL)) {
+			continue;
+		}
+
+		usage = thisSession->usage;
+		sorted[n].session = thisSession;
+		sorted[n].time    = usage->time - (summary ? usage->summaryTime : 0);
+		n++;
+	}
+	qsort(sorted, n, sizeof(usageEntry), compareUsage);
+
+	for (i = 0; (i < n) && (CFArrayGetCount(report) < max); i++) {
+		CFDictionaryRef	dict;
+
+		if (sorted[i].time == 0) {
+			/* if no [more] sessions with any activity */
+			break;
+		}
+
+		dict = copyUsage(sorted[i].session, summary);
+		CFArrayAppendValue(report, dict);
+		CFRelease(dict);
+	}
+
+	if (summary) {
+		/* the next summary starts from here */
+		for (i = 0; i < n; i++) {
+			serverSessionRef	thisSession	= sorted[i].session;
+			sessionUsageRef		usage		= thisSession->usage;
+			int			j;
+
+			for (j = 0; j < kRequestTypes; j++) {
+				usage->summaryRequests[j] = usage->requests[j];
+			}
+			usage->summaryBytesIn       = usage->bytesIn;
+			usage->summaryBytesOut      = usage->bytesOut;
+			usage->summaryTime          = usage->time;
+			usage->summaryNotifications = thisSession->deliveryCount;
+		}
+	}
+
+	CFAllocatorDeallocate(NULL, sorted);
+	return report;
+}
+
+
 __private_extern__
 Boolean
 hasRootAccess(serverSessionRef session)
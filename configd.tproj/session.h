@@ -94,6 +94,71 @@ typedef struct {
 	 */
 	CFTypeRef		callerWriteEntitlement;
 
+	/*
+	 * keys which have changed since last call to SCDynamicStoreCopyNotifiedKeys()
+	 * (a set of the [interned] store keys, NULL if none)
+	 */
+	CFMutableSetRef		changedKeys;
+
+	/*
+	 * notification delivery (the delivery currently in flight, NULL
+	 * if none) and statistics (latency in nanoseconds)
+	 */
+	struct notifyDelivery	*delivery;
+	uint64_t		deliveryCount;
+	uint64_t		deliveryLatency;
+	uint64_t		deliveryLatencyMax;
+
+	/*
+	 * notification options (SCDynamicStoreSetNotificationOptions)
+	 *
+	 *   notifyCoalesce	how long changes accumulate before the session
+	 *			is notified (seconds, 0 == no delay)
+	 *   notifyPending	when the first [un-notified] change was seen
+	 *			(0 if none)
+	 *   notifyRate		token bucket refill rate (notifications per
+	 *			second, 0 == no limit), capacity (notifyBurst),
+	 *			and the tokens available as of notifyTokensUpdated
+	 *   notifyHeld		# of times a notification was held back
+	 */
+	CFTimeInterval		notifyCoalesce;
+	CFAbsoluteTime		notifyPending;
+	double			notifyRate;
+	double			notifyBurst;
+	double			notifyTokens;
+	CFAbsoluteTime		notifyTokensUpdated;
+	uint64_t		notifyHeld;
+
+	/* resource usage (requests, bytes, server time) */
+	struct sessionUsage	*usage;
+
+	/*
+	 * admission control (see admission.c)
+	 *
+	 *   admitOps		request and byte budget tokens available as of
+	 *   admitBytes		admitUpdated
+	 *   admitReject	TRUE if the (write) request being processed is
+	 *			to be rejected
+	 *   admitDelay		how long to stop receiving requests, once the
+	 *			request being processed is complete
+	 *   admitDeprioritize	TRUE if the session should only be serviced when
+	 *			no other requests are pending, once the request
+	 *			being processed is complete
+	 *   admitSuspended	TRUE if requests are not being received
+	 *   admitDelayed, admitRejected, admitDeprioritized
+	 *			# of times each action was taken
+	 */
+	double			admitOps;
+	double			admitBytes;
+	CFAbsoluteTime		admitUpdated;
+	Boolean			admitReject;
+	CFTimeInterval		admitDelay;
+	Boolean			admitDeprioritize;
+	Boolean			admitSuspended;
+	uint64_t		admitDelayed;
+	uint64_t		admitRejected;
+	uint64_t		admitDeprioritized;
+
 } serverSession, *serverSessionRef;
 
 __BEGIN_DECLS
@@ -109,8 +174,14 @@ serverSessionRef	addSession	(mach_port_t	server,
 
 void			cleanupSession	(mach_port_t	server);
 
+void			setSessionSignalTask	(SCDynamicStoreRef	store,
+						 task_t			task);
+
 void			listSessions	(FILE		*f);
 
+CFArrayRef		copySessionUsage	(CFIndex	max,
+						 Boolean	summary);
+
 Boolean			hasRootAccess	(serverSessionRef	session);
 
 Boolean			hasWriteAccess	(serverSessionRef	session,
@@ -0,0 +1,1565 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <libkern/OSAtomic.h>
+#include <malloc/malloc.h>
+
+#include "configd.h"
+#include "store.h"
+
+
+#define	STORE_TABLE_MIN		256	/* initial # of slots (must be a power of 2) */
+#define	STORE_WATCHERS_MIN	4	/* initial # of watchers per key */
+#define	STORE_SNAPSHOTS_MAX	8	/* # of recent snapshots retained */
+#define	STORE_REMOVALS_MAX	1024	/* # of recently removed keys retained */
+#define	STORE_VALUES_MAX	(1024 * 1024)	/* max [approximate] size of the cached (decoded) values */
+
+
+__private_extern__ uint64_t	storeGeneration	= 0;
+
+static Boolean			storeChanged	= FALSE;	/* TRUE if uncommitted changes */
+
+/*
+ * a node of the radix tree of keys (with data).  The tree is persistent : a
+ * snapshot retains the root and any node reachable from a snapshot is never
+ * changed.  Nodes created since the last snapshot (those with the current
+ * "epoch") are only reachable from the store and are updated in place; any
+ * other node is copied before being changed.
+ */
+typedef struct storeNode {
+	int32_t			refs;		/* # of references (parents + snapshots) */
+	uint64_t		epoch;		/* snapshot epoch in which the node was created */
+	uint64_t		changed;	/* generation of the last change in this subtree */
+	UInt8			*label;		/* edge label (UTF-8 bytes) */
+	CFIndex			labelLen;
+	CFStringRef		key;		/* key ending here, NULL if none */
+	CFDataRef		data;		/* ... its data */
+	uint64_t		generation;	/* ... and the generation in which it last changed */
+	Boolean			sessionKey;	/* ... TRUE if a per-session key */
+	storeEntryRef		entry;		/* ... and the entry (only valid from the store root) */
+	struct storeNode	**children;	/* sorted by the first label byte */
+	int			nChildren;
+	int			maxChildren;
+} storeNode, *storeNodeRef;
+
+
+/* a key removed from the store (see storeCopyRemovedKeys) */
+typedef struct {
+	CFStringRef		key;
+	uint64_t		generation;	/* generation in which the key was removed */
+} storeRemoval;
+
+
+static storeEntryRef		*storeTable	= NULL;	/* open-addressing hash table */
+static CFIndex			storeTableSize	= 0;	/* # of slots */
+static CFIndex			storeCount	= 0;	/* # of active entries */
+static CFIndex			storeDataCount	= 0;	/* # of entries with data */
+
+static storeNodeRef		storeRoot	= NULL;	/* radix tree */
+static uint64_t			storeEpoch	= 1;	/* incremented when a snapshot is taken */
+
+static storeRemoval		storeRemovals[STORE_REMOVALS_MAX];	/* recently removed keys (a ring) */
+static CFIndex			storeRemovalsNext	= 0;
+static CFIndex			storeRemovalsCount	= 0;
+static uint64_t			storeRemovalsLost	= 0;	/* newest generation no longer in the ring */
+
+static storeEntryRef		valuesHead	= NULL;	/* most recently used cached value */
+static storeEntryRef		valuesTail	= NULL;	/* least recently used cached value */
+static CFIndex			valuesCount	= 0;	/* # of cached values */
+static size_t			valuesSize	= 0;	/* [approximate] size of the cached values */
+static uint64_t			valuesHits	= 0;
+static uint64_t			valuesMisses	= 0;
+
+
+static storeNodeRef
+nodeCreate(const UInt8 *label, CFIndex labelLen);
+
+
+__private_extern__
+void
+storeInitialize(void)
+{
+	struct timeval	tv;
+
+	/*
+	 * start the store generation at the current time (in usecs) so that
+	 * generations handed out to clients keep increasing (and are not
+	 * reused) across a configd restart.
+	 */
+	(void) gettimeofday(&tv, NULL);
+	storeGeneration = ((uint64_t)tv.tv_sec * USEC_PER_SEC) + tv.tv_usec;
+
+	storeRoot = nodeCreate(NULL, 0);
+	return;
+}
+
+
+static __inline__ CFIndex
+storeSlot(CFHashCode hash)
+{
+	return (CFIndex)(hash & (CFHashCode)(storeTableSize - 1));
+}
+
+
+static void
+storeTableResize(CFIndex newSize)
+{
+	CFIndex		i;
+	storeEntryRef	*oldTable	= storeTable;
+	CFIndex		oldSize		= storeTableSize;
+
+	storeTable     = calloc(newSize, sizeof(storeEntryRef));
+	storeTableSize = newSize;
+
+	for (i = 0; i < oldSize; i++) {
+		CFIndex		slot;
+		storeEntryRef	entry	= oldTable[i];
+
+		if (entry == NULL) {
+			continue;
+		}
+
+		slot = storeSlot(entry->keyHash);
+		while (storeTable[slot] != NULL) {
+			slot = (slot + 1) & (storeTableSize - 1);
+		}
+		storeTable[slot] = entry;
+	}
+
+	if (oldTable != NULL) free(oldTable);
+	return;
+}
+
+
+static CFIndex
+storeFindSlot(CFStringRef key, CFHashCode hash)
+{
+	CFIndex		slot;
+
+	if (storeTable == NULL) {
+		return kCFNotFound;
+	}
+
+	slot = storeSlot(hash);
+	while (storeTable[slot] != NULL) {
+		storeEntryRef	entry	= storeTable[slot];
+
+		if ((entry->key == key) ||
+		    ((entry->keyHash == hash) && CFEqual(entry->key, key))) {
+			return slot;
+		}
+
+		slot = (slot + 1) & (storeTableSize - 1);
+	}
+
+	return kCFNotFound;
+}
+
+
+__private_extern__
+storeEntryRef
+storeLookup(CFStringRef key)
+{
+	CFIndex		slot;
+
+	slot = storeFindSlot(key, CFHash(key));
+	return (slot != kCFNotFound) ? storeTable[slot] : NULL;
+}
+
+
+__private_extern__
+storeEntryRef
+storeLookupOrAdd(CFStringRef key)
+{
+	storeEntryRef	entry;
+	CFHashCode	hash;
+	CFIndex		slot;
+
+	hash = CFHash(key);
+	slot = storeFindSlot(key, hash);
+	if (slot != kCFNotFound) {
+		return storeTable[slot];
+	}
+
+	/* keep the table at most 1/2 full */
+	if (storeTable == NULL) {
+		storeTableResize(STORE_TABLE_MIN);
+	} else if ((storeCount + 1) * 2 > storeTableSize) {
+		storeTableResize(storeTableSize * 2);
+	}
+
+	entry = calloc(1, sizeof(storeEntry));
+	entry->key     = CFStringCreateCopy(NULL, key);	/* intern the key */
+	entry->keyHash = hash;
+	entry->session = MACH_PORT_NULL;
+
+	slot = storeSlot(hash);
+	while (storeTable[slot] != NULL) {
+		slot = (slot + 1) & (storeTableSize - 1);
+	}
+	storeTable[slot] = entry;
+	storeCount++;
+
+	return entry;
+}
+
+
+__private_extern__
+void
+storeRemoveIfUnused(storeEntryRef entry)
+{
+	CFIndex		hole;
+	CFIndex		slot;
+
+	if ((entry->data != NULL) || (entry->nWatchers > 0)) {
+		/* if this key is still active */
+		return;
+	}
+
+	hole = storeFindSlot(entry->key, entry->keyHash);
+	if ((hole == kCFNotFound) || (storeTable[hole] != entry)) {
+		SCLog(TRUE, LOG_ERR, CFSTR("storeRemoveIfUnused(): entry not found for \"%@\""), entry->key);
+		return;
+	}
+
+	/*
+	 * remove the entry, shifting any following entries in the same
+	 * probe sequence back into the hole (so that no tombstones are
+	 * needed).
+	 */
+	storeTable[hole] = NULL;
+	slot = hole;
+	while (TRUE) {
+		CFIndex		home;
+		storeEntryRef	next;
+
+		slot = (slot + 1) & (storeTableSize - 1);
+		next = storeTable[slot];
+		if (next == NULL) {
+			break;
+		}
+
+		home = storeSlot(next->keyHash);
+		if (((slot > hole) && ((home <= hole) || (home > slot))) ||
+		    ((slot < hole) && ((home <= hole) && (home > slot)))) {
+			storeTable[hole] = next;
+			storeTable[slot] = NULL;
+			hole = slot;
+		}
+	}
+	storeCount--;
+
+	CFRelease(entry->key);
+	if (entry->watchers != NULL) free(entry->watchers);
+	free(entry);
+
+	return;
+}
+
+
+__private_extern__
+CFIndex
+storeGetCount(void)
+{
+	return storeCount;
+}
+
+
+__private_extern__
+void
+storeApplyFunction(storeApplierFunction applier, void *context)
+{
+	CFIndex		i;
+
+	/*
+	 * Note: the applier function must not add or remove store entries
+	 */
+	for (i = 0; i < storeTableSize; i++) {
+		storeEntryRef	entry	= storeTable[i];
+
+		if (entry != NULL) {
+			(*applier)(entry, context);
+		}
+	}
+
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Radix tree (keys with data)
+
+
+#define	N_QUICK	256
+
+
+static UInt8 *
+keyBytes(CFStringRef key, UInt8 *buf, CFIndex bufLen, CFIndex *len)
+{
+	CFIndex	n;
+	CFRange	range	= CFRangeMake(0, CFStringGetLength(key));
+
+	(void) CFStringGetBytes(key, range, kCFStringEncodingUTF8, 0, FALSE, NULL, 0, &n);
+	if (n > bufLen) {
+		buf = CFAllocatorAllocate(NULL, n, 0);
+	}
+	(void) CFStringGetBytes(key, range, kCFStringEncodingUTF8, 0, FALSE, buf, n, len);
+	return buf;
+}
+
+
+__private_extern__
+CFComparisonResult
+storeKeyCompare(const void *val1, const void *val2, void *context)
+{
+	UInt8			buf1_q[N_QUICK];
+	UInt8			*buf1;
+	UInt8			buf2_q[N_QUICK];
+	UInt8			*buf2;
+	CFIndex			len1;
+	CFIndex			len2;
+	int			r;
+	CFComparisonResult	result;
+
+	buf1 = keyBytes((CFStringRef)val1, buf1_q, sizeof(buf1_q), &len1);
+	buf2 = keyBytes((CFStringRef)val2, buf2_q, sizeof(buf2_q), &len2);
+
+	r = memcmp(buf1, buf2, (len1 < len2) ? len1 : len2);
+	if (r == 0) {
+		r = (len1 < len2) ? -1 : (len1 > len2) ? 1 : 0;
+	}
+	result = (r < 0) ? kCFCompareLessThan : (r > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo;
+
+	if (buf1 != buf1_q) CFAllocatorDeallocate(NULL, buf1);
+	if (buf2 != buf2_q) CFAllocatorDeallocate(NULL, buf2);
+	return result;
+}
+
+
+/* returns the index of the child starting with "c" (or where it would be inserted) */
+static int
+nodeChildIndex(storeNodeRef node, UInt8 c, Boolean *found)
+{
+	int	hi	= node->nChildren;
+	int	lo	= 0;
+
+	while (lo < hi) {
+		int	mid	= (lo + hi) / 2;
+		UInt8	mc	= node->children[mid]->label[0];
+
+		if (mc == c) {
+			*found = TRUE;
+			return mid;
+		} else if (mc < c) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	*found = FALSE;
+	return lo;
+}
+
+
+static storeNodeRef
+nodeCreate(const UInt8 *label, CFIndex labelLen)
+{
+	storeNodeRef	node;
+
+	node = calloc(1, sizeof(storeNode));
+	node->refs    = 1;
+	node->epoch   = storeEpoch;
+	node->changed = storeGeneration + 1;
+	if (labelLen > 0) {
+		node->label = malloc(labelLen);
+		memcpy(node->label, label, labelLen);
+		node->labelLen = labelLen;
+	}
+	return node;
+}
+
+
+static storeNodeRef
+nodeRetain(storeNodeRef node)
+{
+	OSAtomicIncrement32Barrier(&node->refs);
+	return node;
+}
+
+
+/* may be called from any thread (when releasing a snapshot) */
+static void
+nodeRelease(storeNodeRef node)
+{
+	int	i;
+
+	if (OSAtomicDecrement32Barrier(&node->refs) > 0) {
+		return;
+	}
+
+	for (i = 0; i < node->nChildren; i++) {
+		nodeRelease(node->children[i]);
+	}
+	if (node->children != NULL) free(node->children);
+	if (node->key != NULL) CFRelease(node->key);
+	if (node->data != NULL) CFRelease(node->data);
+	if (node->label != NULL) free(node->label);
+	free(node);
+	return;
+}
+
+
+static void
+nodeSetChildren(storeNodeRef node, storeNodeRef from)
+{
+	int	i;
+
+	/* Note: the node must not have any children */
+	if (from->nChildren > 0) {
+		node->children    = malloc(from->nChildren * sizeof(storeNodeRef));
+		node->maxChildren = from->nChildren;
+		for (i = 0; i < from->nChildren; i++) {
+			node->children[i] = nodeRetain(from->children[i]);
+		}
+		node->nChildren = from->nChildren;
+	}
+	return;
+}
+
+
+static void
+nodeSetKey(storeNodeRef node, storeNodeRef from)
+{
+	if (from->key != NULL) CFRetain(from->key);
+	if (from->data != NULL) CFRetain(from->data);
+	if (node->key != NULL) CFRelease(node->key);
+	if (node->data != NULL) CFRelease(node->data);
+	node->key        = from->key;
+	node->data       = from->data;
+	node->generation = from->generation;
+	node->sessionKey = from->sessionKey;
+	node->entry      = from->entry;
+	return;
+}
+
+
+/* returns the node referenced by "slot", copying it first if it may be shared with a snapshot */
+static storeNodeRef
+nodeMutable(storeNodeRef *slot)
+{
+	storeNodeRef	copy;
+	storeNodeRef	node	= *slot;
+
+	if (node->epoch == storeEpoch) {
+		/* if created since the last snapshot (and only reachable from the store) */
+		return node;
+	}
+
+	copy = nodeCreate(node->label, node->labelLen);
+	copy->changed = node->changed;
+	nodeSetKey(copy, node);
+	nodeSetChildren(copy, node);
+	*slot = copy;
+	nodeRelease(node);
+	return copy;
+}
+
+
+static void
+nodeInsertChild(storeNodeRef node, int i, storeNodeRef child)
+{
+	if (node->nChildren >= node->maxChildren) {
+		node->maxChildren = (node->maxChildren > 0) ? node->maxChildren * 2 : 2;
+		node->children = reallocf(node->children, node->maxChildren * sizeof(storeNodeRef));
+	}
+	memmove(&node->children[i + 1], &node->children[i], (node->nChildren - i) * sizeof(storeNodeRef));
+	node->children[i] = child;
+	node->nChildren++;
+	return;
+}
+
+
+static void
+nodeRemoveChild(storeNodeRef node, int i)
+{
+	node->nChildren--;
+	memmove(&node->children[i], &node->children[i + 1], (node->nChildren - i) * sizeof(storeNodeRef));
+	return;
+}
+
+
+/* merge a (mutable, non-root) node with no key and a single child into that child */
+static void
+nodeCompact(storeNodeRef node)
+{
+	storeNodeRef	child;
+	UInt8		*label;
+
+	if ((node->key != NULL) || (node->nChildren != 1)) {
+		return;
+	}
+
+	child = node->children[0];
+	label = malloc(node->labelLen + child->labelLen);
+	memcpy(label, node->label, node->labelLen);
+	memcpy(label + node->labelLen, child->label, child->labelLen);
+	free(node->label);
+	node->label     = label;
+	node->labelLen += child->labelLen;
+	if (child->changed > node->changed) {
+		node->changed = child->changed;
+	}
+	nodeSetKey(node, child);
+	free(node->children);
+	node->children    = NULL;
+	node->nChildren   = 0;
+	node->maxChildren = 0;
+	nodeSetChildren(node, child);
+	nodeRelease(child);
+	return;
+}
+
+
+static void
+storeIndexSet(storeEntryRef entry)
+{
+	UInt8		buf_q[N_QUICK];
+	UInt8		*buf;
+	uint64_t	changed	= storeGeneration + 1;
+	CFIndex		len;
+	storeNodeRef	node;
+	const UInt8	*p;
+
+	buf = keyBytes(entry->key, buf_q, sizeof(buf_q), &len);
+	p = buf;
+
+	node = nodeMutable(&storeRoot);
+	node->changed = changed;
+
+	while (len > 0) {
+		storeNodeRef	child;
+		Boolean		found;
+		int		i;
+		CFIndex		l;
+
+		i = nodeChildIndex(node, p[0], &found);
+		if (!found) {
+			/* add a new leaf */
+			child = nodeCreate(p, len);
+			nodeInsertChild(node, i, child);
+			node = child;
+			break;
+		}
+
+		child = nodeMutable(&node->children[i]);
+		for (l = 1; (l < len) && (l < child->labelLen) && (p[l] == child->label[l]); l++)
+			;
+
+		if (l < child->labelLen) {
+			storeNodeRef	split;
+
+			/* split the edge */
+			split = nodeCreate(child->label, l);
+			memmove(child->label, child->label + l, child->labelLen - l);
+			child->labelLen -= l;
+			nodeInsertChild(split, 0, child);
+			node->children[i] = split;
+			child = split;
+		}
+
+		child->changed = changed;
+		node = child;
+		p   += l;
+		len -= l;
+	}
+
+	if (node->key != entry->key) {
+		CFRetain(entry->key);
+		if (node->key != NULL) CFRelease(node->key);
+		node->key = entry->key;
+	}
+	CFRetain(entry->data);
+	if (node->data != NULL) CFRelease(node->data);
+	node->data       = entry->data;
+	node->generation = entry->generation;
+	node->sessionKey = (entry->session != MACH_PORT_NULL);
+	node->entry      = entry;
+
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+	return;
+}
+
+
+static Boolean
+nodeRemoveKey(storeNodeRef *slot, const UInt8 *p, CFIndex len, storeEntryRef entry)
+{
+	storeNodeRef	node	= *slot;
+
+	if (len == 0) {
+		if (node->entry != entry) {
+			return FALSE;
+		}
+
+		node = nodeMutable(slot);
+		CFRelease(node->key);
+		CFRelease(node->data);
+		node->key        = NULL;
+		node->data       = NULL;
+		node->generation = 0;
+		node->sessionKey = FALSE;
+		node->entry      = NULL;
+	} else {
+		storeNodeRef	child;
+		Boolean		found;
+		int		i;
+
+		i = nodeChildIndex(node, p[0], &found);
+		if (!found) {
+			return FALSE;
+		}
+
+		child = node->children[i];
+		if ((child->labelLen > len) || (memcmp(child->label, p, child->labelLen) != 0)) {
+			return FALSE;
+		}
+
+		node = nodeMutable(slot);
+		if (!nodeRemoveKey(&node->children[i], p + child->labelLen, len - child->labelLen, entry)) {
+			return FALSE;
+		}
+
+		child = node->children[i];
+		if ((child->key == NULL) && (child->nChildren == 0)) {
+			/* remove the (now empty) leaf */
+			nodeRemoveChild(node, i);
+			nodeRelease(child);
+		}
+	}
+
+	node->changed = storeGeneration + 1;
+	if (slot != &storeRoot) {
+		nodeCompact(node);
+	}
+	return TRUE;
+}
+
+
+static void
+storeIndexRemove(storeEntryRef entry)
+{
+	UInt8		buf_q[N_QUICK];
+	UInt8		*buf;
+	CFIndex		len;
+	storeRemoval	*removal;
+
+	buf = keyBytes(entry->key, buf_q, sizeof(buf_q), &len);
+	if (!nodeRemoveKey(&storeRoot, buf, len, entry)) {
+		SCLog(TRUE, LOG_ERR, CFSTR("storeIndexRemove(): key not found for \"%@\""), entry->key);
+		goto done;
+	}
+
+	/* log the removal (replacing the oldest) */
+	removal = &storeRemovals[storeRemovalsNext];
+	if (storeRemovalsCount == STORE_REMOVALS_MAX) {
+		storeRemovalsLost = removal->generation;
+		CFRelease(removal->key);
+	} else {
+		storeRemovalsCount++;
+	}
+	removal->key        = CFRetain(entry->key);
+	removal->generation = storeGeneration + 1;
+	storeRemovalsNext = (storeRemovalsNext + 1) % STORE_REMOVALS_MAX;
+
+    done :
+
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+	return;
+}
+
+
+/* returns the node whose subtree holds the keys beginning with the provided bytes, NULL if none */
+static storeNodeRef
+nodeFindPrefix(storeNodeRef node, const UInt8 *p, CFIndex len)
+{
+	while (len > 0) {
+		storeNodeRef	child;
+		Boolean		found;
+		int		i;
+		CFIndex		l;
+
+		i = nodeChildIndex(node, p[0], &found);
+		if (!found) {
+			return NULL;
+		}
+
+		child = node->children[i];
+		l = (len < child->labelLen) ? len : child->labelLen;
+		if (memcmp(child->label, p, l) != 0) {
+			return NULL;
+		}
+
+		node = child;
+		p   += l;
+		len -= l;
+	}
+
+	return node;
+}
+
+
+/* returns the node at which the provided bytes end, NULL if none */
+static storeNodeRef
+nodeFind(storeNodeRef node, const UInt8 *p, CFIndex len)
+{
+	while (len > 0) {
+		storeNodeRef	child;
+		Boolean		found;
+		int		i;
+
+		i = nodeChildIndex(node, p[0], &found);
+		if (!found) {
+			return NULL;
+		}
+
+		child = node->children[i];
+		if ((child->labelLen > len) || (memcmp(child->label, p, child->labelLen) != 0)) {
+			return NULL;
+		}
+
+		node = child;
+		p   += child->labelLen;
+		len -= child->labelLen;
+	}
+
+	return node;
+}
+
+
+static void
+nodeApplyFunction(storeNodeRef node, storeApplierFunction applier, void *context)
+{
+	int	i;
+
+	if (node->entry != NULL) {
+		(*applier)(node->entry, context);
+	}
+
+	for (i = 0; i < node->nChildren; i++) {
+		nodeApplyFunction(node->children[i], applier, context);
+	}
+
+	return;
+}
+
+
+__private_extern__
+void
+storeApplyPrefixFunction(CFStringRef prefix, storeApplierFunction applier, void *context)
+{
+	UInt8		buf_q[N_QUICK];
+	UInt8		*buf;
+	CFIndex		len;
+	storeNodeRef	node;
+
+	buf = keyBytes(prefix, buf_q, sizeof(buf_q), &len);
+	node = nodeFindPrefix(storeRoot, buf, len);
+	if (node != NULL) {
+		nodeApplyFunction(node, applier, context);
+	}
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+
+	return;
+}
+
+
+static CFComparisonResult
+removalCompare(const void *val1, const void *val2, void *context)
+{
+	CFDataRef	k1	= (CFDataRef)val1;
+	CFDataRef	k2	= (CFDataRef)val2;
+	CFIndex		len1	= CFDataGetLength(k1);
+	CFIndex		len2	= CFDataGetLength(k2);
+	int		r;
+
+	r = memcmp(CFDataGetBytePtr(k1), CFDataGetBytePtr(k2), (len1 < len2) ? len1 : len2);
+	if (r == 0) {
+		r = (len1 < len2) ? -1 : ((len1 > len2) ? 1 : 0);
+	}
+
+	return (r < 0) ? kCFCompareLessThan : ((r > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo);
+}
+
+
+__private_extern__
+CFArrayRef
+storeCopyRemovedKeys(uint64_t since)
+{
+	CFIndex			i;
+	CFMutableArrayRef	removed;
+	CFMutableSetRef		seen;
+
+	if (storeRemovalsLost > since) {
+		/* if some of the removals are no longer known */
+		return NULL;
+	}
+
+	removed = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	seen    = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
+	for (i = 0; i < storeRemovalsCount; i++) {
+		storeEntryRef	entry;
+		storeRemoval	*removal;
+		UInt8		buf_q[N_QUICK];
+		UInt8		*buf;
+		CFIndex		len;
+		CFDataRef	bytes;
+
+		removal = &storeRemovals[(storeRemovalsNext + STORE_REMOVALS_MAX - 1 - i) % STORE_REMOVALS_MAX];
+		if (removal->generation <= since) {
+			/* if no more (newer) removals */
+			break;
+		}
+
+		if (CFSetContainsValue(seen, removal->key)) {
+			/* if removed more than once */
+			continue;
+		}
+		CFSetAddValue(seen, removal->key);
+
+		entry = storeLookup(removal->key);
+		if ((entry != NULL) && (entry->data != NULL)) {
+			/* if the key has since been [re-]added */
+			continue;
+		}
+
+		buf = keyBytes(removal->key, buf_q, sizeof(buf_q), &len);
+		bytes = CFDataCreate(NULL, buf, len);
+		CFArrayAppendValue(removed, bytes);
+		CFRelease(bytes);
+		if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+	}
+	CFRelease(seen);
+
+	CFArraySortValues(removed,
+			  CFRangeMake(0, CFArrayGetCount(removed)),
+			  removalCompare,
+			  NULL);
+	return removed;
+}
+
+
+#pragma mark -
+#pragma mark Cached (decoded) values
+
+
+static void
+valueSizeApplier(const void *value, void *context);
+
+static void
+valueSizeDictionaryApplier(const void *key, const void *value, void *context);
+
+
+static size_t
+valueSize(CFTypeRef value)
+{
+	size_t		size;
+	CFTypeID	type;
+
+	/*
+	 * tagged (and constant) objects report a size of zero, which is
+	 * what we want since they take up no [additional] heap space
+	 */
+	size = malloc_size(value);
+
+	type = CFGetTypeID(value);
+	if (type == CFArrayGetTypeID()) {
+		CFArrayApplyFunction(value,
+				     CFRangeMake(0, CFArrayGetCount(value)),
+				     valueSizeApplier,
+				     &size);
+	} else if (type == CFDictionaryGetTypeID()) {
+		CFDictionaryApplyFunction(value, valueSizeDictionaryApplier, &size);
+	}
+
+	return size;
+}
+
+
+static void
+valueSizeApplier(const void *value, void *context)
+{
+	size_t	*size	= (size_t *)context;
+
+	*size += valueSize(value);
+	return;
+}
+
+
+static void
+valueSizeDictionaryApplier(const void *key, const void *value, void *context)
+{
+	size_t	*size	= (size_t *)context;
+
+	*size += valueSize(key);
+	*size += valueSize(value);
+	return;
+}
+
+
+static void
+valueUnlink(storeEntryRef entry)
+{
+	if (entry->valuePrev != NULL) {
+		entry->valuePrev->valueNext = entry->valueNext;
+	} else {
+		valuesHead = entry->valueNext;
+	}
+	if (entry->valueNext != NULL) {
+		entry->valueNext->valuePrev = entry->valuePrev;
+	} else {
+		valuesTail = entry->valuePrev;
+	}
+	entry->valuePrev = NULL;
+	entry->valueNext = NULL;
+	return;
+}
+
+
+static void
+valueLinkHead(storeEntryRef entry)
+{
+	entry->valuePrev = NULL;
+	entry->valueNext = valuesHead;
+	if (valuesHead != NULL) {
+		valuesHead->valuePrev = entry;
+	} else {
+		valuesTail = entry;
+	}
+	valuesHead = entry;
+	return;
+}
+
+
+static void
+valueFlush(storeEntryRef entry)
+{
+	if (entry->value == NULL) {
+		return;
+	}
+
+	valueUnlink(entry);
+	valuesCount--;
+	valuesSize -= entry->valueSize;
+
+	CFRelease(entry->value);
+	entry->value     = NULL;
+	entry->valueSize = 0;
+	return;
+}
+
+
+__private_extern__
+CFPropertyListRef
+storeCopyValue(storeEntryRef entry)
+{
+	CFPropertyListRef	value;
+
+	if (entry->data == NULL) {
+		return NULL;
+	}
+
+	if (entry->value != NULL) {
+		/* if cached, move to the head of the LRU list */
+		valuesHits++;
+		if (entry != valuesHead) {
+			valueUnlink(entry);
+			valueLinkHead(entry);
+		}
+		CFRetain(entry->value);
+		return entry->value;
+	}
+
+	valuesMisses++;
+	if (!_SCUnserialize(&value, entry->data, NULL, 0)) {
+		return NULL;
+	}
+
+	entry->value     = CFRetain(value);
+	entry->valueSize = valueSize(value);
+	valueLinkHead(entry);
+	valuesCount++;
+	valuesSize += entry->valueSize;
+
+	/*
+	 * evict the least recently used values (but always keep the one
+	 * we just decoded)
+	 */
+	while ((valuesSize > STORE_VALUES_MAX) && (valuesTail != entry)) {
+		valueFlush(valuesTail);
+	}
+
+	return value;
+}
+
+
+__private_extern__
+void
+storeGetValueCacheInfo(CFIndex		*count,
+		       size_t		*size,
+		       size_t		*limit,
+		       uint64_t		*hits,
+		       uint64_t		*misses)
+{
+	*count  = valuesCount;
+	*size   = valuesSize;
+	*limit  = STORE_VALUES_MAX;
+	*hits   = valuesHits;
+	*misses = valuesMisses;
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Entry data / watchers
+
+
+__private_extern__
+void
+storeSetData(storeEntryRef entry, CFDataRef data)
+{
+	/* the cached value (if any) is no longer valid */
+	valueFlush(entry);
+	entry->restored = FALSE;
+
+	/* update the data, and the (radix tree) index of keys with data */
+	if (data != NULL) {
+		if (entry->data == NULL) {
+			storeDataCount++;
+		}
+		CFRetain(data);
+		if (entry->data != NULL) CFRelease(entry->data);
+		entry->data = data;
+		entry->generation = storeGeneration + 1;
+		storeIndexSet(entry);
+	} else if (entry->data != NULL) {
+		storeIndexRemove(entry);
+		storeDataCount--;
+		CFRelease(entry->data);
+		entry->data = NULL;
+		entry->generation = storeGeneration + 1;
+	}
+	storeChanged = TRUE;
+
+	return;
+}
+
+
+__private_extern__
+void
+storeSetSession(storeEntryRef entry, mach_port_t session)
+{
+	Boolean	sessionKeyChanged;
+
+	sessionKeyChanged = ((entry->session != MACH_PORT_NULL) != (session != MACH_PORT_NULL));
+	entry->session = session;
+
+	if (sessionKeyChanged && (entry->data != NULL)) {
+		/* update the (radix tree) index, snapshots report the per-session keys */
+		storeIndexSet(entry);
+		storeChanged = TRUE;
+	}
+
+	return;
+}
+
+
+__private_extern__
+void
+storeCommit(void)
+{
+	if (storeChanged) {
+		storeGeneration++;
+		storeChanged = FALSE;
+	}
+
+	return;
+}
+
+
+__private_extern__
+Boolean
+storeAddWatcher(storeEntryRef entry, mach_port_t session)
+{
+	int	i;
+
+	for (i = 0; i < entry->nWatchers; i++) {
+		if (entry->watchers[i].session == session) {
+			/* if this is another instance of this session watching this key */
+			entry->watchers[i].refs++;
+			return FALSE;
+		}
+	}
+
+	/* if this is the first instance of this session watching this key */
+	if (entry->nWatchers >= entry->maxWatchers) {
+		entry->maxWatchers = (entry->maxWatchers > 0) ? entry->maxWatchers * 2 : STORE_WATCHERS_MIN;
+		entry->watchers = reallocf(entry->watchers, entry->maxWatchers * sizeof(storeWatcher));
+	}
+	entry->watchers[entry->nWatchers].session = session;
+	entry->watchers[entry->nWatchers].refs    = 1;
+	entry->nWatchers++;
+
+	return TRUE;
+}
+
+
+__private_extern__
+Boolean
+storeRemoveWatcher(storeEntryRef entry, mach_port_t session)
+{
+	int	i;
+
+	for (i = 0; i < entry->nWatchers; i++) {
+		if (entry->watchers[i].session == session) {
+			break;
+		}
+	}
+
+	if (i == entry->nWatchers) {
+		/* if session not watching */
+		return FALSE;
+	}
+
+	if (--entry->watchers[i].refs == 0) {
+		/* if this was the last reference, remove the watcher (keeping the order) */
+		entry->nWatchers--;
+		memmove(&entry->watchers[i],
+			&entry->watchers[i + 1],
+			(entry->nWatchers - i) * sizeof(storeWatcher));
+	}
+
+	return TRUE;
+}
+
+
+__private_extern__
+CFDictionaryRef
+storeCopyEntryInfo(storeEntryRef entry, Boolean expand)
+{
+	CFMutableDictionaryRef	info;
+
+	/*
+	 * return the per-key information in the same form as was
+	 * historically maintained in the "storeData" dictionary
+	 */
+	info = CFDictionaryCreateMutable(NULL,
+					 0,
+					 &kCFTypeDictionaryKeyCallBacks,
+					 &kCFTypeDictionaryValueCallBacks);
+
+	if (entry->data != NULL) {
+		if (expand) {
+			CFPropertyListRef	plist;
+
+			plist = storeCopyValue(entry);
+			if (plist != NULL) {
+				CFDictionarySetValue(info, kSCDData, plist);
+				CFRelease(plist);
+			}
+		} else {
+			CFDictionarySetValue(info, kSCDData, entry->data);
+		}
+	}
+
+	if (entry->generation > 0) {
+		CFNumberRef	num;
+
+		num = CFNumberCreate(NULL, kCFNumberSInt64Type, &entry->generation);
+		CFDictionarySetValue(info, kSCDGeneration, num);
+		CFRelease(num);
+	}
+
+	if (entry->nWatchers > 0) {
+		int			i;
+		CFMutableArrayRef	watchers;
+		CFMutableArrayRef	watcherRefs;
+
+		watchers    = CFArrayCreateMutable(NULL, entry->nWatchers, &kCFTypeArrayCallBacks);
+		watcherRefs = CFArrayCreateMutable(NULL, entry->nWatchers, &kCFTypeArrayCallBacks);
+		for (i = 0; i < entry->nWatchers; i++) {
+			CFNumberRef	num;
+
+			num = CFNumberCreate(NULL, kCFNumberIntType, &entry->watchers[i].session);
+			CFArrayAppendValue(watchers, num);
+			CFRelease(num);
+
+			num = CFNumberCreate(NULL, kCFNumberIntType, &entry->watchers[i].refs);
+			CFArrayAppendValue(watcherRefs, num);
+			CFRelease(num);
+		}
+		CFDictionarySetValue(info, kSCDWatchers, watchers);
+		CFDictionarySetValue(info, kSCDWatcherRefs, watcherRefs);
+		CFRelease(watchers);
+		CFRelease(watcherRefs);
+	}
+
+	if (entry->session != MACH_PORT_NULL) {
+		CFStringRef	sessionKey;
+
+		sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), entry->session);
+		CFDictionarySetValue(info, kSCDSession, sessionKey);
+		CFRelease(sessionKey);
+	}
+
+	return info;
+}
+
+
+#pragma mark -
+#pragma mark Snapshots
+
+
+struct storeSnapshot {
+	int32_t			refs;
+	uint64_t		generation;
+	storeNodeRef		root;		/* the [retained] radix tree, as of the generation */
+	CFIndex			count;		/* # of keys (with data) */
+};
+
+
+/*
+ * the most recent snapshots, newest first.  The array is only changed on
+ * the server thread but may be searched (with the lock held) from any
+ * thread.
+ */
+static storeSnapshotRef		storeSnapshots[STORE_SNAPSHOTS_MAX];
+static pthread_mutex_t		storeSnapshotsLock	= PTHREAD_MUTEX_INITIALIZER;
+
+
+static storeSnapshotRef
+storeSnapshotCreate(void)
+{
+	storeSnapshotRef	snapshot;
+
+	snapshot = calloc(1, sizeof(*snapshot));
+	snapshot->refs       = 1;
+	snapshot->generation = storeGeneration;
+	snapshot->root       = nodeRetain(storeRoot);
+	snapshot->count      = storeDataCount;
+
+	/* the nodes are now shared, copy them before any further changes */
+	storeEpoch++;
+
+	return snapshot;
+}
+
+
+__private_extern__
+storeSnapshotRef
+storeSnapshotCopy(void)
+{
+	/* a snapshot only reflects committed changes */
+	storeCommit();
+
+	if ((storeSnapshots[0] == NULL) ||
+	    (storeSnapshots[0]->generation != storeGeneration)) {
+		storeSnapshotRef	snapshot;
+
+		/* if the store has changed since the last snapshot */
+		snapshot = storeSnapshotCreate();
+
+		pthread_mutex_lock(&storeSnapshotsLock);
+		if (storeSnapshots[STORE_SNAPSHOTS_MAX - 1] != NULL) {
+			storeSnapshotRelease(storeSnapshots[STORE_SNAPSHOTS_MAX - 1]);
+		}
+		memmove(&storeSnapshots[1],
+			&storeSnapshots[0],
+			(STORE_SNAPSHOTS_MAX - 1) * sizeof(storeSnapshotRef));
+		storeSnapshots[0] = snapshot;
+		pthread_mutex_unlock(&storeSnapshotsLock);
+	}
+
+	return storeSnapshotRetain(storeSnapshots[0]);
+}
+
+
+__private_extern__
+storeSnapshotRef
+storeSnapshotCopyGeneration(uint64_t generation)
+{
+	int			i;
+	storeSnapshotRef	snapshot	= NULL;
+
+	pthread_mutex_lock(&storeSnapshotsLock);
+	for (i = 0; (i < STORE_SNAPSHOTS_MAX) && (storeSnapshots[i] != NULL); i++) {
+		if (storeSnapshots[i]->generation == generation) {
+			snapshot = storeSnapshotRetain(storeSnapshots[i]);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&storeSnapshotsLock);
+
+	return snapshot;
+}
+
+
+__private_extern__
+storeSnapshotRef
+storeSnapshotRetain(storeSnapshotRef snapshot)
+{
+	OSAtomicIncrement32Barrier(&snapshot->refs);
+	return snapshot;
+}
+
+
+__private_extern__
+void
+storeSnapshotRelease(storeSnapshotRef snapshot)
+{
+	if (OSAtomicDecrement32Barrier(&snapshot->refs) > 0) {
+		return;
+	}
+
+	nodeRelease(snapshot->root);
+	free(snapshot);
+	return;
+}
+
+
+__private_extern__
+uint64_t
+storeSnapshotGetGeneration(storeSnapshotRef snapshot)
+{
+	return snapshot->generation;
+}
+
+
+__private_extern__
+CFIndex
+storeSnapshotGetCount(storeSnapshotRef snapshot)
+{
+	return snapshot->count;
+}
+
+
+__private_extern__
+CFDataRef
+storeSnapshotGetData(storeSnapshotRef snapshot, CFStringRef key, uint64_t *generation)
+{
+	UInt8		buf_q[N_QUICK];
+	UInt8		*buf;
+	CFDataRef	data	= NULL;
+	CFIndex		len;
+	storeNodeRef	node;
+
+	buf = keyBytes(key, buf_q, sizeof(buf_q), &len);
+	node = nodeFind(snapshot->root, buf, len);
+	if ((node != NULL) && (node->key != NULL)) {
+		data = node->data;
+		if (generation != NULL) *generation = node->generation;
+	}
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+
+	return data;
+}
+
+
+static void
+nodeSnapshotApplyFunction(storeNodeRef node, storeSnapshotApplierFunction applier, void *context)
+{
+	int	i;
+
+	if (node->key != NULL) {
+		(*applier)(node->key, node->data, context);
+	}
+
+	for (i = 0; i < node->nChildren; i++) {
+		nodeSnapshotApplyFunction(node->children[i], applier, context);
+	}
+
+	return;
+}
+
+
+__private_extern__
+void
+storeSnapshotApplyPrefixFunction(storeSnapshotRef		snapshot,
+				 CFStringRef			prefix,
+				 storeSnapshotApplierFunction	applier,
+				 void				*context)
+{
+	UInt8		buf_q[N_QUICK];
+	UInt8		*buf;
+	CFIndex		len;
+	storeNodeRef	node;
+
+	buf = keyBytes(prefix, buf_q, sizeof(buf_q), &len);
+	node = nodeFindPrefix(snapshot->root, buf, len);
+	if (node != NULL) {
+		nodeSnapshotApplyFunction(node, applier, context);
+	}
+	if (buf != buf_q) CFAllocatorDeallocate(NULL, buf);
+
+	return;
+}
+
+
+typedef struct {
+	uint64_t			generation;	/* the snapshot generation */
+	uint64_t			since;
+	CFArrayRef			removed;
+	CFIndex				nRemoved;
+	CFIndex				iRemoved;
+	Boolean				sessionKeys;	/* TRUE if the per-session keys should be reported */
+	storeSnapshotRecordFunction	applier;
+	void				*context;
+	UInt8				*path;		/* UTF-8 bytes leading to the current node */
+	CFIndex				pathLen;
+	CFIndex				pathSize;
+} changesContext, *changesContextRef;
+
+
+/* report the removed keys which sort before the provided (UTF-8) bytes */
+static void
+changesApplyRemoved(changesContextRef context, const UInt8 *bytes, CFIndex len)
+{
+	while (context->iRemoved < context->nRemoved) {
+		CFDataRef	removed;
+		CFIndex		removedLen;
+		int		r;
+
+		removed    = CFArrayGetValueAtIndex(context->removed, context->iRemoved);
+		removedLen = CFDataGetLength(removed);
+		if (bytes != NULL) {
+			r = memcmp(CFDataGetBytePtr(removed), bytes, (removedLen < len) ? removedLen : len);
+			if ((r > 0) || ((r == 0) && (removedLen >= len))) {
+				break;
+			}
+		}
+
+		(*context->applier)(CFDataGetBytePtr(removed), removedLen, NULL, context->generation, context->context);
+		context->iRemoved++;
+	}
+
+	return;
+}
+
+
+static void
+nodeApplyChangesFunction(storeNodeRef node, changesContextRef context)
+{
+	int		i;
+	CFIndex		pathLen	= context->pathLen;
+
+	if ((context->since > 0) && (node->changed <= context->since)) {
+		/* if nothing in this subtree has changed */
+		return;
+	}
+
+	if (node->labelLen > 0) {
+		if (pathLen + node->labelLen > context->pathSize) {
+			context->pathSize = (pathLen + node->labelLen) * 2;
+			context->path = reallocf(context->path, context->pathSize);
+		}
+		memcpy(context->path + pathLen, node->label, node->labelLen);
+		context->pathLen += node->labelLen;
+	}
+
+	if ((node->key != NULL) &&
+	    (node->generation > context->since) &&
+	    (context->sessionKeys || !node->sessionKey)) {
+		changesApplyRemoved(context, context->path, context->pathLen);
+		(*context->applier)(context->path, context->pathLen, node->data, node->generation, context->context);
+	}
+
+	for (i = 0; i < node->nChildren; i++) {
+		nodeApplyChangesFunction(node->children[i], context);
+	}
+
+	context->pathLen = pathLen;
+	return;
+}
+
+
+__private_extern__
+void
+storeSnapshotApplyChangesFunction(storeSnapshotRef		snapshot,
+				  uint64_t			since,
+				  CFArrayRef			removed,
+				  storeSnapshotRecordFunction	applier,
+				  void				*context)
+{
+	changesContext	myContext;
+
+	bzero(&myContext, sizeof(myContext));
+	myContext.generation  = snapshot->generation;
+	myContext.since       = since;
+	myContext.removed     = removed;
+	myContext.nRemoved    = (removed != NULL) ? CFArrayGetCount(removed) : 0;
+	myContext.sessionKeys = TRUE;
+	myContext.applier     = applier;
+	myContext.context     = context;
+
+	/*
+	 * the keys in the tree, and the removed keys, are in key (UTF-8 byte)
+	 * order so the two can be reported in order with a single merge
+	 */
+	nodeApplyChangesFunction(snapshot->root, &myContext);
+	changesApplyRemoved(&myContext, NULL, 0);
+	if (myContext.path != NULL) free(myContext.path);
+
+	return;
+}
+
+
+__private_extern__
+void
+storeSnapshotApplyRecordsFunction(storeSnapshotRef		snapshot,
+				  Boolean			sessionKeys,
+				  storeSnapshotRecordFunction	applier,
+				  void				*context)
+{
+	changesContext	myContext;
+
+	bzero(&myContext, sizeof(myContext));
+	myContext.generation  = snapshot->generation;
+	myContext.sessionKeys = sessionKeys;
+	myContext.applier     = applier;
+	myContext.context     = context;
+
+	nodeApplyChangesFunction(snapshot->root, &myContext);
+	if (myContext.path != NULL) free(myContext.path);
+
+	return;
+}
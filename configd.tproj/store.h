@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+#ifndef _S_STORE_H
+#define _S_STORE_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+
+/*
+ * Notes:
+ *
+ * - the dynamic store is maintained as an open-addressing (linear probe)
+ *   hash table of [interned] store keys.
+ * - each table slot references a fixed "storeEntry" structure which is
+ *   updated in place when a key's data, watchers, or owning session
+ *   changes.
+ * - the CFString held in the entry is the "interned" key.  Callers may
+ *   compare interned keys by pointer.
+ * - an entry is only kept in the table while it has data or while at
+ *   least one session is watching the key.
+ * - the keys that have data are also maintained in a (sorted) radix tree
+ *   of their UTF-8 bytes.  This allows the keys with a given prefix to be
+ *   enumerated (in order) without scanning the entire store.
+ * - the store "generation" is incremented once per commit (the changes
+ *   made by a single request, see storeCommit) and each entry records the
+ *   generation in which its data last changed.
+ * - the radix tree is persistent (copy-on-write) : each node holds the key
+ *   ending there, its data and generation.  Once a snapshot has been taken
+ *   the nodes are shared and a later change copies (only) the nodes on the
+ *   path to the changed key.
+ * - a "snapshot" is an immutable, reference counted, view of the keys (and
+ *   data) in the store as of a given generation : the root of the radix
+ *   tree at that generation.  Taking a snapshot does not depend on the size
+ *   of the store.  Snapshots are created on the server (writer) thread but
+ *   may be retained, queried, and released from any thread.  The most
+ *   recent snapshots are retained so that reads can be made "as of" an
+ *   earlier generation.
+ * - the most recently removed keys are remembered so that the changes
+ *   since a given generation (including removals) can be reported.
+ * - the decoded (CFPropertyList) form of an entry's data is cached when
+ *   it is needed on the server thread (see storeCopyValue).  The cache is
+ *   bounded by the [approximate] memory used by the decoded values; the
+ *   least recently used values are evicted first.
+ */
+
+
+/* a session watching a store key */
+typedef struct {
+	mach_port_t		session;	/* session watching the key */
+	int			refs;		/* # of references (key + matching patterns) */
+} storeWatcher;
+
+
+/* per-key information maintained in the dynamic store */
+typedef struct storeEntry {
+
+	/* the [interned] dynamic store key */
+	CFStringRef		key;
+	CFHashCode		keyHash;
+
+	/* serialized data associated with the key (NULL if not defined) */
+	CFDataRef		data;
+
+	/* client sessions watching this key */
+	storeWatcher		*watchers;
+	int			nWatchers;
+	int			maxWatchers;
+
+	/* session that owns this (per-session) key, MACH_PORT_NULL if none */
+	mach_port_t		session;
+
+	/* store generation (commit) in which the data was last changed */
+	uint64_t		generation;
+
+	/* TRUE if restored from a checkpoint (and not yet [re-]set) */
+	Boolean			restored;
+
+	/*
+	 * the decoded data (NULL if not cached), its [approximate] size,
+	 * and the LRU linkage of the cached values
+	 */
+	CFPropertyListRef	value;
+	size_t			valueSize;
+	struct storeEntry	*valuePrev;
+	struct storeEntry	*valueNext;
+
+} storeEntry, *storeEntryRef;
+
+
+typedef void (*storeApplierFunction)	(storeEntryRef	entry,
+					 void		*context);
+
+
+/* an immutable copy of the store (see storeSnapshotCopy) */
+typedef struct storeSnapshot	*storeSnapshotRef;
+
+typedef void (*storeSnapshotApplierFunction)	(CFStringRef	key,
+						 CFDataRef	data,
+						 void		*context);
+
+typedef void (*storeSnapshotRecordFunction)	(const UInt8	*keyBytes,
+						 CFIndex	keyLen,
+						 CFDataRef	data,
+						 uint64_t	generation,
+						 void		*context);
+
+
+__BEGIN_DECLS
+
+/* the current store generation (incremented on each commit) */
+extern uint64_t		storeGeneration;
+
+void			storeInitialize		(void);
+
+storeEntryRef		storeLookup		(CFStringRef		key);
+
+storeEntryRef		storeLookupOrAdd	(CFStringRef		key);
+
+void			storeRemoveIfUnused	(storeEntryRef		entry);
+
+CFIndex			storeGetCount		(void);
+
+/*
+ * storeKeyCompare
+ *   a CFComparatorFunction ordering keys by their UTF-8 bytes (the order
+ *   of the key index, snapshots, and key listings).
+ */
+CFComparisonResult	storeKeyCompare		(const void		*val1,
+						 const void		*val2,
+						 void			*context);
+
+void			storeApplyFunction	(storeApplierFunction	applier,
+						 void			*context);
+
+/*
+ * storeApplyPrefixFunction
+ *   calls the applier function, in key order, for each entry with data
+ *   whose key begins with the specified prefix.  The applier function
+ *   must not add or remove store entries (or data).
+ */
+void			storeApplyPrefixFunction(CFStringRef		prefix,
+						 storeApplierFunction	applier,
+						 void			*context);
+
+void			storeSetData		(storeEntryRef		entry,
+						 CFDataRef		data);
+
+/*
+ * storeSetSession
+ *   sets (or, with MACH_PORT_NULL, clears) the session owning a per-session
+ *   key.  Must be called (rather than setting entry->session) so that
+ *   snapshots can tell the per-session keys apart.
+ */
+void			storeSetSession		(storeEntryRef		entry,
+						 mach_port_t		session);
+
+/*
+ * storeCommit
+ *   completes the current commit, advancing the store generation if any
+ *   data was changed.
+ */
+void			storeCommit		(void);
+
+Boolean			storeAddWatcher		(storeEntryRef		entry,
+						 mach_port_t		session);
+
+Boolean			storeRemoveWatcher	(storeEntryRef		entry,
+						 mach_port_t		session);
+
+CF_RETURNS_RETAINED
+CFDictionaryRef		storeCopyEntryInfo	(storeEntryRef		entry,
+						 Boolean		expand);
+
+/*
+ * storeCopyValue
+ *   returns the decoded data associated with the entry, NULL if none (or
+ *   if the data could not be decoded).  Must be called from the server
+ *   thread.
+ */
+CF_RETURNS_RETAINED
+CFPropertyListRef	storeCopyValue		(storeEntryRef		entry);
+
+/*
+ * storeGetValueCacheInfo
+ *   returns the # of cached values, their [approximate] size (and the
+ *   limit), and the # of cache hits and misses.
+ */
+void			storeGetValueCacheInfo	(CFIndex		*count,
+						 size_t			*size,
+						 size_t			*limit,
+						 uint64_t		*hits,
+						 uint64_t		*misses);
+
+/*
+ * storeSnapshotCopy
+ *   returns a [retained] snapshot of the current store contents.  A new
+ *   snapshot is only created if the store has changed since the last call
+ *   (and only retains the current radix tree).  Must be called from the
+ *   server thread.
+ */
+storeSnapshotRef	storeSnapshotCopy	(void);
+
+/*
+ * storeSnapshotCopyGeneration
+ *   returns a [retained] snapshot of the store as of the specified
+ *   generation, NULL if that generation is no longer available.  May be
+ *   called from any thread.
+ */
+storeSnapshotRef	storeSnapshotCopyGeneration
+						(uint64_t		generation);
+
+storeSnapshotRef	storeSnapshotRetain	(storeSnapshotRef	snapshot);
+
+void			storeSnapshotRelease	(storeSnapshotRef	snapshot);
+
+uint64_t		storeSnapshotGetGeneration
+						(storeSnapshotRef	snapshot);
+
+CFIndex			storeSnapshotGetCount	(storeSnapshotRef	snapshot);
+
+/*
+ * storeSnapshotGetData
+ *   returns the data associated with a key in the snapshot (and,
+ *   optionally, the generation in which that data last changed).
+ */
+CFDataRef		storeSnapshotGetData	(storeSnapshotRef	snapshot,
+						 CFStringRef		key,
+						 uint64_t		*generation);
+
+/*
+ * storeSnapshotApplyPrefixFunction
+ *   calls the applier function, in key order, for each key in the
+ *   snapshot which begins with the specified prefix.
+ */
+void			storeSnapshotApplyPrefixFunction
+						(storeSnapshotRef		snapshot,
+						 CFStringRef			prefix,
+						 storeSnapshotApplierFunction	applier,
+						 void				*context);
+
+/*
+ * storeCopyRemovedKeys
+ *   returns the UTF-8 bytes (CFData) of the keys removed after the "since"
+ *   generation (and not since re-added), in key order.  Returns NULL if
+ *   the removals are no longer known.  Must be called from the server
+ *   thread.
+ */
+CF_RETURNS_RETAINED
+CFArrayRef		storeCopyRemovedKeys	(uint64_t		since);
+
+/*
+ * storeSnapshotApplyChangesFunction
+ *   calls the applier function, in key order, with the UTF-8 key bytes,
+ *   data, and generation of each key in the snapshot whose data changed
+ *   after the "since" generation (or of every key if "since" is 0).  The
+ *   "removed" keys (see storeCopyRemovedKeys) are reported, in order, with
+ *   NULL data.  Only the parts of the tree changed after "since" are
+ *   visited.  May be called from any thread.
+ */
+void			storeSnapshotApplyChangesFunction
+						(storeSnapshotRef		snapshot,
+						 uint64_t			since,
+						 CFArrayRef			removed,
+						 storeSnapshotRecordFunction	applier,
+						 void				*context);
+
+/*
+ * storeSnapshotApplyRecordsFunction
+ *   calls the applier function, in key order, with the UTF-8 key bytes,
+ *   data, and generation of each key in the snapshot.  The per-session
+ *   keys are only reported if "sessionKeys" is TRUE.  May be called from
+ *   any thread.
+ */
+void			storeSnapshotApplyRecordsFunction
+						(storeSnapshotRef		snapshot,
+						 Boolean			sessionKeys,
+						 storeSnapshotRecordFunction	applier,
+						 void				*context);
+
+__END_DECLS
+
+#endif /* !_S_STORE_H */
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+/*
+ * request trace
+ *
+ * When enabled (configd "-T <KB>"), each request (and notification) is
+ * recorded as a fixed size binary record in a per-thread ring of a
+ * memory-mapped file (see trace_format.h).  Recording is a handful of
+ * stores into the calling thread's ring; nothing is formatted, locked,
+ * or written.  There is a ring for each reader thread (and for the
+ * server, plug-in, and delivery threads); any other thread shares the
+ * last ring, claiming each record slot with an atomic increment.  The
+ * trace can be decoded at any time (and after a crash) with "scutil
+ * --trace".
+ *
+ * A ring has a single writer so a record is published with release
+ * stores (of its "seq" and the ring's "head") rather than full memory
+ * barriers; only the stores need to be ordered.
+ */
+
+#include "configd.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <paths.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <mach/mach_time.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <libkern/OSAtomic.h>
+
+
+#define	TRACE_PATH		_PATH_VARRUN "configd-trace"
+#define	TRACE_PATH_OLD		_PATH_VARRUN "configd-trace.old"
+
+#define	TRACE_HEADER_SIZE	64		/* space reserved for the traceHeader */
+#define	TRACE_RINGS		16		/* rings for the server, plug-in, delivery, ... threads */
+#define	TRACE_RECORDS_MIN	256
+#define	TRACE_RECORDS_MAX	(1024 * 1024)
+
+#define	TRACE_RING_SHARED	UINT64_MAX	/* owner of the shared ring */
+
+
+static traceHeader		*trace		= NULL;
+static traceRing		*traceShared	= NULL;	/* the ring shared by threads without one */
+static pthread_key_t		traceRingKey;
+
+
+static traceRing *
+traceRingAt(uint32_t i)
+{
+	return (traceRing *)(void *)((UInt8 *)trace + trace->headerSize + ((size_t)i * trace->ringSize));
+}
+
+
+static void
+traceRingRelease(void *context)
+{
+	traceRing	*ring	= (traceRing *)context;
+
+	/* the thread is exiting, make its ring available */
+	if (ring != traceShared) {
+		OSMemoryBarrier();
+		ring->owner = 0;
+	}
+
+	return;
+}
+
+
+static traceRing *
+traceRingClaim(void)
+{
+	uint32_t	i;
+	traceRing	*ring;
+	uint64_t	tid	= 0;
+
+	(void) pthread_threadid_np(pthread_self(), &tid);
+	for (i = 0; i < trace->sharedRing; i++) {
+		ring = traceRingAt(i);
+		if ((ring->owner == 0) &&
+		    OSAtomicCompareAndSwap64Barrier(0, (int64_t)tid, (volatile int64_t *)&ring->owner)) {
+			bzero(ring->name, sizeof(ring->name));
+			(void) pthread_getname_np(pthread_self(), ring->name, sizeof(ring->name));
+			goto done;
+		}
+	}
+
+	/* if all of the rings are in use, use the shared ring */
+	ring = traceShared;
+
+    done :
+
+	(void) pthread_setspecific(traceRingKey, ring);
+	return ring;
+}
+
+
+__private_extern__
+uint64_t
+traceStart(void)
+{
+	if (trace == NULL) {
+		/* if not tracing */
+		return 0;
+	}
+
+	return mach_absolute_time();
+}
+
+
+__private_extern__
+void
+traceRecordOp(traceOp		op,
+	      uint16_t		flags,
+	      mach_port_t	server,
+	      CFStringRef	key,
+	      int		status,
+	      uint64_t		start,
+	      uint32_t		arg)
+{
+	uint64_t	duration;
+	uint64_t	head;
+	traceRecord	*record;
+	traceRing	*ring;
+
+	if (start == 0) {
+		/* if not tracing */
+		return;
+	}
+
+	duration = mach_absolute_time() - start;
+
+	ring = pthread_getspecific(traceRingKey);
+	if (ring == NULL) {
+		ring = traceRingClaim();
+	}
+	if (ring != traceShared) {
+		head = ring->head;
+	} else {
+		/* the shared ring has more than one writer, claim the slot */
+		head = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+	}
+
+	record = &((traceRecord *)(void *)(ring + 1))[head & (trace->ringRecords - 1)];
+
+	/* mark the record as being written (before any of it is) */
+	__atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	record->time     = start;
+	record->duration = (duration < UINT32_MAX) ? (uint32_t)duration : UINT32_MAX;
+	record->op       = op;
+	record->flags    = flags;
+	record->session  = server;
+	record->key      = (key != NULL) ? (uint32_t)CFHash(key) : 0;
+	record->status   = status;
+	record->arg      = arg;
+
+	/* and make the record visible to a reader */
+	__atomic_store_n(&record->seq, (uint32_t)(head + 1), __ATOMIC_RELEASE);
+	if (ring != traceShared) {
+		__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+	}
+	return;
+}
+
+
+__private_extern__
+void
+traceEvent(traceOp op, uint16_t flags, mach_port_t server, int status, uint32_t arg)
+{
+	if (trace == NULL) {
+		/* if not tracing */
+		return;
+	}
+
+	traceRecordOp(op, flags, server, NULL, status, mach_absolute_time(), arg);
+	return;
+}
+
+
+__private_extern__
+void
+traceInit(size_t ringSize, uint32_t nReaders)
+{
+	int				fd;
+	size_t				fileSize;
+	traceHeader			*header;
+	void				*map;
+	uint32_t			nRings;
+	uint32_t			records;
+	mach_timebase_info_data_t	timebase;
+	struct timeval			tv;
+
+	if (trace != NULL) {
+		/* if already tracing */
+		return;
+	}
+
+	/* the # of records per ring (a power of 2) */
+	records = TRACE_RECORDS_MIN;
+	while ((records < TRACE_RECORDS_MAX) && ((records * sizeof(traceRecord)) < ringSize)) {
+		records <<= 1;
+	}
+	nRings = TRACE_RINGS + nReaders + 1;	/* ... and the shared ring */
+	fileSize = TRACE_HEADER_SIZE + (nRings * (sizeof(traceRing) + (records * sizeof(traceRecord))));
+
+	/* keep the previous trace (e.g. for a post-mortem after a crash) */
+	(void) rename(TRACE_PATH, TRACE_PATH_OLD);
+
+	fd = open(TRACE_PATH, O_RDWR|O_CREAT|O_TRUNC|O_EXCL, 0600);
+	if (fd == -1) {
+		SCLog(TRUE, LOG_ERR, CFSTR("traceInit open() failed: %s"), strerror(errno));
+		return;
+	}
+	if (ftruncate(fd, fileSize) == -1) {
+		SCLog(TRUE, LOG_ERR, CFSTR("traceInit ftruncate() failed: %s"), strerror(errno));
+		(void) close(fd);
+		return;
+	}
+	map = mmap(NULL, fileSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	(void) close(fd);
+	if (map == MAP_FAILED) {
+		SCLog(TRUE, LOG_ERR, CFSTR("traceInit mmap() failed: %s"), strerror(errno));
+		return;
+	}
+
+	if (pthread_key_create(&traceRingKey, traceRingRelease) != 0) {
+		SCLog(TRUE, LOG_ERR, CFSTR("traceInit pthread_key_create() failed"));
+		(void) munmap(map, fileSize);
+		return;
+	}
+
+	(void) mach_timebase_info(&timebase);
+	(void) gettimeofday(&tv, NULL);
+
+	header = (traceHeader *)map;
+	header->magic         = TRACE_MAGIC;
+	header->version       = TRACE_VERSION;
+	header->headerSize    = TRACE_HEADER_SIZE;
+	header->ringSize      = (uint32_t)(sizeof(traceRing) + (records * sizeof(traceRecord)));
+	header->ringRecords   = records;
+	header->nRings        = nRings;
+	header->timebaseNumer = timebase.numer;
+	header->timebaseDenom = timebase.denom;
+	header->created       = ((uint64_t)tv.tv_sec * USEC_PER_SEC) + tv.tv_usec;
+	header->createdTime   = mach_absolute_time();
+	header->sharedRing    = nRings - 1;
+
+	traceShared = (traceRing *)(void *)((UInt8 *)header + header->headerSize + ((size_t)header->sharedRing * header->ringSize));
+	traceShared->owner = TRACE_RING_SHARED;
+	strlcpy(traceShared->name, "shared", sizeof(traceShared->name));
+
+	/* and start tracing */
+	OSMemoryBarrier();
+	trace = header;
+	return;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_TRACE_H
+#define _S_TRACE_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+#include "trace_format.h"
+
+
+__BEGIN_DECLS
+
+/*
+ * traceInit
+ *   creates the request trace (with rings of the specified size, enough
+ *   for the specified # of reader threads) and starts tracing.  Any
+ *   previous trace is preserved as "configd-trace.old".
+ */
+void		traceInit		(size_t			ringSize,
+					 uint32_t		nReaders);
+
+/*
+ * traceStart
+ *   returns the start time of an operation to be traced, 0 if tracing
+ *   is not enabled.
+ */
+uint64_t	traceStart		(void);
+
+/*
+ * traceRecordOp
+ *   records an operation (started at the time returned by traceStart)
+ *   in the calling thread's ring.  Does nothing if "start" is 0.  May
+ *   be called from any thread.
+ */
+void		traceRecordOp		(traceOp		op,
+					 uint16_t		flags,
+					 mach_port_t		server,
+					 CFStringRef		key,
+					 int			status,
+					 uint64_t		start,
+					 uint32_t		arg);
+
+/*
+ * traceEvent
+ *   records an event (an operation with no duration) if tracing is
+ *   enabled.
+ */
+void		traceEvent		(traceOp		op,
+					 uint16_t		flags,
+					 mach_port_t		server,
+					 int			status,
+					 uint32_t		arg);
+
+/*
+ * traceArgCounts
+ *   returns the "arg" for an operation on some # of keys and patterns
+ */
+static __inline__ uint32_t
+traceArgCounts(CFIndex nKeys, CFIndex nPatterns)
+{
+	if (nKeys > 0xffff)	nKeys = 0xffff;
+	if (nPatterns > 0xffff)	nPatterns = 0xffff;
+	return (uint32_t)nKeys | ((uint32_t)nPatterns << 16);
+}
+
+__END_DECLS
+
+#endif /* !_S_TRACE_H */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+
+
+#ifndef _S_TRACE_FORMAT_H
+#define _S_TRACE_FORMAT_H
+
+/*
+ * The request trace
+ *
+ * The trace is a memory-mapped file holding a fixed number of "rings"
+ * of fixed size (40 byte) binary records.  There is a ring for each of
+ * configd's threads (including one per reader thread); a thread claims a
+ * ring the first time it traces a request and is then the only writer of
+ * that ring (a ring is released, and may be claimed by another thread,
+ * when its thread exits).  Any thread that finds all of the rings in use
+ * writes to the last, "shared", ring instead.  When a ring is full, the
+ * oldest records are overwritten.
+ *
+ * A ring's "head" is the # of records ever written (or, for the shared
+ * ring, started) in the ring; record # "head" is written to
+ * records[head % ringRecords].  Each record carries its own sequence :
+ * "seq" is cleared before the record is written and then set to the
+ * (low 32 bits of the) record # + 1.  A reader copies the records from
+ * MAX(0, head - ringRecords) to head, keeping only those whose "seq"
+ * matched the record # both before and after the copy (any other record
+ * was being written, or was overwritten, during the copy).
+ *
+ * Times (and durations) are in mach_absolute_time() units; see the
+ * timebase (and created / createdTime) in the header to convert.  A key
+ * is identified by its hash (the low 32 bits of CFHash()).
+ *
+ * All values are in host byte order.  This header has no dependencies
+ * so that the trace can be decoded on any host.
+ */
+
+#include <stdint.h>
+
+#define	TRACE_MAGIC		0x53435452	/* 'SCTR' */
+#define	TRACE_VERSION		2
+
+typedef struct {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		headerSize;	/* offset (from the start of the file) of the first ring */
+	uint32_t		ringSize;	/* size of each ring (the traceRing and its records) */
+	uint32_t		ringRecords;	/* # of records in each ring (a power of 2) */
+	uint32_t		nRings;		/* # of rings */
+	uint32_t		timebaseNumer;	/* mach_absolute_time() units --> nsecs */
+	uint32_t		timebaseDenom;
+	uint64_t		created;	/* time (usecs since 1970) the trace was created */
+	uint64_t		createdTime;	/* mach_absolute_time() when the trace was created */
+	uint32_t		sharedRing;	/* the ring shared by the threads without one of their own */
+	uint32_t		_reserved1;
+	uint64_t		_reserved;
+} traceHeader;
+
+typedef struct {
+	volatile uint64_t	head;		/* # of records written */
+	volatile uint64_t	owner;		/* thread id of the writer, 0 if available (UINT64_MAX if shared) */
+	char			name[48];	/* [last] writer thread name */
+} traceRing;
+
+typedef enum {
+	kTraceOpNone		= 0,
+	kTraceOpOpen		= 1,		/* session opened */
+	kTraceOpClose		= 2,		/* session closed */
+	kTraceOpCleanup		= 3,		/* session (port) cleaned up */
+	kTraceOpAdd		= 4,		/* key */
+	kTraceOpCopy		= 5,		/* key */
+	kTraceOpCopyMultiple	= 6,		/* arg : # keys (low 16 bits), # patterns (high 16 bits) */
+	kTraceOpSet		= 7,		/* key */
+	kTraceOpSetMultiple	= 8,		/* arg : # set + # removed + # notified */
+	kTraceOpRemove		= 9,		/* key */
+	kTraceOpNotify		= 10,		/* key */
+	kTraceOpWatchAdd	= 11,		/* key (or pattern) */
+	kTraceOpWatchRemove	= 12,		/* key (or pattern) */
+	kTraceOpWatchSet	= 13,		/* arg : # keys (low 16 bits), # patterns (high 16 bits) */
+	kTraceOpWatchProps	= 14,		/* key (or pattern), arg : # properties */
+	kTraceOpPush		= 15,		/* arg : # sessions notified */
+	kTraceOpPostPort	= 16,		/* notification posted, arg : port */
+	kTraceOpPostRing	= 17,		/* notification posted (ring doorbell), arg : port */
+	kTraceOpPostValues	= 18,		/* notification (with values) posted, arg : # bytes */
+	kTraceOpPostFD		= 19,		/* notification posted, arg : fd */
+	kTraceOpPostSignal	= 20,		/* notification posted, arg : signal */
+	kTraceOpDelivered	= 21,		/* notification delivered, status : mach status, arg : latency (usecs) */
+	kTraceOpPlugin		= 22,		/* plug-in event, key : bundle identifier, arg : kTracePlugin* */
+	kTraceOpLast
+} traceOp;
+
+#define	kTraceFlagInternal	0x0001		/* request made within configd */
+#define	kTraceFlagPattern	0x0002		/* the key is a pattern */
+#define	kTraceFlagSessionKey	0x0004		/* session (temporary) key */
+#define	kTraceFlagSnapshot	0x0008		/* serviced from a snapshot (reader thread) */
+
+/* kTraceOpPlugin events */
+#define	kTracePluginBeforeLoad	1		/* before loading any plug-ins */
+#define	kTracePluginLoading	2		/* loading the bundle executable */
+#define	kTracePluginLoad	3		/* calling load() */
+#define	kTracePluginStart	4		/* calling start() */
+#define	kTracePluginPrime	5		/* calling prime() */
+#define	kTracePluginRunLoop	6		/* about to start the plug-in CFRunLoop */
+#define	kTracePluginWaiting	7		/* the plug-in CFRunLoop is waiting */
+
+typedef struct {
+	uint64_t		time;		/* mach_absolute_time() at the start of the operation */
+	uint32_t		duration;	/* mach_absolute_time() units (UINT32_MAX if longer) */
+	uint16_t		op;		/* traceOp */
+	uint16_t		flags;
+	uint32_t		session;	/* session (server port) */
+	uint32_t		key;		/* key (or pattern) hash, 0 if none */
+	int32_t			status;		/* sc_status */
+	uint32_t		arg;		/* operation specific */
+	volatile uint32_t	seq;		/* record # + 1 (low 32 bits), 0 while being written */
+	uint32_t		_reserved;
+} traceRecord;
+
+#endif /* !_S_TRACE_FORMAT_H */
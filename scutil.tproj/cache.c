@@ -257,11 +257,29 @@ do_block(int argc, char **argv)
 }
 
 
+/* sort keys by their UTF-8 bytes (the order of the server's key list) */
 static CFComparisonResult
 sort_keys(const void *p1, const void *p2, void *context) {
-	CFStringRef key1 = (CFStringRef)p1;
-	CFStringRef key2 = (CFStringRef)p2;
-	return CFStringCompare(key1, key2, 0);
+	char		buf1_q[256];
+	char		*buf1;
+	char		buf2_q[256];
+	char		*buf2;
+	int		r;
+
+	buf1 = _SC_cfstring_to_cstring((CFStringRef)p1, buf1_q, sizeof(buf1_q), kCFStringEncodingUTF8);
+	if (buf1 == NULL) {
+		buf1 = _SC_cfstring_to_cstring((CFStringRef)p1, NULL, 0, kCFStringEncodingUTF8);
+	}
+	buf2 = _SC_cfstring_to_cstring((CFStringRef)p2, buf2_q, sizeof(buf2_q), kCFStringEncodingUTF8);
+	if (buf2 == NULL) {
+		buf2 = _SC_cfstring_to_cstring((CFStringRef)p2, NULL, 0, kCFStringEncodingUTF8);
+	}
+
+	r = strcmp(buf1, buf2);
+
+	if (buf1 != buf1_q) CFAllocatorDeallocate(NULL, buf1);
+	if (buf2 != buf2_q) CFAllocatorDeallocate(NULL, buf2);
+	return (r < 0) ? kCFCompareLessThan : (r > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo;
 }
 
 
@@ -276,6 +294,7 @@ do_list(int argc, char **argv)
 	CFStringRef		pattern;
 	CFArrayRef		list;
 	CFIndex			listCnt;
+	Boolean			needsSort	= FALSE;
 	CFMutableArrayRef	sortedList;
 
 	pattern = CFStringCreateWithCString(NULL,
@@ -308,6 +327,7 @@ do_list(int argc, char **argv)
 				if (cachedKeys != cachedKeys_q) {
 					CFAllocatorDeallocate(NULL, cachedKeys);
 				}
+				needsSort = TRUE;	/* cached keys are not ordered */
 			} else {
 				SCPrint(TRUE, stdout, CFSTR("  no keys.\n"));
 				return;
@@ -320,13 +340,18 @@ do_list(int argc, char **argv)
 			CFSTR("  Note: SCDynamicStore transactions in progress, key list (below) may be out of date.\n\n"));
 	}
 
+	/*
+	 * Note: the key list returned by the server is already sorted
+	 */
 	listCnt = CFArrayGetCount(list);
 	sortedList = CFArrayCreateMutableCopy(NULL, listCnt, list);
 	CFRelease(list);
-	CFArraySortValues(sortedList,
-			  CFRangeMake(0, listCnt),
-			  sort_keys,
-			  NULL);
+	if (needsSort) {
+		CFArraySortValues(sortedList,
+				  CFRangeMake(0, listCnt),
+				  sort_keys,
+				  NULL);
+	}
 
 	if (listCnt > 0) {
 		for (i = 0; i < listCnt; i++) {
@@ -140,8 +140,11 @@ const cmdInfo commands_store[] = {
 	{ "n.cancel",	0,	1,	do_notify_cancel,	5,	0,
 		" n.cancel                      : cancel notification requests"			},
 
-	{ "snapshot",	0,	0,	do_snapshot,		99,	2,
-		" snapshot                      : save snapshot of store and session data"	}
+	{ "snapshot",	0,	1,	do_snapshot,		99,	2,
+		" snapshot [stream | delta]     : save snapshot of store and session data"	},
+
+	{ "stats",	0,	1,	do_stats,		99,	0,
+		" stats [reset]                 : show the server's request statistics"	}
 };
 __private_extern__
 const int nCommands_store = (sizeof(commands_store)/sizeof(cmdInfo));
@@ -68,6 +68,7 @@
 #include "prefs.h"
 #include "session.h"
 #include "tests.h"
+#include "trace.h"
 
 
 #define LINE_LENGTH 2048
@@ -106,6 +107,8 @@ static const struct option longopts[] = {
 	{ "renew",		required_argument,	NULL,	0	},
 	{ "set",		required_argument,	NULL,	0	},
 	{ "snapshot",		no_argument,		NULL,	0	},
+	{ "stats",		no_argument,		NULL,	0	},
+	{ "trace",		no_argument,		NULL,	0	},
 	{ "user",		required_argument,	NULL,	0	},
 	{ "password",		required_argument,	NULL,	0	},
 	{ "secret",		required_argument,	NULL,	0	},
@@ -356,6 +359,12 @@ usage(const char *command)
 	SCPrint(TRUE, stderr, CFSTR("\n"));
 	SCPrint(TRUE, stderr, CFSTR("   or: %s --nc\n"), command);
 	SCPrint(TRUE, stderr, CFSTR("\tshow VPN network configuration information. Use --nc help for full command list\n"));
+	SCPrint(TRUE, stderr, CFSTR("\n"));
+	SCPrint(TRUE, stderr, CFSTR("   or: %s --stats [reset]\n"), command);
+	SCPrint(TRUE, stderr, CFSTR("\tshow the configd request statistics.\n"));
+	SCPrint(TRUE, stderr, CFSTR("\n"));
+	SCPrint(TRUE, stderr, CFSTR("   or: %s --trace [trace-file]\n"), command);
+	SCPrint(TRUE, stderr, CFSTR("\tshow the configd request trace (see configd -T).\n"));
 
 	if (_sc_debug) {
 		SCPrint(TRUE, stderr, CFSTR("\n"));
@@ -398,6 +407,8 @@ main(int argc, char * const argv[])
 	Boolean			doProxy	= FALSE;
 	Boolean			doReach	= FALSE;
 	Boolean			doSnap	= FALSE;
+	Boolean			doStats	= FALSE;
+	Boolean			doTrace	= FALSE;
 	char			*error	= NULL;
 	char			*get	= NULL;
 	char			*log	= NULL;
@@ -480,6 +491,12 @@ main(int argc, char * const argv[])
 			} else if (strcmp(longopts[opti].name, "snapshot") == 0) {
 				doSnap = TRUE;
 				xStore++;
+			} else if (strcmp(longopts[opti].name, "stats") == 0) {
+				doStats = TRUE;
+				xStore++;
+			} else if (strcmp(longopts[opti].name, "trace") == 0) {
+				doTrace = TRUE;
+				xStore++;
 			} else if (strcmp(longopts[opti].name, "log") == 0) {
 				log = optarg;
 				xStore++;
@@ -555,6 +572,19 @@ main(int argc, char * const argv[])
 		exit(0);
 	}
 
+	/* are we reporting the server's request statistics */
+	if (doStats) {
+		do_open(0, NULL);	/* open the dynamic store */
+		do_stats(argc, (char **)argv);
+		exit(0);
+	}
+
+	/* are we decoding the configd request trace */
+	if (doTrace) {
+		do_trace(argc, (char **)argv);
+		/* NOT REACHED */
+	}
+
 	/* are we translating error #'s to descriptive text */
 	if (error != NULL) {
 		int	sc_status	= atoi(error);
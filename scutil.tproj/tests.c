@@ -1022,6 +1022,19 @@ __private_extern__
 void
 do_snapshot(int argc, char **argv)
 {
+	if ((argc > 0) &&
+	    ((strcmp(argv[0], "stream") == 0) || (strcmp(argv[0], "delta") == 0))) {
+		uint64_t	generation;
+
+		if (!SCDynamicStoreSnapshotStream(store, (strcmp(argv[0], "delta") == 0), &generation)) {
+			SCPrint(TRUE, stdout, CFSTR("  %s\n"), SCErrorString(SCError()));
+			return;
+		}
+
+		SCPrint(TRUE, stdout, CFSTR("  generation = %llu\n"), generation);
+		return;
+	}
+
 	if (!SCDynamicStoreSnapshot(store)) {
 		SCPrint(TRUE, stdout, CFSTR("  %s\n"), SCErrorString(SCError()));
 	}
@@ -1032,6 +1045,235 @@ do_snapshot(int argc, char **argv)
 }
 
 
+static uint64_t
+statsPercentile(CFArrayRef histogram, int64_t count, int64_t max, double percentile)
+{
+	int64_t		cum	= 0;
+	CFIndex		i;
+	CFIndex		n;
+	int64_t		target;
+
+	/* returns the limit of the bucket holding the percentile */
+	target = (int64_t)((count * percentile) + 0.999999);
+	n = CFArrayGetCount(histogram);
+	for (i = 0; i < n; i++) {
+		int64_t		bucketCount	= 0;
+		int64_t		limit		= 0;
+		CFArrayRef	pair;
+
+		pair = CFArrayGetValueAtIndex(histogram, i);
+		if (!isA_CFArray(pair) || (CFArrayGetCount(pair) != 2)) {
+			continue;
+		}
+		(void) CFNumberGetValue(CFArrayGetValueAtIndex(pair, 0), kCFNumberSInt64Type, &limit);
+		(void) CFNumberGetValue(CFArrayGetValueAtIndex(pair, 1), kCFNumberSInt64Type, &bucketCount);
+		cum += bucketCount;
+		if (cum >= target) {
+			return (limit < max) ? limit : max;
+		}
+	}
+
+	return max;
+}
+
+
+static int64_t
+statsValue(CFDictionaryRef reqStats, CFStringRef key)
+{
+	CFNumberRef	num;
+	int64_t		val	= 0;
+
+	num = CFDictionaryGetValue(reqStats, key);
+	if (isA_CFNumber(num)) {
+		(void) CFNumberGetValue(num, kCFNumberSInt64Type, &val);
+	}
+	return val;
+}
+
+
+static CFComparisonResult
+compareStatsTime(const void *val1, const void *val2, void *context)
+{
+	CFDictionaryRef	requests	= (CFDictionaryRef)context;
+	int64_t		time1;
+	int64_t		time2;
+
+	time1 = statsValue(CFDictionaryGetValue(requests, val1), CFSTR("Time"));
+	time2 = statsValue(CFDictionaryGetValue(requests, val2), CFSTR("Time"));
+	if (time1 != time2) {
+		return (time1 > time2) ? kCFCompareLessThan : kCFCompareGreaterThan;
+	}
+	return CFStringCompare(val1, val2, 0);
+}
+
+
+static void
+printSessionStats(CFArrayRef sessions)
+{
+	CFIndex		i;
+	CFIndex		n;
+
+	/* the sessions are reported with the most [total] time first */
+	n = CFArrayGetCount(sessions);
+	if (n == 0) {
+		return;
+	}
+
+	SCPrint(TRUE, stdout,
+		CFSTR("\n%-24s %7s %8s %8s %8s %8s %12s %12s %8s %8s %12s\n"),
+		"session", "pid", "read", "write", "watch", "other",
+		"bytes in", "bytes out", "notify", "watched", "time(us)");
+	for (i = 0; i < n; i++) {
+		char		*nameStr;
+		CFDictionaryRef	requests;
+		CFDictionaryRef	sessionStats;
+
+		sessionStats = CFArrayGetValueAtIndex(sessions, i);
+		if (!isA_CFDictionary(sessionStats)) {
+			continue;
+		}
+
+		requests = CFDictionaryGetValue(sessionStats, CFSTR("Requests"));
+		if (!isA_CFDictionary(requests)) {
+			continue;
+		}
+
+		nameStr = _SC_cfstring_to_cstring(isA_CFString(CFDictionaryGetValue(sessionStats, CFSTR("Name"))),
+						  NULL,
+						  0,
+						  kCFStringEncodingUTF8);
+
+		SCPrint(TRUE, stdout,
+			CFSTR("%-24.24s %7lld %8lld %8lld %8lld %8lld %12lld %12lld %8lld %8lld %12.0f\n"),
+			(nameStr != NULL) ? nameStr : "???",
+			statsValue(sessionStats, CFSTR("PID")),
+			statsValue(requests, CFSTR("Read")),
+			statsValue(requests, CFSTR("Write")),
+			statsValue(requests, CFSTR("Watch")),
+			statsValue(requests, CFSTR("Other")),
+			statsValue(sessionStats, CFSTR("BytesIn")),
+			statsValue(sessionStats, CFSTR("BytesOut")),
+			statsValue(sessionStats, CFSTR("Notifications")),
+			statsValue(sessionStats, CFSTR("WatchedKeys")) + statsValue(sessionStats, CFSTR("WatchedPatterns")),
+			(double)statsValue(sessionStats, CFSTR("Time")) / 1000.0);
+		if (nameStr != NULL) CFAllocatorDeallocate(NULL, nameStr);
+	}
+
+	return;
+}
+
+
+__private_extern__
+void
+do_stats(int argc, char **argv)
+{
+	CFDictionaryRef		admission;
+	CFIndex			i;
+	const void		**keys;
+	CFMutableArrayRef	names;
+	CFIndex			n;
+	CFDictionaryRef		requests;
+	Boolean			reset	= FALSE;
+	CFArrayRef		sessions;
+	CFDateRef		since;
+	CFDictionaryRef		stats;
+
+	if ((argc > 0) && (strcmp(argv[0], "reset") == 0)) {
+		reset = TRUE;
+	}
+
+	stats = SCDynamicStoreCopyStatistics(store, reset);
+	if (stats == NULL) {
+		SCPrint(TRUE, stdout, CFSTR("  %s\n"), SCErrorString(SCError()));
+		return;
+	}
+
+	since = CFDictionaryGetValue(stats, CFSTR("Since"));
+	if (isA_CFDate(since)) {
+		SCPrint(TRUE, stdout, CFSTR("since %@ (%.0f seconds)\n\n"),
+			since,
+			CFAbsoluteTimeGetCurrent() - CFDateGetAbsoluteTime(since));
+	}
+
+	requests = CFDictionaryGetValue(stats, CFSTR("Requests"));
+	if (!isA_CFDictionary(requests) || (CFDictionaryGetCount(requests) == 0)) {
+		SCPrint(TRUE, stdout, CFSTR("  no requests\n"));
+		CFRelease(stats);
+		return;
+	}
+
+	/* report the requests taking the most [total] time first */
+	n = CFDictionaryGetCount(requests);
+	keys = CFAllocatorAllocate(NULL, n * sizeof(CFTypeRef), 0);
+	CFDictionaryGetKeysAndValues(requests, keys, NULL);
+	names = CFArrayCreateMutable(NULL, n, &kCFTypeArrayCallBacks);
+	for (i = 0; i < n; i++) {
+		CFArrayAppendValue(names, keys[i]);
+	}
+	CFAllocatorDeallocate(NULL, keys);
+	CFArraySortValues(names, CFRangeMake(0, n), compareStatsTime, (void *)requests);
+
+	SCPrint(TRUE, stdout,
+		CFSTR("%-18s %10s %12s %12s %10s %10s %10s %10s %10s\n"),
+		"request", "count", "bytes in", "bytes out",
+		"mean(us)", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+	for (i = 0; i < n; i++) {
+		int64_t		count;
+		CFArrayRef	histogram;
+		int64_t		max;
+		CFStringRef	name;
+		char		nameStr[32];
+		CFDictionaryRef	reqStats;
+
+		name = CFArrayGetValueAtIndex(names, i);
+		reqStats = CFDictionaryGetValue(requests, name);
+		if (!isA_CFDictionary(reqStats)) {
+			continue;
+		}
+
+		count = statsValue(reqStats, CFSTR("Count"));
+		if (count == 0) {
+			continue;
+		}
+		max = statsValue(reqStats, CFSTR("TimeMax"));
+		histogram = isA_CFArray(CFDictionaryGetValue(reqStats, CFSTR("Histogram")));
+		(void) _SC_cfstring_to_cstring(name, nameStr, sizeof(nameStr), kCFStringEncodingASCII);
+
+		SCPrint(TRUE, stdout,
+			CFSTR("%-18s %10lld %12lld %12lld %10.2f %10.2f %10.2f %10.2f %10.2f\n"),
+			nameStr,
+			count,
+			statsValue(reqStats, CFSTR("BytesIn")),
+			statsValue(reqStats, CFSTR("BytesOut")),
+			(double)statsValue(reqStats, CFSTR("Time")) / count / 1000.0,
+			(histogram != NULL) ? (double)statsPercentile(histogram, count, max, 0.50) / 1000.0 : 0.0,
+			(histogram != NULL) ? (double)statsPercentile(histogram, count, max, 0.90) / 1000.0 : 0.0,
+			(histogram != NULL) ? (double)statsPercentile(histogram, count, max, 0.99) / 1000.0 : 0.0,
+			(double)max / 1000.0);
+	}
+
+	sessions = CFDictionaryGetValue(stats, CFSTR("Sessions"));
+	if (isA_CFArray(sessions)) {
+		printSessionStats(sessions);
+	}
+
+	admission = CFDictionaryGetValue(stats, CFSTR("Admission"));
+	if (isA_CFDictionary(admission)) {
+		SCPrint(TRUE, stdout,
+			CFSTR("\nover budget (policy = %@) : delayed = %lld, rejected = %lld, deprioritized = %lld, patterns rejected = %lld\n"),
+			CFDictionaryGetValue(admission, CFSTR("Policy")),
+			statsValue(admission, CFSTR("Delayed")),
+			statsValue(admission, CFSTR("Rejected")),
+			statsValue(admission, CFSTR("Deprioritized")),
+			statsValue(admission, CFSTR("PatternsRejected")));
+	}
+
+	CFRelease(names);
+	CFRelease(stats);
+	return;
+}
+
+
 __private_extern__
 void
 do_renew(char *if_name)
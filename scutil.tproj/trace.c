@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * Modification History
+ *
+ * October 16, 2026
+ * - initial revision
+ */
+
+/*
+ * "scutil --trace [trace-file]"
+ *   decodes the configd request trace (by default, /var/run/configd-trace;
+ *   see configd "-T").  The records from all of the [per-thread] rings are
+ *   merged and printed (oldest first), followed by a per-operation summary.
+ *   Keys are recorded by hash and are resolved against the keys currently
+ *   in the dynamic store.
+ */
+
+#include "scutil.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libkern/OSAtomic.h>
+#include <mach/mach.h>
+
+#include "../configd.tproj/trace_format.h"
+
+
+#define	DEFAULT_TRACE		"/var/run/configd-trace"
+
+
+typedef struct {
+	traceRecord	record;
+	uint32_t	ring;
+} traceEntry;
+
+typedef struct {
+	uint64_t	count;
+	uint64_t	errors;
+	uint64_t	total;		/* nsecs */
+	uint64_t	max;		/* nsecs */
+} traceSummary;
+
+
+static const char *
+traceOpName(uint16_t op)
+{
+	switch (op) {
+		case kTraceOpOpen		: return "open";
+		case kTraceOpClose		: return "close";
+		case kTraceOpCleanup		: return "cleanup";
+		case kTraceOpAdd		: return "add";
+		case kTraceOpCopy		: return "get";
+		case kTraceOpCopyMultiple	: return "get m";
+		case kTraceOpSet		: return "set";
+		case kTraceOpSetMultiple	: return "set m";
+		case kTraceOpRemove		: return "remove";
+		case kTraceOpNotify		: return "notify";
+		case kTraceOpWatchAdd		: return "watch a";
+		case kTraceOpWatchRemove	: return "watch r";
+		case kTraceOpWatchSet		: return "watch m";
+		case kTraceOpWatchProps		: return "props";
+		case kTraceOpPush		: return "push";
+		case kTraceOpPostPort		: return "-->port";
+		case kTraceOpPostRing		: return "-->ring";
+		case kTraceOpPostValues		: return "-->vals";
+		case kTraceOpPostFD		: return "-->fd";
+		case kTraceOpPostSignal		: return "-->sig";
+		case kTraceOpDelivered		: return "<--done";
+		case kTraceOpPlugin		: return "plugin";
+		default				: return "?";
+	}
+}
+
+
+static uint64_t
+traceNsecs(const traceHeader *header, uint64_t t)
+{
+	/* mach_absolute_time() units --> nsecs (without overflowing) */
+	return ((t / header->timebaseDenom) * header->timebaseNumer) +
+	       (((t % header->timebaseDenom) * header->timebaseNumer) / header->timebaseDenom);
+}
+
+
+static CFStringRef
+traceTimeString(const traceHeader *header, uint64_t t)
+{
+	char		buf[32];
+	struct tm	tm;
+	uint64_t	usecs;
+	time_t		secs;
+
+	usecs = header->created;
+	if (t > header->createdTime) {
+		usecs += traceNsecs(header, t - header->createdTime) / NSEC_PER_USEC;
+	}
+	secs = (time_t)(usecs / USEC_PER_SEC);
+	(void) localtime_r(&secs, &tm);
+	(void) strftime(buf, sizeof(buf), "%H:%M:%S", &tm);
+	return CFStringCreateWithFormat(NULL, NULL, CFSTR("%s.%06llu"), buf, usecs % USEC_PER_SEC);
+}
+
+
+static CFStringRef
+traceArgString(const traceRecord *record)
+{
+	switch (record->op) {
+		case kTraceOpCopyMultiple :
+		case kTraceOpWatchSet :
+			return CFStringCreateWithFormat(NULL, NULL,
+							CFSTR("keys = %u, patterns = %u"),
+							record->arg & 0xffff,
+							record->arg >> 16);
+		case kTraceOpSetMultiple :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("changes = %u"), record->arg);
+		case kTraceOpPush :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("sessions = %u"), record->arg);
+		case kTraceOpPostPort :
+		case kTraceOpPostRing :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("port = %u"), record->arg);
+		case kTraceOpPostValues :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("bytes = %u"), record->arg);
+		case kTraceOpPostFD :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("fd = %u"), record->arg);
+		case kTraceOpPostSignal :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("signal = %u"), record->arg);
+		case kTraceOpDelivered :
+			return CFStringCreateWithFormat(NULL, NULL, CFSTR("latency = %u us"), record->arg);
+		case kTraceOpPlugin :
+			switch (record->arg) {
+				case kTracePluginBeforeLoad	: return CFRetain(CFSTR("before loading any plug-ins"));
+				case kTracePluginLoading	: return CFRetain(CFSTR("loading"));
+				case kTracePluginLoad		: return CFRetain(CFSTR("calling load()"));
+				case kTracePluginStart		: return CFRetain(CFSTR("calling start()"));
+				case kTracePluginPrime		: return CFRetain(CFSTR("calling prime()"));
+				case kTracePluginRunLoop	: return CFRetain(CFSTR("starting the plug-in CFRunLoop"));
+				case kTracePluginWaiting	: return CFRetain(CFSTR("the plug-in CFRunLoop is waiting"));
+				default				: return CFStringCreateWithFormat(NULL, NULL, CFSTR("event = %u"), record->arg);
+			}
+		default :
+			return NULL;
+	}
+}
+
+
+static CFDictionaryRef
+copyKeyNames(void)
+{
+	CFIndex			i;
+	CFArrayRef		keys;
+	CFIndex			n;
+	CFMutableDictionaryRef	names;
+	SCDynamicStoreRef	traceStore;
+
+	traceStore = SCDynamicStoreCreate(NULL, CFSTR("scutil --trace"), NULL, NULL);
+	if (traceStore == NULL) {
+		return NULL;
+	}
+
+	keys = SCDynamicStoreCopyKeyList(traceStore, CFSTR(".*"));
+	CFRelease(traceStore);
+	if (keys == NULL) {
+		return NULL;
+	}
+
+	names = CFDictionaryCreateMutable(NULL,
+					  0,
+					  &kCFTypeDictionaryKeyCallBacks,
+					  &kCFTypeDictionaryValueCallBacks);
+	n = CFArrayGetCount(keys);
+	for (i = 0; i < n; i++) {
+		uint32_t	hash;
+		CFStringRef	key	= CFArrayGetValueAtIndex(keys, i);
+		CFNumberRef	num;
+
+		hash = (uint32_t)CFHash(key);
+		num = CFNumberCreate(NULL, kCFNumberSInt32Type, &hash);
+		CFDictionarySetValue(names, num, key);
+		CFRelease(num);
+	}
+	CFRelease(keys);
+
+	return names;
+}
+
+
+static CFStringRef
+copyKeyName(CFDictionaryRef names, uint32_t hash)
+{
+	CFStringRef	key	= NULL;
+	CFNumberRef	num;
+
+	if (names != NULL) {
+		num = CFNumberCreate(NULL, kCFNumberSInt32Type, &hash);
+		key = CFDictionaryGetValue(names, num);
+		CFRelease(num);
+	}
+
+	if (key != NULL) {
+		CFRetain(key);
+	} else {
+		/* if not (or no longer) in the store */
+		key = CFStringCreateWithFormat(NULL, NULL, CFSTR("#%08x"), hash);
+	}
+
+	return key;
+}
+
+
+static int
+compareEntries(const void *a, const void *b)
+{
+	const traceEntry	*entryA	= (const traceEntry *)a;
+	const traceEntry	*entryB	= (const traceEntry *)b;
+
+	if (entryA->record.time != entryB->record.time) {
+		return (entryA->record.time < entryB->record.time) ? -1 : 1;
+	}
+	if (entryA->ring != entryB->ring) {
+		return (entryA->ring < entryB->ring) ? -1 : 1;
+	}
+	return 0;
+}
+
+
+/*
+ * copyRing
+ *   copies the records from a [live] ring, discarding any that were being
+ *   written (or were overwritten) during the copy.  Returns the # of
+ *   records copied.
+ */
+static uint64_t
+copyRing(const traceHeader *header, uint32_t ringIndex, traceEntry *entries)
+{
+	uint64_t		first;
+	uint64_t		head;
+	uint64_t		i;
+	uint64_t		n		= header->ringRecords;
+	uint64_t		nCopied		= 0;
+	const traceRing		*ring;
+	const traceRecord	*records;
+
+	ring = (const traceRing *)(const void *)((const char *)header + header->headerSize + ((size_t)ringIndex * header->ringSize));
+	records = (const traceRecord *)(const void *)(ring + 1);
+
+	head = ring->head;
+	OSMemoryBarrier();
+	first = (head > n) ? head - n : 0;
+	for (i = first; i < head; i++) {
+		const traceRecord	*record	= &records[i & (n - 1)];
+		uint32_t		seq	= (uint32_t)(i + 1);
+
+		/* a record is only valid if its sequence did not change during the copy */
+		if (record->seq != seq) {
+			continue;
+		}
+		OSMemoryBarrier();
+		entries[nCopied].record = *record;
+		entries[nCopied].ring   = ringIndex;
+		OSMemoryBarrier();
+		if (record->seq != seq) {
+			continue;
+		}
+		nCopied++;
+	}
+
+	return nCopied;
+}
+
+
+__private_extern__
+void
+do_trace(int argc, char **argv)
+{
+	traceEntry		*entries;
+	int			fd;
+	const traceHeader	*header;
+	uint64_t		i;
+	void			*map;
+	CFDictionaryRef		names;
+	uint64_t		nEntries	= 0;
+	const char		*path		= DEFAULT_TRACE;
+	uint32_t		r;
+	struct stat		statbuf;
+	traceSummary		summary[kTraceOpLast];
+
+	if (argc > 0) {
+		path = argv[0];
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		SCPrint(TRUE, stderr, CFSTR("%s: %s\n"), path, strerror(errno));
+		exit(1);
+	}
+	if ((fstat(fd, &statbuf) == -1) || (statbuf.st_size < (off_t)sizeof(traceHeader))) {
+		SCPrint(TRUE, stderr, CFSTR("%s: not a trace\n"), path);
+		exit(1);
+	}
+	map = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	(void) close(fd);
+	if (map == MAP_FAILED) {
+		SCPrint(TRUE, stderr, CFSTR("%s: mmap() failed: %s\n"), path, strerror(errno));
+		exit(1);
+	}
+
+	header = (const traceHeader *)map;
+	if ((header->magic != TRACE_MAGIC) ||
+	    (header->version != TRACE_VERSION) ||
+	    (header->headerSize < sizeof(traceHeader)) ||
+	    (header->ringRecords == 0) ||
+	    ((header->ringRecords & (header->ringRecords - 1)) != 0) ||
+	    (header->ringSize < sizeof(traceRing) + ((uint64_t)header->ringRecords * sizeof(traceRecord))) ||
+	    (header->timebaseDenom == 0) ||
+	    ((uint64_t)statbuf.st_size < header->headerSize + ((uint64_t)header->nRings * header->ringSize))) {
+		SCPrint(TRUE, stderr, CFSTR("%s: not a trace (or an unsupported version)\n"), path);
+		exit(1);
+	}
+
+	entries = malloc((size_t)header->nRings * header->ringRecords * sizeof(traceEntry));
+	if (entries == NULL) {
+		SCPrint(TRUE, stderr, CFSTR("%s: too many records\n"), path);
+		exit(1);
+	}
+	for (r = 0; r < header->nRings; r++) {
+		nEntries += copyRing(header, r, &entries[nEntries]);
+	}
+	qsort(entries, (size_t)nEntries, sizeof(traceEntry), compareEntries);
+
+	names = copyKeyNames();
+	bzero(summary, sizeof(summary));
+
+	for (i = 0; i < nEntries; i++) {
+		CFStringRef		arg;
+		uint64_t		duration;
+		CFStringRef		key	= NULL;
+		const traceRecord	*record	= &entries[i].record;
+		CFStringRef		when;
+
+		duration = traceNsecs(header, record->duration);
+		if (record->op < kTraceOpLast) {
+			summary[record->op].count++;
+			if (record->status != kSCStatusOK) {
+				summary[record->op].errors++;
+			}
+			summary[record->op].total += duration;
+			if (duration > summary[record->op].max) {
+				summary[record->op].max = duration;
+			}
+		}
+
+		when = traceTimeString(header, record->time);
+		arg = traceArgString(record);
+		if (arg == NULL) {
+			key = copyKeyName(names, record->key);
+		}
+		SCPrint(TRUE, stdout,
+			CFSTR("%@ [%2u] %-7s : %5u : %@%s%s%s%s : %d : %llu.%03llu us\n"),
+			when,
+			entries[i].ring,
+			traceOpName(record->op),
+			record->session,
+			(arg != NULL) ? arg : (record->key != 0) ? key : CFSTR("-"),
+			(record->flags & kTraceFlagPattern)    ? " (pattern)"  : "",
+			(record->flags & kTraceFlagSessionKey) ? " (session)"  : "",
+			(record->flags & kTraceFlagInternal)   ? " (internal)" : "",
+			(record->flags & kTraceFlagSnapshot)   ? " (snapshot)" : "",
+			record->status,
+			duration / NSEC_PER_USEC,
+			duration % NSEC_PER_USEC);
+		CFRelease(when);
+		if (arg != NULL) CFRelease(arg);
+		if (key != NULL) CFRelease(key);
+	}
+
+	SCPrint(TRUE, stdout, CFSTR("\n%llu records (ring %u is shared by the threads without a ring)\n\n"),
+		nEntries,
+		header->sharedRing);
+	SCPrint(TRUE, stdout, CFSTR("  %-7s  %10s  %8s  %12s  %12s\n"), "op", "count", "errors", "avg (us)", "max (us)");
+	for (r = kTraceOpNone + 1; r < kTraceOpLast; r++) {
+		if (summary[r].count == 0) {
+			continue;
+		}
+		SCPrint(TRUE, stdout, CFSTR("  %-7s  %10llu  %8llu  %12.3f  %12.3f\n"),
+			traceOpName(r),
+			summary[r].count,
+			summary[r].errors,
+			(double)summary[r].total / summary[r].count / NSEC_PER_USEC,
+			(double)summary[r].max / NSEC_PER_USEC);
+	}
+
+	if (names != NULL) CFRelease(names);
+	free(entries);
+	(void) munmap(map, (size_t)statbuf.st_size);
+	exit(0);
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * PatternDFATester
+ *
+ * A differential test (and benchmark) of configd's pattern matching engine
+ * (configd.tproj/pattern_dfa.c) against the libc (POSIX) regex engine.
+ *
+ *   PatternDFATester test [<iterations>]
+ *     compares the engine with regcomp()/regexec() for a set of fixed and
+ *     randomly generated patterns and keys.
+ *
+ *   PatternDFATester bench [<keys>]
+ *     compares the cost of matching a set of (typical) notification
+ *     patterns against a store of <keys> keys.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <regex.h>
+#include <sys/time.h>
+
+#ifndef	__APPLE__
+#define	__private_extern__
+#define	reallocf	realloc
+#endif	/* __APPLE__ */
+
+#include "../configd.tproj/pattern_dfa.c"
+
+
+#pragma mark -
+#pragma mark Differential test
+
+
+static const char	*fixedPatterns[]	= {
+	"^State:/Network/Global/IPv4$",
+	"^State:/Network/Service/[^/]+/IPv4$",
+	"^State:/Network/Service/[^/]+/(IPv4|IPv6|DNS)$",
+	"^State:/Network/Interface/[^/]+/Link$",
+	"^Setup:/Network/Service/.*$",
+	"^State:/Network/Interface/en[0-9]+/AirPort$",
+	"^State:/Net\\.work$",
+	"^a(b|c)*d$",
+	"^a(b|cd?)+e$",
+	"^(a|b)?c$",
+	"^[]a]+$",
+	"^[^]a]$",
+	"^[a-c-]+$",
+	"^x.*y.*z$",
+	"^$",
+	"^((a|b)(c|d))*$",
+	NULL
+};
+
+static const char	*unsupportedPatterns[]	= {
+	"State:/Network",		/* not anchored */
+	"^a|b$",			/* un-anchored alternation */
+	"^a{2}$",			/* bounded repetition */
+	"^[[:alpha:]]+$",		/* character class */
+	"^(a)\\1$",			/* back-reference */
+	"^a**$",			/* multiple repetition */
+	"^()$",				/* empty group */
+	"^(a|)$",			/* empty alternative */
+	"^a\\$",			/* escaped (not anchored) */
+	"^(a$",				/* unbalanced */
+	"^a)$",				/* unbalanced */
+	"^*a$",				/* repetition of nothing */
+	NULL
+};
+
+static const char	*fixedKeys[]		= {
+	"",
+	"State:/Network/Global/IPv4",
+	"State:/Network/Global/IPv6",
+	"State:/Network/Service/ABC/IPv4",
+	"State:/Network/Service/ABC/DNS",
+	"State:/Network/Service/A/B/IPv4",
+	"State:/Network/Service//IPv4",
+	"State:/Network/Interface/en0/Link",
+	"State:/Network/Interface/en12/AirPort",
+	"State:/Network/Interface/enX/AirPort",
+	"Setup:/Network/Service/",
+	"Setup:/Network/Service/1/2/3",
+	"State:/Net.work",
+	"State:/NetXwork",
+	"ad", "abcbd", "abe", "acde", "abcdbe", "c", "ac", "bc", "abc",
+	"]", "a]", "b", "-", "abc-", "xyz", "xaybzc", "xy",
+	"acbd", "ad", "adbc",
+	NULL
+};
+
+
+static char
+randomChar(const char *alphabet)
+{
+	return alphabet[random() % strlen(alphabet)];
+}
+
+
+static void
+randomAtom(char **p, int depth)
+{
+	switch (random() % 8) {
+		case 0 :
+			*(*p)++ = '.';
+			break;
+		case 1 :
+			*(*p)++ = '[';
+			if (random() % 2) *(*p)++ = '^';
+			*(*p)++ = randomChar("ab/");
+			if (random() % 2) {
+				*(*p)++ = '-';
+				*(*p)++ = randomChar("cz");
+			}
+			*(*p)++ = ']';
+			break;
+		case 2 :
+			if (depth < 3) {
+				int	i;
+				int	n	= 1 + (random() % 3);
+
+				*(*p)++ = '(';
+				for (i = 0; i < n; i++) {
+					int	j;
+					int	m	= 1 + (random() % 3);
+
+					if (i > 0) *(*p)++ = '|';
+					for (j = 0; j < m; j++) {
+						randomAtom(p, depth + 1);
+					}
+				}
+				*(*p)++ = ')';
+				break;
+			}
+			/* fall through */
+		case 3 :
+			*(*p)++ = '\\';
+			*(*p)++ = randomChar("./");
+			break;
+		default :
+			*(*p)++ = randomChar("ab/:");
+			break;
+	}
+
+	switch (random() % 6) {
+		case 0 : *(*p)++ = '*'; break;
+		case 1 : *(*p)++ = '+'; break;
+		case 2 : *(*p)++ = '?'; break;
+		default : break;
+	}
+
+	return;
+}
+
+
+static void
+randomPattern(char *buf)
+{
+	int	i;
+	int	n	= 1 + (random() % 6);
+	char	*p	= buf;
+
+	*p++ = '^';
+	for (i = 0; i < n; i++) {
+		randomAtom(&p, 0);
+	}
+	*p++ = '$';
+	*p   = '\0';
+	return;
+}
+
+
+static void
+randomKey(char *buf)
+{
+	int	i;
+	int	n	= random() % 12;
+
+	for (i = 0; i < n; i++) {
+		buf[i] = randomChar("ab/:.cz");
+	}
+	buf[n] = '\0';
+	return;
+}
+
+
+static int
+compare(const char *pattern, dfaRef dfa, const char *key)
+{
+	int	dfaMatched;
+	int	id;
+	regex_t	preg;
+	int	reMatched;
+
+	if (regcomp(&preg, pattern, REG_EXTENDED) != 0) {
+		printf("regcomp() failed: %s\n", pattern);
+		return 1;
+	}
+	reMatched  = (regexec(&preg, key, 0, NULL, 0) == 0);
+	regfree(&preg);
+
+	dfaMatched = (dfaMatch(dfa, key, &id, 1) > 0);
+	if (dfaMatched != reMatched) {
+		printf("MISMATCH: pattern \"%s\", key \"%s\" : regex=%d, dfa=%d\n",
+		       pattern, key, reMatched, dfaMatched);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+static int
+do_test(int iterations)
+{
+	dfaRef		dfa;
+	int		errors	= 0;
+	int		i;
+	int		j;
+	int		n;
+	int		tests	= 0;
+
+	/* fixed patterns and keys */
+	for (i = 0; fixedPatterns[i] != NULL; i++) {
+		dfa = dfaCreate(&fixedPatterns[i], 1, NULL);
+		if (dfa == NULL) {
+			printf("FAILED: \"%s\" not supported\n", fixedPatterns[i]);
+			errors++;
+			continue;
+		}
+		for (j = 0; fixedKeys[j] != NULL; j++) {
+			errors += compare(fixedPatterns[i], dfa, fixedKeys[j]);
+			tests++;
+		}
+		dfaRelease(dfa);
+	}
+
+	/* unsupported patterns */
+	for (i = 0; unsupportedPatterns[i] != NULL; i++) {
+		dfa = dfaCreate(&unsupportedPatterns[i], 1, NULL);
+		if (dfa != NULL) {
+			printf("FAILED: \"%s\" should not be supported\n", unsupportedPatterns[i]);
+			dfaRelease(dfa);
+			errors++;
+		}
+		tests++;
+	}
+
+	/* batch matching (all fixed patterns at once) */
+	for (n = 0; fixedPatterns[n] != NULL; n++)
+		;
+	dfa = dfaCreate(fixedPatterns, n, NULL);
+	for (j = 0; fixedKeys[j] != NULL; j++) {
+		int	matches[64];
+		int	nMatches;
+		int	expected	= 0;
+
+		nMatches = dfaMatch(dfa, fixedKeys[j], matches, 64);
+		for (i = 0; i < n; i++) {
+			regex_t	preg;
+
+			(void) regcomp(&preg, fixedPatterns[i], REG_EXTENDED);
+			if (regexec(&preg, fixedKeys[j], 0, NULL, 0) == 0) {
+				int	k;
+
+				for (k = 0; k < nMatches; k++) {
+					if (matches[k] == i) break;
+				}
+				if (k == nMatches) {
+					printf("MISMATCH: batch, key \"%s\" : pattern \"%s\" not matched\n",
+					       fixedKeys[j], fixedPatterns[i]);
+					errors++;
+				}
+				expected++;
+			}
+			regfree(&preg);
+		}
+		if (nMatches != expected) {
+			printf("MISMATCH: batch, key \"%s\" : %d matches, expected %d\n",
+			       fixedKeys[j], nMatches, expected);
+			errors++;
+		}
+		tests++;
+	}
+	dfaRelease(dfa);
+
+	/* random patterns and keys */
+	srandom(1);
+	for (i = 0; i < iterations; i++) {
+		char		key[64];
+		char		pattern[512];
+		const char	*patterns[1];
+
+		randomPattern(pattern);
+		patterns[0] = pattern;
+		dfa = dfaCreate(patterns, 1, NULL);
+		if (dfa == NULL) {
+			printf("FAILED: \"%s\" not supported\n", pattern);
+			errors++;
+			continue;
+		}
+		for (j = 0; j < 50; j++) {
+			randomKey(key);
+			errors += compare(pattern, dfa, key);
+			tests++;
+		}
+		dfaRelease(dfa);
+	}
+
+	printf("%d tests, %d errors\n", tests, errors);
+	return (errors == 0) ? 0 : 1;
+}
+
+
+#pragma mark -
+#pragma mark Benchmark
+
+
+static const char	*benchPatterns[]	= {
+	"^State:/Network/Global/(IPv4|IPv6|DNS|Proxies)$",
+	"^State:/Network/Service/[^/]+/IPv4$",
+	"^State:/Network/Service/[^/]+/IPv6$",
+	"^State:/Network/Service/[^/]+/DNS$",
+	"^State:/Network/Service/[^/]+/PPP$",
+	"^State:/Network/Interface/[^/]+/Link$",
+	"^State:/Network/Interface/[^/]+/AirPort$",
+	"^State:/Network/Interface/[^/]+/IPv4$",
+	"^Setup:/Network/Service/[^/]+$",
+	"^Setup:/Network/Service/[^/]+/.*$",
+	"^State:/Users/ConsoleUser$",
+	"^State:/Network/MulticastDNS$",
+};
+#define	N_BENCH_PATTERNS	(int)(sizeof(benchPatterns) / sizeof(benchPatterns[0]))
+
+
+static double
+now(void)
+{
+	struct timeval	tv;
+
+	(void) gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + ((double)tv.tv_usec / 1000000.0);
+}
+
+
+static int
+do_bench(int nKeys)
+{
+	static const char	*entities[]	= { "IPv4", "IPv6", "DNS", "Proxies", "Link", "AirPort", "SMB", "PPP" };
+	dfaRef			dfa;
+	dfaRef			dfas[N_BENCH_PATTERNS];
+	int			i;
+	int			j;
+	char			**keys;
+	int			matched;
+	regex_t			pregs[N_BENCH_PATTERNS];
+	double			start;
+
+	keys = malloc(nKeys * sizeof(char *));
+	for (i = 0; i < nKeys; i++) {
+		char	key[128];
+
+		switch (i % 4) {
+			case 0 :
+				snprintf(key, sizeof(key), "State:/Network/Service/%08X-%04X/%s",
+					 i, i % 7919, entities[i % 8]);
+				break;
+			case 1 :
+				snprintf(key, sizeof(key), "Setup:/Network/Service/%08X-%04X/%s",
+					 i, i % 7919, entities[i % 8]);
+				break;
+			case 2 :
+				snprintf(key, sizeof(key), "State:/Network/Interface/en%d/%s",
+					 i, entities[i % 8]);
+				break;
+			default :
+				snprintf(key, sizeof(key), "com.apple.bench/%d/%s",
+					 i, entities[i % 8]);
+				break;
+		}
+		keys[i] = strdup(key);
+	}
+
+	printf("%d keys x %d patterns\n", nKeys, N_BENCH_PATTERNS);
+
+	/* regexec */
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		(void) regcomp(&pregs[j], benchPatterns[j], REG_EXTENDED);
+	}
+	matched = 0;
+	start = now();
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		for (i = 0; i < nKeys; i++) {
+			if (regexec(&pregs[j], keys[i], 0, NULL, 0) == 0) {
+				matched++;
+			}
+		}
+	}
+	printf("  regexec     : %10.3f ms, %d matches\n", (now() - start) * 1000.0, matched);
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		regfree(&pregs[j]);
+	}
+
+	/* DFA (one pattern at a time) */
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		dfas[j] = dfaCreate(&benchPatterns[j], 1, NULL);
+	}
+	matched = 0;
+	start = now();
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		for (i = 0; i < nKeys; i++) {
+			int	id;
+
+			matched += dfaMatch(dfas[j], keys[i], &id, 1);
+		}
+	}
+	printf("  dfa         : %10.3f ms, %d matches\n", (now() - start) * 1000.0, matched);
+	for (j = 0; j < N_BENCH_PATTERNS; j++) {
+		dfaRelease(dfas[j]);
+	}
+
+	/* DFA (all patterns in one pass) */
+	dfa = dfaCreate(benchPatterns, N_BENCH_PATTERNS, NULL);
+	matched = 0;
+	start = now();
+	for (i = 0; i < nKeys; i++) {
+		int	ids[N_BENCH_PATTERNS];
+
+		matched += dfaMatch(dfa, keys[i], ids, N_BENCH_PATTERNS);
+	}
+	printf("  dfa (batch) : %10.3f ms, %d matches, %d states\n",
+	       (now() - start) * 1000.0, matched, dfaGetStateCount(dfa));
+	dfaRelease(dfa);
+
+	for (i = 0; i < nKeys; i++) {
+		free(keys[i]);
+	}
+	free(keys);
+	return 0;
+}
+
+
+int
+main(int argc, char **argv)
+{
+	if ((argc >= 2) && (strcmp(argv[1], "test") == 0)) {
+		exit(do_test((argc > 2) ? atoi(argv[2]) : 10000));
+	}
+
+	if ((argc >= 2) && (strcmp(argv[1], "bench") == 0)) {
+		exit(do_bench((argc > 2) ? atoi(argv[2]) : 10000));
+	}
+
+	fprintf(stderr, "usage: %s test [<iterations>] | bench [<keys>]\n", argv[0]);
+	exit(1);
+}
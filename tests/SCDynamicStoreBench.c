@@ -0,0 +1,1234 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * SCDynamicStoreBench
+ *
+ * A simple (client side) benchmark of the configd "dynamic store".  Each
+ * test performs a number of operations against the running configd and
+ * reports the elapsed time and the # of operations / second.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <SystemConfiguration/SystemConfiguration.h>
+#include <SystemConfiguration/SCPrivate.h>
+
+#define	DEFAULT_COUNT		10000
+#define	DEFAULT_PATTERNS	400
+#define	READERS_SECONDS		2
+#define	NOTIFY_ROUNDS		100
+
+static SCDynamicStoreRef	g_store		= NULL;
+static CFStringRef		g_prefix	= NULL;
+static int			g_patterns	= DEFAULT_PATTERNS;
+
+
+static CFStringRef
+benchKey(int i)
+{
+	return CFStringCreateWithFormat(NULL, NULL, CFSTR("%@/%d"), g_prefix, i);
+}
+
+
+static void
+benchReport(const char *test, int count, CFAbsoluteTime start)
+{
+	CFAbsoluteTime	elapsed	= CFAbsoluteTimeGetCurrent() - start;
+
+	printf("%-16s %8d ops %10.3f ms %12.0f ops/sec\n",
+	       test,
+	       count,
+	       elapsed * 1000.0,
+	       (elapsed > 0) ? (double)count / elapsed : 0.0);
+	return;
+}
+
+
+static void
+benchCleanup(int count)
+{
+	int	i;
+
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+
+		key = benchKey(i);
+		(void) SCDynamicStoreRemoveValue(g_store, key);
+		CFRelease(key);
+	}
+
+	return;
+}
+
+
+static void
+do_set(int count)
+{
+	int		i;
+	CFAbsoluteTime	start;
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+		CFNumberRef	num;
+
+		key = benchKey(i);
+		num = CFNumberCreate(NULL, kCFNumberIntType, &i);
+		if (!SCDynamicStoreSetValue(g_store, key, num)) {
+			printf("SCDynamicStoreSetValue() failed: %s\n", SCErrorString(SCError()));
+		}
+		CFRelease(num);
+		CFRelease(key);
+	}
+	benchReport("set (new)", count, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+		CFNumberRef	num;
+		int		val	= -i;
+
+		key = benchKey(i);
+		num = CFNumberCreate(NULL, kCFNumberIntType, &val);
+		(void) SCDynamicStoreSetValue(g_store, key, num);
+		CFRelease(num);
+		CFRelease(key);
+	}
+	benchReport("set (update)", count, start);
+
+	return;
+}
+
+
+static void
+do_get(int count)
+{
+	int		i;
+	CFAbsoluteTime	start;
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef		key;
+		CFPropertyListRef	val;
+
+		key = benchKey(i);
+		val = SCDynamicStoreCopyValue(g_store, key);
+		if (val != NULL) CFRelease(val);
+		CFRelease(key);
+	}
+	benchReport("get", count, start);
+
+	return;
+}
+
+
+static void
+do_remove(int count)
+{
+	CFAbsoluteTime	start;
+
+	start = CFAbsoluteTimeGetCurrent();
+	benchCleanup(count);
+	benchReport("remove", count, start);
+
+	return;
+}
+
+
+static void
+do_watch(int count)
+{
+	int		i;
+	CFAbsoluteTime	start;
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+
+		key = benchKey(i);
+		(void) SCDynamicStoreAddWatchedKey(g_store, key, FALSE);
+		CFRelease(key);
+	}
+	benchReport("watch (add)", count, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+
+		key = benchKey(i);
+		(void) SCDynamicStoreNotifyValue(g_store, key);
+		CFRelease(key);
+	}
+	benchReport("watch (notify)", count, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	(void) SCDynamicStoreSetNotificationKeys(g_store, NULL, NULL);
+	benchReport("watch (remove)", count, start);
+
+	return;
+}
+
+
+static void
+benchRequests(const char *test, SCDynamicStoreRef store, int n)
+{
+	int		i;
+	CFStringRef	key;
+	CFAbsoluteTime	start;
+
+	key = benchKey(-1);
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < n; i++) {
+		CFPropertyListRef	val;
+
+		val = SCDynamicStoreCopyValue(store, key);
+		if (val != NULL) CFRelease(val);
+	}
+	benchReport(test, n, start);
+	CFRelease(key);
+
+	return;
+}
+
+
+static void
+do_sessions(int count)
+{
+	int			i;
+	int			n	= 10000;
+	SCDynamicStoreRef	*stores;
+	CFAbsoluteTime		start;
+
+	/*
+	 * measure the per-request (dispatch) cost with one session, open
+	 * <count> additional sessions, and then measure the cost again.
+	 */
+	benchRequests("request (1)", g_store, n);
+
+	stores = calloc(count, sizeof(SCDynamicStoreRef));
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		stores[i] = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-session"), NULL, NULL);
+		if (stores[i] == NULL) {
+			printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+			break;
+		}
+	}
+	benchReport("session (open)", i, start);
+
+	benchRequests("request (first)", g_store, n);
+	if ((i > 0) && (stores[i - 1] != NULL)) {
+		benchRequests("request (last)", stores[i - 1], n);
+	}
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		if (stores[i] != NULL) CFRelease(stores[i]);
+	}
+	benchReport("session (close)", count, start);
+	free(stores);
+
+	return;
+}
+
+
+static void
+do_list(int count)
+{
+	int		i;
+	int		n	= 1000;
+	CFStringRef	pattern;
+	CFAbsoluteTime	start;
+
+	/*
+	 * populate the store with <count> keys and then measure the cost
+	 * of listing a (narrow) range of keys.
+	 */
+	do_set(count);
+
+	pattern = CFStringCreateWithFormat(NULL, NULL, CFSTR("^%@/1[0-9]$"), g_prefix);
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < n; i++) {
+		CFArrayRef	keys;
+
+		keys = SCDynamicStoreCopyKeyList(g_store, pattern);
+		if (keys != NULL) CFRelease(keys);
+	}
+	benchReport("list (narrow)", n, start);
+	CFRelease(pattern);
+
+	return;
+}
+
+
+static void
+do_patterns(int count)
+{
+	int			i;
+	CFMutableArrayRef	patterns;
+	CFAbsoluteTime		start;
+	SCDynamicStoreRef	watcher;
+
+	/*
+	 * register <g_patterns> patterns (each with a different literal
+	 * prefix) and then measure the cost of adding and removing keys,
+	 * most of which do not match any pattern.
+	 */
+	watcher = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-patterns"), NULL, NULL);
+	if (watcher == NULL) {
+		printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+		return;
+	}
+
+	patterns = CFArrayCreateMutable(NULL, g_patterns, &kCFTypeArrayCallBacks);
+	for (i = 0; i < g_patterns; i++) {
+		CFStringRef	pattern;
+
+		pattern = CFStringCreateWithFormat(NULL, NULL, CFSTR("%@-pattern/%d/[^/]+/IPv4"), g_prefix, i);
+		CFArrayAppendValue(patterns, pattern);
+		CFRelease(pattern);
+	}
+
+	start = CFAbsoluteTimeGetCurrent();
+	if (!SCDynamicStoreSetNotificationKeys(watcher, NULL, patterns)) {
+		printf("SCDynamicStoreSetNotificationKeys() failed: %s\n", SCErrorString(SCError()));
+	}
+	benchReport("patterns (add)", g_patterns, start);
+	CFRelease(patterns);
+
+	printf("%d patterns:\n", g_patterns);
+	do_set(count);
+	do_remove(count);
+
+	CFRelease(watcher);
+	return;
+}
+
+
+static void
+do_fanout(int count)
+{
+	int			i;
+	int			n	= 1000;
+	CFStringRef		key;
+	CFArrayRef		changes;
+	SCDynamicStoreRef	*stores;
+	CFAbsoluteTime		start;
+
+	/*
+	 * open <count> (e.g. 1000) sessions, each watching the same key,
+	 * and then measure the cost of posting changes to that one key.
+	 */
+	key = benchKey(0);
+	stores = calloc(count, sizeof(SCDynamicStoreRef));
+	for (i = 0; i < count; i++) {
+		stores[i] = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-fanout"), NULL, NULL);
+		if (stores[i] == NULL) {
+			printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+			break;
+		}
+		(void) SCDynamicStoreAddWatchedKey(stores[i], key, FALSE);
+	}
+
+	printf("%d watchers:\n", i);
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < n; i++) {
+		(void) SCDynamicStoreNotifyValue(g_store, key);
+	}
+	benchReport("fanout (notify)", n, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		if (stores[i] == NULL) break;
+		changes = SCDynamicStoreCopyNotifiedKeys(stores[i]);
+		if (changes != NULL) CFRelease(changes);
+	}
+	benchReport("fanout (collect)", i, start);
+
+	for (i = 0; i < count; i++) {
+		if (stores[i] != NULL) CFRelease(stores[i]);
+	}
+	free(stores);
+	CFRelease(key);
+
+	return;
+}
+
+
+static CFStringRef		g_notifyKey	= NULL;
+static dispatch_semaphore_t	g_notifyDone	= NULL;
+static int32_t			g_notifyPending	= 0;
+static pthread_mutex_t		g_notifyLock	= PTHREAD_MUTEX_INITIALIZER;
+static double			g_notifySum	= 0.0;
+static double			g_notifyMax	= 0.0;
+static int			g_notifyCount	= 0;
+static int			g_notifyIPC	= 0;	/* # of follow-up requests */
+
+
+static void
+benchNotifyCallback(SCDynamicStoreRef store, CFArrayRef changedKeys, void *info)
+{
+	double			latency;
+	double			posted	= 0.0;
+	CFPropertyListRef	value	= NULL;
+	Boolean			*useValues	= (Boolean *)info;
+
+	if (*useValues) {
+		CFDictionaryRef	values;
+
+		/* use the value delivered with the notification */
+		values = SCDynamicStoreCopyNotifiedValues(store);
+		if (values != NULL) {
+			value = CFDictionaryGetValue(values, g_notifyKey);
+			if (value != NULL) CFRetain(value);
+			CFRelease(values);
+		}
+	}
+
+	if (value == NULL) {
+		/* fetch the value (like most clients do) */
+		value = SCDynamicStoreCopyValue(store, g_notifyKey);
+		__sync_fetch_and_add(&g_notifyIPC, 1);
+	}
+
+	if (value != NULL) {
+		if (CFGetTypeID(value) == CFNumberGetTypeID()) {
+			(void) CFNumberGetValue(value, kCFNumberDoubleType, &posted);
+		}
+		CFRelease(value);
+	}
+
+	latency = CFAbsoluteTimeGetCurrent() - posted;
+	pthread_mutex_lock(&g_notifyLock);
+	g_notifySum += latency;
+	if (latency > g_notifyMax) g_notifyMax = latency;
+	g_notifyCount++;
+	pthread_mutex_unlock(&g_notifyLock);
+
+	if (__sync_sub_and_fetch(&g_notifyPending, 1) == 0) {
+		dispatch_semaphore_signal(g_notifyDone);
+	}
+
+	return;
+}
+
+
+static void
+benchNotify(int count, const char *test, CFStringRef option)
+{
+	int			i;
+	int			missed	= 0;
+	CFDictionaryRef		options	= NULL;
+	SCDynamicStoreRef	*stores;
+	dispatch_queue_t	*queues;
+	Boolean			useValues;
+
+	if (option != NULL) {
+		options = CFDictionaryCreate(NULL,
+					     (const void **)&option,
+					     (const void **)&kCFBooleanTrue,
+					     1,
+					     &kCFTypeDictionaryKeyCallBacks,
+					     &kCFTypeDictionaryValueCallBacks);
+	}
+	useValues = (option != NULL) && CFEqual(option, kSCDynamicStoreNotificationValues);
+
+	stores = calloc(count, sizeof(SCDynamicStoreRef));
+	queues = calloc(count, sizeof(dispatch_queue_t));
+	for (i = 0; i < count; i++) {
+		SCDynamicStoreContext	context	= { 0, &useValues, NULL, NULL, NULL };
+
+		stores[i] = SCDynamicStoreCreateWithOptions(NULL,
+							    CFSTR("SCDynamicStoreBench-notify"),
+							    options,
+							    benchNotifyCallback,
+							    &context);
+		if (stores[i] == NULL) {
+			printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+			break;
+		}
+		(void) SCDynamicStoreAddWatchedKey(stores[i], g_notifyKey, FALSE);
+		queues[i] = dispatch_queue_create("SCDynamicStoreBench-notify", NULL);
+		(void) SCDynamicStoreSetDispatchQueue(stores[i], queues[i]);
+	}
+	count = i;
+	if (options != NULL) CFRelease(options);
+
+	g_notifySum   = 0.0;
+	g_notifyMax   = 0.0;
+	g_notifyCount = 0;
+	g_notifyIPC   = 0;
+	for (i = 0; i < NOTIFY_ROUNDS; i++) {
+		CFAbsoluteTime	now;
+		CFNumberRef	num;
+
+		/* post a change (with the current time) and wait for all of the watchers */
+		g_notifyPending = count;
+		now = CFAbsoluteTimeGetCurrent();
+		num = CFNumberCreate(NULL, kCFNumberDoubleType, &now);
+		(void) SCDynamicStoreSetValue(g_store, g_notifyKey, num);
+		CFRelease(num);
+
+		if (dispatch_semaphore_wait(g_notifyDone,
+					    dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC)) != 0) {
+			missed++;
+		}
+	}
+
+	printf("%-16s %8d ops %10.3f ms avg %10.3f ms max  (%d follow-up requests, %d timeouts)\n",
+	       test,
+	       g_notifyCount,
+	       (g_notifyCount > 0) ? g_notifySum * 1000.0 / g_notifyCount : 0.0,
+	       g_notifyMax * 1000.0,
+	       g_notifyIPC,
+	       missed);
+
+	for (i = 0; i < count; i++) {
+		(void) SCDynamicStoreSetDispatchQueue(stores[i], NULL);
+		CFRelease(stores[i]);
+		dispatch_release(queues[i]);
+	}
+	free(queues);
+	free(stores);
+
+	return;
+}
+
+
+static void
+do_notify(int count)
+{
+	/*
+	 * open <count> (e.g. 200) sessions, each watching the same key, and
+	 * measure the end-to-end latency from posting a change to each of
+	 * the watchers having the new value in hand.  This is done with
+	 * the usual notifications (changed keys, then value fetched), with
+	 * the changed keys delivered via the shared notification ring, and
+	 * with the values delivered along with the notification.
+	 */
+	g_notifyKey = benchKey(0);
+	g_notifyDone = dispatch_semaphore_create(0);
+
+	printf("%d watchers, %d changes:\n", count, NOTIFY_ROUNDS);
+	benchNotify(count, "notify (keys)", NULL);
+	benchNotify(count, "notify (ring)", kSCDynamicStoreNotificationRing);
+	benchNotify(count, "notify (values)", kSCDynamicStoreNotificationValues);
+
+	dispatch_release(g_notifyDone);
+	CFRelease(g_notifyKey);
+
+	return;
+}
+
+
+static int			g_burstNotifications	= 0;
+static int			g_burstKeys		= 0;
+static CFAbsoluteTime		g_burstLast		= 0;
+
+
+static void
+benchBurstCallback(SCDynamicStoreRef store, CFArrayRef changedKeys, void *info)
+{
+	pthread_mutex_lock(&g_notifyLock);
+	g_burstNotifications++;
+	g_burstKeys += (int)CFArrayGetCount(changedKeys);
+	g_burstLast = CFAbsoluteTimeGetCurrent();
+	pthread_mutex_unlock(&g_notifyLock);
+	return;
+}
+
+
+static void
+benchBurst(int count, const char *test, double coalesce, double rate, double burst, int pass)
+{
+	SCDynamicStoreContext	context		= { 0, NULL, NULL, NULL, NULL };
+	int			i;
+	int			keys;
+	int			notifications;
+	CFMutableDictionaryRef	options;
+	CFStringRef		pattern;
+	CFArrayRef		patterns;
+	dispatch_queue_t	queue;
+	CFAbsoluteTime		start;
+	SCDynamicStoreRef	store;
+
+	store = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-burst"), benchBurstCallback, &context);
+	if (store == NULL) {
+		printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+		return;
+	}
+
+	pattern = CFStringCreateWithFormat(NULL, NULL, CFSTR("^%@/.*"), g_prefix);
+	patterns = CFArrayCreate(NULL, (const void **)&pattern, 1, &kCFTypeArrayCallBacks);
+	(void) SCDynamicStoreSetNotificationKeys(store, NULL, patterns);
+	CFRelease(patterns);
+	CFRelease(pattern);
+
+	if ((coalesce > 0) || (rate > 0)) {
+		CFNumberRef	num;
+
+		options = CFDictionaryCreateMutable(NULL,
+						    0,
+						    &kCFTypeDictionaryKeyCallBacks,
+						    &kCFTypeDictionaryValueCallBacks);
+		num = CFNumberCreate(NULL, kCFNumberDoubleType, &coalesce);
+		CFDictionarySetValue(options, kSCDynamicStoreNotificationCoalesce, num);
+		CFRelease(num);
+		num = CFNumberCreate(NULL, kCFNumberDoubleType, &rate);
+		CFDictionarySetValue(options, kSCDynamicStoreNotificationRateLimit, num);
+		CFRelease(num);
+		num = CFNumberCreate(NULL, kCFNumberDoubleType, &burst);
+		CFDictionarySetValue(options, kSCDynamicStoreNotificationRateBurst, num);
+		CFRelease(num);
+		if (!SCDynamicStoreSetNotificationOptions(store, options)) {
+			printf("SCDynamicStoreSetNotificationOptions() failed: %s\n", SCErrorString(SCError()));
+		}
+		CFRelease(options);
+	}
+
+	queue = dispatch_queue_create("SCDynamicStoreBench-burst", NULL);
+	(void) SCDynamicStoreSetDispatchQueue(store, queue);
+
+	g_burstNotifications = 0;
+	g_burstKeys          = 0;
+	g_burstLast          = 0;
+
+	/* change <count> keys, back-to-back (like an interface flap) */
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+		CFNumberRef	num;
+		int		val	= (pass * count) + i;
+
+		key = benchKey(i);
+		num = CFNumberCreate(NULL, kCFNumberIntType, &val);
+		(void) SCDynamicStoreSetValue(g_store, key, num);
+		CFRelease(num);
+		CFRelease(key);
+	}
+
+	/* wait (up to 10 seconds) for the notifications to settle */
+	for (i = 0; i < 20; i++) {
+		int	before;
+
+		pthread_mutex_lock(&g_notifyLock);
+		before = g_burstKeys;
+		pthread_mutex_unlock(&g_notifyLock);
+		usleep(500 * 1000);
+		pthread_mutex_lock(&g_notifyLock);
+		keys = g_burstKeys;
+		pthread_mutex_unlock(&g_notifyLock);
+		if ((keys >= count) && (keys == before)) {
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&g_notifyLock);
+	notifications = g_burstNotifications;
+	keys          = g_burstKeys;
+	pthread_mutex_unlock(&g_notifyLock);
+
+	printf("%-16s %8d keys %8d notifications %10.1f keys/notification %10.3f ms to last\n",
+	       test,
+	       keys,
+	       notifications,
+	       (notifications > 0) ? (double)keys / notifications : 0.0,
+	       (g_burstLast - start) * 1000.0);
+
+	(void) SCDynamicStoreSetDispatchQueue(store, NULL);
+	CFRelease(store);
+	dispatch_release(queue);
+
+	return;
+}
+
+
+static void
+do_burst(int count)
+{
+	/*
+	 * watch all of the benchmark keys (with a pattern) and change <count>
+	 * (e.g. 1000) of them back-to-back, reporting the # of notifications
+	 * delivered vs. the # of keys changed.  This is done with the default
+	 * notification options, with a coalescing window, and with a rate
+	 * limit.
+	 */
+	printf("%d changed keys:\n", count);
+	benchBurst(count, "burst",		 0,  0, 1, 0);
+	benchBurst(count, "burst (20ms)",	20,  0, 1, 1);
+	benchBurst(count, "burst (10/sec)",	 0, 10, 2, 2);
+
+	return;
+}
+
+
+static CFDictionaryRef
+benchDictionary(const void **keys, const void **values, CFIndex n)
+{
+	return CFDictionaryCreate(NULL,
+				  keys,
+				  values,
+				  n,
+				  &kCFTypeDictionaryKeyCallBacks,
+				  &kCFTypeDictionaryValueCallBacks);
+}
+
+
+static CFArrayRef
+benchEncodeValues(void)
+{
+	CFArrayRef		a1;
+	CFArrayRef		a2;
+	CFArrayRef		a3;
+	CFDictionaryRef		dict;
+	const void *		keys[8];
+	CFIndex			n;
+	CFStringRef		pattern;
+	CFArrayRef		patterns;
+	const void *		values[8];
+	CFMutableArrayRef	storeValues;
+	CFNumberRef		num;
+	int			val;
+
+	storeValues = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+
+	/* State:/Network/Service/<id>/IPv4 */
+	values[0] = CFSTR("192.168.1.23");
+	a1 = CFArrayCreate(NULL, values, 1, &kCFTypeArrayCallBacks);
+	values[0] = CFSTR("255.255.255.0");
+	a2 = CFArrayCreate(NULL, values, 1, &kCFTypeArrayCallBacks);
+	keys[0] = CFSTR("Addresses");		values[0] = a1;
+	keys[1] = CFSTR("SubnetMasks");		values[1] = a2;
+	keys[2] = CFSTR("InterfaceName");	values[2] = CFSTR("en0");
+	keys[3] = CFSTR("Router");		values[3] = CFSTR("192.168.1.1");
+	keys[4] = CFSTR("ConfirmedInterfaceName"); values[4] = CFSTR("en0");
+	dict = benchDictionary(keys, values, 5);
+	CFArrayAppendValue(storeValues, dict);
+	CFRelease(dict);
+	CFRelease(a1);
+	CFRelease(a2);
+
+	/* State:/Network/Global/IPv4 */
+	keys[0] = CFSTR("PrimaryInterface");	values[0] = CFSTR("en0");
+	keys[1] = CFSTR("PrimaryService");	values[1] = CFSTR("A1B2C3D4-E5F6-4789-ABCD-0123456789AB");
+	keys[2] = CFSTR("Router");		values[2] = CFSTR("192.168.1.1");
+	dict = benchDictionary(keys, values, 3);
+	CFArrayAppendValue(storeValues, dict);
+	CFRelease(dict);
+
+	/* State:/Network/Global/DNS */
+	values[0] = CFSTR("192.168.1.1");
+	values[1] = CFSTR("8.8.8.8");
+	a1 = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+	values[0] = CFSTR("example.com");
+	values[1] = CFSTR("corp.example.com");
+	a2 = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+	keys[0] = CFSTR("ServerAddresses");	values[0] = a1;
+	keys[1] = CFSTR("SearchDomains");	values[1] = a2;
+	keys[2] = CFSTR("DomainName");		values[2] = CFSTR("example.com");
+	dict = benchDictionary(keys, values, 3);
+	CFArrayAppendValue(storeValues, dict);
+	CFRelease(dict);
+	CFRelease(a1);
+	CFRelease(a2);
+
+	/* State:/Network/Service/<id>/IPv6 */
+	values[0] = CFSTR("fe80::1c2b:3a4d:5e6f:7081");
+	values[1] = CFSTR("2001:db8:1234:5678:1c2b:3a4d:5e6f:7081");
+	a1 = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+	val = 0;
+	num = CFNumberCreate(NULL, kCFNumberIntType, &val);
+	values[0] = num;
+	values[1] = num;
+	a2 = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+	CFRelease(num);
+	val = 64;
+	num = CFNumberCreate(NULL, kCFNumberIntType, &val);
+	values[0] = num;
+	values[1] = num;
+	a3 = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+	CFRelease(num);
+	keys[0] = CFSTR("Addresses");		values[0] = a1;
+	keys[1] = CFSTR("Flags");		values[1] = a2;
+	keys[2] = CFSTR("PrefixLength");	values[2] = a3;
+	keys[3] = CFSTR("InterfaceName");	values[3] = CFSTR("en0");
+	keys[4] = CFSTR("Router");		values[4] = CFSTR("fe80::1");
+	dict = benchDictionary(keys, values, 5);
+	CFArrayAppendValue(storeValues, dict);
+	CFRelease(dict);
+	CFRelease(a1);
+	CFRelease(a2);
+	CFRelease(a3);
+
+	/* State:/Network/Interface/<if>/Link */
+	keys[0] = CFSTR("Active");		values[0] = kCFBooleanTrue;
+	dict = benchDictionary(keys, values, 1);
+	CFArrayAppendValue(storeValues, dict);
+	CFRelease(dict);
+
+	/* ... and whatever is in the [live] store */
+	pattern = CFSTR("^State:/Network/.*");
+	patterns = CFArrayCreate(NULL, (const void **)&pattern, 1, &kCFTypeArrayCallBacks);
+	dict = SCDynamicStoreCopyMultiple(g_store, NULL, patterns);
+	CFRelease(patterns);
+	n = (dict != NULL) ? CFDictionaryGetCount(dict) : 0;
+	if (n > 0) {
+		CFIndex		i;
+		const void **	storeDictValues;
+
+		storeDictValues = malloc(n * sizeof(CFTypeRef));
+		CFDictionaryGetKeysAndValues(dict, NULL, storeDictValues);
+		for (i = 0; i < n; i++) {
+			if (CFGetTypeID(storeDictValues[i]) == CFDictionaryGetTypeID()) {
+				CFArrayAppendValue(storeValues, storeDictValues[i]);
+			}
+		}
+		free(storeDictValues);
+	}
+	if (dict != NULL) CFRelease(dict);
+
+	return storeValues;
+}
+
+
+static void
+do_encode(int count)
+{
+	CFIndex		bytesEncoded	= 0;
+	CFIndex		bytesPlist	= 0;
+	CFDataRef	*encoded;
+	int		i;
+	char		**lookupKeys;
+	CFIndex		n;
+	CFIndex		nOps;
+	CFDataRef	*plists;
+	CFAbsoluteTime	start;
+	CFArrayRef	storeValues;
+	CFIndex		v;
+
+	/*
+	 * measure the cost of serializing and deserializing (and then
+	 * looking up one property of) <count> x realistic State:/Network
+	 * values with the binary plist (_SCSerialize) and with the encoded
+	 * value (_SCEncodedValueCreateData) formats.
+	 */
+	storeValues = benchEncodeValues();
+	n = CFArrayGetCount(storeValues);
+	nOps = n * count;
+	encoded = calloc(n, sizeof(CFDataRef));
+	plists = calloc(n, sizeof(CFDataRef));
+	lookupKeys = calloc(n, sizeof(char *));
+	for (v = 0; v < n; v++) {
+		CFDictionaryRef	dict	= CFArrayGetValueAtIndex(storeValues, v);
+		const void **	keys;
+		CFIndex		nKeys;
+
+		/* lookup the first property */
+		nKeys = CFDictionaryGetCount(dict);
+		keys = malloc((nKeys > 0 ? nKeys : 1) * sizeof(CFTypeRef));
+		CFDictionaryGetKeysAndValues(dict, keys, NULL);
+		lookupKeys[v] = (nKeys > 0) ? _SC_cfstring_to_cstring(keys[0], NULL, 0, kCFStringEncodingUTF8) : NULL;
+		if (lookupKeys[v] == NULL) lookupKeys[v] = strdup("");
+		free(keys);
+		(void) _SCSerialize(dict, &plists[v], NULL, NULL);
+		encoded[v] = _SCEncodedValueCreateData(dict);
+		bytesPlist += CFDataGetLength(plists[v]);
+		bytesEncoded += (encoded[v] != NULL) ? CFDataGetLength(encoded[v]) : CFDataGetLength(plists[v]);
+	}
+
+	printf("%ld values, binary plist = %ld bytes, encoded = %ld bytes\n", n, bytesPlist, bytesEncoded);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		for (v = 0; v < n; v++) {
+			CFDataRef	xml;
+
+			(void) _SCSerialize(CFArrayGetValueAtIndex(storeValues, v), &xml, NULL, NULL);
+			CFRelease(xml);
+		}
+	}
+	benchReport("plist (ser)", (int)nOps, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		for (v = 0; v < n; v++) {
+			CFPropertyListRef	dict;
+			CFStringRef		key;
+
+			if (_SCUnserialize(&dict, plists[v], NULL, 0)) {
+				key = CFStringCreateWithCString(NULL, lookupKeys[v], kCFStringEncodingUTF8);
+				(void) CFDictionaryGetValue(dict, key);
+				CFRelease(key);
+				CFRelease(dict);
+			}
+		}
+	}
+	benchReport("plist (de+get)", (int)nOps, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		for (v = 0; v < n; v++) {
+			CFDataRef	data;
+
+			data = _SCEncodedValueCreateData(CFArrayGetValueAtIndex(storeValues, v));
+			if (data != NULL) CFRelease(data);
+		}
+	}
+	benchReport("encoded (ser)", (int)nOps, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		for (v = 0; v < n; v++) {
+			_SCEncodedValue	dict;
+			_SCEncodedValue	value;
+
+			if ((encoded[v] != NULL) &&
+			    _SCEncodedValueInit(&dict, CFDataGetBytePtr(encoded[v]), CFDataGetLength(encoded[v]))) {
+				(void) _SCEncodedValueGetDictionaryValue(&dict, lookupKeys[v], &value);
+			}
+		}
+	}
+	benchReport("encoded (get)", (int)nOps, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	for (i = 0; i < count; i++) {
+		for (v = 0; v < n; v++) {
+			_SCEncodedValue		dict;
+			CFPropertyListRef	plist;
+
+			if ((encoded[v] != NULL) &&
+			    _SCEncodedValueInit(&dict, CFDataGetBytePtr(encoded[v]), CFDataGetLength(encoded[v]))) {
+				plist = _SCEncodedValueCopyPropertyList(&dict);
+				if (plist != NULL) CFRelease(plist);
+			}
+		}
+	}
+	benchReport("encoded (de)", (int)nOps, start);
+
+	for (v = 0; v < n; v++) {
+		if (encoded[v] != NULL) CFRelease(encoded[v]);
+		if (plists[v] != NULL) CFRelease(plists[v]);
+		free(lookupKeys[v]);
+	}
+	free(lookupKeys);
+	free(plists);
+	free(encoded);
+	CFRelease(storeValues);
+
+	return;
+}
+
+
+static void
+do_snapshot(int count)
+{
+	int		changed;
+	uint64_t	generation;
+	int		i;
+	CFIndex		n;
+	CFAbsoluteTime	start;
+	CFArrayRef	storeValues;
+
+	/*
+	 * populate the store with <count> realistic State:/Network values
+	 * and compare the time to write the [XML] store snapshot with the
+	 * time to write a streamed snapshot (and, after changing 1% of the
+	 * keys, a "delta" snapshot).  Must be run as root.
+	 */
+	storeValues = benchEncodeValues();
+	n = CFArrayGetCount(storeValues);
+	for (i = 0; i < count; i++) {
+		CFStringRef	key;
+
+		key = benchKey(i);
+		(void) SCDynamicStoreSetValue(g_store, key, CFArrayGetValueAtIndex(storeValues, i % n));
+		CFRelease(key);
+	}
+
+	start = CFAbsoluteTimeGetCurrent();
+	if (!SCDynamicStoreSnapshot(g_store)) {
+		printf("SCDynamicStoreSnapshot() failed: %s\n", SCErrorString(SCError()));
+	}
+	benchReport("snapshot xml", 1, start);
+
+	start = CFAbsoluteTimeGetCurrent();
+	if (!SCDynamicStoreSnapshotStream(g_store, FALSE, &generation)) {
+		printf("SCDynamicStoreSnapshotStream() failed: %s\n", SCErrorString(SCError()));
+	}
+	benchReport("snapshot stream", 1, start);
+
+	changed = (count >= 100) ? count / 100 : 1;
+	for (i = 0; i < changed; i++) {
+		CFStringRef	key;
+
+		key = benchKey(i);
+		(void) SCDynamicStoreSetValue(g_store, key, CFArrayGetValueAtIndex(storeValues, (i + 1) % n));
+		CFRelease(key);
+	}
+
+	start = CFAbsoluteTimeGetCurrent();
+	if (!SCDynamicStoreSnapshotStream(g_store, TRUE, &generation)) {
+		printf("SCDynamicStoreSnapshotStream() failed: %s\n", SCErrorString(SCError()));
+	}
+	benchReport("snapshot delta", 1, start);
+
+	CFRelease(storeValues);
+	return;
+}
+
+
+typedef struct {
+	pthread_t		thread;
+	int			count;		/* # of keys in the store */
+	int			ops;		/* # of requests completed */
+} benchThread;
+
+
+static volatile int		g_stop		= 0;
+
+
+static void *
+benchReader(void *context)
+{
+	benchThread		*info	= (benchThread *)context;
+	unsigned int		seed	= (unsigned int)(uintptr_t)info;
+	SCDynamicStoreRef	store;
+
+	store = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-reader"), NULL, NULL);
+	if (store == NULL) {
+		printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+		return NULL;
+	}
+
+	while (!g_stop) {
+		CFStringRef		key;
+		CFPropertyListRef	val;
+
+		key = benchKey(rand_r(&seed) % info->count);
+		val = SCDynamicStoreCopyValue(store, key);
+		if (val != NULL) CFRelease(val);
+		CFRelease(key);
+		info->ops++;
+	}
+
+	CFRelease(store);
+	return NULL;
+}
+
+
+static void *
+benchWriter(void *context)
+{
+	benchThread		*info	= (benchThread *)context;
+	SCDynamicStoreRef	store;
+
+	store = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench-writer"), NULL, NULL);
+	if (store == NULL) {
+		printf("SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+		return NULL;
+	}
+
+	while (!g_stop) {
+		CFStringRef	key;
+		CFNumberRef	num;
+
+		key = benchKey(info->ops % info->count);
+		num = CFNumberCreate(NULL, kCFNumberIntType, &info->ops);
+		(void) SCDynamicStoreSetValue(store, key, num);
+		CFRelease(num);
+		CFRelease(key);
+		info->ops++;
+	}
+
+	CFRelease(store);
+	return NULL;
+}
+
+
+static void
+do_readers(int count)
+{
+	int		maxReaders;
+	int		n;
+
+	/*
+	 * populate the store with <count> keys and then, while a writer
+	 * continuously updates those keys, measure the aggregate read
+	 * throughput with 1, 2, 4, ... concurrent readers.  To see the
+	 * reads scale, configd must be started with reader threads
+	 * (e.g. "configd -d -R 8").
+	 */
+	do_set(count);
+
+	maxReaders = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (maxReaders < 1) maxReaders = 1;
+
+	for (n = 1; ; n = (n * 2 <= maxReaders) ? n * 2 : maxReaders) {
+		int		i;
+		benchThread	*readers;
+		int		readOps	= 0;
+		char		test[32];
+		benchThread	writer;
+
+		g_stop = 0;
+		bzero(&writer, sizeof(writer));
+		writer.count = count;
+		(void) pthread_create(&writer.thread, NULL, benchWriter, &writer);
+
+		readers = calloc(n, sizeof(benchThread));
+		for (i = 0; i < n; i++) {
+			readers[i].count = count;
+			(void) pthread_create(&readers[i].thread, NULL, benchReader, &readers[i]);
+		}
+
+		sleep(READERS_SECONDS);
+		g_stop = 1;
+
+		for (i = 0; i < n; i++) {
+			(void) pthread_join(readers[i].thread, NULL);
+			readOps += readers[i].ops;
+		}
+		(void) pthread_join(writer.thread, NULL);
+		free(readers);
+
+		snprintf(test, sizeof(test), "readers (%d)", n);
+		printf("%-16s %8d ops %10.3f ms %12.0f ops/sec  (%d writes)\n",
+		       test,
+		       readOps,
+		       READERS_SECONDS * 1000.0,
+		       (double)readOps / READERS_SECONDS,
+		       writer.ops);
+
+		if (n == maxReaders) {
+			break;
+		}
+	}
+
+	return;
+}
+
+
+static void
+do_all(int count)
+{
+	do_set(count);
+	do_get(count);
+	do_watch(count);
+	do_remove(count);
+	return;
+}
+
+
+static const struct {
+	const char	*name;
+	void		(*func)(int count);
+	const char	*help;
+} tests[] = {
+	{ "all",	do_all,		"run all of the basic tests"			},
+	{ "set",	do_set,		"add, then update, <count> keys"		},
+	{ "get",	do_get,		"copy <count> key values"			},
+	{ "remove",	do_remove,	"remove <count> keys"				},
+	{ "watch",	do_watch,	"watch, notify, and unwatch <count> keys"	},
+	{ "list",	do_list,	"list a few keys from a store of <count> keys"	},
+	{ "sessions",	do_sessions,	"request cost with <count> (e.g. 5000) open sessions"	},
+	{ "fanout",	do_fanout,	"notify one key watched by <count> (e.g. 1000) sessions"	},
+	{ "notify",	do_notify,	"change-to-value latency with <count> (e.g. 200) watchers"	},
+	{ "encode",	do_encode,	"serialize/deserialize <count> x realistic State:/Network values"	},
+	{ "snapshot",	do_snapshot,	"XML vs. streamed (and delta) snapshots of <count> keys (as root)"	},
+	{ "burst",	do_burst,	"notifications delivered for a burst of <count> (e.g. 1000) changes"	},
+	{ "readers",	do_readers,	"read throughput with 1..N readers (and a writer) over <count> keys"	},
+	{ "patterns",	do_patterns,	"add/remove <count> keys with <patterns> watched patterns"	},
+};
+#define	N_TESTS	(sizeof(tests) / sizeof(tests[0]))
+
+
+static void
+usage(const char *command)
+{
+	size_t	i;
+
+	fprintf(stderr, "usage: %s <test> [<count> [<patterns>]]\n\n", command);
+	for (i = 0; i < N_TESTS; i++) {
+		fprintf(stderr, "  %-10s %s\n", tests[i].name, tests[i].help);
+	}
+	exit(1);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	int	count	= DEFAULT_COUNT;
+	size_t	i;
+
+	if (argc < 2) {
+		usage(argv[0]);
+	}
+
+	if (argc > 2) {
+		count = atoi(argv[2]);
+		if (count <= 0) {
+			usage(argv[0]);
+		}
+	}
+
+	if (argc > 3) {
+		g_patterns = atoi(argv[3]);
+		if (g_patterns <= 0) {
+			usage(argv[0]);
+		}
+	}
+
+	for (i = 0; i < N_TESTS; i++) {
+		if (strcmp(argv[1], tests[i].name) == 0) {
+			break;
+		}
+	}
+	if (i == N_TESTS) {
+		usage(argv[0]);
+	}
+
+	g_store = SCDynamicStoreCreate(NULL, CFSTR("SCDynamicStoreBench"), NULL, NULL);
+	if (g_store == NULL) {
+		fprintf(stderr, "SCDynamicStoreCreate() failed: %s\n", SCErrorString(SCError()));
+		exit(1);
+	}
+	g_prefix = CFStringCreateWithFormat(NULL, NULL, CFSTR("State:/Bench/%d"), getpid());
+
+	(*tests[i].func)(count);
+
+	if (strcmp(tests[i].name, "remove") != 0) {
+		benchCleanup(count);
+	}
+
+	CFRelease(g_prefix);
+	CFRelease(g_store);
+	exit(0);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+/*
+ * SCDynamicStoreJournal
+ *
+ * Decodes the configd store mutation journal (see "configd -j").
+ *
+ *   SCDynamicStoreJournal [-x] [<journal>]
+ *     prints the records (oldest first) in the journal (by default,
+ *     /var/run/configd-journal).  With "-x", the data of each record
+ *     is also dumped (in hex).
+ *
+ * Note: SCDynamicStoreJournal has no framework dependencies and can also
+ *       be built for the host (e.g. "cc -o SCDynamicStoreJournal SCDynamicStoreJournal.c")
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "../configd.tproj/journal_format.h"
+
+#define	DEFAULT_JOURNAL		"/var/run/configd-journal"
+
+
+static const char *
+recordTypeName(uint16_t type)
+{
+	switch (type) {
+		case kJournalSet		: return "set";
+		case kJournalRemove		: return "remove";
+		case kJournalNotify		: return "notify";
+		case kJournalSetMultiple	: return "set m";
+		case kJournalOpen		: return "open";
+		case kJournalClose		: return "close";
+		default				: return "?";
+	}
+}
+
+
+static void
+printTime(uint64_t usecs)
+{
+	char		buf[32];
+	time_t		t	= (time_t)(usecs / 1000000);
+	struct tm	tm;
+
+	(void) localtime_r(&t, &tm);
+	(void) strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+	printf("%s.%06u", buf, (unsigned int)(usecs % 1000000));
+	return;
+}
+
+
+static void
+dumpBytes(const uint8_t *bytes, uint32_t len)
+{
+	uint32_t	i;
+
+	for (i = 0; i < len; i++) {
+		if ((i % 32) == 0) {
+			printf("%s    %06x ", (i > 0) ? "\n" : "", i);
+		}
+		printf("%02x", bytes[i]);
+	}
+	if (len > 0) {
+		printf("\n");
+	}
+	return;
+}
+
+
+static int
+printRecord(const journalRecord *record, int dumpData)
+{
+	const uint8_t	*key	= (const uint8_t *)(record + 1);
+	const uint8_t	*data	= key + record->keyLen;
+
+	if ((sizeof(journalRecord) + (uint64_t)record->keyLen + record->dataLen) > record->length) {
+		/* if not a valid record */
+		return 0;
+	}
+
+	printTime(record->time);
+	printf("  %-7s %6u %c  ",
+	       recordTypeName(record->type),
+	       record->session,
+	       (record->flags & kJournalFlagInternal) ? '*' : ' ');
+
+	switch (record->type) {
+		case kJournalSetMultiple : {
+			uint32_t	counts[3]	= { 0, 0, 0 };
+
+			if (record->dataLen >= sizeof(counts)) {
+				memcpy(counts, data, sizeof(counts));
+			}
+			printf("%u set, %u remove, %u notify\n", counts[0], counts[1], counts[2]);
+			return 1;
+		}
+		case kJournalClose :
+			printf("\n");
+			return 1;
+		default :
+			break;
+	}
+
+	printf("%.*s", (int)record->keyLen, (const char *)key);
+	if (record->type == kJournalSet) {
+		if (record->flags & kJournalFlagTruncated) {
+			printf("  (%u bytes, not recorded)", record->dataSize);
+		} else {
+			printf("  (%u bytes)", record->dataLen);
+		}
+	}
+	printf("\n");
+
+	if (dumpData) {
+		dumpBytes(data, record->dataLen);
+	}
+
+	return 1;
+}
+
+
+int
+main(int argc, char **argv)
+{
+	uint8_t			*bytes;
+	int			dumpData	= 0;
+	int			fd;
+	const journalHeader	*header;
+	int			n		= 0;
+	int			opt;
+	const char		*path		= DEFAULT_JOURNAL;
+	uint64_t		pos;
+	const uint8_t		*ring;
+	struct stat		statbuf;
+
+	while ((opt = getopt(argc, argv, "x")) != -1) {
+		switch (opt) {
+			case 'x' :
+				dumpData = 1;
+				break;
+			default :
+				fprintf(stderr, "usage: %s [-x] [<journal>]\n", argv[0]);
+				exit(1);
+		}
+	}
+	if (optind < argc) {
+		path = argv[optind];
+	}
+
+	/* take a copy (the journal may be changing) */
+	fd = open(path, O_RDONLY, 0);
+	if ((fd == -1) || (fstat(fd, &statbuf) == -1)) {
+		perror(path);
+		exit(1);
+	}
+	bytes = malloc((statbuf.st_size > 0) ? (size_t)statbuf.st_size : 1);
+	if (read(fd, bytes, (size_t)statbuf.st_size) != statbuf.st_size) {
+		perror("read");
+		exit(1);
+	}
+	(void) close(fd);
+
+	header = (const journalHeader *)(const void *)bytes;
+	if ((statbuf.st_size < (off_t)sizeof(journalHeader)) ||
+	    (header->magic != JOURNAL_MAGIC) ||
+	    (header->version != JOURNAL_VERSION) ||
+	    ((uint64_t)header->headerSize + header->ringSize > (uint64_t)statbuf.st_size) ||
+	    ((header->ringSize % 8) != 0) ||
+	    (header->head < header->tail) ||
+	    (header->head - header->tail > header->ringSize)) {
+		fprintf(stderr, "%s: not a valid journal\n", path);
+		exit(1);
+	}
+	ring = bytes + header->headerSize;
+
+	printf("journal created ");
+	printTime(header->created);
+	printf(", %u byte ring, %llu records dropped\n\n",
+	       header->ringSize,
+	       (unsigned long long)header->dropped);
+
+	for (pos = header->tail; pos < header->head; ) {
+		uint32_t		offset	= (uint32_t)(pos % header->ringSize);
+		const journalRecord	*record	= (const journalRecord *)(const void *)(ring + offset);
+
+		if ((header->ringSize - offset < 8) ||
+		    (record->length < 8) ||
+		    ((record->length % 8) != 0) ||
+		    (record->length > header->ringSize - offset)) {
+			fprintf(stderr, "invalid record at position %llu\n", (unsigned long long)pos);
+			break;
+		}
+
+		if (record->type != kJournalPad) {
+			if ((record->length < sizeof(journalRecord)) || !printRecord(record, dumpData)) {
+				fprintf(stderr, "invalid record at position %llu\n", (unsigned long long)pos);
+				break;
+			}
+			n++;
+		}
+
+		pos += record->length;
+	}
+
+	printf("\n%d records\n", n);
+	free(bytes);
+	exit(0);
+}
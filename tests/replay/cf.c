@@ -0,0 +1,2896 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * A CoreFoundation stand-in for building the configd store engine (and
+ * the replay driver) on hosts without CoreFoundation.  See
+ * include/CoreFoundation/CoreFoundation.h for what is (and is not)
+ * supported.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/CFRuntime.h>
+
+
+#define	IMMORTAL_RC	INT32_MAX	/* retain count of static / CFSTR() objects */
+
+
+static uint64_t		objectsLive	= 0;
+static uint64_t		objectsCreated	= 0;
+
+
+#pragma mark -
+#pragma mark Runtime
+
+
+enum {
+	_kCFNullTypeID		= 1,
+	_kCFBooleanTypeID,
+	_kCFStringTypeID,
+	_kCFDataTypeID,
+	_kCFNumberTypeID,
+	_kCFArrayTypeID,
+	_kCFDictionaryTypeID,
+	_kCFSetTypeID,
+	_kCFDateTypeID,
+	_kCFFirstUserTypeID
+};
+
+#define	N_CLASSES	64
+
+static const CFRuntimeClass	*classes[N_CLASSES];
+static CFTypeID			nClasses	= _kCFFirstUserTypeID;
+
+
+CFTypeID
+_CFRuntimeRegisterClass(const CFRuntimeClass * const cls)
+{
+	if (nClasses >= N_CLASSES) {
+		return _kCFRuntimeNotATypeID;
+	}
+
+	classes[nClasses] = cls;
+	return nClasses++;
+}
+
+
+static void *
+objectCreate(CFTypeID typeID, size_t size)
+{
+	CFRuntimeBase	*obj;
+
+	obj = calloc(1, size);
+	if (obj == NULL) {
+		abort();
+	}
+	obj->_typeID = typeID;
+	obj->_rc     = 1;
+
+	__atomic_add_fetch(&objectsLive, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&objectsCreated, 1, __ATOMIC_RELAXED);
+	return obj;
+}
+
+
+CFTypeRef
+_CFRuntimeCreateInstance(CFAllocatorRef allocator, CFTypeID typeID, CFIndex extraBytes, unsigned char *category)
+{
+	CFRuntimeBase	*obj;
+
+	obj = objectCreate(typeID, sizeof(CFRuntimeBase) + extraBytes);
+	if ((typeID < N_CLASSES) && (classes[typeID] != NULL) && (classes[typeID]->init != NULL)) {
+		classes[typeID]->init(obj);
+	}
+	return obj;
+}
+
+
+void
+__CFStandInGetObjectCount(uint64_t *live, uint64_t *created)
+{
+	if (live != NULL)	*live    = __atomic_load_n(&objectsLive, __ATOMIC_RELAXED);
+	if (created != NULL)	*created = __atomic_load_n(&objectsCreated, __ATOMIC_RELAXED);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFAllocator
+
+
+static const struct { int unused; }	__allocatorDefault, __allocatorNull;
+
+const CFAllocatorRef	kCFAllocatorDefault		= NULL;
+const CFAllocatorRef	kCFAllocatorSystemDefault	= (CFAllocatorRef)&__allocatorDefault;
+const CFAllocatorRef	kCFAllocatorMalloc		= (CFAllocatorRef)&__allocatorDefault;
+const CFAllocatorRef	kCFAllocatorNull		= (CFAllocatorRef)&__allocatorNull;
+
+
+void *
+CFAllocatorAllocate(CFAllocatorRef allocator, CFIndex size, CFOptionFlags hint)
+{
+	return malloc(size);
+}
+
+
+void *
+CFAllocatorReallocate(CFAllocatorRef allocator, void *ptr, CFIndex newsize, CFOptionFlags hint)
+{
+	return realloc(ptr, newsize);
+}
+
+
+void
+CFAllocatorDeallocate(CFAllocatorRef allocator, void *ptr)
+{
+	free(ptr);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Object types
+
+
+struct __CFNull {
+	CFRuntimeBase	base;
+};
+
+struct __CFBoolean {
+	CFRuntimeBase	base;
+	Boolean		value;
+};
+
+struct __CFString {
+	CFRuntimeBase	base;
+	Boolean		isMutable;
+	CFHashCode	hash;		/* 0 if not yet computed (or mutable) */
+	CFIndex		length;		/* # of [UTF-8] bytes */
+	CFIndex		capacity;
+	char		*bytes;		/* NUL terminated */
+	char		inline_bytes[];
+};
+
+struct __CFData {
+	CFRuntimeBase	base;
+	Boolean		isMutable;
+	Boolean		freeBytes;
+	CFIndex		length;
+	CFIndex		capacity;
+	UInt8		*bytes;
+	UInt8		inline_bytes[];
+};
+
+struct __CFNumber {
+	CFRuntimeBase	base;
+	Boolean		isFloat;
+	int64_t		i;
+	double		d;
+};
+
+typedef struct {
+	const void	**values;
+	CFIndex		count;
+	CFIndex		capacity;
+} arrayStorage;
+
+struct __CFArray {
+	CFRuntimeBase		base;
+	Boolean			isMutable;
+	CFArrayCallBacks	callBacks;
+	arrayStorage		storage;
+};
+
+/*
+ * the (open addressing, linear probe) hash table used by both CFDictionary
+ * and CFSet
+ */
+typedef struct {
+	CFIndex		count;
+	CFIndex		used;		/* count + deleted */
+	CFIndex		capacity;	/* 0 or a power of 2 */
+	uint8_t		*state;		/* 0 == empty, 1 == in use, 2 == deleted */
+	CFHashCode	*hashes;
+	const void	**keys;
+	const void	**values;	/* NULL for a set */
+} hashStorage;
+
+#define	SLOT_EMPTY	0
+#define	SLOT_IN_USE	1
+#define	SLOT_DELETED	2
+
+struct __CFDictionary {
+	CFRuntimeBase			base;
+	Boolean				isMutable;
+	CFDictionaryKeyCallBacks	keyCallBacks;
+	CFDictionaryValueCallBacks	valueCallBacks;
+	hashStorage			storage;
+};
+
+struct __CFSet {
+	CFRuntimeBase			base;
+	Boolean				isMutable;
+	CFSetCallBacks			callBacks;
+	hashStorage			storage;
+};
+
+
+static const struct __CFNull	__kCFNull		= { { _kCFNullTypeID, IMMORTAL_RC } };
+static const struct __CFBoolean	__kCFBooleanTrue	= { { _kCFBooleanTypeID, IMMORTAL_RC }, TRUE };
+static const struct __CFBoolean	__kCFBooleanFalse	= { { _kCFBooleanTypeID, IMMORTAL_RC }, FALSE };
+
+const CFNullRef		kCFNull		= &__kCFNull;
+const CFBooleanRef	kCFBooleanTrue	= &__kCFBooleanTrue;
+const CFBooleanRef	kCFBooleanFalse	= &__kCFBooleanFalse;
+
+
+static void	arrayFinalize		(CFArrayRef array);
+static void	dictionaryFinalize	(CFDictionaryRef dict);
+static void	setFinalize		(CFSetRef set);
+static Boolean	stringEqual		(CFStringRef str1, CFStringRef str2);
+static Boolean	arrayEqual		(CFArrayRef array1, CFArrayRef array2);
+static Boolean	dictionaryEqual		(CFDictionaryRef dict1, CFDictionaryRef dict2);
+static Boolean	setEqual		(CFSetRef set1, CFSetRef set2);
+static CFHashCode stringHash		(CFStringRef str);
+
+
+#pragma mark -
+#pragma mark CFType
+
+
+CFTypeRef
+CFRetain(CFTypeRef cf)
+{
+	CFRuntimeBase	*obj	= (CFRuntimeBase *)cf;
+
+	if (obj == NULL) {
+		fprintf(stderr, "*** CFRetain() called with NULL\n");
+		abort();
+	}
+
+	if (obj->_rc != IMMORTAL_RC) {
+		__atomic_add_fetch(&obj->_rc, 1, __ATOMIC_RELAXED);
+	}
+	return cf;
+}
+
+
+void
+CFRelease(CFTypeRef cf)
+{
+	CFRuntimeBase	*obj	= (CFRuntimeBase *)cf;
+
+	if (obj == NULL) {
+		fprintf(stderr, "*** CFRelease() called with NULL\n");
+		abort();
+	}
+
+	if (obj->_rc == IMMORTAL_RC) {
+		return;
+	}
+
+	if (__atomic_sub_fetch(&obj->_rc, 1, __ATOMIC_ACQ_REL) > 0) {
+		return;
+	}
+
+	switch (obj->_typeID) {
+		case _kCFStringTypeID : {
+			struct __CFString	*str	= (struct __CFString *)cf;
+
+			if (str->bytes != str->inline_bytes) free(str->bytes);
+			break;
+		}
+		case _kCFDataTypeID : {
+			struct __CFData		*data	= (struct __CFData *)cf;
+
+			if (data->freeBytes) free(data->bytes);
+			break;
+		}
+		case _kCFArrayTypeID :
+			arrayFinalize(cf);
+			break;
+		case _kCFDictionaryTypeID :
+			dictionaryFinalize(cf);
+			break;
+		case _kCFSetTypeID :
+			setFinalize(cf);
+			break;
+		default :
+			if ((obj->_typeID < N_CLASSES) &&
+			    (classes[obj->_typeID] != NULL) &&
+			    (classes[obj->_typeID]->finalize != NULL)) {
+				classes[obj->_typeID]->finalize(cf);
+			}
+			break;
+	}
+
+	__atomic_sub_fetch(&objectsLive, 1, __ATOMIC_RELAXED);
+	free(obj);
+	return;
+}
+
+
+CFIndex
+CFGetRetainCount(CFTypeRef cf)
+{
+	return ((CFRuntimeBase *)cf)->_rc;
+}
+
+
+CFTypeID
+CFGetTypeID(CFTypeRef cf)
+{
+	return ((CFRuntimeBase *)cf)->_typeID;
+}
+
+
+CFAllocatorRef
+CFGetAllocator(CFTypeRef cf)
+{
+	return kCFAllocatorDefault;
+}
+
+
+Boolean
+CFEqual(CFTypeRef cf1, CFTypeRef cf2)
+{
+	CFTypeID	type;
+
+	if (cf1 == cf2) {
+		return TRUE;
+	}
+
+	type = CFGetTypeID(cf1);
+	if (type != CFGetTypeID(cf2)) {
+		return FALSE;
+	}
+
+	switch (type) {
+		case _kCFStringTypeID :
+			return stringEqual(cf1, cf2);
+		case _kCFDataTypeID : {
+			CFDataRef	data1	= cf1;
+			CFDataRef	data2	= cf2;
+
+			return ((data1->length == data2->length) &&
+				(memcmp(data1->bytes, data2->bytes, data1->length) == 0));
+		}
+		case _kCFNumberTypeID :
+			return (CFNumberCompare(cf1, cf2, NULL) == kCFCompareEqualTo);
+		case _kCFArrayTypeID :
+			return arrayEqual(cf1, cf2);
+		case _kCFDictionaryTypeID :
+			return dictionaryEqual(cf1, cf2);
+		case _kCFSetTypeID :
+			return setEqual(cf1, cf2);
+		case _kCFNullTypeID :
+		case _kCFBooleanTypeID :
+			return FALSE;
+		default :
+			if ((type < N_CLASSES) && (classes[type] != NULL) && (classes[type]->equal != NULL)) {
+				return classes[type]->equal(cf1, cf2);
+			}
+			return FALSE;
+	}
+}
+
+
+static CFHashCode
+hashBytes(const void *bytes, CFIndex length)
+{
+	const uint8_t	*p	= bytes;
+	CFHashCode	h	= 14695981039346656037UL;	/* FNV-1a */
+	CFIndex		i;
+
+	for (i = 0; i < length; i++) {
+		h ^= p[i];
+		h *= 1099511628211UL;
+	}
+
+	return h;
+}
+
+
+CFHashCode
+CFHash(CFTypeRef cf)
+{
+	CFTypeID	type	= CFGetTypeID(cf);
+
+	switch (type) {
+		case _kCFStringTypeID :
+			return stringHash(cf);
+		case _kCFDataTypeID : {
+			CFDataRef	data	= cf;
+
+			return hashBytes(data->bytes, (data->length < 80) ? data->length : 80) ^ data->length;
+		}
+		case _kCFNumberTypeID : {
+			CFNumberRef	num	= cf;
+
+			if (num->isFloat && (num->d != floor(num->d))) {
+				return hashBytes(&num->d, sizeof(num->d));
+			}
+			return (CFHashCode)(num->isFloat ? (int64_t)num->d : num->i);
+		}
+		case _kCFArrayTypeID :
+			return ((CFArrayRef)cf)->storage.count;
+		case _kCFDictionaryTypeID :
+			return ((CFDictionaryRef)cf)->storage.count;
+		case _kCFSetTypeID :
+			return ((CFSetRef)cf)->storage.count;
+		default :
+			if ((type < N_CLASSES) && (classes[type] != NULL) && (classes[type]->hash != NULL)) {
+				return classes[type]->hash(cf);
+			}
+			return (CFHashCode)cf;
+	}
+}
+
+
+static void	describe		(CFMutableStringRef desc, CFTypeRef cf);
+
+
+CFStringRef
+CFCopyDescription(CFTypeRef cf)
+{
+	CFMutableStringRef	desc;
+
+	if (cf == NULL) {
+		return CFStringCreateWithCString(NULL, "(null)", kCFStringEncodingUTF8);
+	}
+
+	if (CFGetTypeID(cf) == _kCFStringTypeID) {
+		return CFStringCreateCopy(NULL, cf);
+	}
+
+	desc = CFStringCreateMutable(NULL, 0);
+	describe(desc, cf);
+	return desc;
+}
+
+
+CFStringRef
+CFCopyTypeIDDescription(CFTypeID type_id)
+{
+	static const char	*names[]	= {
+		"<invalid>", "CFNull", "CFBoolean", "CFString", "CFData",
+		"CFNumber", "CFArray", "CFDictionary", "CFSet", "CFDate"
+	};
+
+	if (type_id < _kCFFirstUserTypeID) {
+		return CFStringCreateWithCString(NULL, names[type_id], kCFStringEncodingUTF8);
+	}
+	if ((type_id < N_CLASSES) && (classes[type_id] != NULL)) {
+		return CFStringCreateWithCString(NULL, classes[type_id]->className, kCFStringEncodingUTF8);
+	}
+	return CFStringCreateWithCString(NULL, "<unknown>", kCFStringEncodingUTF8);
+}
+
+
+void
+CFShow(CFTypeRef obj)
+{
+	CFStringRef	desc;
+
+	desc = CFCopyDescription(obj);
+	fprintf(stderr, "%s\n", CFStringGetCStringPtr(desc, kCFStringEncodingUTF8));
+	CFRelease(desc);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFNull / CFBoolean
+
+
+CFTypeID
+CFNullGetTypeID(void)
+{
+	return _kCFNullTypeID;
+}
+
+
+CFTypeID
+CFBooleanGetTypeID(void)
+{
+	return _kCFBooleanTypeID;
+}
+
+
+Boolean
+CFBooleanGetValue(CFBooleanRef boolean)
+{
+	return boolean->value;
+}
+
+
+#pragma mark -
+#pragma mark CFString
+
+
+static struct __CFString *
+stringCreate(const char *bytes, CFIndex length)
+{
+	struct __CFString	*str;
+
+	str = objectCreate(_kCFStringTypeID, sizeof(struct __CFString) + length + 1);
+	str->length   = length;
+	str->capacity = length + 1;
+	str->bytes    = str->inline_bytes;
+	if (length > 0) {
+		memcpy(str->bytes, bytes, length);
+	}
+	str->bytes[length] = '\0';
+	return str;
+}
+
+
+static void
+stringReserve(struct __CFString *str, CFIndex length)
+{
+	CFIndex	capacity;
+
+	if (length + 1 <= str->capacity) {
+		return;
+	}
+
+	capacity = (str->capacity > 16) ? str->capacity : 16;
+	while (capacity < length + 1) {
+		capacity *= 2;
+	}
+
+	if (str->bytes == str->inline_bytes) {
+		char	*bytes;
+
+		bytes = malloc(capacity);
+		memcpy(bytes, str->bytes, str->length + 1);
+		str->bytes = bytes;
+	} else {
+		str->bytes = realloc(str->bytes, capacity);
+	}
+	str->capacity = capacity;
+	return;
+}
+
+
+static void
+stringAppendBytes(CFMutableStringRef str, const char *bytes, CFIndex length)
+{
+	stringReserve(str, str->length + length);
+	memcpy(str->bytes + str->length, bytes, length);
+	str->length += length;
+	str->bytes[str->length] = '\0';
+	return;
+}
+
+
+static Boolean
+stringEqual(CFStringRef str1, CFStringRef str2)
+{
+	if (str1->length != str2->length) {
+		return FALSE;
+	}
+
+	if (!str1->isMutable && !str2->isMutable &&
+	    (str1->hash != 0) && (str2->hash != 0) && (str1->hash != str2->hash)) {
+		return FALSE;
+	}
+
+	return (memcmp(str1->bytes, str2->bytes, str1->length) == 0);
+}
+
+
+static CFHashCode
+stringHash(CFStringRef str)
+{
+	CFHashCode	hash;
+
+	if (str->isMutable) {
+		return hashBytes(str->bytes, str->length);
+	}
+
+	hash = str->hash;
+	if (hash == 0) {
+		hash = hashBytes(str->bytes, str->length);
+		if (hash == 0) hash = 1;
+		((struct __CFString *)str)->hash = hash;
+	}
+
+	return hash;
+}
+
+
+/*
+ * CFSTR() strings are uniqued (by content) so that the same constant
+ * string (used, for example, as a dictionary key) is always the same
+ * object.
+ */
+static pthread_mutex_t		constantLock	= PTHREAD_MUTEX_INITIALIZER;
+static CFStringRef		*constants	= NULL;
+static CFIndex			nConstants	= 0;
+static CFIndex			maxConstants	= 0;	/* a power of 2 */
+
+
+CFStringRef
+__CFStringMakeConstantString(const char *cStr)
+{
+	CFHashCode		hash;
+	CFIndex			i;
+	CFIndex			length	= strlen(cStr);
+	struct __CFString	*str;
+
+	hash = hashBytes(cStr, length);
+	if (hash == 0) hash = 1;
+
+	pthread_mutex_lock(&constantLock);
+
+	if (maxConstants > 0) {
+		for (i = hash & (maxConstants - 1); constants[i] != NULL; i = (i + 1) & (maxConstants - 1)) {
+			if ((constants[i]->hash == hash) &&
+			    (constants[i]->length == length) &&
+			    (memcmp(constants[i]->bytes, cStr, length) == 0)) {
+				str = (struct __CFString *)constants[i];
+				goto done;
+			}
+		}
+	}
+
+	if ((nConstants + 1) * 2 > maxConstants) {
+		CFStringRef	*old		= constants;
+		CFIndex		oldMax		= maxConstants;
+
+		maxConstants = (maxConstants > 0) ? maxConstants * 2 : 256;
+		constants    = calloc(maxConstants, sizeof(CFStringRef));
+		for (i = 0; i < oldMax; i++) {
+			CFIndex	j;
+
+			if (old[i] == NULL) continue;
+			for (j = old[i]->hash & (maxConstants - 1); constants[j] != NULL; j = (j + 1) & (maxConstants - 1)) {
+			}
+			constants[j] = old[i];
+		}
+		free(old);
+	}
+
+	str = stringCreate(cStr, length);
+	str->hash = hash;
+	str->base._rc = IMMORTAL_RC;
+	__atomic_sub_fetch(&objectsLive, 1, __ATOMIC_RELAXED);
+
+	for (i = hash & (maxConstants - 1); constants[i] != NULL; i = (i + 1) & (maxConstants - 1)) {
+	}
+	constants[i] = str;
+	nConstants++;
+
+    done :
+
+	pthread_mutex_unlock(&constantLock);
+	return str;
+}
+
+
+CFTypeID
+CFStringGetTypeID(void)
+{
+	return _kCFStringTypeID;
+}
+
+
+CFStringRef
+CFStringCreateWithCString(CFAllocatorRef alloc, const char *cStr, CFStringEncoding encoding)
+{
+	return stringCreate(cStr, strlen(cStr));
+}
+
+
+CFStringRef
+CFStringCreateWithCStringNoCopy(CFAllocatorRef alloc, const char *cStr, CFStringEncoding encoding, CFAllocatorRef contentsDeallocator)
+{
+	CFStringRef	str;
+
+	str = stringCreate(cStr, strlen(cStr));
+	if (contentsDeallocator != kCFAllocatorNull) {
+		free((void *)cStr);
+	}
+	return str;
+}
+
+
+CFStringRef
+CFStringCreateWithBytes(CFAllocatorRef alloc, const UInt8 *bytes, CFIndex numBytes, CFStringEncoding encoding, Boolean isExternalRepresentation)
+{
+	return stringCreate((const char *)bytes, numBytes);
+}
+
+
+CFStringRef
+CFStringCreateWithSubstring(CFAllocatorRef alloc, CFStringRef str, CFRange range)
+{
+	return stringCreate(str->bytes + range.location, range.length);
+}
+
+
+CFStringRef
+CFStringCreateCopy(CFAllocatorRef alloc, CFStringRef theString)
+{
+	if (!theString->isMutable) {
+		return CFRetain(theString);
+	}
+	return stringCreate(theString->bytes, theString->length);
+}
+
+
+CFMutableStringRef
+CFStringCreateMutable(CFAllocatorRef alloc, CFIndex maxLength)
+{
+	struct __CFString	*str;
+
+	str = stringCreate(NULL, 0);
+	str->isMutable = TRUE;
+	return str;
+}
+
+
+CFMutableStringRef
+CFStringCreateMutableCopy(CFAllocatorRef alloc, CFIndex maxLength, CFStringRef theString)
+{
+	CFMutableStringRef	str;
+
+	str = CFStringCreateMutable(alloc, maxLength);
+	stringAppendBytes(str, theString->bytes, theString->length);
+	return str;
+}
+
+
+void
+CFStringAppend(CFMutableStringRef theString, CFStringRef appendedString)
+{
+	stringAppendBytes(theString, appendedString->bytes, appendedString->length);
+	return;
+}
+
+
+void
+CFStringAppendCString(CFMutableStringRef theString, const char *cStr, CFStringEncoding encoding)
+{
+	stringAppendBytes(theString, cStr, strlen(cStr));
+	return;
+}
+
+
+static void
+appendFormat(CFMutableStringRef str, const char *format, va_list arguments)
+{
+	const char	*p	= format;
+
+	while (*p != '\0') {
+		char		buf[512];
+		char		spec[64];
+		size_t		specLen;
+		const char	*start;
+		int		n;
+		enum { mod_none, mod_hh, mod_h, mod_l, mod_ll, mod_z, mod_t, mod_j, mod_L } mod = mod_none;
+
+		if (*p != '%') {
+			start = p;
+			while ((*p != '\0') && (*p != '%')) p++;
+			stringAppendBytes(str, start, p - start);
+			continue;
+		}
+
+		/* parse the conversion specification */
+		start = p++;
+		if (*p == '%') {
+			stringAppendBytes(str, "%", 1);
+			p++;
+			continue;
+		}
+
+		specLen = 0;
+		spec[specLen++] = '%';
+		while ((*p != '\0') && (strchr("-+ #0'", *p) != NULL)) {
+			if (specLen < sizeof(spec) - 8) spec[specLen++] = *p;
+			p++;
+		}
+		if (*p == '*') {
+			specLen += snprintf(spec + specLen, sizeof(spec) - specLen, "%d", va_arg(arguments, int));
+			p++;
+		} else {
+			while (isdigit((unsigned char)*p)) {
+				if (specLen < sizeof(spec) - 8) spec[specLen++] = *p;
+				p++;
+			}
+		}
+		if (*p == '.') {
+			spec[specLen++] = *p++;
+			if (*p == '*') {
+				specLen += snprintf(spec + specLen, sizeof(spec) - specLen, "%d", va_arg(arguments, int));
+				p++;
+			} else {
+				while (isdigit((unsigned char)*p)) {
+					if (specLen < sizeof(spec) - 8) spec[specLen++] = *p;
+					p++;
+				}
+			}
+		}
+		switch (*p) {
+			case 'h' : p++; mod = mod_h;  if (*p == 'h') { p++; mod = mod_hh; } break;
+			case 'l' : p++; mod = mod_l;  if (*p == 'l') { p++; mod = mod_ll; } break;
+			case 'q' : p++; mod = mod_ll; break;
+			case 'z' : p++; mod = mod_z;  break;
+			case 't' : p++; mod = mod_t;  break;
+			case 'j' : p++; mod = mod_j;  break;
+			case 'L' : p++; mod = mod_L;  break;
+		}
+
+		switch (*p) {
+			case '@' : {
+				CFTypeRef	obj	= va_arg(arguments, CFTypeRef);
+				CFStringRef	desc;
+
+				desc = CFCopyDescription(obj);
+				stringAppendBytes(str, desc->bytes, desc->length);
+				CFRelease(desc);
+				p++;
+				continue;
+			}
+			case 'd' :
+			case 'i' :
+				spec[specLen++] = 'l';
+				spec[specLen++] = 'l';
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				switch (mod) {
+					case mod_l  : n = snprintf(buf, sizeof(buf), spec, (long long)va_arg(arguments, long));		break;
+					case mod_ll : n = snprintf(buf, sizeof(buf), spec, va_arg(arguments, long long));		break;
+					case mod_z  : n = snprintf(buf, sizeof(buf), spec, (long long)va_arg(arguments, ssize_t));	break;
+					case mod_t  : n = snprintf(buf, sizeof(buf), spec, (long long)va_arg(arguments, ptrdiff_t));	break;
+					case mod_j  : n = snprintf(buf, sizeof(buf), spec, (long long)va_arg(arguments, intmax_t));	break;
+					default     : n = snprintf(buf, sizeof(buf), spec, (long long)va_arg(arguments, int));		break;
+				}
+				break;
+			case 'u' :
+			case 'o' :
+			case 'x' :
+			case 'X' :
+				spec[specLen++] = 'l';
+				spec[specLen++] = 'l';
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				switch (mod) {
+					case mod_l  : n = snprintf(buf, sizeof(buf), spec, (unsigned long long)va_arg(arguments, unsigned long));	break;
+					case mod_ll : n = snprintf(buf, sizeof(buf), spec, va_arg(arguments, unsigned long long));		break;
+					case mod_z  : n = snprintf(buf, sizeof(buf), spec, (unsigned long long)va_arg(arguments, size_t));	break;
+					case mod_t  : n = snprintf(buf, sizeof(buf), spec, (unsigned long long)va_arg(arguments, ptrdiff_t));	break;
+					case mod_j  : n = snprintf(buf, sizeof(buf), spec, (unsigned long long)va_arg(arguments, uintmax_t));	break;
+					default     : n = snprintf(buf, sizeof(buf), spec, (unsigned long long)va_arg(arguments, unsigned int));	break;
+				}
+				break;
+			case 'c' :
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				n = snprintf(buf, sizeof(buf), spec, va_arg(arguments, int));
+				break;
+			case 'e' :
+			case 'E' :
+			case 'f' :
+			case 'F' :
+			case 'g' :
+			case 'G' :
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				if (mod == mod_L) {
+					n = snprintf(buf, sizeof(buf), spec, (double)va_arg(arguments, long double));
+				} else {
+					n = snprintf(buf, sizeof(buf), spec, va_arg(arguments, double));
+				}
+				break;
+			case 'p' :
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				n = snprintf(buf, sizeof(buf), spec, va_arg(arguments, void *));
+				break;
+			case 's' : {
+				const char	*s	= va_arg(arguments, const char *);
+
+				if (s == NULL) s = "(null)";
+				spec[specLen++] = *p;
+				spec[specLen]   = '\0';
+				if (strcmp(spec, "%s") == 0) {
+					stringAppendBytes(str, s, strlen(s));
+					p++;
+					continue;
+				}
+				n = snprintf(buf, sizeof(buf), spec, s);
+				break;
+			}
+			default :
+				/* unsupported conversion, copy it as-is */
+				stringAppendBytes(str, start, p - start);
+				continue;
+		}
+		p++;
+
+		if (n >= (int)sizeof(buf)) n = sizeof(buf) - 1;
+		if (n > 0) stringAppendBytes(str, buf, n);
+	}
+
+	return;
+}
+
+
+CFStringRef
+CFStringCreateWithFormatAndArguments(CFAllocatorRef alloc, CFDictionaryRef formatOptions, CFStringRef format, va_list arguments)
+{
+	CFMutableStringRef	str;
+	CFStringRef		result;
+
+	str = CFStringCreateMutable(alloc, 0);
+	appendFormat(str, format->bytes, arguments);
+	result = stringCreate(str->bytes, str->length);
+	CFRelease(str);
+	return result;
+}
+
+
+CFStringRef
+CFStringCreateWithFormat(CFAllocatorRef alloc, CFDictionaryRef formatOptions, CFStringRef format, ...)
+{
+	va_list		arguments;
+	CFStringRef	str;
+
+	va_start(arguments, format);
+	str = CFStringCreateWithFormatAndArguments(alloc, formatOptions, format, arguments);
+	va_end(arguments);
+	return str;
+}
+
+
+void
+CFStringAppendFormat(CFMutableStringRef theString, CFDictionaryRef formatOptions, CFStringRef format, ...)
+{
+	va_list		arguments;
+
+	va_start(arguments, format);
+	appendFormat(theString, format->bytes, arguments);
+	va_end(arguments);
+	return;
+}
+
+
+CFStringRef
+CFStringCreateFromExternalRepresentation(CFAllocatorRef alloc, CFDataRef data, CFStringEncoding encoding)
+{
+	return stringCreate((const char *)data->bytes, data->length);
+}
+
+
+CFDataRef
+CFStringCreateExternalRepresentation(CFAllocatorRef alloc, CFStringRef theString, CFStringEncoding encoding, UInt8 lossByte)
+{
+	return CFDataCreate(alloc, (const UInt8 *)theString->bytes, theString->length);
+}
+
+
+CFIndex
+CFStringGetLength(CFStringRef theString)
+{
+	return theString->length;
+}
+
+
+CFIndex
+CFStringGetMaximumSizeForEncoding(CFIndex length, CFStringEncoding encoding)
+{
+	/* our "characters" are bytes */
+	return length;
+}
+
+
+Boolean
+CFStringGetCString(CFStringRef theString, char *buffer, CFIndex bufferSize, CFStringEncoding encoding)
+{
+	if (theString->length + 1 > bufferSize) {
+		return FALSE;
+	}
+
+	memcpy(buffer, theString->bytes, theString->length + 1);
+	return TRUE;
+}
+
+
+const char *
+CFStringGetCStringPtr(CFStringRef theString, CFStringEncoding encoding)
+{
+	return theString->bytes;
+}
+
+
+CFIndex
+CFStringGetBytes(CFStringRef theString, CFRange range, CFStringEncoding encoding, UInt8 lossByte, Boolean isExternalRepresentation, UInt8 *buffer, CFIndex maxBufLen, CFIndex *usedBufLen)
+{
+	CFIndex	n	= range.length;
+
+	if ((buffer != NULL) && (n > maxBufLen)) {
+		n = maxBufLen;
+	}
+	if (buffer != NULL) {
+		memcpy(buffer, theString->bytes + range.location, n);
+	}
+	if (usedBufLen != NULL) {
+		*usedBufLen = n;
+	}
+	return n;
+}
+
+
+UniChar
+CFStringGetCharacterAtIndex(CFStringRef theString, CFIndex idx)
+{
+	return (UInt8)theString->bytes[idx];
+}
+
+
+CFComparisonResult
+CFStringCompare(CFStringRef theString1, CFStringRef theString2, CFOptionFlags compareOptions)
+{
+	CFIndex	len	= (theString1->length < theString2->length) ? theString1->length : theString2->length;
+	int	result;
+
+	if ((compareOptions & kCFCompareCaseInsensitive) != 0) {
+		result = strncasecmp(theString1->bytes, theString2->bytes, len);
+	} else {
+		result = memcmp(theString1->bytes, theString2->bytes, len);
+	}
+	if (result == 0) {
+		result = (theString1->length < theString2->length) ? -1 : (theString1->length > theString2->length);
+	}
+
+	return (result < 0) ? kCFCompareLessThan : ((result > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo);
+}
+
+
+Boolean
+CFStringHasPrefix(CFStringRef theString, CFStringRef prefix)
+{
+	return ((theString->length >= prefix->length) &&
+		(memcmp(theString->bytes, prefix->bytes, prefix->length) == 0));
+}
+
+
+Boolean
+CFStringHasSuffix(CFStringRef theString, CFStringRef suffix)
+{
+	return ((theString->length >= suffix->length) &&
+		(memcmp(theString->bytes + theString->length - suffix->length, suffix->bytes, suffix->length) == 0));
+}
+
+
+CFRange
+CFStringFind(CFStringRef theString, CFStringRef stringToFind, CFOptionFlags compareOptions)
+{
+	CFIndex	i;
+	CFIndex	last	= theString->length - stringToFind->length;
+
+	if ((stringToFind->length == 0) || (last < 0)) {
+		return CFRangeMake(kCFNotFound, 0);
+	}
+
+	if ((compareOptions & kCFCompareBackwards) != 0) {
+		for (i = last; i >= 0; i--) {
+			if (memcmp(theString->bytes + i, stringToFind->bytes, stringToFind->length) == 0) {
+				return CFRangeMake(i, stringToFind->length);
+			}
+			if ((compareOptions & kCFCompareAnchored) != 0) break;
+		}
+	} else {
+		for (i = 0; i <= last; i++) {
+			if (memcmp(theString->bytes + i, stringToFind->bytes, stringToFind->length) == 0) {
+				return CFRangeMake(i, stringToFind->length);
+			}
+			if ((compareOptions & kCFCompareAnchored) != 0) break;
+		}
+	}
+
+	return CFRangeMake(kCFNotFound, 0);
+}
+
+
+CFArrayRef
+CFStringCreateArrayBySeparatingStrings(CFAllocatorRef alloc, CFStringRef theString, CFStringRef separatorString)
+{
+	CFMutableArrayRef	array;
+	const char		*p	= theString->bytes;
+	const char		*end	= theString->bytes + theString->length;
+
+	array = CFArrayCreateMutable(alloc, 0, &kCFTypeArrayCallBacks);
+	while (TRUE) {
+		const char	*sep;
+		CFStringRef	str;
+
+		sep = (separatorString->length > 0) ? memmem(p, end - p, separatorString->bytes, separatorString->length) : NULL;
+		if (sep == NULL) {
+			str = stringCreate(p, end - p);
+			CFArrayAppendValue(array, str);
+			CFRelease(str);
+			break;
+		}
+		str = stringCreate(p, sep - p);
+		CFArrayAppendValue(array, str);
+		CFRelease(str);
+		p = sep + separatorString->length;
+	}
+
+	return array;
+}
+
+
+SInt32
+CFStringGetIntValue(CFStringRef str)
+{
+	return (SInt32)strtol(str->bytes, NULL, 10);
+}
+
+
+#pragma mark -
+#pragma mark CFData
+
+
+static struct __CFData *
+dataCreate(const UInt8 *bytes, CFIndex length, Boolean isMutable)
+{
+	struct __CFData	*data;
+
+	if (isMutable) {
+		data = objectCreate(_kCFDataTypeID, sizeof(struct __CFData));
+		data->isMutable = TRUE;
+		data->freeBytes = TRUE;
+		data->capacity  = (length > 16) ? length : 16;
+		data->bytes     = malloc(data->capacity);
+	} else {
+		data = objectCreate(_kCFDataTypeID, sizeof(struct __CFData) + length);
+		data->capacity  = length;
+		data->bytes     = data->inline_bytes;
+	}
+	data->length = length;
+	if (length > 0) {
+		memcpy(data->bytes, bytes, length);
+	}
+	return data;
+}
+
+
+CFTypeID
+CFDataGetTypeID(void)
+{
+	return _kCFDataTypeID;
+}
+
+
+CFDataRef
+CFDataCreate(CFAllocatorRef allocator, const UInt8 *bytes, CFIndex length)
+{
+	return dataCreate(bytes, length, FALSE);
+}
+
+
+CFDataRef
+CFDataCreateWithBytesNoCopy(CFAllocatorRef allocator, const UInt8 *bytes, CFIndex length, CFAllocatorRef bytesDeallocator)
+{
+	struct __CFData	*data;
+
+	data = objectCreate(_kCFDataTypeID, sizeof(struct __CFData));
+	data->freeBytes = (bytesDeallocator != kCFAllocatorNull);
+	data->length    = length;
+	data->capacity  = length;
+	data->bytes     = (UInt8 *)bytes;
+	return data;
+}
+
+
+CFDataRef
+CFDataCreateCopy(CFAllocatorRef allocator, CFDataRef theData)
+{
+	if (!theData->isMutable && (theData->bytes == theData->inline_bytes)) {
+		return CFRetain(theData);
+	}
+	return dataCreate(theData->bytes, theData->length, FALSE);
+}
+
+
+CFMutableDataRef
+CFDataCreateMutable(CFAllocatorRef allocator, CFIndex capacity)
+{
+	return dataCreate(NULL, 0, TRUE);
+}
+
+
+CFMutableDataRef
+CFDataCreateMutableCopy(CFAllocatorRef allocator, CFIndex capacity, CFDataRef theData)
+{
+	return dataCreate(theData->bytes, theData->length, TRUE);
+}
+
+
+CFIndex
+CFDataGetLength(CFDataRef theData)
+{
+	return theData->length;
+}
+
+
+const UInt8 *
+CFDataGetBytePtr(CFDataRef theData)
+{
+	return theData->bytes;
+}
+
+
+UInt8 *
+CFDataGetMutableBytePtr(CFMutableDataRef theData)
+{
+	return theData->bytes;
+}
+
+
+void
+CFDataGetBytes(CFDataRef theData, CFRange range, UInt8 *buffer)
+{
+	memcpy(buffer, theData->bytes + range.location, range.length);
+	return;
+}
+
+
+void
+CFDataSetLength(CFMutableDataRef theData, CFIndex length)
+{
+	if (length > theData->capacity) {
+		CFIndex	capacity	= theData->capacity;
+
+		while (capacity < length) {
+			capacity *= 2;
+		}
+		theData->bytes    = realloc(theData->bytes, capacity);
+		theData->capacity = capacity;
+	}
+	if (length > theData->length) {
+		memset(theData->bytes + theData->length, 0, length - theData->length);
+	}
+	theData->length = length;
+	return;
+}
+
+
+void
+CFDataIncreaseLength(CFMutableDataRef theData, CFIndex extraLength)
+{
+	CFDataSetLength(theData, theData->length + extraLength);
+	return;
+}
+
+
+void
+CFDataAppendBytes(CFMutableDataRef theData, const UInt8 *bytes, CFIndex length)
+{
+	CFIndex	offset	= theData->length;
+
+	CFDataSetLength(theData, offset + length);
+	memcpy(theData->bytes + offset, bytes, length);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFNumber
+
+
+CFTypeID
+CFNumberGetTypeID(void)
+{
+	return _kCFNumberTypeID;
+}
+
+
+CFNumberRef
+CFNumberCreate(CFAllocatorRef allocator, CFNumberType theType, const void *valuePtr)
+{
+	struct __CFNumber	*num;
+
+	num = objectCreate(_kCFNumberTypeID, sizeof(struct __CFNumber));
+	switch (theType) {
+		case kCFNumberSInt8Type		:
+		case kCFNumberCharType		: num->i = *(const int8_t *)valuePtr;		break;
+		case kCFNumberSInt16Type	:
+		case kCFNumberShortType		: num->i = *(const int16_t *)valuePtr;		break;
+		case kCFNumberSInt32Type	:
+		case kCFNumberIntType		: num->i = *(const int32_t *)valuePtr;		break;
+		case kCFNumberLongType		: num->i = *(const long *)valuePtr;		break;
+		case kCFNumberCFIndexType	: num->i = *(const CFIndex *)valuePtr;		break;
+		case kCFNumberSInt64Type	:
+		case kCFNumberLongLongType	: num->i = *(const int64_t *)valuePtr;		break;
+		case kCFNumberFloat32Type	:
+		case kCFNumberFloatType		: num->d = *(const float *)valuePtr;	num->isFloat = TRUE;	break;
+		case kCFNumberFloat64Type	:
+		case kCFNumberDoubleType	: num->d = *(const double *)valuePtr;	num->isFloat = TRUE;	break;
+	}
+	if (!num->isFloat) {
+		num->d = (double)num->i;
+	} else {
+		num->i = (int64_t)num->d;
+	}
+	return num;
+}
+
+
+Boolean
+CFNumberGetValue(CFNumberRef number, CFNumberType theType, void *valuePtr)
+{
+	switch (theType) {
+		case kCFNumberSInt8Type		:
+		case kCFNumberCharType		: *(int8_t *)valuePtr  = (int8_t)number->i;	break;
+		case kCFNumberSInt16Type	:
+		case kCFNumberShortType		: *(int16_t *)valuePtr = (int16_t)number->i;	break;
+		case kCFNumberSInt32Type	:
+		case kCFNumberIntType		: *(int32_t *)valuePtr = (int32_t)number->i;	break;
+		case kCFNumberLongType		: *(long *)valuePtr    = (long)number->i;	break;
+		case kCFNumberCFIndexType	: *(CFIndex *)valuePtr = (CFIndex)number->i;	break;
+		case kCFNumberSInt64Type	:
+		case kCFNumberLongLongType	: *(int64_t *)valuePtr = number->i;		break;
+		case kCFNumberFloat32Type	:
+		case kCFNumberFloatType		: *(float *)valuePtr   = (float)number->d;	break;
+		case kCFNumberFloat64Type	:
+		case kCFNumberDoubleType	: *(double *)valuePtr  = number->d;		break;
+	}
+	return TRUE;
+}
+
+
+Boolean
+CFNumberIsFloatType(CFNumberRef number)
+{
+	return number->isFloat;
+}
+
+
+CFComparisonResult
+CFNumberCompare(CFNumberRef number, CFNumberRef otherNumber, void *context)
+{
+	if (!number->isFloat && !otherNumber->isFloat) {
+		return (number->i < otherNumber->i) ? kCFCompareLessThan :
+		       ((number->i > otherNumber->i) ? kCFCompareGreaterThan : kCFCompareEqualTo);
+	}
+
+	return (number->d < otherNumber->d) ? kCFCompareLessThan :
+	       ((number->d > otherNumber->d) ? kCFCompareGreaterThan : kCFCompareEqualTo);
+}
+
+
+#pragma mark -
+#pragma mark CFDate
+
+
+CFTypeID
+CFDateGetTypeID(void)
+{
+	return _kCFDateTypeID;
+}
+
+
+CFAbsoluteTime
+CFAbsoluteTimeGetCurrent(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9 - 978307200.0;
+}
+
+
+#pragma mark -
+#pragma mark CFArray
+
+
+static const void *
+__CFTypeRetain(CFAllocatorRef allocator, const void *value)
+{
+	return CFRetain(value);
+}
+
+
+static void
+__CFTypeRelease(CFAllocatorRef allocator, const void *value)
+{
+	CFRelease(value);
+	return;
+}
+
+
+const CFArrayCallBacks	kCFTypeArrayCallBacks	= {
+	0, __CFTypeRetain, __CFTypeRelease, CFCopyDescription, CFEqual
+};
+
+
+static struct __CFArray *
+arrayCreate(const CFArrayCallBacks *callBacks, Boolean isMutable)
+{
+	struct __CFArray	*array;
+
+	array = objectCreate(_kCFArrayTypeID, sizeof(struct __CFArray));
+	array->isMutable = isMutable;
+	if (callBacks != NULL) {
+		array->callBacks = *callBacks;
+	}
+	return array;
+}
+
+
+static void
+arrayReserve(struct __CFArray *array, CFIndex count)
+{
+	if (count <= array->storage.capacity) {
+		return;
+	}
+
+	array->storage.capacity = (array->storage.capacity > 4) ? array->storage.capacity : 4;
+	while (array->storage.capacity < count) {
+		array->storage.capacity *= 2;
+	}
+	array->storage.values = realloc(array->storage.values, array->storage.capacity * sizeof(const void *));
+	return;
+}
+
+
+static void
+arrayFinalize(CFArrayRef array)
+{
+	CFIndex	i;
+
+	if (array->callBacks.release != NULL) {
+		for (i = 0; i < array->storage.count; i++) {
+			array->callBacks.release(NULL, array->storage.values[i]);
+		}
+	}
+	free(array->storage.values);
+	return;
+}
+
+
+static Boolean
+valuesEqual(CFArrayEqualCallBack equal, const void *value1, const void *value2)
+{
+	if (value1 == value2) {
+		return TRUE;
+	}
+	return ((equal != NULL) && equal(value1, value2));
+}
+
+
+static Boolean
+arrayEqual(CFArrayRef array1, CFArrayRef array2)
+{
+	CFIndex	i;
+
+	if (array1->storage.count != array2->storage.count) {
+		return FALSE;
+	}
+
+	for (i = 0; i < array1->storage.count; i++) {
+		if (!valuesEqual(array1->callBacks.equal, array1->storage.values[i], array2->storage.values[i])) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+CFTypeID
+CFArrayGetTypeID(void)
+{
+	return _kCFArrayTypeID;
+}
+
+
+CFArrayRef
+CFArrayCreate(CFAllocatorRef allocator, const void **values, CFIndex numValues, const CFArrayCallBacks *callBacks)
+{
+	struct __CFArray	*array;
+
+	array = arrayCreate(callBacks, FALSE);
+	CFArrayReplaceValues(array, CFRangeMake(0, 0), values, numValues);
+	return array;
+}
+
+
+CFArrayRef
+CFArrayCreateCopy(CFAllocatorRef allocator, CFArrayRef theArray)
+{
+	return CFArrayCreate(allocator, theArray->storage.values, theArray->storage.count, &theArray->callBacks);
+}
+
+
+CFMutableArrayRef
+CFArrayCreateMutable(CFAllocatorRef allocator, CFIndex capacity, const CFArrayCallBacks *callBacks)
+{
+	return arrayCreate(callBacks, TRUE);
+}
+
+
+CFMutableArrayRef
+CFArrayCreateMutableCopy(CFAllocatorRef allocator, CFIndex capacity, CFArrayRef theArray)
+{
+	struct __CFArray	*array;
+
+	array = arrayCreate(&theArray->callBacks, TRUE);
+	CFArrayReplaceValues(array, CFRangeMake(0, 0), theArray->storage.values, theArray->storage.count);
+	return array;
+}
+
+
+CFIndex
+CFArrayGetCount(CFArrayRef theArray)
+{
+	return theArray->storage.count;
+}
+
+
+const void *
+CFArrayGetValueAtIndex(CFArrayRef theArray, CFIndex idx)
+{
+	if ((idx < 0) || (idx >= theArray->storage.count)) {
+		fprintf(stderr, "*** CFArrayGetValueAtIndex(): index %ld out of bounds (%ld)\n", idx, theArray->storage.count);
+		abort();
+	}
+	return theArray->storage.values[idx];
+}
+
+
+void
+CFArrayGetValues(CFArrayRef theArray, CFRange range, const void **values)
+{
+	memcpy(values, theArray->storage.values + range.location, range.length * sizeof(const void *));
+	return;
+}
+
+
+CFIndex
+CFArrayGetFirstIndexOfValue(CFArrayRef theArray, CFRange range, const void *value)
+{
+	CFIndex	i;
+
+	for (i = range.location; i < range.location + range.length; i++) {
+		if (valuesEqual(theArray->callBacks.equal, theArray->storage.values[i], value)) {
+			return i;
+		}
+	}
+
+	return kCFNotFound;
+}
+
+
+Boolean
+CFArrayContainsValue(CFArrayRef theArray, CFRange range, const void *value)
+{
+	return (CFArrayGetFirstIndexOfValue(theArray, range, value) != kCFNotFound);
+}
+
+
+void
+CFArrayApplyFunction(CFArrayRef theArray, CFRange range, CFArrayApplierFunction applier, void *context)
+{
+	CFIndex	i;
+
+	for (i = range.location; i < range.location + range.length; i++) {
+		applier(theArray->storage.values[i], context);
+	}
+	return;
+}
+
+
+void
+CFArrayReplaceValues(CFMutableArrayRef theArray, CFRange range, const void **newValues, CFIndex newCount)
+{
+	CFIndex	i;
+	CFIndex	tail;
+
+	/* retain the new values (before releasing the old ones) */
+	if (theArray->callBacks.retain != NULL) {
+		for (i = 0; i < newCount; i++) {
+			theArray->callBacks.retain(NULL, newValues[i]);
+		}
+	}
+	if (theArray->callBacks.release != NULL) {
+		for (i = range.location; i < range.location + range.length; i++) {
+			theArray->callBacks.release(NULL, theArray->storage.values[i]);
+		}
+	}
+
+	arrayReserve(theArray, theArray->storage.count - range.length + newCount);
+	tail = theArray->storage.count - (range.location + range.length);
+	if (tail > 0) {
+		memmove(theArray->storage.values + range.location + newCount,
+			theArray->storage.values + range.location + range.length,
+			tail * sizeof(const void *));
+	}
+	if (newCount > 0) {
+		memcpy(theArray->storage.values + range.location, newValues, newCount * sizeof(const void *));
+	}
+	theArray->storage.count += newCount - range.length;
+	return;
+}
+
+
+void
+CFArrayAppendValue(CFMutableArrayRef theArray, const void *value)
+{
+	CFArrayReplaceValues(theArray, CFRangeMake(theArray->storage.count, 0), &value, 1);
+	return;
+}
+
+
+void
+CFArrayAppendArray(CFMutableArrayRef theArray, CFArrayRef otherArray, CFRange otherRange)
+{
+	CFArrayReplaceValues(theArray,
+			     CFRangeMake(theArray->storage.count, 0),
+			     otherArray->storage.values + otherRange.location,
+			     otherRange.length);
+	return;
+}
+
+
+void
+CFArrayInsertValueAtIndex(CFMutableArrayRef theArray, CFIndex idx, const void *value)
+{
+	CFArrayReplaceValues(theArray, CFRangeMake(idx, 0), &value, 1);
+	return;
+}
+
+
+void
+CFArraySetValueAtIndex(CFMutableArrayRef theArray, CFIndex idx, const void *value)
+{
+	if (idx == theArray->storage.count) {
+		CFArrayAppendValue(theArray, value);
+	} else {
+		CFArrayReplaceValues(theArray, CFRangeMake(idx, 1), &value, 1);
+	}
+	return;
+}
+
+
+void
+CFArrayRemoveValueAtIndex(CFMutableArrayRef theArray, CFIndex idx)
+{
+	CFArrayReplaceValues(theArray, CFRangeMake(idx, 1), NULL, 0);
+	return;
+}
+
+
+void
+CFArrayRemoveAllValues(CFMutableArrayRef theArray)
+{
+	CFArrayReplaceValues(theArray, CFRangeMake(0, theArray->storage.count), NULL, 0);
+	return;
+}
+
+
+void
+CFArraySortValues(CFMutableArrayRef theArray, CFRange range, CFComparatorFunction comparator, void *context)
+{
+	const void	**values	= theArray->storage.values + range.location;
+	const void	**tmp;
+	CFIndex		width;
+
+	if (range.length < 2) {
+		return;
+	}
+
+	/* a (stable) bottom-up merge sort */
+	tmp = malloc(range.length * sizeof(const void *));
+	for (width = 1; width < range.length; width *= 2) {
+		CFIndex	i;
+
+		for (i = 0; i < range.length; i += 2 * width) {
+			CFIndex	left	= i;
+			CFIndex	mid	= (i + width < range.length) ? i + width : range.length;
+			CFIndex	right	= (i + 2 * width < range.length) ? i + 2 * width : range.length;
+			CFIndex	a	= left;
+			CFIndex	b	= mid;
+			CFIndex	k	= left;
+
+			while ((a < mid) && (b < right)) {
+				if (comparator(values[b], values[a], context) == kCFCompareLessThan) {
+					tmp[k++] = values[b++];
+				} else {
+					tmp[k++] = values[a++];
+				}
+			}
+			while (a < mid)		tmp[k++] = values[a++];
+			while (b < right)	tmp[k++] = values[b++];
+		}
+		memcpy(values, tmp, range.length * sizeof(const void *));
+	}
+	free(tmp);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Hash tables (CFDictionary, CFSet)
+
+
+/* the (common) layout of CFDictionaryKeyCallBacks and CFSetCallBacks, less the version */
+typedef struct {
+	CFDictionaryRetainCallBack		retain;
+	CFDictionaryReleaseCallBack		release;
+	CFDictionaryCopyDescriptionCallBack	copyDescription;
+	CFDictionaryEqualCallBack		equal;
+	CFDictionaryHashCallBack		hash;
+} hashKeyCallBacks;
+
+
+static __inline__ CFHashCode
+hashKey(const hashKeyCallBacks *cb, const void *key)
+{
+	return (cb->hash != NULL) ? cb->hash(key) : (CFHashCode)key;
+}
+
+
+static CFIndex
+hashFind(const hashStorage *storage, const hashKeyCallBacks *cb, const void *key, CFHashCode hash)
+{
+	CFIndex	i;
+	CFIndex	mask;
+
+	if (storage->count == 0) {
+		return kCFNotFound;
+	}
+
+	mask = storage->capacity - 1;
+	for (i = hash & mask; storage->state[i] != SLOT_EMPTY; i = (i + 1) & mask) {
+		if ((storage->state[i] == SLOT_IN_USE) &&
+		    (storage->hashes[i] == hash) &&
+		    ((storage->keys[i] == key) || ((cb->equal != NULL) && cb->equal(storage->keys[i], key)))) {
+			return i;
+		}
+	}
+
+	return kCFNotFound;
+}
+
+
+static void
+hashResize(hashStorage *storage, CFIndex capacity, Boolean isSet)
+{
+	hashStorage	old	= *storage;
+	CFIndex		i;
+
+	storage->capacity = capacity;
+	storage->used     = storage->count;
+	storage->state    = calloc(capacity, sizeof(uint8_t));
+	storage->hashes   = malloc(capacity * sizeof(CFHashCode));
+	storage->keys     = malloc(capacity * sizeof(const void *));
+	storage->values   = !isSet ? malloc(capacity * sizeof(const void *)) : NULL;
+
+	for (i = 0; i < old.capacity; i++) {
+		CFIndex	j;
+
+		if (old.state[i] != SLOT_IN_USE) {
+			continue;
+		}
+		for (j = old.hashes[i] & (capacity - 1); storage->state[j] != SLOT_EMPTY; j = (j + 1) & (capacity - 1)) {
+		}
+		storage->state[j]  = SLOT_IN_USE;
+		storage->hashes[j] = old.hashes[i];
+		storage->keys[j]   = old.keys[i];
+		if (storage->values != NULL) storage->values[j] = old.values[i];
+	}
+
+	free(old.state);
+	free(old.hashes);
+	free(old.keys);
+	free(old.values);
+	return;
+}
+
+
+/*
+ * hashAdd
+ *   adds (or, if "replace", replaces the value of) the key.  Returns the
+ *   slot of the key.
+ */
+static CFIndex
+hashAdd(hashStorage *storage, const hashKeyCallBacks *cb, CFDictionaryValueCallBacks *vcb, Boolean isSet,
+	const void *key, const void *value, Boolean replace)
+{
+	CFHashCode	hash;
+	CFIndex		i;
+	CFIndex		mask;
+
+	hash = hashKey(cb, key);
+	i = hashFind(storage, cb, key, hash);
+	if (i != kCFNotFound) {
+		if (replace && !isSet) {
+			if (vcb->retain != NULL)	vcb->retain(NULL, value);
+			if (vcb->release != NULL)	vcb->release(NULL, storage->values[i]);
+			storage->values[i] = value;
+		}
+		return i;
+	}
+
+	if ((storage->used + 1) * 2 > storage->capacity) {
+		CFIndex	capacity	= (storage->capacity > 0) ? storage->capacity : 8;
+
+		while ((storage->count + 1) * 2 > capacity) {
+			capacity *= 2;
+		}
+		hashResize(storage, capacity, isSet);
+	}
+
+	mask = storage->capacity - 1;
+	for (i = hash & mask; storage->state[i] == SLOT_IN_USE; i = (i + 1) & mask) {
+	}
+	if (storage->state[i] == SLOT_EMPTY) {
+		storage->used++;
+	}
+	storage->state[i]  = SLOT_IN_USE;
+	storage->hashes[i] = hash;
+	storage->keys[i]   = (cb->retain != NULL) ? cb->retain(NULL, key) : key;
+	if (!isSet) {
+		storage->values[i] = (vcb->retain != NULL) ? vcb->retain(NULL, value) : value;
+	}
+	storage->count++;
+	return i;
+}
+
+
+static void
+hashRemoveSlot(hashStorage *storage, const hashKeyCallBacks *cb, CFDictionaryValueCallBacks *vcb, CFIndex i)
+{
+	const void	*key	= storage->keys[i];
+	const void	*value	= (storage->values != NULL) ? storage->values[i] : NULL;
+
+	storage->state[i] = SLOT_DELETED;
+	storage->count--;
+	if (storage->count == 0) {
+		/* start fresh (and drop any tombstones) */
+		memset(storage->state, SLOT_EMPTY, storage->capacity);
+		storage->used = 0;
+	}
+
+	if (cb->release != NULL)				cb->release(NULL, key);
+	if ((vcb != NULL) && (vcb->release != NULL))		vcb->release(NULL, value);
+	return;
+}
+
+
+static void
+hashRemoveAll(hashStorage *storage, const hashKeyCallBacks *cb, CFDictionaryValueCallBacks *vcb)
+{
+	CFIndex	i;
+
+	for (i = 0; i < storage->capacity; i++) {
+		if (storage->state[i] == SLOT_IN_USE) {
+			if (cb->release != NULL)			cb->release(NULL, storage->keys[i]);
+			if ((vcb != NULL) && (vcb->release != NULL))	vcb->release(NULL, storage->values[i]);
+		}
+	}
+	if (storage->capacity > 0) {
+		memset(storage->state, SLOT_EMPTY, storage->capacity);
+	}
+	storage->count = 0;
+	storage->used  = 0;
+	return;
+}
+
+
+static void
+hashFree(hashStorage *storage)
+{
+	free(storage->state);
+	free(storage->hashes);
+	free(storage->keys);
+	free(storage->values);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFDictionary
+
+
+const CFDictionaryKeyCallBacks		kCFTypeDictionaryKeyCallBacks		= {
+	0, __CFTypeRetain, __CFTypeRelease, CFCopyDescription, CFEqual, CFHash
+};
+
+const CFDictionaryKeyCallBacks		kCFCopyStringDictionaryKeyCallBacks	= {
+	0, __CFTypeRetain, __CFTypeRelease, CFCopyDescription, CFEqual, CFHash
+};
+
+const CFDictionaryValueCallBacks	kCFTypeDictionaryValueCallBacks		= {
+	0, __CFTypeRetain, __CFTypeRelease, CFCopyDescription, CFEqual
+};
+
+
+#define	DICT_KEY_CB(dict)	((const hashKeyCallBacks *)&(dict)->keyCallBacks.retain)
+
+
+static struct __CFDictionary *
+dictionaryCreate(const CFDictionaryKeyCallBacks *keyCallBacks, const CFDictionaryValueCallBacks *valueCallBacks, Boolean isMutable)
+{
+	struct __CFDictionary	*dict;
+
+	dict = objectCreate(_kCFDictionaryTypeID, sizeof(struct __CFDictionary));
+	dict->isMutable = isMutable;
+	if (keyCallBacks != NULL)	dict->keyCallBacks   = *keyCallBacks;
+	if (valueCallBacks != NULL)	dict->valueCallBacks = *valueCallBacks;
+	return dict;
+}
+
+
+static void
+dictionaryFinalize(CFDictionaryRef dict)
+{
+	hashRemoveAll((hashStorage *)&dict->storage, DICT_KEY_CB(dict), (CFDictionaryValueCallBacks *)&dict->valueCallBacks);
+	hashFree((hashStorage *)&dict->storage);
+	return;
+}
+
+
+static Boolean
+dictionaryEqual(CFDictionaryRef dict1, CFDictionaryRef dict2)
+{
+	CFIndex	i;
+
+	if (dict1->storage.count != dict2->storage.count) {
+		return FALSE;
+	}
+
+	for (i = 0; i < dict1->storage.capacity; i++) {
+		CFIndex	j;
+
+		if (dict1->storage.state[i] != SLOT_IN_USE) {
+			continue;
+		}
+		j = hashFind(&dict2->storage, DICT_KEY_CB(dict2), dict1->storage.keys[i], dict1->storage.hashes[i]);
+		if (j == kCFNotFound) {
+			return FALSE;
+		}
+		if (!valuesEqual(dict1->valueCallBacks.equal, dict1->storage.values[i], dict2->storage.values[j])) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+CFTypeID
+CFDictionaryGetTypeID(void)
+{
+	return _kCFDictionaryTypeID;
+}
+
+
+CFDictionaryRef
+CFDictionaryCreate(CFAllocatorRef allocator, const void **keys, const void **values, CFIndex numValues, const CFDictionaryKeyCallBacks *keyCallBacks, const CFDictionaryValueCallBacks *valueCallBacks)
+{
+	struct __CFDictionary	*dict;
+	CFIndex			i;
+
+	dict = dictionaryCreate(keyCallBacks, valueCallBacks, TRUE);
+	for (i = 0; i < numValues; i++) {
+		CFDictionarySetValue(dict, keys[i], values[i]);
+	}
+	dict->isMutable = FALSE;
+	return dict;
+}
+
+
+static void
+dictionaryCopyValues(CFMutableDictionaryRef dict, CFDictionaryRef theDict)
+{
+	CFIndex	i;
+
+	for (i = 0; i < theDict->storage.capacity; i++) {
+		if (theDict->storage.state[i] == SLOT_IN_USE) {
+			CFDictionarySetValue(dict, theDict->storage.keys[i], theDict->storage.values[i]);
+		}
+	}
+	return;
+}
+
+
+CFDictionaryRef
+CFDictionaryCreateCopy(CFAllocatorRef allocator, CFDictionaryRef theDict)
+{
+	struct __CFDictionary	*dict;
+
+	dict = dictionaryCreate(&theDict->keyCallBacks, &theDict->valueCallBacks, TRUE);
+	dictionaryCopyValues(dict, theDict);
+	dict->isMutable = FALSE;
+	return dict;
+}
+
+
+CFMutableDictionaryRef
+CFDictionaryCreateMutable(CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryKeyCallBacks *keyCallBacks, const CFDictionaryValueCallBacks *valueCallBacks)
+{
+	return dictionaryCreate(keyCallBacks, valueCallBacks, TRUE);
+}
+
+
+CFMutableDictionaryRef
+CFDictionaryCreateMutableCopy(CFAllocatorRef allocator, CFIndex capacity, CFDictionaryRef theDict)
+{
+	struct __CFDictionary	*dict;
+
+	dict = dictionaryCreate(&theDict->keyCallBacks, &theDict->valueCallBacks, TRUE);
+	dictionaryCopyValues(dict, theDict);
+	return dict;
+}
+
+
+CFIndex
+CFDictionaryGetCount(CFDictionaryRef theDict)
+{
+	return theDict->storage.count;
+}
+
+
+Boolean
+CFDictionaryContainsKey(CFDictionaryRef theDict, const void *key)
+{
+	return (hashFind(&theDict->storage, DICT_KEY_CB(theDict), key, hashKey(DICT_KEY_CB(theDict), key)) != kCFNotFound);
+}
+
+
+const void *
+CFDictionaryGetValue(CFDictionaryRef theDict, const void *key)
+{
+	CFIndex	i;
+
+	i = hashFind(&theDict->storage, DICT_KEY_CB(theDict), key, hashKey(DICT_KEY_CB(theDict), key));
+	return (i != kCFNotFound) ? theDict->storage.values[i] : NULL;
+}
+
+
+Boolean
+CFDictionaryGetValueIfPresent(CFDictionaryRef theDict, const void *key, const void **value)
+{
+	CFIndex	i;
+
+	i = hashFind(&theDict->storage, DICT_KEY_CB(theDict), key, hashKey(DICT_KEY_CB(theDict), key));
+	if (i == kCFNotFound) {
+		return FALSE;
+	}
+	if (value != NULL) *value = theDict->storage.values[i];
+	return TRUE;
+}
+
+
+void
+CFDictionaryGetKeysAndValues(CFDictionaryRef theDict, const void **keys, const void **values)
+{
+	CFIndex	i;
+	CFIndex	n	= 0;
+
+	for (i = 0; i < theDict->storage.capacity; i++) {
+		if (theDict->storage.state[i] == SLOT_IN_USE) {
+			if (keys != NULL)	keys[n]   = theDict->storage.keys[i];
+			if (values != NULL)	values[n] = theDict->storage.values[i];
+			n++;
+		}
+	}
+	return;
+}
+
+
+void
+CFDictionaryApplyFunction(CFDictionaryRef theDict, CFDictionaryApplierFunction applier, void *context)
+{
+	CFIndex	i;
+
+	for (i = 0; i < theDict->storage.capacity; i++) {
+		if (theDict->storage.state[i] == SLOT_IN_USE) {
+			applier(theDict->storage.keys[i], theDict->storage.values[i], context);
+		}
+	}
+	return;
+}
+
+
+void
+CFDictionaryAddValue(CFMutableDictionaryRef theDict, const void *key, const void *value)
+{
+	(void) hashAdd(&theDict->storage, DICT_KEY_CB(theDict), &theDict->valueCallBacks, FALSE, key, value, FALSE);
+	return;
+}
+
+
+void
+CFDictionarySetValue(CFMutableDictionaryRef theDict, const void *key, const void *value)
+{
+	(void) hashAdd(&theDict->storage, DICT_KEY_CB(theDict), &theDict->valueCallBacks, FALSE, key, value, TRUE);
+	return;
+}
+
+
+void
+CFDictionaryReplaceValue(CFMutableDictionaryRef theDict, const void *key, const void *value)
+{
+	if (CFDictionaryContainsKey(theDict, key)) {
+		CFDictionarySetValue(theDict, key, value);
+	}
+	return;
+}
+
+
+void
+CFDictionaryRemoveValue(CFMutableDictionaryRef theDict, const void *key)
+{
+	CFIndex	i;
+
+	i = hashFind(&theDict->storage, DICT_KEY_CB(theDict), key, hashKey(DICT_KEY_CB(theDict), key));
+	if (i != kCFNotFound) {
+		hashRemoveSlot(&theDict->storage, DICT_KEY_CB(theDict), &theDict->valueCallBacks, i);
+	}
+	return;
+}
+
+
+void
+CFDictionaryRemoveAllValues(CFMutableDictionaryRef theDict)
+{
+	hashRemoveAll(&theDict->storage, DICT_KEY_CB(theDict), &theDict->valueCallBacks);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFSet
+
+
+const CFSetCallBacks	kCFTypeSetCallBacks	= {
+	0, __CFTypeRetain, __CFTypeRelease, CFCopyDescription, CFEqual, CFHash
+};
+
+
+#define	SET_KEY_CB(set)	((const hashKeyCallBacks *)&(set)->callBacks.retain)
+
+
+static struct __CFSet *
+setCreate(const CFSetCallBacks *callBacks, Boolean isMutable)
+{
+	struct __CFSet	*set;
+
+	set = objectCreate(_kCFSetTypeID, sizeof(struct __CFSet));
+	set->isMutable = isMutable;
+	if (callBacks != NULL) {
+		set->callBacks = *callBacks;
+	}
+	return set;
+}
+
+
+static void
+setFinalize(CFSetRef set)
+{
+	hashRemoveAll((hashStorage *)&set->storage, SET_KEY_CB(set), NULL);
+	hashFree((hashStorage *)&set->storage);
+	return;
+}
+
+
+static Boolean
+setEqual(CFSetRef set1, CFSetRef set2)
+{
+	CFIndex	i;
+
+	if (set1->storage.count != set2->storage.count) {
+		return FALSE;
+	}
+
+	for (i = 0; i < set1->storage.capacity; i++) {
+		if ((set1->storage.state[i] == SLOT_IN_USE) &&
+		    (hashFind(&set2->storage, SET_KEY_CB(set2), set1->storage.keys[i], set1->storage.hashes[i]) == kCFNotFound)) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
+static void
+setCopyValues(CFMutableSetRef set, CFSetRef theSet)
+{
+	CFIndex	i;
+
+	for (i = 0; i < theSet->storage.capacity; i++) {
+		if (theSet->storage.state[i] == SLOT_IN_USE) {
+			CFSetAddValue(set, theSet->storage.keys[i]);
+		}
+	}
+	return;
+}
+
+
+CFTypeID
+CFSetGetTypeID(void)
+{
+	return _kCFSetTypeID;
+}
+
+
+CFSetRef
+CFSetCreate(CFAllocatorRef allocator, const void **values, CFIndex numValues, const CFSetCallBacks *callBacks)
+{
+	struct __CFSet	*set;
+	CFIndex		i;
+
+	set = setCreate(callBacks, TRUE);
+	for (i = 0; i < numValues; i++) {
+		CFSetAddValue(set, values[i]);
+	}
+	set->isMutable = FALSE;
+	return set;
+}
+
+
+CFSetRef
+CFSetCreateCopy(CFAllocatorRef allocator, CFSetRef theSet)
+{
+	struct __CFSet	*set;
+
+	set = setCreate(&theSet->callBacks, TRUE);
+	setCopyValues(set, theSet);
+	set->isMutable = FALSE;
+	return set;
+}
+
+
+CFMutableSetRef
+CFSetCreateMutable(CFAllocatorRef allocator, CFIndex capacity, const CFSetCallBacks *callBacks)
+{
+	return setCreate(callBacks, TRUE);
+}
+
+
+CFMutableSetRef
+CFSetCreateMutableCopy(CFAllocatorRef allocator, CFIndex capacity, CFSetRef theSet)
+{
+	struct __CFSet	*set;
+
+	set = setCreate(&theSet->callBacks, TRUE);
+	setCopyValues(set, theSet);
+	return set;
+}
+
+
+CFIndex
+CFSetGetCount(CFSetRef theSet)
+{
+	return theSet->storage.count;
+}
+
+
+Boolean
+CFSetContainsValue(CFSetRef theSet, const void *value)
+{
+	return (hashFind(&theSet->storage, SET_KEY_CB(theSet), value, hashKey(SET_KEY_CB(theSet), value)) != kCFNotFound);
+}
+
+
+const void *
+CFSetGetValue(CFSetRef theSet, const void *value)
+{
+	CFIndex	i;
+
+	i = hashFind(&theSet->storage, SET_KEY_CB(theSet), value, hashKey(SET_KEY_CB(theSet), value));
+	return (i != kCFNotFound) ? theSet->storage.keys[i] : NULL;
+}
+
+
+void
+CFSetGetValues(CFSetRef theSet, const void **values)
+{
+	CFIndex	i;
+	CFIndex	n	= 0;
+
+	for (i = 0; i < theSet->storage.capacity; i++) {
+		if (theSet->storage.state[i] == SLOT_IN_USE) {
+			values[n++] = theSet->storage.keys[i];
+		}
+	}
+	return;
+}
+
+
+void
+CFSetApplyFunction(CFSetRef theSet, CFSetApplierFunction applier, void *context)
+{
+	CFIndex	i;
+
+	for (i = 0; i < theSet->storage.capacity; i++) {
+		if (theSet->storage.state[i] == SLOT_IN_USE) {
+			applier(theSet->storage.keys[i], context);
+		}
+	}
+	return;
+}
+
+
+void
+CFSetAddValue(CFMutableSetRef theSet, const void *value)
+{
+	(void) hashAdd(&theSet->storage, SET_KEY_CB(theSet), NULL, TRUE, value, NULL, FALSE);
+	return;
+}
+
+
+void
+CFSetSetValue(CFMutableSetRef theSet, const void *value)
+{
+	CFSetRemoveValue(theSet, value);
+	CFSetAddValue(theSet, value);
+	return;
+}
+
+
+void
+CFSetRemoveValue(CFMutableSetRef theSet, const void *value)
+{
+	CFIndex	i;
+
+	i = hashFind(&theSet->storage, SET_KEY_CB(theSet), value, hashKey(SET_KEY_CB(theSet), value));
+	if (i != kCFNotFound) {
+		hashRemoveSlot(&theSet->storage, SET_KEY_CB(theSet), NULL, i);
+	}
+	return;
+}
+
+
+void
+CFSetRemoveAllValues(CFMutableSetRef theSet)
+{
+	hashRemoveAll(&theSet->storage, SET_KEY_CB(theSet), NULL);
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Descriptions
+
+
+typedef struct {
+	CFMutableStringRef	desc;
+	Boolean			first;
+} describeContext;
+
+
+static void
+describeArrayValue(const void *value, void *context)
+{
+	describeContext	*myContext	= (describeContext *)context;
+
+	if (!myContext->first) stringAppendBytes(myContext->desc, ", ", 2);
+	describe(myContext->desc, value);
+	myContext->first = FALSE;
+	return;
+}
+
+
+static void
+describeDictionaryValue(const void *key, const void *value, void *context)
+{
+	describeContext	*myContext	= (describeContext *)context;
+
+	describe(myContext->desc, key);
+	stringAppendBytes(myContext->desc, " = ", 3);
+	describe(myContext->desc, value);
+	stringAppendBytes(myContext->desc, "; ", 2);
+	return;
+}
+
+
+static void
+describe(CFMutableStringRef desc, CFTypeRef cf)
+{
+	CFTypeID	type	= CFGetTypeID(cf);
+	char		buf[64];
+
+	switch (type) {
+		case _kCFNullTypeID :
+			CFStringAppendCString(desc, "<null>", kCFStringEncodingUTF8);
+			break;
+		case _kCFBooleanTypeID :
+			CFStringAppendCString(desc, CFBooleanGetValue(cf) ? "true" : "false", kCFStringEncodingUTF8);
+			break;
+		case _kCFStringTypeID :
+			CFStringAppend(desc, cf);
+			break;
+		case _kCFDataTypeID : {
+			CFDataRef	data	= cf;
+			CFIndex		i;
+
+			stringAppendBytes(desc, "<", 1);
+			for (i = 0; i < data->length; i++) {
+				snprintf(buf, sizeof(buf), "%02x", data->bytes[i]);
+				stringAppendBytes(desc, buf, 2);
+			}
+			stringAppendBytes(desc, ">", 1);
+			break;
+		}
+		case _kCFNumberTypeID : {
+			CFNumberRef	num	= cf;
+
+			if (num->isFloat) {
+				snprintf(buf, sizeof(buf), "%g", num->d);
+			} else {
+				snprintf(buf, sizeof(buf), "%lld", (long long)num->i);
+			}
+			CFStringAppendCString(desc, buf, kCFStringEncodingUTF8);
+			break;
+		}
+		case _kCFArrayTypeID : {
+			describeContext	context	= { desc, TRUE };
+
+			stringAppendBytes(desc, "( ", 2);
+			CFArrayApplyFunction(cf, CFRangeMake(0, CFArrayGetCount(cf)), describeArrayValue, &context);
+			stringAppendBytes(desc, " )", 2);
+			break;
+		}
+		case _kCFDictionaryTypeID : {
+			describeContext	context	= { desc, TRUE };
+
+			stringAppendBytes(desc, "{ ", 2);
+			CFDictionaryApplyFunction(cf, describeDictionaryValue, &context);
+			stringAppendBytes(desc, "}", 1);
+			break;
+		}
+		case _kCFSetTypeID : {
+			describeContext	context	= { desc, TRUE };
+
+			stringAppendBytes(desc, "{( ", 3);
+			CFSetApplyFunction(cf, describeArrayValue, &context);
+			stringAppendBytes(desc, " )}", 3);
+			break;
+		}
+		default :
+			if ((type < N_CLASSES) && (classes[type] != NULL) && (classes[type]->copyDebugDesc != NULL)) {
+				CFStringRef	str;
+
+				str = classes[type]->copyDebugDesc(cf);
+				CFStringAppend(desc, str);
+				CFRelease(str);
+			} else {
+				snprintf(buf, sizeof(buf), "<%s %p>",
+					 ((type < N_CLASSES) && (classes[type] != NULL)) ? classes[type]->className : "CFType",
+					 cf);
+				CFStringAppendCString(desc, buf, kCFStringEncodingUTF8);
+			}
+			break;
+	}
+
+	return;
+}
+
+
+#pragma mark -
+#pragma mark CFPropertyList
+
+
+/*
+ * The (private) serialized property list format :
+ *
+ *   "cfsi"			magic
+ *   <object>
+ *
+ * where each <object> is a 1-byte tag followed by :
+ *
+ *   's' string, 'd' data	: uint32 length, bytes
+ *   'i' integer		: int64
+ *   'r' real			: double
+ *   't' true, 'f' false	: (nothing)
+ *   'a' array			: uint32 count, <object> * count
+ *   'm' dictionary		: uint32 count, (<key object> <value object>) * count
+ *
+ * All values are in host byte order.
+ */
+#define	PLIST_MAGIC	"cfsi"
+#define	PLIST_DEPTH_MAX	64
+
+
+static Boolean
+plistEncode(CFMutableDataRef data, CFPropertyListRef obj, int depth);
+
+
+typedef struct {
+	CFMutableDataRef	data;
+	Boolean			ok;
+	int			depth;
+} encodeContext;
+
+
+static void
+plistEncodeArrayValue(const void *value, void *context)
+{
+	encodeContext	*myContext	= (encodeContext *)context;
+
+	if (myContext->ok) {
+		myContext->ok = plistEncode(myContext->data, value, myContext->depth);
+	}
+	return;
+}
+
+
+static void
+plistEncodeDictionaryValue(const void *key, const void *value, void *context)
+{
+	encodeContext	*myContext	= (encodeContext *)context;
+
+	if (myContext->ok) {
+		myContext->ok = plistEncode(myContext->data, key, myContext->depth) &&
+				plistEncode(myContext->data, value, myContext->depth);
+	}
+	return;
+}
+
+
+static void
+plistAppend(CFMutableDataRef data, char tag, const void *bytes, size_t length)
+{
+	CFDataAppendBytes(data, (const UInt8 *)&tag, 1);
+	if (length > 0) {
+		CFDataAppendBytes(data, bytes, length);
+	}
+	return;
+}
+
+
+static Boolean
+plistEncode(CFMutableDataRef data, CFPropertyListRef obj, int depth)
+{
+	CFTypeID	type	= CFGetTypeID(obj);
+	uint32_t	n;
+
+	if (depth >= PLIST_DEPTH_MAX) {
+		return FALSE;
+	}
+
+	switch (type) {
+		case _kCFStringTypeID : {
+			CFStringRef	str	= obj;
+
+			n = (uint32_t)str->length;
+			plistAppend(data, 's', &n, sizeof(n));
+			CFDataAppendBytes(data, (const UInt8 *)str->bytes, n);
+			return TRUE;
+		}
+		case _kCFDataTypeID : {
+			CFDataRef	d	= obj;
+
+			n = (uint32_t)d->length;
+			plistAppend(data, 'd', &n, sizeof(n));
+			CFDataAppendBytes(data, d->bytes, n);
+			return TRUE;
+		}
+		case _kCFNumberTypeID : {
+			CFNumberRef	num	= obj;
+
+			if (num->isFloat) {
+				plistAppend(data, 'r', &num->d, sizeof(num->d));
+			} else {
+				plistAppend(data, 'i', &num->i, sizeof(num->i));
+			}
+			return TRUE;
+		}
+		case _kCFBooleanTypeID :
+			plistAppend(data, CFBooleanGetValue(obj) ? 't' : 'f', NULL, 0);
+			return TRUE;
+		case _kCFArrayTypeID : {
+			encodeContext	context	= { data, TRUE, depth + 1 };
+
+			n = (uint32_t)CFArrayGetCount(obj);
+			plistAppend(data, 'a', &n, sizeof(n));
+			CFArrayApplyFunction(obj, CFRangeMake(0, n), plistEncodeArrayValue, &context);
+			return context.ok;
+		}
+		case _kCFDictionaryTypeID : {
+			encodeContext	context	= { data, TRUE, depth + 1 };
+
+			n = (uint32_t)CFDictionaryGetCount(obj);
+			plistAppend(data, 'm', &n, sizeof(n));
+			CFDictionaryApplyFunction(obj, plistEncodeDictionaryValue, &context);
+			return context.ok;
+		}
+		default :
+			return FALSE;
+	}
+}
+
+
+CFDataRef
+CFPropertyListCreateData(CFAllocatorRef allocator, CFPropertyListRef propertyList, CFPropertyListFormat format, CFOptionFlags options, CFErrorRef *error)
+{
+	CFMutableDataRef	data;
+	CFDataRef		result;
+
+	if (error != NULL) *error = NULL;
+
+	data = CFDataCreateMutable(allocator, 0);
+	CFDataAppendBytes(data, (const UInt8 *)PLIST_MAGIC, 4);
+	if (!plistEncode(data, propertyList, 0)) {
+		CFRelease(data);
+		return NULL;
+	}
+
+	result = CFDataCreate(allocator, data->bytes, data->length);
+	CFRelease(data);
+	return result;
+}
+
+
+typedef struct {
+	const UInt8	*p;
+	const UInt8	*end;
+	CFOptionFlags	options;
+} decodeState;
+
+
+static Boolean
+plistGet(decodeState *state, void *bytes, size_t length)
+{
+	if ((size_t)(state->end - state->p) < length) {
+		return FALSE;
+	}
+	memcpy(bytes, state->p, length);
+	state->p += length;
+	return TRUE;
+}
+
+
+static CFPropertyListRef
+plistDecode(decodeState *state, int depth)
+{
+	uint32_t	i;
+	uint32_t	n;
+	char		tag;
+
+	if ((depth >= PLIST_DEPTH_MAX) || !plistGet(state, &tag, 1)) {
+		return NULL;
+	}
+
+	switch (tag) {
+		case 's' :
+		case 'd' :
+			if (!plistGet(state, &n, sizeof(n)) || ((size_t)(state->end - state->p) < n)) {
+				return NULL;
+			}
+			state->p += n;
+			if (tag == 's') {
+				if (state->options == kCFPropertyListMutableContainersAndLeaves) {
+					CFMutableStringRef	str;
+
+					str = CFStringCreateMutable(NULL, 0);
+					stringAppendBytes(str, (const char *)state->p - n, n);
+					return str;
+				}
+				return stringCreate((const char *)state->p - n, n);
+			}
+			return dataCreate(state->p - n, n, (state->options == kCFPropertyListMutableContainersAndLeaves));
+		case 'i' : {
+			int64_t	v;
+
+			if (!plistGet(state, &v, sizeof(v))) return NULL;
+			return CFNumberCreate(NULL, kCFNumberSInt64Type, &v);
+		}
+		case 'r' : {
+			double	v;
+
+			if (!plistGet(state, &v, sizeof(v))) return NULL;
+			return CFNumberCreate(NULL, kCFNumberDoubleType, &v);
+		}
+		case 't' :
+			return kCFBooleanTrue;
+		case 'f' :
+			return kCFBooleanFalse;
+		case 'a' : {
+			struct __CFArray	*array;
+
+			if (!plistGet(state, &n, sizeof(n))) return NULL;
+			array = arrayCreate(&kCFTypeArrayCallBacks, TRUE);
+			for (i = 0; i < n; i++) {
+				CFPropertyListRef	value;
+
+				value = plistDecode(state, depth + 1);
+				if (value == NULL) {
+					CFRelease(array);
+					return NULL;
+				}
+				CFArrayAppendValue(array, value);
+				CFRelease(value);
+			}
+			array->isMutable = (state->options != kCFPropertyListImmutable);
+			return array;
+		}
+		case 'm' : {
+			struct __CFDictionary	*dict;
+
+			if (!plistGet(state, &n, sizeof(n))) return NULL;
+			dict = dictionaryCreate(&kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks, TRUE);
+			for (i = 0; i < n; i++) {
+				CFPropertyListRef	key;
+				CFPropertyListRef	value;
+
+				key = plistDecode(state, depth + 1);
+				value = (key != NULL) ? plistDecode(state, depth + 1) : NULL;
+				if (value == NULL) {
+					if (key != NULL) CFRelease(key);
+					CFRelease(dict);
+					return NULL;
+				}
+				CFDictionarySetValue(dict, key, value);
+				CFRelease(key);
+				CFRelease(value);
+			}
+			dict->isMutable = (state->options != kCFPropertyListImmutable);
+			return dict;
+		}
+		default :
+			return NULL;
+	}
+}
+
+
+CFPropertyListRef
+CFPropertyListCreateWithData(CFAllocatorRef allocator, CFDataRef data, CFOptionFlags options, CFPropertyListFormat *format, CFErrorRef *error)
+{
+	CFPropertyListRef	plist;
+	decodeState		state;
+
+	if (error != NULL) *error = NULL;
+
+	if ((data->length < 4) || (memcmp(data->bytes, PLIST_MAGIC, 4) != 0)) {
+		return NULL;
+	}
+
+	state.p       = data->bytes + 4;
+	state.end     = data->bytes + data->length;
+	state.options = options;
+	plist = plistDecode(&state, 0);
+	if ((plist != NULL) && (state.p != state.end)) {
+		/* if trailing garbage */
+		CFRelease(plist);
+		return NULL;
+	}
+
+	if ((plist != NULL) && (format != NULL)) {
+		*format = kCFPropertyListBinaryFormat_v1_0;
+	}
+	return plist;
+}
+
+
+CFPropertyListRef
+CFPropertyListCreateDeepCopy(CFAllocatorRef allocator, CFPropertyListRef propertyList, CFOptionFlags mutabilityOption)
+{
+	CFDataRef		data;
+	CFPropertyListRef	plist;
+
+	data = CFPropertyListCreateData(allocator, propertyList, kCFPropertyListBinaryFormat_v1_0, 0, NULL);
+	if (data == NULL) {
+		return NULL;
+	}
+	plist = CFPropertyListCreateWithData(allocator, data, mutabilityOption, NULL, NULL);
+	CFRelease(data);
+	return plist;
+}
+
+
+#pragma mark -
+#pragma mark CFRunLoop / CFMachPort (not supported)
+
+
+const CFStringRef	kCFRunLoopDefaultMode	= NULL;
+const CFStringRef	kCFRunLoopCommonModes	= NULL;
+
+
+CFRunLoopRef
+CFRunLoopGetCurrent(void)
+{
+	return NULL;
+}
+
+
+void
+CFRunLoopAddSource(CFRunLoopRef rl, CFRunLoopSourceRef source, CFStringRef mode)
+{
+	return;
+}
+
+
+void
+CFRunLoopSourceInvalidate(CFRunLoopSourceRef source)
+{
+	return;
+}
+
+
+CFRunLoopTimerRef
+CFRunLoopTimerCreate(CFAllocatorRef allocator, CFAbsoluteTime fireDate, CFTimeInterval interval, CFOptionFlags flags, CFIndex order, CFRunLoopTimerCallBack callout, CFRunLoopTimerContext *context)
+{
+	return NULL;
+}
+
+
+void
+CFRunLoopAddTimer(CFRunLoopRef rl, CFRunLoopTimerRef timer, CFStringRef mode)
+{
+	return;
+}
+
+
+void
+CFRunLoopTimerInvalidate(CFRunLoopTimerRef timer)
+{
+	return;
+}
+
+
+CFAbsoluteTime
+CFRunLoopTimerGetNextFireDate(CFRunLoopTimerRef timer)
+{
+	return 0.0;
+}
+
+
+void
+CFRunLoopTimerSetNextFireDate(CFRunLoopTimerRef timer, CFAbsoluteTime fireDate)
+{
+	return;
+}
+
+
+CFRunLoopSourceRef
+CFMachPortCreateRunLoopSource(CFAllocatorRef allocator, CFMachPortRef port, CFIndex order)
+{
+	return NULL;
+}
+
+
+void
+CFMachPortInvalidate(CFMachPortRef port)
+{
+	return;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * CFRuntime stand-in (see CoreFoundation.h).
+ */
+
+#ifndef _CF_STANDIN_CFRUNTIME_H
+#define _CF_STANDIN_CFRUNTIME_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+__BEGIN_DECLS
+
+/* the header shared by all CF objects */
+typedef struct __CFRuntimeBase {
+	CFTypeID		_typeID;
+	volatile int32_t	_rc;
+} CFRuntimeBase;
+
+typedef struct __CFRuntimeClass {
+	CFIndex		version;
+	const char *	className;
+	void		(*init)(CFTypeRef cf);
+	CFTypeRef	(*copy)(CFAllocatorRef allocator, CFTypeRef cf);
+	void		(*finalize)(CFTypeRef cf);
+	Boolean		(*equal)(CFTypeRef cf1, CFTypeRef cf2);
+	CFHashCode	(*hash)(CFTypeRef cf);
+	CFStringRef	(*copyFormattingDesc)(CFTypeRef cf, CFDictionaryRef formatOptions);
+	CFStringRef	(*copyDebugDesc)(CFTypeRef cf);
+} CFRuntimeClass;
+
+#define _kCFRuntimeNotATypeID	0
+
+CFTypeID	_CFRuntimeRegisterClass		(const CFRuntimeClass * const cls);
+
+/*
+ * _CFRuntimeCreateInstance
+ *   returns a new [zeroed] instance; "extraBytes" is the size of the
+ *   object following the CFRuntimeBase.
+ */
+CFTypeRef	_CFRuntimeCreateInstance	(CFAllocatorRef allocator, CFTypeID typeID, CFIndex extraBytes, unsigned char *category);
+
+__END_DECLS
+
+#endif	/* _CF_STANDIN_CFRUNTIME_H */
@@ -0,0 +1,485 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * A CoreFoundation stand-in for building the configd store engine (and
+ * the replay driver) on hosts without CoreFoundation.
+ *
+ * Only the subset of the CF API used by the store engine is provided.
+ * The behavior follows CF where the engine depends on it (reference
+ * counting, CFEqual / CFHash, collection callbacks) and is simplified
+ * elsewhere.  In particular :
+ *
+ *   - strings are stored as UTF-8 and CFStringGetLength() returns the
+ *     # of bytes (dynamic store keys are ASCII),
+ *   - CFSTR() strings are created (and uniqued) on first use,
+ *   - property lists are serialized with a private (not "bplist00")
+ *     binary format,
+ *   - run loops, mach ports, and dates are declared but not supported.
+ */
+
+#ifndef _CF_STANDIN_COREFOUNDATION_H
+#define _CF_STANDIN_COREFOUNDATION_H
+
+#include <sys/cdefs.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+__BEGIN_DECLS
+
+#pragma mark -
+#pragma mark Base types
+
+typedef unsigned char		Boolean;
+typedef uint8_t			UInt8;
+typedef int8_t			SInt8;
+typedef uint16_t		UInt16;
+typedef int16_t			SInt16;
+typedef uint32_t		UInt32;
+typedef int32_t			SInt32;
+typedef uint64_t		UInt64;
+typedef int64_t			SInt64;
+typedef float			Float32;
+typedef double			Float64;
+typedef uint16_t		UniChar;
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+typedef long			CFIndex;
+typedef unsigned long		CFOptionFlags;
+typedef unsigned long		CFHashCode;
+typedef unsigned long		CFTypeID;
+typedef double			CFTimeInterval;
+typedef CFTimeInterval		CFAbsoluteTime;
+typedef UInt32			CFStringEncoding;
+
+typedef const void *		CFTypeRef;
+typedef CFTypeRef		CFPropertyListRef;
+
+typedef const struct __CFAllocator *		CFAllocatorRef;
+typedef const struct __CFString *		CFStringRef;
+typedef struct __CFString *			CFMutableStringRef;
+typedef const struct __CFData *			CFDataRef;
+typedef struct __CFData *			CFMutableDataRef;
+typedef const struct __CFNumber *		CFNumberRef;
+typedef const struct __CFBoolean *		CFBooleanRef;
+typedef const struct __CFNull *			CFNullRef;
+typedef const struct __CFArray *		CFArrayRef;
+typedef struct __CFArray *			CFMutableArrayRef;
+typedef const struct __CFDictionary *		CFDictionaryRef;
+typedef struct __CFDictionary *			CFMutableDictionaryRef;
+typedef const struct __CFSet *			CFSetRef;
+typedef struct __CFSet *			CFMutableSetRef;
+typedef const struct __CFDate *			CFDateRef;
+typedef struct __CFError *			CFErrorRef;
+typedef struct __CFRunLoop *			CFRunLoopRef;
+typedef struct __CFRunLoopSource *		CFRunLoopSourceRef;
+typedef struct __CFRunLoopTimer *		CFRunLoopTimerRef;
+typedef struct __CFMachPort *			CFMachPortRef;
+
+typedef struct {
+	CFIndex		location;
+	CFIndex		length;
+} CFRange;
+
+static __inline__ CFRange
+CFRangeMake(CFIndex loc, CFIndex len)
+{
+	CFRange	range;
+
+	range.location = loc;
+	range.length   = len;
+	return range;
+}
+
+enum {
+	kCFNotFound	= -1
+};
+
+typedef enum {
+	kCFCompareLessThan	= -1L,
+	kCFCompareEqualTo	= 0,
+	kCFCompareGreaterThan	= 1
+} CFComparisonResult;
+
+typedef CFComparisonResult (*CFComparatorFunction)(const void *val1, const void *val2, void *context);
+
+#define CF_RETURNS_RETAINED
+#define CF_RETURNS_NOT_RETAINED
+#define CF_EXPORT		extern
+#define CF_INLINE		static __inline__
+
+#pragma mark -
+#pragma mark CFType
+
+CFTypeRef	CFRetain			(CFTypeRef cf);
+void		CFRelease			(CFTypeRef cf);
+CFIndex		CFGetRetainCount		(CFTypeRef cf);
+CFTypeID	CFGetTypeID			(CFTypeRef cf);
+Boolean		CFEqual				(CFTypeRef cf1, CFTypeRef cf2);
+CFHashCode	CFHash				(CFTypeRef cf);
+CFStringRef	CFCopyDescription		(CFTypeRef cf);
+CFStringRef	CFCopyTypeIDDescription		(CFTypeID type_id);
+CFAllocatorRef	CFGetAllocator			(CFTypeRef cf);
+void		CFShow				(CFTypeRef obj);
+
+#pragma mark -
+#pragma mark CFAllocator
+
+extern const CFAllocatorRef	kCFAllocatorDefault;
+extern const CFAllocatorRef	kCFAllocatorSystemDefault;
+extern const CFAllocatorRef	kCFAllocatorMalloc;
+extern const CFAllocatorRef	kCFAllocatorNull;
+
+void *		CFAllocatorAllocate		(CFAllocatorRef allocator, CFIndex size, CFOptionFlags hint);
+void *		CFAllocatorReallocate		(CFAllocatorRef allocator, void *ptr, CFIndex newsize, CFOptionFlags hint);
+void		CFAllocatorDeallocate		(CFAllocatorRef allocator, void *ptr);
+
+#pragma mark -
+#pragma mark CFNull / CFBoolean
+
+extern const CFNullRef		kCFNull;
+extern const CFBooleanRef	kCFBooleanTrue;
+extern const CFBooleanRef	kCFBooleanFalse;
+
+CFTypeID	CFNullGetTypeID			(void);
+CFTypeID	CFBooleanGetTypeID		(void);
+Boolean		CFBooleanGetValue		(CFBooleanRef boolean);
+
+#pragma mark -
+#pragma mark CFString
+
+typedef enum {
+	kCFStringEncodingMacRoman	= 0,
+	kCFStringEncodingASCII		= 0x0600,
+	kCFStringEncodingUTF8		= 0x08000100,
+	kCFStringEncodingISOLatin1	= 0x0201
+} CFStringBuiltInEncodings;
+
+typedef enum {
+	kCFCompareCaseInsensitive	= 1,
+	kCFCompareBackwards		= 4,
+	kCFCompareAnchored		= 8,
+	kCFCompareNonliteral		= 16,
+	kCFCompareLocalized		= 32,
+	kCFCompareNumerically		= 64
+} CFStringCompareFlags;
+
+CFStringRef	__CFStringMakeConstantString	(const char *cStr);
+#define CFSTR(cStr)	__CFStringMakeConstantString("" cStr "")
+
+CFTypeID	CFStringGetTypeID		(void);
+CFStringRef	CFStringCreateWithCString	(CFAllocatorRef alloc, const char *cStr, CFStringEncoding encoding);
+CFStringRef	CFStringCreateWithCStringNoCopy	(CFAllocatorRef alloc, const char *cStr, CFStringEncoding encoding, CFAllocatorRef contentsDeallocator);
+CFStringRef	CFStringCreateWithBytes		(CFAllocatorRef alloc, const UInt8 *bytes, CFIndex numBytes, CFStringEncoding encoding, Boolean isExternalRepresentation);
+CFStringRef	CFStringCreateWithFormat	(CFAllocatorRef alloc, CFDictionaryRef formatOptions, CFStringRef format, ...);
+CFStringRef	CFStringCreateWithFormatAndArguments
+						(CFAllocatorRef alloc, CFDictionaryRef formatOptions, CFStringRef format, va_list arguments);
+CFStringRef	CFStringCreateWithSubstring	(CFAllocatorRef alloc, CFStringRef str, CFRange range);
+CFStringRef	CFStringCreateCopy		(CFAllocatorRef alloc, CFStringRef theString);
+CFMutableStringRef
+		CFStringCreateMutable		(CFAllocatorRef alloc, CFIndex maxLength);
+CFMutableStringRef
+		CFStringCreateMutableCopy	(CFAllocatorRef alloc, CFIndex maxLength, CFStringRef theString);
+void		CFStringAppend			(CFMutableStringRef theString, CFStringRef appendedString);
+void		CFStringAppendCString		(CFMutableStringRef theString, const char *cStr, CFStringEncoding encoding);
+void		CFStringAppendFormat		(CFMutableStringRef theString, CFDictionaryRef formatOptions, CFStringRef format, ...);
+CFStringRef	CFStringCreateFromExternalRepresentation
+						(CFAllocatorRef alloc, CFDataRef data, CFStringEncoding encoding);
+CFDataRef	CFStringCreateExternalRepresentation
+						(CFAllocatorRef alloc, CFStringRef theString, CFStringEncoding encoding, UInt8 lossByte);
+CFIndex		CFStringGetLength		(CFStringRef theString);
+CFIndex		CFStringGetMaximumSizeForEncoding
+						(CFIndex length, CFStringEncoding encoding);
+Boolean		CFStringGetCString		(CFStringRef theString, char *buffer, CFIndex bufferSize, CFStringEncoding encoding);
+const char *	CFStringGetCStringPtr		(CFStringRef theString, CFStringEncoding encoding);
+CFIndex		CFStringGetBytes		(CFStringRef theString, CFRange range, CFStringEncoding encoding, UInt8 lossByte, Boolean isExternalRepresentation, UInt8 *buffer, CFIndex maxBufLen, CFIndex *usedBufLen);
+UniChar		CFStringGetCharacterAtIndex	(CFStringRef theString, CFIndex idx);
+CFComparisonResult
+		CFStringCompare			(CFStringRef theString1, CFStringRef theString2, CFOptionFlags compareOptions);
+Boolean		CFStringHasPrefix		(CFStringRef theString, CFStringRef prefix);
+Boolean		CFStringHasSuffix		(CFStringRef theString, CFStringRef suffix);
+CFRange		CFStringFind			(CFStringRef theString, CFStringRef stringToFind, CFOptionFlags compareOptions);
+CFArrayRef	CFStringCreateArrayBySeparatingStrings
+						(CFAllocatorRef alloc, CFStringRef theString, CFStringRef separatorString);
+SInt32		CFStringGetIntValue		(CFStringRef str);
+
+#pragma mark -
+#pragma mark CFData
+
+CFTypeID	CFDataGetTypeID			(void);
+CFDataRef	CFDataCreate			(CFAllocatorRef allocator, const UInt8 *bytes, CFIndex length);
+CFDataRef	CFDataCreateWithBytesNoCopy	(CFAllocatorRef allocator, const UInt8 *bytes, CFIndex length, CFAllocatorRef bytesDeallocator);
+CFDataRef	CFDataCreateCopy		(CFAllocatorRef allocator, CFDataRef theData);
+CFMutableDataRef
+		CFDataCreateMutable		(CFAllocatorRef allocator, CFIndex capacity);
+CFMutableDataRef
+		CFDataCreateMutableCopy		(CFAllocatorRef allocator, CFIndex capacity, CFDataRef theData);
+CFIndex		CFDataGetLength			(CFDataRef theData);
+const UInt8 *	CFDataGetBytePtr		(CFDataRef theData);
+UInt8 *		CFDataGetMutableBytePtr		(CFMutableDataRef theData);
+void		CFDataGetBytes			(CFDataRef theData, CFRange range, UInt8 *buffer);
+void		CFDataSetLength			(CFMutableDataRef theData, CFIndex length);
+void		CFDataIncreaseLength		(CFMutableDataRef theData, CFIndex extraLength);
+void		CFDataAppendBytes		(CFMutableDataRef theData, const UInt8 *bytes, CFIndex length);
+
+#pragma mark -
+#pragma mark CFNumber
+
+typedef enum {
+	kCFNumberSInt8Type	= 1,
+	kCFNumberSInt16Type	= 2,
+	kCFNumberSInt32Type	= 3,
+	kCFNumberSInt64Type	= 4,
+	kCFNumberFloat32Type	= 5,
+	kCFNumberFloat64Type	= 6,
+	kCFNumberCharType	= 7,
+	kCFNumberShortType	= 8,
+	kCFNumberIntType	= 9,
+	kCFNumberLongType	= 10,
+	kCFNumberLongLongType	= 11,
+	kCFNumberFloatType	= 12,
+	kCFNumberDoubleType	= 13,
+	kCFNumberCFIndexType	= 14
+} CFNumberType;
+
+CFTypeID	CFNumberGetTypeID		(void);
+CFNumberRef	CFNumberCreate			(CFAllocatorRef allocator, CFNumberType theType, const void *valuePtr);
+Boolean		CFNumberGetValue		(CFNumberRef number, CFNumberType theType, void *valuePtr);
+Boolean		CFNumberIsFloatType		(CFNumberRef number);
+CFComparisonResult
+		CFNumberCompare			(CFNumberRef number, CFNumberRef otherNumber, void *context);
+
+#pragma mark -
+#pragma mark CFDate
+
+CFTypeID	CFDateGetTypeID			(void);
+CFAbsoluteTime	CFAbsoluteTimeGetCurrent	(void);
+
+#pragma mark -
+#pragma mark CFArray
+
+typedef const void *	(*CFArrayRetainCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef void		(*CFArrayReleaseCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef CFStringRef	(*CFArrayCopyDescriptionCallBack)	(const void *value);
+typedef Boolean		(*CFArrayEqualCallBack)			(const void *value1, const void *value2);
+
+typedef struct {
+	CFIndex				version;
+	CFArrayRetainCallBack		retain;
+	CFArrayReleaseCallBack		release;
+	CFArrayCopyDescriptionCallBack	copyDescription;
+	CFArrayEqualCallBack		equal;
+} CFArrayCallBacks;
+
+typedef void (*CFArrayApplierFunction)(const void *value, void *context);
+
+extern const CFArrayCallBacks	kCFTypeArrayCallBacks;
+
+CFTypeID	CFArrayGetTypeID		(void);
+CFArrayRef	CFArrayCreate			(CFAllocatorRef allocator, const void **values, CFIndex numValues, const CFArrayCallBacks *callBacks);
+CFArrayRef	CFArrayCreateCopy		(CFAllocatorRef allocator, CFArrayRef theArray);
+CFMutableArrayRef
+		CFArrayCreateMutable		(CFAllocatorRef allocator, CFIndex capacity, const CFArrayCallBacks *callBacks);
+CFMutableArrayRef
+		CFArrayCreateMutableCopy	(CFAllocatorRef allocator, CFIndex capacity, CFArrayRef theArray);
+CFIndex		CFArrayGetCount			(CFArrayRef theArray);
+const void *	CFArrayGetValueAtIndex		(CFArrayRef theArray, CFIndex idx);
+void		CFArrayGetValues		(CFArrayRef theArray, CFRange range, const void **values);
+Boolean		CFArrayContainsValue		(CFArrayRef theArray, CFRange range, const void *value);
+CFIndex		CFArrayGetFirstIndexOfValue	(CFArrayRef theArray, CFRange range, const void *value);
+void		CFArrayApplyFunction		(CFArrayRef theArray, CFRange range, CFArrayApplierFunction applier, void *context);
+void		CFArrayAppendValue		(CFMutableArrayRef theArray, const void *value);
+void		CFArrayAppendArray		(CFMutableArrayRef theArray, CFArrayRef otherArray, CFRange otherRange);
+void		CFArrayInsertValueAtIndex	(CFMutableArrayRef theArray, CFIndex idx, const void *value);
+void		CFArraySetValueAtIndex		(CFMutableArrayRef theArray, CFIndex idx, const void *value);
+void		CFArrayRemoveValueAtIndex	(CFMutableArrayRef theArray, CFIndex idx);
+void		CFArrayRemoveAllValues		(CFMutableArrayRef theArray);
+void		CFArrayReplaceValues		(CFMutableArrayRef theArray, CFRange range, const void **newValues, CFIndex newCount);
+void		CFArraySortValues		(CFMutableArrayRef theArray, CFRange range, CFComparatorFunction comparator, void *context);
+
+#pragma mark -
+#pragma mark CFDictionary
+
+typedef const void *	(*CFDictionaryRetainCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef void		(*CFDictionaryReleaseCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef CFStringRef	(*CFDictionaryCopyDescriptionCallBack)	(const void *value);
+typedef Boolean		(*CFDictionaryEqualCallBack)		(const void *value1, const void *value2);
+typedef CFHashCode	(*CFDictionaryHashCallBack)		(const void *value);
+
+typedef struct {
+	CFIndex					version;
+	CFDictionaryRetainCallBack		retain;
+	CFDictionaryReleaseCallBack		release;
+	CFDictionaryCopyDescriptionCallBack	copyDescription;
+	CFDictionaryEqualCallBack		equal;
+	CFDictionaryHashCallBack		hash;
+} CFDictionaryKeyCallBacks;
+
+typedef struct {
+	CFIndex					version;
+	CFDictionaryRetainCallBack		retain;
+	CFDictionaryReleaseCallBack		release;
+	CFDictionaryCopyDescriptionCallBack	copyDescription;
+	CFDictionaryEqualCallBack		equal;
+} CFDictionaryValueCallBacks;
+
+typedef void (*CFDictionaryApplierFunction)(const void *key, const void *value, void *context);
+
+extern const CFDictionaryKeyCallBacks	kCFTypeDictionaryKeyCallBacks;
+extern const CFDictionaryKeyCallBacks	kCFCopyStringDictionaryKeyCallBacks;
+extern const CFDictionaryValueCallBacks	kCFTypeDictionaryValueCallBacks;
+
+CFTypeID	CFDictionaryGetTypeID		(void);
+CFDictionaryRef	CFDictionaryCreate		(CFAllocatorRef allocator, const void **keys, const void **values, CFIndex numValues, const CFDictionaryKeyCallBacks *keyCallBacks, const CFDictionaryValueCallBacks *valueCallBacks);
+CFDictionaryRef	CFDictionaryCreateCopy		(CFAllocatorRef allocator, CFDictionaryRef theDict);
+CFMutableDictionaryRef
+		CFDictionaryCreateMutable	(CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryKeyCallBacks *keyCallBacks, const CFDictionaryValueCallBacks *valueCallBacks);
+CFMutableDictionaryRef
+		CFDictionaryCreateMutableCopy	(CFAllocatorRef allocator, CFIndex capacity, CFDictionaryRef theDict);
+CFIndex		CFDictionaryGetCount		(CFDictionaryRef theDict);
+Boolean		CFDictionaryContainsKey		(CFDictionaryRef theDict, const void *key);
+const void *	CFDictionaryGetValue		(CFDictionaryRef theDict, const void *key);
+Boolean		CFDictionaryGetValueIfPresent	(CFDictionaryRef theDict, const void *key, const void **value);
+void		CFDictionaryGetKeysAndValues	(CFDictionaryRef theDict, const void **keys, const void **values);
+void		CFDictionaryApplyFunction	(CFDictionaryRef theDict, CFDictionaryApplierFunction applier, void *context);
+void		CFDictionaryAddValue		(CFMutableDictionaryRef theDict, const void *key, const void *value);
+void		CFDictionarySetValue		(CFMutableDictionaryRef theDict, const void *key, const void *value);
+void		CFDictionaryReplaceValue	(CFMutableDictionaryRef theDict, const void *key, const void *value);
+void		CFDictionaryRemoveValue		(CFMutableDictionaryRef theDict, const void *key);
+void		CFDictionaryRemoveAllValues	(CFMutableDictionaryRef theDict);
+
+#pragma mark -
+#pragma mark CFSet
+
+typedef const void *	(*CFSetRetainCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef void		(*CFSetReleaseCallBack)		(CFAllocatorRef allocator, const void *value);
+typedef CFStringRef	(*CFSetCopyDescriptionCallBack)	(const void *value);
+typedef Boolean		(*CFSetEqualCallBack)		(const void *value1, const void *value2);
+typedef CFHashCode	(*CFSetHashCallBack)		(const void *value);
+
+typedef struct {
+	CFIndex				version;
+	CFSetRetainCallBack		retain;
+	CFSetReleaseCallBack		release;
+	CFSetCopyDescriptionCallBack	copyDescription;
+	CFSetEqualCallBack		equal;
+	CFSetHashCallBack		hash;
+} CFSetCallBacks;
+
+typedef void (*CFSetApplierFunction)(const void *value, void *context);
+
+extern const CFSetCallBacks	kCFTypeSetCallBacks;
+
+CFTypeID	CFSetGetTypeID			(void);
+CFSetRef	CFSetCreate			(CFAllocatorRef allocator, const void **values, CFIndex numValues, const CFSetCallBacks *callBacks);
+CFSetRef	CFSetCreateCopy			(CFAllocatorRef allocator, CFSetRef theSet);
+CFMutableSetRef	CFSetCreateMutable		(CFAllocatorRef allocator, CFIndex capacity, const CFSetCallBacks *callBacks);
+CFMutableSetRef	CFSetCreateMutableCopy		(CFAllocatorRef allocator, CFIndex capacity, CFSetRef theSet);
+CFIndex		CFSetGetCount			(CFSetRef theSet);
+Boolean		CFSetContainsValue		(CFSetRef theSet, const void *value);
+const void *	CFSetGetValue			(CFSetRef theSet, const void *value);
+void		CFSetGetValues			(CFSetRef theSet, const void **values);
+void		CFSetApplyFunction		(CFSetRef theSet, CFSetApplierFunction applier, void *context);
+void		CFSetAddValue			(CFMutableSetRef theSet, const void *value);
+void		CFSetSetValue			(CFMutableSetRef theSet, const void *value);
+void		CFSetRemoveValue		(CFMutableSetRef theSet, const void *value);
+void		CFSetRemoveAllValues		(CFMutableSetRef theSet);
+
+#pragma mark -
+#pragma mark CFPropertyList
+
+typedef enum {
+	kCFPropertyListImmutable			= 0,
+	kCFPropertyListMutableContainers		= 1,
+	kCFPropertyListMutableContainersAndLeaves	= 2
+} CFPropertyListMutabilityOptions;
+
+typedef enum {
+	kCFPropertyListOpenStepFormat	= 1,
+	kCFPropertyListXMLFormat_v1_0	= 100,
+	kCFPropertyListBinaryFormat_v1_0	= 200
+} CFPropertyListFormat;
+
+CFDataRef	CFPropertyListCreateData	(CFAllocatorRef allocator, CFPropertyListRef propertyList, CFPropertyListFormat format, CFOptionFlags options, CFErrorRef *error);
+CFPropertyListRef
+		CFPropertyListCreateWithData	(CFAllocatorRef allocator, CFDataRef data, CFOptionFlags options, CFPropertyListFormat *format, CFErrorRef *error);
+CFPropertyListRef
+		CFPropertyListCreateDeepCopy	(CFAllocatorRef allocator, CFPropertyListRef propertyList, CFOptionFlags mutabilityOption);
+
+#pragma mark -
+#pragma mark CFRunLoop / CFMachPort (not supported)
+
+typedef void (*CFRunLoopTimerCallBack)(CFRunLoopTimerRef timer, void *info);
+typedef void (*CFMachPortCallBack)(CFMachPortRef port, void *msg, CFIndex size, void *info);
+
+typedef struct {
+	CFIndex		version;
+	void *		info;
+	const void *	(*retain)(const void *info);
+	void		(*release)(const void *info);
+	CFStringRef	(*copyDescription)(const void *info);
+} CFRunLoopTimerContext, CFMachPortContext;
+
+extern const CFStringRef	kCFRunLoopDefaultMode;
+extern const CFStringRef	kCFRunLoopCommonModes;
+
+CFRunLoopRef	CFRunLoopGetCurrent		(void);
+void		CFRunLoopAddSource		(CFRunLoopRef rl, CFRunLoopSourceRef source, CFStringRef mode);
+void		CFRunLoopSourceInvalidate	(CFRunLoopSourceRef source);
+CFRunLoopTimerRef
+		CFRunLoopTimerCreate		(CFAllocatorRef allocator, CFAbsoluteTime fireDate, CFTimeInterval interval, CFOptionFlags flags, CFIndex order, CFRunLoopTimerCallBack callout, CFRunLoopTimerContext *context);
+void		CFRunLoopAddTimer		(CFRunLoopRef rl, CFRunLoopTimerRef timer, CFStringRef mode);
+void		CFRunLoopTimerInvalidate	(CFRunLoopTimerRef timer);
+CFAbsoluteTime	CFRunLoopTimerGetNextFireDate	(CFRunLoopTimerRef timer);
+void		CFRunLoopTimerSetNextFireDate	(CFRunLoopTimerRef timer, CFAbsoluteTime fireDate);
+CFRunLoopSourceRef
+		CFMachPortCreateRunLoopSource	(CFAllocatorRef allocator, CFMachPortRef port, CFIndex order);
+void		CFMachPortInvalidate		(CFMachPortRef port);
+
+#pragma mark -
+#pragma mark Stand-in statistics
+
+/*
+ * __CFStandInGetObjectCount
+ *   returns the # of live CF objects (and the # ever created).
+ */
+void		__CFStandInGetObjectCount	(uint64_t *live, uint64_t *created);
+
+__END_DECLS
+
+#endif	/* _CF_STANDIN_COREFOUNDATION_H */
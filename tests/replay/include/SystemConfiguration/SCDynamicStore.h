@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * SCDynamicStore.h stand-in : the SCDynamicStore types referenced by the
+ * configd store engine sources.
+ */
+
+#ifndef _SCDYNAMICSTORE_STANDIN_H
+#define _SCDYNAMICSTORE_STANDIN_H
+
+#include <sys/cdefs.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+typedef const struct __SCDynamicStore *	SCDynamicStoreRef;
+
+typedef struct {
+	CFIndex		version;
+	void *		info;
+	const void	*(*retain)(const void *info);
+	void		(*release)(const void *info);
+	CFStringRef	(*copyDescription)(const void *info);
+} SCDynamicStoreContext;
+
+typedef void (*SCDynamicStoreCallBack)	(SCDynamicStoreRef	store,
+					 CFArrayRef		changedKeys,
+					 void			*info);
+
+typedef void (*SCDynamicStoreDisconnectCallBack)	(SCDynamicStoreRef	store,
+							 void			*info);
+
+/*
+ * session options (CFSTR() strings are not compile-time constants in the
+ * CoreFoundation stand-in so these are macros rather than globals)
+ */
+#define	kSCDynamicStoreUseSessionKeys		CFSTR("UseSessionKeys")		/* CFBoolean */
+#define	kSCDynamicStoreNotificationValues	CFSTR("NotificationValues")	/* CFBoolean */
+#define	kSCDynamicStoreNotificationRing		CFSTR("NotificationRing")	/* CFBoolean */
+
+#endif	/* _SCDYNAMICSTORE_STANDIN_H */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * SCPrivate.h stand-in : the SystemConfiguration SPI referenced by the
+ * configd store engine sources (see replay_transport.c).
+ */
+
+#ifndef _SCPRIVATE_STANDIN_H
+#define _SCPRIVATE_STANDIN_H
+
+#include <stdio.h>
+#include <syslog.h>
+#include <sys/cdefs.h>
+#include <CoreFoundation/CoreFoundation.h>
+#include <SystemConfiguration/SystemConfiguration.h>
+
+__BEGIN_DECLS
+
+extern int	_sc_verbose;
+extern int	_sc_log;
+
+void		SCLog				(Boolean		condition,
+						 int			level,
+						 CFStringRef		formatString,
+						 ...);
+
+void		_SCErrorSet			(int			error);
+
+Boolean		_SCSerialize			(CFPropertyListRef	obj,
+						 CFDataRef		*xml,
+						 void			**dataRef,
+						 CFIndex		*dataLen);
+
+Boolean		_SCUnserialize			(CFPropertyListRef	*obj,
+						 CFDataRef		xml,
+						 void			*dataRef,
+						 CFIndex		dataLen);
+
+Boolean		_SCSerializeString		(CFStringRef		str,
+						 CFDataRef		*data,
+						 void			**dataRef,
+						 CFIndex		*dataLen);
+
+Boolean		_SCUnserializeString		(CFStringRef		*str,
+						 CFDataRef		utf8,
+						 void			*dataRef,
+						 CFIndex		dataLen);
+
+Boolean		_SCSerializeData		(CFDataRef		data,
+						 void			**dataRef,
+						 CFIndex		*dataLen);
+
+Boolean		_SCUnserializeData		(CFDataRef		*data,
+						 void			*dataRef,
+						 CFIndex		dataLen);
+
+char *		_SC_cfstring_to_cstring		(CFStringRef		cfstr,
+						 char			*buf,
+						 CFIndex		bufLen,
+						 CFStringEncoding	encoding);
+
+static __inline__ Boolean
+_SC_CFEqual(CFTypeRef val1, CFTypeRef val2)
+{
+	if (val1 == val2) {
+	    return TRUE;
+	}
+	if (val1 != NULL && val2 != NULL) {
+		return CFEqual(val1, val2);
+	}
+	return FALSE;
+}
+
+#define __MACH_PORT_DEBUG(cond, str, port)
+
+__END_DECLS
+
+#endif	/* _SCPRIVATE_STANDIN_H */
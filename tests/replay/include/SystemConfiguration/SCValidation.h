@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * SCValidation.h stand-in
+ */
+
+#ifndef _SCVALIDATION_STANDIN_H
+#define _SCVALIDATION_STANDIN_H
+
+#include <CoreFoundation/CoreFoundation.h>
+
+static __inline__ CFTypeRef
+isA_CFType(CFTypeRef obj, CFTypeID type)
+{
+	if (obj == NULL)
+		return (NULL);
+
+	if (CFGetTypeID(obj) != type)
+		return (NULL);
+
+	return (obj);
+}
+
+static __inline__ CFTypeRef
+isA_CFArray(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFArrayGetTypeID()));
+}
+
+static __inline__ CFTypeRef
+isA_CFBoolean(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFBooleanGetTypeID()));
+}
+
+static __inline__ CFTypeRef
+isA_CFData(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFDataGetTypeID()));
+}
+
+static __inline__ CFTypeRef
+isA_CFDictionary(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFDictionaryGetTypeID()));
+}
+
+static __inline__ CFTypeRef
+isA_CFNumber(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFNumberGetTypeID()));
+}
+
+static __inline__ CFTypeRef
+isA_CFString(CFTypeRef obj)
+{
+	return (isA_CFType(obj, CFStringGetTypeID()));
+}
+
+#endif	/* _SCVALIDATION_STANDIN_H */
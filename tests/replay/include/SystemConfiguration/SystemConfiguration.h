@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * SystemConfiguration.h stand-in : the status codes and types referenced
+ * by the configd store engine sources.
+ */
+
+#ifndef _SYSTEMCONFIGURATION_STANDIN_H
+#define _SYSTEMCONFIGURATION_STANDIN_H
+
+#include <sys/cdefs.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+enum {
+	kSCStatusOK				= 0,
+	kSCStatusFailed				= 1001,
+	kSCStatusInvalidArgument		= 1002,
+	kSCStatusAccessError			= 1003,
+	kSCStatusNoKey				= 1004,
+	kSCStatusKeyExists			= 1005,
+	kSCStatusLocked				= 1006,
+	kSCStatusNeedLock			= 1007,
+	kSCStatusNoStoreSession			= 2001,
+	kSCStatusNoStoreServer			= 2002,
+	kSCStatusNotifierActive			= 2003,
+	kSCStatusLimitExceeded			= 2004,
+	kSCStatusNoPrefsSession			= 3001,
+	kSCStatusPrefsBusy			= 3002,
+	kSCStatusNoConfigFile			= 3003,
+	kSCStatusNoLink				= 3004,
+	kSCStatusStale				= 3005,
+	kSCStatusMaxLink			= 3006
+};
+
+#include <SystemConfiguration/SCDynamicStore.h>
+
+__BEGIN_DECLS
+
+const char *	SCErrorString	(int	status);
+
+__END_DECLS
+
+#endif	/* _SYSTEMCONFIGURATION_STANDIN_H */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * bsm/libbsm.h stand-in
+ */
+
+#ifndef _BSM_STANDIN_LIBBSM_H
+#define _BSM_STANDIN_LIBBSM_H
+
+#include <sys/types.h>
+#include <mach/mach.h>
+
+static __inline__ pid_t
+audit_token_to_pid(audit_token_t atoken)
+{
+	return (pid_t)atoken.val[5];
+}
+
+static __inline__ uid_t
+audit_token_to_euid(audit_token_t atoken)
+{
+	return (uid_t)atoken.val[1];
+}
+
+#endif	/* _BSM_STANDIN_LIBBSM_H */
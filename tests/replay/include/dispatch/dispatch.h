@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * dispatch stand-in : just the types referenced by the configd store
+ * engine sources.
+ */
+
+#ifndef _DISPATCH_STANDIN_DISPATCH_H
+#define _DISPATCH_STANDIN_DISPATCH_H
+
+typedef struct dispatch_group_s		*dispatch_group_t;
+typedef struct dispatch_queue_s		*dispatch_queue_t;
+typedef struct dispatch_source_s	*dispatch_source_t;
+
+#endif	/* _DISPATCH_STANDIN_DISPATCH_H */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * libkern/OSAtomic.h stand-in
+ */
+
+#ifndef _OSATOMIC_STANDIN_H
+#define _OSATOMIC_STANDIN_H
+
+#include <stdint.h>
+
+static __inline__ void
+OSMemoryBarrier(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static __inline__ int32_t
+OSAtomicAdd32Barrier(int32_t amount, volatile int32_t *value)
+{
+	return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST);
+}
+
+static __inline__ int32_t
+OSAtomicIncrement32Barrier(volatile int32_t *value)
+{
+	return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static __inline__ int32_t
+OSAtomicDecrement32Barrier(volatile int32_t *value)
+{
+	return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static __inline__ int64_t
+OSAtomicAdd64(int64_t amount, volatile int64_t *value)
+{
+	return __atomic_add_fetch(value, amount, __ATOMIC_RELAXED);
+}
+
+static __inline__ int64_t
+OSAtomicIncrement64(volatile int64_t *value)
+{
+	return __atomic_add_fetch(value, 1, __ATOMIC_RELAXED);
+}
+
+static __inline__ int
+OSAtomicCompareAndSwap64Barrier(int64_t oldValue, int64_t newValue, volatile int64_t *value)
+{
+	return __atomic_compare_exchange_n(value, &oldValue, newValue, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif	/* _OSATOMIC_STANDIN_H */
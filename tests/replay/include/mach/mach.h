@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * mach stand-in : just the types (and the few calls) referenced by the
+ * configd store engine sources.  See replay_transport.c.
+ */
+
+#ifndef _MACH_STANDIN_MACH_H
+#define _MACH_STANDIN_MACH_H
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+#include <stdint.h>
+
+__BEGIN_DECLS
+
+typedef unsigned int		natural_t;
+typedef int			integer_t;
+typedef int			boolean_t;
+typedef int			kern_return_t;
+typedef natural_t		mach_port_t;
+typedef natural_t		mach_port_name_t;
+typedef natural_t		mach_port_right_t;
+typedef natural_t		mach_port_type_t;
+typedef integer_t		mach_port_delta_t;
+typedef mach_port_t		task_t;
+typedef mach_port_t		ipc_space_t;
+typedef natural_t		mach_msg_type_number_t;
+typedef natural_t		mach_msg_type_name_t;
+typedef natural_t		mach_msg_size_t;
+typedef natural_t		mach_msg_bits_t;
+typedef integer_t		mach_msg_id_t;
+typedef natural_t		mach_msg_msgid_t;
+typedef uintptr_t		vm_address_t;
+typedef uintptr_t		vm_size_t;
+typedef uintptr_t		vm_offset_t;
+
+typedef struct {
+	unsigned int	val[8];
+} audit_token_t;
+
+typedef struct {
+	mach_msg_bits_t		msgh_bits;
+	mach_msg_size_t		msgh_size;
+	mach_port_t		msgh_remote_port;
+	mach_port_t		msgh_local_port;
+	mach_port_name_t	msgh_voucher_port;
+	mach_msg_id_t		msgh_id;
+} mach_msg_header_t;
+
+typedef struct {
+	mach_msg_size_t		msgh_descriptor_count;
+} mach_msg_body_t;
+
+typedef struct {
+	void			*address;
+	unsigned int		deallocate : 8;
+	unsigned int		copy : 8;
+	unsigned int		pad1 : 8;
+	unsigned int		type : 8;
+	mach_msg_size_t		size;
+} mach_msg_ool_descriptor_t;
+
+#define	NSEC_PER_USEC			1000ull
+#define	USEC_PER_SEC			1000000ull
+#define	NSEC_PER_SEC			1000000000ull
+
+#define	KERN_SUCCESS			0
+#define	KERN_INVALID_ARGUMENT		4
+#define	KERN_FAILURE			5
+#define	KERN_RESOURCE_SHORTAGE		6
+
+#define	MACH_PORT_NULL			((mach_port_t)0)
+#define	TASK_NULL			((task_t)0)
+
+#define	MACH_PORT_RIGHT_SEND		((mach_port_right_t)0)
+#define	MACH_PORT_RIGHT_RECEIVE		((mach_port_right_t)1)
+#define	MACH_PORT_RIGHT_SEND_ONCE	((mach_port_right_t)2)
+
+#define	MACH_MSG_TYPE_MOVE_SEND		17
+#define	MACH_MSG_TYPE_MOVE_SEND_ONCE	18
+#define	MACH_MSG_TYPE_COPY_SEND		19
+#define	MACH_MSG_TYPE_MAKE_SEND		20
+#define	MACH_MSG_TYPE_MAKE_SEND_ONCE	21
+
+#define	MACH_NOTIFY_FIRST		0100
+#define	MACH_NOTIFY_PORT_DELETED	(MACH_NOTIFY_FIRST + 001)
+#define	MACH_NOTIFY_NO_SENDERS		(MACH_NOTIFY_FIRST + 006)
+#define	MACH_NOTIFY_DEAD_NAME		(MACH_NOTIFY_FIRST + 010)
+
+mach_port_t	mach_task_self			(void);
+
+kern_return_t	mach_port_deallocate		(ipc_space_t		task,
+						 mach_port_name_t	name);
+
+kern_return_t	mach_port_mod_refs		(ipc_space_t		task,
+						 mach_port_name_t	name,
+						 mach_port_right_t	right,
+						 mach_port_delta_t	delta);
+
+kern_return_t	mach_port_type			(ipc_space_t		task,
+						 mach_port_name_t	name,
+						 mach_port_type_t	*ptype);
+
+kern_return_t	mach_port_request_notification	(ipc_space_t		task,
+						 mach_port_name_t	name,
+						 integer_t		msgid,
+						 mach_port_name_t	sync,
+						 mach_port_t		notify,
+						 mach_msg_type_name_t	notifyPoly,
+						 mach_port_t		*previous);
+
+kern_return_t	vm_deallocate			(vm_address_t		task,
+						 vm_address_t		address,
+						 vm_size_t		size);
+
+const char *	mach_error_string		(kern_return_t		error_value);
+
+__END_DECLS
+
+#endif	/* _MACH_STANDIN_MACH_H */
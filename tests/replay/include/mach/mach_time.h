@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * mach/mach_time.h stand-in (mach_absolute_time() units are nsecs)
+ */
+
+#ifndef _MACH_TIME_STANDIN_H
+#define _MACH_TIME_STANDIN_H
+
+#include <stdint.h>
+#include <time.h>
+#include <mach/mach.h>
+
+typedef struct {
+	uint32_t	numer;
+	uint32_t	denom;
+} mach_timebase_info_data_t;
+
+typedef mach_timebase_info_data_t	*mach_timebase_info_t;
+
+static __inline__ uint64_t
+mach_absolute_time(void)
+{
+	struct timespec	ts;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * NSEC_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+static __inline__ kern_return_t
+mach_timebase_info(mach_timebase_info_t info)
+{
+	info->numer = 1;
+	info->denom = 1;
+	return KERN_SUCCESS;
+}
+
+#endif	/* _MACH_TIME_STANDIN_H */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * BSD libc extensions used by the configd sources (included ahead of
+ * every source file, see Makefile).
+ */
+
+#ifndef _REPLAY_COMPAT_H
+#define _REPLAY_COMPAT_H
+
+#include <stdlib.h>
+
+#ifndef	__APPLE__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define	__private_extern__	__attribute__((visibility("hidden")))
+
+static __inline__ void *
+reallocf(void *ptr, size_t size)
+{
+	void	*nptr;
+
+	nptr = realloc(ptr, size);
+	if ((nptr == NULL) && (ptr != NULL) && (size != 0)) {
+		free(ptr);
+	}
+	return nptr;
+}
+
+#if	!defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+static __inline__ size_t
+strlcpy(char *dst, const char *src, size_t size)
+{
+	size_t	len	= strlen(src);
+
+	if (size > 0) {
+		size_t	n	= (len < size) ? len : size - 1;
+
+		memcpy(dst, src, n);
+		dst[n] = '\0';
+	}
+	return len;
+}
+#endif	/* !__GLIBC_PREREQ(2, 38) */
+
+static __inline__ int
+pthread_threadid_np(pthread_t thread, uint64_t *thread_id)
+{
+	(void) thread;		/* only the calling thread is supported */
+	*thread_id = (uint64_t)syscall(SYS_gettid);
+	return 0;
+}
+
+#endif	/* !__APPLE__ */
+
+#endif	/* _REPLAY_COMPAT_H */
@@ -0,0 +1,1089 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * replay
+ *
+ * Drives the configd store engine, in-process, from a recorded trace of
+ * requests and reports the # of operations / second, the per-operation
+ * latency percentiles, and the peak memory used.  The engine sources are
+ * built unmodified (see Makefile); on hosts without CoreFoundation, the
+ * stand-in in this directory is used.
+ *
+ *   replay [-F] [-T KB] [-v] <trace>
+ *
+ *     -F	do not fetch the changed keys when a session is notified
+ *     -T	trace the requests, as with "configd -T" (to measure the
+ *		cost of tracing)
+ *     -v	report requests that did not succeed
+ *
+ * The trace is either a store mutation journal (see journal_format.h and
+ * "configd -J") or a text file with one request per line :
+ *
+ *   open <sid> <name> [sessionkeys]	open a session
+ *   close <sid>				close a session
+ *   set <sid> <key> <value>		SCDynamicStoreSetValue
+ *   add <sid> <key> <value>		SCDynamicStoreAddValue
+ *   remove <sid> <key>			SCDynamicStoreRemoveValue
+ *   notify <sid> <key>			SCDynamicStoreNotifyValue
+ *   get <sid> <key>			SCDynamicStoreCopyValue
+ *   getm <sid> <key> ... re:<pattern> ...	SCDynamicStoreCopyMultiple
+ *   list <sid> <prefix>			SCDynamicStoreCopyKeyList
+ *   listre <sid> <pattern>		SCDynamicStoreCopyKeyList (regex)
+ *   watch <sid> <key>			SCDynamicStoreAddWatchedKey
+ *   watchre <sid> <pattern>		SCDynamicStoreAddWatchedKey (regex)
+ *   unwatch <sid> <key>			SCDynamicStoreRemoveWatchedKey
+ *   unwatchre <sid> <pattern>		SCDynamicStoreRemoveWatchedKey (regex)
+ *   changes <sid>			SCDynamicStoreCopyNotifiedKeys
+ *   repeat <n> ... end			repeat the enclosed requests <n> times
+ *   # ...				a comment
+ *
+ * Session ids (<sid>) are non-zero integers.  Within a "repeat" block,
+ * "$i" (or "${i}") is replaced with the iteration # (starting at 0) of
+ * the innermost block, "$j" and "$k" with that of the enclosing blocks,
+ * and "${i%<n>}" with the iteration # modulo <n>.
+ *
+ * A <value> is written without spaces :
+ *
+ *   #<number>			a CFNumber (e.g. "#42", "#0.5")
+ *   @<n>				a CFData of <n> bytes
+ *   true, false			a CFBoolean
+ *   [<value>;...]		a CFArray
+ *   {<key>=<value>;...}		a CFDictionary
+ *   anything else		a CFString
+ *
+ * After each request, the sessions watching a changed key are notified
+ * and (unless -F) fetch their changed keys, just as an SCDynamicStore
+ * client would.  The time spent doing so is reported as "push".
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "configd.h"
+#include "session.h"
+#include "journal_format.h"
+#include "trace.h"
+#include "replay.h"
+
+#define	MAX_TOKENS	256
+#define	MAX_DEPTH	8
+#define	LINE_MAX_LEN	8192
+
+
+#pragma mark -
+#pragma mark Statistics
+
+
+typedef enum {
+	opOpen = 0,
+	opClose,
+	opSet,
+	opAdd,
+	opRemove,
+	opNotify,
+	opGet,
+	opGetMultiple,
+	opList,
+	opWatch,
+	opUnwatch,
+	opChanges,
+	opPush,
+	opCount
+} replayOp;
+
+static const char	*opNames[opCount]	= {
+	"open",
+	"close",
+	"set",
+	"add",
+	"remove",
+	"notify",
+	"get",
+	"getm",
+	"list",
+	"watch",
+	"unwatch",
+	"changes",
+	"push",
+};
+
+typedef struct {
+	uint64_t	*samples;	/* latency (nsecs) */
+	size_t		n;
+	size_t		max;
+	uint64_t	failed;		/* # of requests with status != kSCStatusOK */
+	uint64_t	total;		/* nsecs */
+} opStats;
+
+static opStats		stats[opCount];
+static uint64_t		nRequests		= 0;
+static uint64_t		nNotified		= 0;
+static uint64_t		nSkipped		= 0;
+static Boolean		fetchChanges		= TRUE;
+static Boolean		verbose			= FALSE;
+
+
+static uint64_t
+now_ns(void)
+{
+	struct timespec	ts;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * NSEC_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void
+addSample(replayOp op, uint64_t elapsed, int status)
+{
+	opStats	*s	= &stats[op];
+
+	if (s->n == s->max) {
+		s->max = (s->max == 0) ? 1024 : (s->max * 2);
+		s->samples = reallocf(s->samples, s->max * sizeof(uint64_t));
+		if (s->samples == NULL) {
+			fprintf(stderr, "replay: out of memory\n");
+			exit(1);
+		}
+	}
+	s->samples[s->n++] = elapsed;
+	s->total += elapsed;
+	if (status != kSCStatusOK) {
+		s->failed++;
+	}
+	return;
+}
+
+
+static int
+compareSamples(const void *p1, const void *p2)
+{
+	uint64_t	v1	= *(const uint64_t *)p1;
+	uint64_t	v2	= *(const uint64_t *)p2;
+
+	return (v1 < v2) ? -1 : ((v1 > v2) ? 1 : 0);
+}
+
+
+static double
+percentile(const opStats *s, double pct)
+{
+	size_t	i;
+
+	i = (size_t)(((double)(s->n - 1) * pct / 100.0) + 0.5);
+	return (double)s->samples[i] / 1000.0;
+}
+
+
+static void
+report(uint64_t wall)
+{
+	uint64_t	created;
+	uint64_t	engine		= 0;
+	uint64_t	live;
+	int		op;
+	uint64_t	ops		= 0;
+	struct rusage	usage;
+	long		peakKB;
+
+	printf("%-10s %10s %8s %10s %10s %10s %10s %10s\n",
+	       "op", "count", "failed", "mean(us)", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+	for (op = 0; op < opCount; op++) {
+		opStats	*s	= &stats[op];
+
+		if (s->n == 0) {
+			continue;
+		}
+
+		qsort(s->samples, s->n, sizeof(uint64_t), compareSamples);
+		printf("%-10s %10zu %8llu %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+		       opNames[op],
+		       s->n,
+		       (unsigned long long)s->failed,
+		       (double)s->total / (double)s->n / 1000.0,
+		       percentile(s, 50.0),
+		       percentile(s, 90.0),
+		       percentile(s, 99.0),
+		       (double)s->samples[s->n - 1] / 1000.0);
+
+		engine += s->total;
+		if (op != opPush) {
+			ops += s->n;
+		}
+	}
+	printf("\n");
+
+	printf("requests      : %llu (%llu skipped)\n",
+	       (unsigned long long)nRequests,
+	       (unsigned long long)nSkipped);
+	printf("notifications : %llu\n", (unsigned long long)nNotified);
+	printf("engine time   : %.3f s, %.0f ops/sec\n",
+	       (double)engine / NSEC_PER_SEC,
+	       (engine > 0) ? (double)ops * NSEC_PER_SEC / (double)engine : 0.0);
+	printf("wall time     : %.3f s, %.0f ops/sec\n",
+	       (double)wall / NSEC_PER_SEC,
+	       (wall > 0) ? (double)ops * NSEC_PER_SEC / (double)wall : 0.0);
+
+	(void) getrusage(RUSAGE_SELF, &usage);
+#ifdef	__APPLE__
+	peakKB = usage.ru_maxrss / 1024;	/* bytes */
+#else	// __APPLE__
+	peakKB = usage.ru_maxrss;		/* kilobytes */
+#endif	// __APPLE__
+	printf("peak memory   : %ld KB\n", peakKB);
+
+	__CFStandInGetObjectCount(&live, &created);
+	printf("CF objects    : %llu live, %llu created\n",
+	       (unsigned long long)live,
+	       (unsigned long long)created);
+
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Requests
+
+
+static serverSessionRef
+lookupSession(mach_port_t id, Boolean create)
+{
+	serverSessionRef	mySession;
+
+	mySession = getSession(id);
+	if ((mySession == NULL) && create) {
+		CFStringRef	name;
+
+		/* a session opened before the trace started */
+		name = CFStringCreateWithFormat(NULL, NULL, CFSTR("session-%u"), id);
+		mySession = replaySessionOpen(id, name, FALSE);
+		CFRelease(name);
+	}
+
+	return mySession;
+}
+
+
+static void
+pushChanges(void)
+{
+	CFIndex		n;
+	uint64_t	t;
+
+	if (needsNotification == NULL) {
+		return;
+	}
+
+	t = now_ns();
+	n = replayPushNotifications(fetchChanges);
+	addSample(opPush, now_ns() - t, kSCStatusOK);
+	nNotified += n;
+	return;
+}
+
+
+static void
+requestDone(replayOp op, uint64_t start, int status, const char *what)
+{
+	addSample(op, now_ns() - start, status);
+	nRequests++;
+	if ((status != kSCStatusOK) && verbose) {
+		fprintf(stderr, "%s %s : %s\n", opNames[op], what, SCErrorString(status));
+	}
+	pushChanges();
+	return;
+}
+
+
+static int
+doOpen(mach_port_t id, CFStringRef name, Boolean useSessionKeys)
+{
+	uint64_t	t;
+
+	t = now_ns();
+	if (replaySessionOpen(id, name, useSessionKeys) == NULL) {
+		return kSCStatusFailed;
+	}
+	addSample(opOpen, now_ns() - t, kSCStatusOK);
+	nRequests++;
+	return kSCStatusOK;
+}
+
+
+static int
+doClose(mach_port_t id)
+{
+	uint64_t	t;
+
+	if (getSession(id) == NULL) {
+		return kSCStatusNoStoreSession;
+	}
+
+	t = now_ns();
+	replaySessionClose(id);
+	requestDone(opClose, t, kSCStatusOK, "");
+	return kSCStatusOK;
+}
+
+
+static int
+doRequest(replayOp op, serverSessionRef mySession, CFStringRef key, CFDataRef data, Boolean isRegex)
+{
+	CFTypeRef	result	= NULL;
+	int		status;
+	uint64_t	t;
+
+	t = now_ns();
+	switch (op) {
+		case opSet :
+			status = __SCDynamicStoreSetValue(mySession->store, key, data, FALSE);
+			break;
+		case opAdd :
+			status = __SCDynamicStoreAddValue(mySession->store, key, data);
+			break;
+		case opRemove :
+			status = __SCDynamicStoreRemoveValue(mySession->store, key, FALSE);
+			break;
+		case opNotify :
+			status = __SCDynamicStoreNotifyValue(mySession->store, key, FALSE);
+			break;
+		case opGet :
+			status = __SCDynamicStoreCopyValue(mySession->store, key, (CFDataRef *)&result, FALSE);
+			break;
+		case opList :
+			status = __SCDynamicStoreCopyKeyList(mySession->store, key, isRegex, (CFArrayRef *)&result);
+			break;
+		case opWatch :
+			status = __SCDynamicStoreAddWatchedKey(mySession->store, key, isRegex, FALSE);
+			break;
+		case opUnwatch :
+			status = __SCDynamicStoreRemoveWatchedKey(mySession->store, key, isRegex, FALSE);
+			break;
+		case opChanges :
+			status = __SCDynamicStoreCopyNotifiedKeys(mySession->store, (CFArrayRef *)&result);
+			break;
+		default :
+			status = kSCStatusInvalidArgument;
+			break;
+	}
+	if ((status == kSCStatusOK) && (result != NULL)) {
+		CFRelease(result);
+	}
+
+	if (verbose && (status != kSCStatusOK)) {
+		char	buf[256];
+
+		(void) _SC_cfstring_to_cstring(key, buf, sizeof(buf), kCFStringEncodingUTF8);
+		requestDone(op, t, status, buf);
+	} else {
+		requestDone(op, t, status, "");
+	}
+	return status;
+}
+
+
+static int
+doGetMultiple(serverSessionRef mySession, CFArrayRef keys, CFArrayRef patterns)
+{
+	CFDictionaryRef	dict	= NULL;
+	int		status;
+	uint64_t	t;
+
+	t = now_ns();
+	status = __SCDynamicStoreCopyMultiple(mySession->store, keys, patterns, &dict);
+	if ((status == kSCStatusOK) && (dict != NULL)) {
+		CFRelease(dict);
+	}
+	requestDone(opGetMultiple, t, status, "");
+	return status;
+}
+
+
+#pragma mark -
+#pragma mark Text traces
+
+
+static CFPropertyListRef	parseValue	(const char **p);
+
+
+static CFStringRef
+parseString(const char **p, const char *stop)
+{
+	const char	*s	= *p;
+
+	while ((**p != '\0') && (strchr(stop, **p) == NULL)) {
+		(*p)++;
+	}
+	return CFStringCreateWithBytes(NULL, (const UInt8 *)s, *p - s, kCFStringEncodingUTF8, FALSE);
+}
+
+
+static CFPropertyListRef
+parseValue(const char **p)
+{
+	const char	*s	= *p;
+
+	if (*s == '{') {
+		CFMutableDictionaryRef	dict;
+
+		dict = CFDictionaryCreateMutable(NULL,
+						 0,
+						 &kCFTypeDictionaryKeyCallBacks,
+						 &kCFTypeDictionaryValueCallBacks);
+		(*p)++;
+		while ((**p != '\0') && (**p != '}')) {
+			CFStringRef		key;
+			CFPropertyListRef	val;
+
+			key = parseString(p, "=;}");
+			if (**p == '=') {
+				(*p)++;
+				val = parseValue(p);
+			} else {
+				val = CFRetain(kCFBooleanTrue);
+			}
+			CFDictionarySetValue(dict, key, val);
+			CFRelease(key);
+			CFRelease(val);
+			if (**p == ';') {
+				(*p)++;
+			}
+		}
+		if (**p == '}') {
+			(*p)++;
+		}
+		return dict;
+	}
+
+	if (*s == '[') {
+		CFMutableArrayRef	array;
+
+		array = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+		(*p)++;
+		while ((**p != '\0') && (**p != ']')) {
+			CFPropertyListRef	val;
+
+			val = parseValue(p);
+			CFArrayAppendValue(array, val);
+			CFRelease(val);
+			if (**p == ';') {
+				(*p)++;
+			}
+		}
+		if (**p == ']') {
+			(*p)++;
+		}
+		return array;
+	}
+
+	if (*s == '#') {
+		char	*end;
+		double	d;
+		long long	ll;
+
+		ll = strtoll(s + 1, &end, 0);
+		if ((*end == '.') || (*end == 'e') || (*end == 'E')) {
+			d = strtod(s + 1, &end);
+			*p = end;
+			return CFNumberCreate(NULL, kCFNumberDoubleType, &d);
+		}
+		*p = end;
+		return CFNumberCreate(NULL, kCFNumberLongLongType, &ll);
+	}
+
+	if (*s == '@') {
+		CFMutableDataRef	data;
+		char			*end;
+		long			i;
+		long			len;
+		UInt8			*bytes;
+
+		len = strtol(s + 1, &end, 0);
+		if (len < 0) {
+			len = 0;
+		}
+		*p = end;
+		data = CFDataCreateMutable(NULL, len);
+		CFDataSetLength(data, len);
+		bytes = CFDataGetMutableBytePtr(data);
+		for (i = 0; i < len; i++) {
+			bytes[i] = (UInt8)i;
+		}
+		return data;
+	}
+
+	if ((strncmp(s, "true", 4) == 0) && (strchr(";]}", s[4]) != NULL)) {
+		*p = s + 4;
+		return CFRetain(kCFBooleanTrue);
+	}
+
+	if ((strncmp(s, "false", 5) == 0) && (strchr(";]}", s[5]) != NULL)) {
+		*p = s + 5;
+		return CFRetain(kCFBooleanFalse);
+	}
+
+	return parseString(p, ";]}");
+}
+
+
+static CFDataRef
+createSerializedValue(const char *str)
+{
+	CFDataRef		data	= NULL;
+	CFPropertyListRef	value;
+
+	value = parseValue(&str);
+	(void) _SCSerialize(value, &data, NULL, NULL);
+	CFRelease(value);
+	return data;
+}
+
+
+/*
+ * expand "$i", "${i}", and "${i%<n>}" (and "$j", "$k") in a line
+ */
+static Boolean
+expandLine(const char *line, char *buf, size_t bufLen, const long *iter, int depth)
+{
+	size_t	n	= 0;
+
+	while (*line != '\0') {
+		long	level	= -1;
+		long	mod	= 0;
+		long	val;
+		char	num[32];
+
+		if (line[0] == '$') {
+			const char	*v	= line + 1;
+			Boolean		braced	= FALSE;
+
+			if (*v == '{') {
+				braced = TRUE;
+				v++;
+			}
+			if ((*v == 'i') || (*v == 'j') || (*v == 'k')) {
+				level = *v - 'i';
+				v++;
+				if (braced) {
+					if (*v == '%') {
+						mod = strtol(v + 1, (char **)&v, 10);
+					}
+					if (*v != '}') {
+						level = -1;
+					} else {
+						v++;
+					}
+				}
+			}
+			if ((level >= 0) && (level < depth)) {
+				val = iter[depth - 1 - level];
+				if (mod > 0) {
+					val %= mod;
+				}
+				snprintf(num, sizeof(num), "%ld", val);
+				if ((n + strlen(num)) >= bufLen) {
+					return FALSE;
+				}
+				memcpy(&buf[n], num, strlen(num));
+				n += strlen(num);
+				line = v;
+				continue;
+			}
+		}
+
+		if ((n + 1) >= bufLen) {
+			return FALSE;
+		}
+		buf[n++] = *line++;
+	}
+	buf[n] = '\0';
+	return TRUE;
+}
+
+
+static int
+tokenize(char *buf, char **tokens)
+{
+	int	n	= 0;
+	char	*p	= buf;
+	char	*tok;
+
+	while ((n < MAX_TOKENS) && ((tok = strsep(&p, " \t\r\n")) != NULL)) {
+		if (*tok != '\0') {
+			tokens[n++] = tok;
+		}
+	}
+	return n;
+}
+
+
+static void
+runLine(const char *path, size_t lineNo, char **tokens, int nTokens)
+{
+	const char		*cmd		= tokens[0];
+	mach_port_t		id;
+	CFStringRef		key		= NULL;
+	serverSessionRef	mySession;
+	int			status;
+
+	if (nTokens < 2) {
+		goto syntax;
+	}
+
+	id = (mach_port_t)strtoul(tokens[1], NULL, 0);
+	if (id == MACH_PORT_NULL) {
+		goto syntax;
+	}
+
+	if (strcmp(cmd, "open") == 0) {
+		Boolean		useSessionKeys	= FALSE;
+
+		if (nTokens < 3) {
+			goto syntax;
+		}
+		if ((nTokens > 3) && (strcmp(tokens[3], "sessionkeys") == 0)) {
+			useSessionKeys = TRUE;
+		}
+		key = CFStringCreateWithCString(NULL, tokens[2], kCFStringEncodingUTF8);
+		status = doOpen(id, key, useSessionKeys);
+		CFRelease(key);
+		if (status != kSCStatusOK) {
+			fprintf(stderr, "%s:%zu: session %u already open\n", path, lineNo, id);
+			nSkipped++;
+		}
+		return;
+	}
+
+	if (strcmp(cmd, "close") == 0) {
+		if (doClose(id) != kSCStatusOK) {
+			fprintf(stderr, "%s:%zu: session %u not open\n", path, lineNo, id);
+			nSkipped++;
+		}
+		return;
+	}
+
+	mySession = lookupSession(id, FALSE);
+	if (mySession == NULL) {
+		fprintf(stderr, "%s:%zu: session %u not open\n", path, lineNo, id);
+		nSkipped++;
+		return;
+	}
+
+	if (strcmp(cmd, "changes") == 0) {
+		(void) doRequest(opChanges, mySession, NULL, NULL, FALSE);
+		return;
+	}
+
+	if (strcmp(cmd, "getm") == 0) {
+		int			i;
+		CFMutableArrayRef	keys;
+		CFMutableArrayRef	patterns;
+
+		keys     = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+		patterns = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+		for (i = 2; i < nTokens; i++) {
+			if (strncmp(tokens[i], "re:", 3) == 0) {
+				key = CFStringCreateWithCString(NULL, tokens[i] + 3, kCFStringEncodingUTF8);
+				CFArrayAppendValue(patterns, key);
+			} else {
+				key = CFStringCreateWithCString(NULL, tokens[i], kCFStringEncodingUTF8);
+				CFArrayAppendValue(keys, key);
+			}
+			CFRelease(key);
+		}
+		(void) doGetMultiple(mySession, keys, patterns);
+		CFRelease(keys);
+		CFRelease(patterns);
+		return;
+	}
+
+	if (nTokens < 3) {
+		goto syntax;
+	}
+	key = CFStringCreateWithCString(NULL, tokens[2], kCFStringEncodingUTF8);
+
+	if ((strcmp(cmd, "set") == 0) || (strcmp(cmd, "add") == 0)) {
+		CFDataRef	data;
+
+		if (nTokens < 4) {
+			goto syntax;
+		}
+		data = createSerializedValue(tokens[3]);
+		(void) doRequest((cmd[0] == 's') ? opSet : opAdd, mySession, key, data, FALSE);
+		CFRelease(data);
+	} else if (strcmp(cmd, "remove") == 0) {
+		(void) doRequest(opRemove, mySession, key, NULL, FALSE);
+	} else if (strcmp(cmd, "notify") == 0) {
+		(void) doRequest(opNotify, mySession, key, NULL, FALSE);
+	} else if (strcmp(cmd, "get") == 0) {
+		(void) doRequest(opGet, mySession, key, NULL, FALSE);
+	} else if ((strcmp(cmd, "list") == 0) || (strcmp(cmd, "listre") == 0)) {
+		(void) doRequest(opList, mySession, key, NULL, (cmd[4] != '\0'));
+	} else if ((strcmp(cmd, "watch") == 0) || (strcmp(cmd, "watchre") == 0)) {
+		(void) doRequest(opWatch, mySession, key, NULL, (cmd[5] != '\0'));
+	} else if ((strcmp(cmd, "unwatch") == 0) || (strcmp(cmd, "unwatchre") == 0)) {
+		(void) doRequest(opUnwatch, mySession, key, NULL, (cmd[7] != '\0'));
+	} else {
+		goto syntax;
+	}
+
+	CFRelease(key);
+	return;
+
+    syntax :
+
+	if (key != NULL) CFRelease(key);
+	fprintf(stderr, "%s:%zu: unrecognized request \"%s\"\n", path, lineNo, cmd);
+	nSkipped++;
+	return;
+}
+
+
+typedef struct {
+	char	*text;
+	size_t	lineNo;
+	size_t	match;		/* for "repeat" (and "end"), the index of the matching "end" (or "repeat") */
+	long	count;		/* for "repeat", the # of iterations */
+} traceLine;
+
+
+static void
+runLines(const char *path, traceLine *lines, size_t start, size_t end, long *iter, int depth)
+{
+	char	buf[LINE_MAX_LEN];
+	size_t	i;
+	char	*tokens[MAX_TOKENS];
+	int	nTokens;
+
+	for (i = start; i < end; i++) {
+		traceLine	*line	= &lines[i];
+
+		if (line->count >= 0) {
+			/* if "repeat" */
+			for (iter[depth] = 0; iter[depth] < line->count; iter[depth]++) {
+				runLines(path, lines, i + 1, line->match, iter, depth + 1);
+			}
+			i = line->match;	/* skip to "end" */
+			continue;
+		}
+
+		if (!expandLine(line->text, buf, sizeof(buf), iter, depth)) {
+			fprintf(stderr, "%s:%zu: line too long\n", path, line->lineNo);
+			nSkipped++;
+			continue;
+		}
+
+		nTokens = tokenize(buf, tokens);
+		if ((nTokens == 0) || (tokens[0][0] == '#')) {
+			continue;
+		}
+		runLine(path, line->lineNo, tokens, nTokens);
+	}
+
+	return;
+}
+
+
+static int
+replayText(const char *path, char *text)
+{
+	long		iter[MAX_DEPTH];
+	traceLine	*lines		= NULL;
+	size_t		maxLines	= 0;
+	size_t		n		= 0;
+	char		*p		= text;
+	size_t		stack[MAX_DEPTH];
+	int		depth		= 0;
+	char		*s;
+	size_t		lineNo		= 0;
+
+	/* split the trace into lines, matching "repeat" and "end" */
+	while ((s = strsep(&p, "\n")) != NULL) {
+		traceLine	*line;
+
+		lineNo++;
+		while ((*s == ' ') || (*s == '\t')) {
+			s++;
+		}
+		if ((*s == '\0') || (*s == '#')) {
+			continue;
+		}
+
+		if (n == maxLines) {
+			maxLines = (maxLines == 0) ? 256 : (maxLines * 2);
+			lines = reallocf(lines, maxLines * sizeof(traceLine));
+			if (lines == NULL) {
+				fprintf(stderr, "replay: out of memory\n");
+				return 1;
+			}
+		}
+		line = &lines[n];
+		line->text   = s;
+		line->lineNo = lineNo;
+		line->match  = 0;
+		line->count  = -1;
+
+		if (strncmp(s, "repeat", 6) == 0) {
+			if (depth == MAX_DEPTH) {
+				fprintf(stderr, "%s:%zu: \"repeat\" nested too deeply\n", path, lineNo);
+				free(lines);
+				return 1;
+			}
+			line->count = strtol(s + 6, NULL, 0);
+			if (line->count < 0) {
+				line->count = 0;
+			}
+			stack[depth++] = n;
+		} else if ((strncmp(s, "end", 3) == 0) && ((s[3] == '\0') || isspace((unsigned char)s[3]))) {
+			if (depth == 0) {
+				fprintf(stderr, "%s:%zu: \"end\" without \"repeat\"\n", path, lineNo);
+				free(lines);
+				return 1;
+			}
+			depth--;
+			lines[stack[depth]].match = n;
+			line->match = stack[depth];
+			line->text  = "";
+		}
+		n++;
+	}
+
+	if (depth > 0) {
+		fprintf(stderr, "%s: \"repeat\" without \"end\"\n", path);
+		free(lines);
+		return 1;
+	}
+
+	runLines(path, lines, 0, n, iter, 0);
+	free(lines);
+	return 0;
+}
+
+
+#pragma mark -
+#pragma mark Journals
+
+
+static int
+replayJournal(const char *path, const uint8_t *base, size_t size)
+{
+	const journalHeader	*header	= (const journalHeader *)base;
+	uint64_t		pos;
+
+	if ((size < sizeof(journalHeader)) ||
+	    (header->version != JOURNAL_VERSION) ||
+	    (header->headerSize < sizeof(journalHeader)) ||
+	    (header->ringSize == 0) ||
+	    ((header->ringSize % 8) != 0) ||
+	    ((uint64_t)header->headerSize + header->ringSize > size) ||
+	    (header->head < header->tail) ||
+	    ((header->head - header->tail) > header->ringSize)) {
+		fprintf(stderr, "%s: not a valid journal\n", path);
+		return 1;
+	}
+
+	for (pos = header->tail; pos < header->head; ) {
+		CFDataRef		data		= NULL;
+		uint64_t		offset		= pos % header->ringSize;
+		const journalRecord	*record;
+		CFStringRef		key		= NULL;
+		serverSessionRef	mySession;
+
+		record = (const journalRecord *)(base + header->headerSize + offset);
+		if ((offset + sizeof(journalRecord) > header->ringSize) ||
+		    (record->length < sizeof(journalRecord)) ||
+		    ((record->length % 8) != 0) ||
+		    (offset + record->length > header->ringSize) ||
+		    ((uint64_t)sizeof(journalRecord) + record->keyLen + record->dataLen > record->length)) {
+			fprintf(stderr, "%s: invalid record at position %llu\n", path, (unsigned long long)pos);
+			return 1;
+		}
+		pos += record->length;
+
+		switch (record->type) {
+			case kJournalPad :
+				continue;
+			case kJournalSetMultiple :
+				/* the individual keys are not recorded */
+				nSkipped++;
+				continue;
+			case kJournalSet :
+				if ((record->flags & kJournalFlagTruncated) != 0) {
+					/* the data was not recorded */
+					nSkipped++;
+					continue;
+				}
+				break;
+			default :
+				break;
+		}
+
+		if (record->keyLen > 0) {
+			key = CFStringCreateWithBytes(NULL,
+						      (const UInt8 *)(record + 1),
+						      record->keyLen,
+						      kCFStringEncodingUTF8,
+						      FALSE);
+		}
+
+		switch (record->type) {
+			case kJournalOpen :
+				if (key == NULL) {
+					key = CFStringCreateWithFormat(NULL, NULL, CFSTR("session-%u"), record->session);
+				}
+				if (getSession(record->session) != NULL) {
+					/* if the session id was reused (we missed the close) */
+					(void) doClose(record->session);
+				}
+				(void) doOpen(record->session, key, FALSE);
+				break;
+			case kJournalClose :
+				if (doClose(record->session) != kSCStatusOK) {
+					nSkipped++;
+				}
+				break;
+			case kJournalSet :
+			case kJournalRemove :
+			case kJournalNotify :
+				if (key == NULL) {
+					nSkipped++;
+					break;
+				}
+				mySession = lookupSession(record->session, TRUE);
+				if (record->type == kJournalSet) {
+					data = CFDataCreate(NULL,
+							    (const UInt8 *)(record + 1) + record->keyLen,
+							    record->dataLen);
+					(void) doRequest(opSet, mySession, key, data, FALSE);
+					CFRelease(data);
+				} else {
+					(void) doRequest((record->type == kJournalRemove) ? opRemove : opNotify,
+							 mySession, key, NULL, FALSE);
+				}
+				break;
+			default :
+				nSkipped++;
+				break;
+		}
+
+		if (key != NULL) CFRelease(key);
+	}
+
+	return 0;
+}
+
+
+#pragma mark -
+#pragma mark main
+
+
+static void
+usage(const char *command)
+{
+	fprintf(stderr, "usage: %s [-F] [-T KB] [-v] <trace>\n", command);
+	exit(2);
+}
+
+
+int
+main(int argc, char **argv)
+{
+	char		*base;
+	int		ch;
+	const char	*command	= argv[0];
+	int		fd;
+	ssize_t		n;
+	const char	*path;
+	int		ret;
+	struct stat	sb;
+	uint64_t	start;
+
+	while ((ch = getopt(argc, argv, "FT:v")) != -1) {
+		switch (ch) {
+			case 'F' :
+				fetchChanges = FALSE;
+				break;
+			case 'T' :
+				traceInit((size_t)atoi(optarg) * 1024, 0);
+				break;
+			case 'v' :
+				verbose = TRUE;
+				_sc_verbose = TRUE;
+				break;
+			default :
+				usage(command);
+		}
+	}
+	argc -= optind;
+	argv += optind;
+
+	if (argc != 1) {
+		usage(command);
+	}
+	path = argv[0];
+
+	fd = open(path, O_RDONLY);
+	if ((fd == -1) || (fstat(fd, &sb) == -1)) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	/* read the trace (text traces are split in place) */
+	base = malloc(sb.st_size + 1);
+	if (base == NULL) {
+		fprintf(stderr, "replay: out of memory\n");
+		return 1;
+	}
+	n = read(fd, base, sb.st_size);
+	(void) close(fd);
+	if (n != sb.st_size) {
+		fprintf(stderr, "%s: %s\n", path, (n == -1) ? strerror(errno) : "short read");
+		free(base);
+		return 1;
+	}
+	base[n] = '\0';
+
+	start = now_ns();
+	if ((n >= (ssize_t)sizeof(uint32_t)) && (*(uint32_t *)(void *)base == JOURNAL_MAGIC)) {
+		ret = replayJournal(path, (const uint8_t *)base, n);
+	} else {
+		ret = replayText(path, base);
+	}
+	replaySessionCloseAll();
+	pushChanges();
+	if (ret == 0) {
+		report(now_ns() - start);
+	}
+
+	free(base);
+	return ret;
+}
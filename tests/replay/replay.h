@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <sys/cdefs.h>
+#include <mach/mach.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+#include "session.h"
+
+__BEGIN_DECLS
+
+/*
+ * replay_transport.c : the "transport" for the configd store engine (see
+ * _SCD.h) used by the replay driver.  Sessions are identified by the ids
+ * recorded in the trace (in place of configd's mach ports) and there is
+ * no client to notify; instead, a notified session can (optionally) fetch
+ * its changed keys, just as an SCDynamicStore client would.
+ */
+
+serverSessionRef	replaySessionOpen		(mach_port_t		id,
+							 CFStringRef		name,
+							 Boolean		useSessionKeys);
+
+void			replaySessionClose		(mach_port_t		id);
+
+void			replaySessionCloseAll		(void);
+
+CFIndex			replaySessionCount		(void);
+
+CFIndex			replayPushNotifications		(Boolean		fetchChanges);
+
+__END_DECLS
+
+#endif	/* _REPLAY_H */
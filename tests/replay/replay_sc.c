@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * The SystemConfiguration framework routines (logging, serialization,
+ * and the SCDynamicStore object) referenced by the configd store engine,
+ * implemented on top of the CoreFoundation stand-in.
+ *
+ * Serialized data that, in configd, would be handed to (or received from)
+ * MiG as out-of-line memory is malloc()'d here and released with the
+ * vm_deallocate() stand-in.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "configd.h"
+#include "replay.h"
+
+
+int	_sc_verbose	= FALSE;
+int	_sc_log		= TRUE;
+
+
+#pragma mark -
+#pragma mark Logging
+
+
+static void
+__SCPrint(FILE *stream, CFStringRef formatString, va_list formatArguments)
+{
+	char		*buf;
+	CFIndex		bufLen;
+	CFStringRef	str;
+
+	str = CFStringCreateWithFormatAndArguments(NULL, NULL, formatString, formatArguments);
+	bufLen = CFStringGetMaximumSizeForEncoding(CFStringGetLength(str), kCFStringEncodingUTF8) + 1;
+	buf = malloc(bufLen);
+	if (CFStringGetCString(str, buf, bufLen, kCFStringEncodingUTF8)) {
+		fputs(buf, stream);
+	}
+	free(buf);
+	CFRelease(str);
+	return;
+}
+
+
+void
+SCLog(Boolean condition, int level, CFStringRef formatString, ...)
+{
+	va_list		formatArguments;
+
+	if (!condition) {
+		return;
+	}
+
+	if ((level > LOG_NOTICE) && !_sc_verbose) {
+		return;
+	}
+
+	va_start(formatArguments, formatString);
+	__SCPrint(stderr, formatString, formatArguments);
+	va_end(formatArguments);
+	fputc('\n', stderr);
+	return;
+}
+
+
+static int	sc_status	= kSCStatusOK;
+
+
+void
+_SCErrorSet(int error)
+{
+	sc_status = error;
+	return;
+}
+
+
+const char *
+SCErrorString(int status)
+{
+	switch (status) {
+		case kSCStatusOK :			return "Success!";
+		case kSCStatusFailed :			return "Failed!";
+		case kSCStatusInvalidArgument :		return "Invalid argument";
+		case kSCStatusAccessError :		return "Permission denied";
+		case kSCStatusNoKey :			return "No such key";
+		case kSCStatusKeyExists :		return "Key already defined";
+		case kSCStatusLocked :			return "Lock already held";
+		case kSCStatusNeedLock :		return "Lock required for this operation";
+		case kSCStatusNoStoreSession :		return "Configuration daemon session not active";
+		case kSCStatusNoStoreServer :		return "Configuration daemon not (no longer) available";
+		case kSCStatusNotifierActive :		return "Notifier is currently active";
+		case kSCStatusLimitExceeded :		return "Configuration daemon session limit exceeded";
+		default :				break;
+	}
+
+	return strerror(status);
+}
+
+
+#pragma mark -
+#pragma mark Serialization
+
+
+static Boolean
+copyOut(CFDataRef data, void **dataRef, CFIndex *dataLen)
+{
+	*dataLen = CFDataGetLength(data);
+	*dataRef = malloc((*dataLen > 0) ? *dataLen : 1);
+	if (*dataRef == NULL) {
+		*dataLen = 0;
+		return FALSE;
+	}
+	memcpy(*dataRef, CFDataGetBytePtr(data), *dataLen);
+	return TRUE;
+}
+
+
+Boolean
+_SCSerialize(CFPropertyListRef obj, CFDataRef *xml, void **dataRef, CFIndex *dataLen)
+{
+	Boolean		ok	= TRUE;
+	CFDataRef	myXml;
+
+	if ((xml == NULL) && ((dataRef == NULL) || (dataLen == NULL))) {
+		/* if not keeping track of allocated space */
+		return FALSE;
+	}
+
+	myXml = CFPropertyListCreateData(NULL,
+					 obj,
+					 kCFPropertyListBinaryFormat_v1_0,
+					 0,
+					 NULL);
+	if (myXml == NULL) {
+		SCLog(TRUE, LOG_ERR, CFSTR("_SCSerialize() failed"));
+		if (xml != NULL) {
+			*xml = NULL;
+		}
+		if ((dataRef != NULL) && (dataLen != NULL)) {
+			*dataLen = 0;
+			*dataRef = NULL;
+		}
+		return FALSE;
+	}
+
+	if (xml != NULL) {
+		*xml = myXml;
+		if ((dataRef != NULL) && (dataLen != NULL)) {
+			*dataRef = (void *)CFDataGetBytePtr(myXml);
+			*dataLen = CFDataGetLength(myXml);
+		}
+	} else {
+		ok = copyOut(myXml, dataRef, dataLen);
+		CFRelease(myXml);
+	}
+
+	return ok;
+}
+
+
+Boolean
+_SCUnserialize(CFPropertyListRef *obj, CFDataRef xml, void *dataRef, CFIndex dataLen)
+{
+	if (xml == NULL) {
+		xml = CFDataCreateWithBytesNoCopy(NULL, (void *)dataRef, dataLen, kCFAllocatorNull);
+		*obj = CFPropertyListCreateWithData(NULL, xml, kCFPropertyListImmutable, NULL, NULL);
+		CFRelease(xml);
+		(void) vm_deallocate(mach_task_self(), (vm_address_t)dataRef, dataLen);
+	} else {
+		*obj = CFPropertyListCreateWithData(NULL, xml, kCFPropertyListImmutable, NULL, NULL);
+	}
+
+	if (*obj == NULL) {
+		SCLog(TRUE, LOG_ERR, CFSTR("_SCUnserialize() failed"));
+		_SCErrorSet(kSCStatusFailed);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+Boolean
+_SCSerializeString(CFStringRef str, CFDataRef *data, void **dataRef, CFIndex *dataLen)
+{
+	Boolean		ok	= TRUE;
+	CFDataRef	myData;
+
+	if (!isA_CFString(str)) {
+		/* if not a CFString */
+		return FALSE;
+	}
+
+	if ((data == NULL) && ((dataRef == NULL) || (dataLen == NULL))) {
+		/* if not keeping track of allocated space */
+		return FALSE;
+	}
+
+	myData = CFStringCreateExternalRepresentation(NULL, str, kCFStringEncodingUTF8, 0);
+	if (myData == NULL) {
+		SCLog(TRUE, LOG_ERR, CFSTR("_SCSerializeString() failed"));
+		if (data != NULL) {
+			*data = NULL;
+		}
+		if ((dataRef != NULL) && (dataLen != NULL)) {
+			*dataRef = NULL;
+			*dataLen = 0;
+		}
+		return FALSE;
+	}
+
+	if (data != NULL) {
+		*data = myData;
+		if ((dataRef != NULL) && (dataLen != NULL)) {
+			*dataRef = (void *)CFDataGetBytePtr(myData);
+			*dataLen = CFDataGetLength(myData);
+		}
+	} else {
+		ok = copyOut(myData, dataRef, dataLen);
+		CFRelease(myData);
+	}
+
+	return ok;
+}
+
+
+Boolean
+_SCUnserializeString(CFStringRef *str, CFDataRef utf8, void *dataRef, CFIndex dataLen)
+{
+	if (utf8 == NULL) {
+		*str = CFStringCreateWithBytes(NULL, (const UInt8 *)dataRef, dataLen, kCFStringEncodingUTF8, FALSE);
+		(void) vm_deallocate(mach_task_self(), (vm_address_t)dataRef, dataLen);
+	} else {
+		*str = CFStringCreateFromExternalRepresentation(NULL, utf8, kCFStringEncodingUTF8);
+	}
+
+	if (*str == NULL) {
+		SCLog(TRUE, LOG_ERR, CFSTR("_SCUnserializeString() failed"));
+		_SCErrorSet(kSCStatusFailed);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+Boolean
+_SCSerializeData(CFDataRef data, void **dataRef, CFIndex *dataLen)
+{
+	if (!isA_CFData(data)) {
+		/* if not a CFData */
+		return FALSE;
+	}
+
+	return copyOut(data, dataRef, dataLen);
+}
+
+
+Boolean
+_SCUnserializeData(CFDataRef *data, void *dataRef, CFIndex dataLen)
+{
+	*data = CFDataCreate(NULL, dataRef, dataLen);
+	(void) vm_deallocate(mach_task_self(), (vm_address_t)dataRef, dataLen);
+	return TRUE;
+}
+
+
+char *
+_SC_cfstring_to_cstring(CFStringRef cfstr, char *buf, CFIndex bufLen, CFStringEncoding encoding)
+{
+	CFIndex	len;
+
+	if (cfstr == NULL) {
+		return NULL;
+	}
+
+	len = CFStringGetMaximumSizeForEncoding(CFStringGetLength(cfstr), encoding) + 1;
+	if (buf == NULL) {
+		bufLen = len;
+		buf = CFAllocatorAllocate(NULL, bufLen, 0);
+	}
+
+	if (!CFStringGetCString(cfstr, buf, bufLen, encoding)) {
+		if (bufLen != len) {
+			/* if caller provided the buffer */
+			buf[0] = '\0';
+		} else {
+			CFAllocatorDeallocate(NULL, buf);
+			buf = NULL;
+		}
+	}
+
+	return buf;
+}
+
+
+#pragma mark -
+#pragma mark SCDynamicStore
+
+
+static CFTypeID	__kSCDynamicStoreTypeID	= 0;	/* _kCFRuntimeNotATypeID */
+
+
+static void
+__SCDynamicStoreDeallocate(CFTypeRef cf)
+{
+	SCDynamicStorePrivateRef	storePrivate	= (SCDynamicStorePrivateRef)cf;
+
+	/* release any callback context info */
+	if (storePrivate->rlsContext.release != NULL) {
+		(*storePrivate->rlsContext.release)(storePrivate->rlsContext.info);
+	}
+
+	/* release any keys being watched */
+	if (storePrivate->keys != NULL)			CFRelease(storePrivate->keys);
+	if (storePrivate->patterns != NULL)		CFRelease(storePrivate->patterns);
+	if (storePrivate->watchedKeys != NULL)		CFRelease(storePrivate->watchedKeys);
+	if (storePrivate->watchedPatterns != NULL)	CFRelease(storePrivate->watchedPatterns);
+	if (storePrivate->sessionKeys != NULL)		CFRelease(storePrivate->sessionKeys);
+	if (storePrivate->keyProperties != NULL)	CFRelease(storePrivate->keyProperties);
+	if (storePrivate->patternProperties != NULL)	CFRelease(storePrivate->patternProperties);
+	if (storePrivate->notifyOptions != NULL)	CFRelease(storePrivate->notifyOptions);
+
+	/* release any values not yet delivered */
+	if (storePrivate->notifyValuesPending != NULL)	CFRelease(storePrivate->notifyValuesPending);
+	if (storePrivate->notifiedValues != NULL)	CFRelease(storePrivate->notifiedValues);
+
+	/* release any client info */
+	if (storePrivate->name != NULL)			CFRelease(storePrivate->name);
+	if (storePrivate->options != NULL)		CFRelease(storePrivate->options);
+
+	return;
+}
+
+
+static const CFRuntimeClass __SCDynamicStoreClass = {
+	0,				// version
+	"SCDynamicStore",		// className
+	NULL,				// init
+	NULL,				// copy
+	__SCDynamicStoreDeallocate,	// dealloc
+	NULL,				// equal
+	NULL,				// hash
+	NULL,				// copyFormattingDesc
+	NULL				// copyDebugDesc
+};
+
+
+SCDynamicStorePrivateRef
+__SCDynamicStoreCreatePrivate(CFAllocatorRef		allocator,
+			     const CFStringRef		name,
+			     SCDynamicStoreCallBack	callout,
+			     SCDynamicStoreContext	*context)
+{
+	uint32_t			size;
+	SCDynamicStorePrivateRef	storePrivate;
+
+	if (__kSCDynamicStoreTypeID == 0) {
+		__kSCDynamicStoreTypeID = _CFRuntimeRegisterClass(&__SCDynamicStoreClass);
+	}
+
+	/* allocate session (zero filled) */
+	size  = sizeof(SCDynamicStorePrivate) - sizeof(CFRuntimeBase);
+	storePrivate = (SCDynamicStorePrivateRef)_CFRuntimeCreateInstance(allocator,
+									  __kSCDynamicStoreTypeID,
+									  size,
+									  NULL);
+	if (storePrivate == NULL) {
+		_SCErrorSet(kSCStatusFailed);
+		return NULL;
+	}
+
+	storePrivate->name			= (name != NULL) ? CFRetain(name) : NULL;
+	storePrivate->server			= MACH_PORT_NULL;
+	storePrivate->notifyStatus		= NotifierNotRegistered;
+	storePrivate->rlsFunction		= callout;
+	if (context) {
+		bcopy(context, &storePrivate->rlsContext, sizeof(SCDynamicStoreContext));
+		if (context->retain != NULL) {
+			storePrivate->rlsContext.info = (void *)(*context->retain)(context->info);
+		}
+	}
+	storePrivate->notifyPort		= MACH_PORT_NULL;
+	storePrivate->notifyFile		= -1;
+	storePrivate->notifySignalTask		= TASK_NULL;
+
+	return storePrivate;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ * 
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ * 
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ * 
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * The replay "transport" : the session table, the session level helpers
+ * normally provided by the configd server (session.c, configd_server.c,
+ * checkpoint.c, _notifyviaring.c), and the mach routines referenced by
+ * the store engine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "configd.h"
+#include "configd_server.h"
+#include "admission.h"
+#include "checkpoint.h"
+#include "session.h"
+#include "replay.h"
+
+
+Boolean		_configd_verbose	= FALSE;
+
+
+/* session id --> serverSessionRef */
+static CFMutableDictionaryRef	sessions	= NULL;
+
+
+#pragma mark -
+#pragma mark Sessions
+
+
+__private_extern__
+serverSessionRef
+getSession(mach_port_t server)
+{
+	if ((server == MACH_PORT_NULL) || (sessions == NULL)) {
+		return NULL;
+	}
+
+	return (serverSessionRef)CFDictionaryGetValue(sessions, (const void *)(uintptr_t)server);
+}
+
+
+__private_extern__
+serverSessionRef
+tempSession(mach_port_t server, CFStringRef name, audit_token_t auditToken)
+{
+	/* all replayed requests are made with an open session */
+	return NULL;
+}
+
+
+__private_extern__
+serverSessionRef
+addSession(mach_port_t server, CFStringRef (*copyDescription)(const void *info))
+{
+	serverSessionRef	newSession;
+
+	if (sessions == NULL) {
+		sessions = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+	}
+
+	newSession = calloc(1, sizeof(serverSession));
+	newSession->key				= server;
+	newSession->callerEUID			= 0;
+	newSession->callerRootAccess		= YES;
+	newSession->callerWriteEntitlement	= NULL;
+
+	CFDictionarySetValue(sessions, (const void *)(uintptr_t)server, newSession);
+	return newSession;
+}
+
+
+__private_extern__
+void
+cleanupSession(mach_port_t server)
+{
+	CFStringRef		sessionKey;
+	serverSessionRef	thisSession;
+
+	thisSession = getSession(server);
+	if (thisSession == NULL) {
+		return;
+	}
+
+	/*
+	 * Close any open connections including cancelling any outstanding
+	 * notification requests and releasing any locks.
+	 */
+	(void) __SCDynamicStoreClose(&thisSession->store);
+
+	/*
+	 * release any pending (undelivered) changes
+	 */
+	if (thisSession->changedKeys != NULL) {
+		CFRelease(thisSession->changedKeys);
+		thisSession->changedKeys = NULL;
+	}
+
+	/*
+	 * We don't need any remaining information in the
+	 * sessionData dictionary, remove it.
+	 */
+	sessionKey = CFStringCreateWithFormat(NULL, NULL, CFSTR("%d"), server);
+	CFDictionaryRemoveValue(sessionData, sessionKey);
+	CFRelease(sessionKey);
+
+	/*
+	 * get rid of the per-session structure.
+	 */
+	CFDictionaryRemoveValue(sessions, (const void *)(uintptr_t)server);
+	free(thisSession);
+
+	return;
+}
+
+
+__private_extern__
+void
+setSessionSignalTask(SCDynamicStoreRef store, task_t task)
+{
+	return;
+}
+
+
+__private_extern__
+Boolean
+hasWriteAccess(serverSessionRef session, CFStringRef key)
+{
+	return TRUE;
+}
+
+
+__private_extern__
+int
+admissionCheckPatterns(serverSessionRef session, CFIndex nPatterns)
+{
+	/* replayed sessions have no budget */
+	return kSCStatusOK;
+}
+
+
+__private_extern__
+storeSnapshotRef
+serverReaderSnapshot(void)
+{
+	/* all requests are serviced by the "main" thread */
+	return NULL;
+}
+
+
+__private_extern__
+void
+checkpointNoteRead(void)
+{
+	return;
+}
+
+
+__private_extern__
+void
+__SCDynamicStoreNotifyRingRelease(SCDynamicStoreRef store)
+{
+	return;
+}
+
+
+#pragma mark -
+#pragma mark Replay
+
+
+serverSessionRef
+replaySessionOpen(mach_port_t id, CFStringRef name, Boolean useSessionKeys)
+{
+	serverSessionRef		mySession;
+	SCDynamicStorePrivateRef	storePrivate;
+
+	if ((id == MACH_PORT_NULL) || (getSession(id) != NULL)) {
+		/* if invalid (or already open) session id */
+		return NULL;
+	}
+
+	mySession = addSession(id, NULL);
+	(void) __SCDynamicStoreOpen(&mySession->store, name);
+	__SCDynamicStoreAttachSession(mySession->store, id, name);
+
+	storePrivate = (SCDynamicStorePrivateRef)mySession->store;
+	storePrivate->useSessionKeys = useSessionKeys;
+
+	return mySession;
+}
+
+
+void
+replaySessionClose(mach_port_t id)
+{
+	cleanupSession(id);
+	return;
+}
+
+
+void
+replaySessionCloseAll(void)
+{
+	CFIndex		i;
+	CFIndex		n;
+	const void	**ids;
+
+	n = replaySessionCount();
+	if (n == 0) {
+		return;
+	}
+
+	ids = malloc(n * sizeof(void *));
+	CFDictionaryGetKeysAndValues(sessions, ids, NULL);
+	for (i = 0; i < n; i++) {
+		cleanupSession((mach_port_t)(uintptr_t)ids[i]);
+	}
+	free(ids);
+
+	return;
+}
+
+
+CFIndex
+replaySessionCount(void)
+{
+	return (sessions != NULL) ? CFDictionaryGetCount(sessions) : 0;
+}
+
+
+CFIndex
+replayPushNotifications(Boolean fetchChanges)
+{
+	CFIndex			i;
+	CFIndex			n;
+	const void		**ids;
+	CFArrayRef		keys;
+	serverSessionRef	theSession;
+
+	if (needsNotification == NULL) {
+		/* if no sessions need to be kicked */
+		return 0;
+	}
+
+	n = CFSetGetCount(needsNotification);
+	ids = malloc(n * sizeof(void *));
+	CFSetGetValues(needsNotification, ids);
+	CFRelease(needsNotification);
+	needsNotification = NULL;
+
+	for (i = 0; i < n; i++) {
+		theSession = getSession((mach_port_t)(uintptr_t)ids[i]);
+		if (theSession == NULL) {
+			/* if the session is gone */
+			continue;
+		}
+
+		theSession->deliveryCount++;
+		if (fetchChanges &&
+		    (__SCDynamicStoreCopyNotifiedKeys(theSession->store, &keys) == kSCStatusOK)) {
+			CFRelease(keys);
+		}
+	}
+	free(ids);
+
+	return n;
+}
+
+
+#pragma mark -
+#pragma mark Mach
+
+
+mach_port_t
+mach_task_self(void)
+{
+	return 1;
+}
+
+
+kern_return_t
+mach_port_deallocate(ipc_space_t task, mach_port_name_t name)
+{
+	return KERN_SUCCESS;
+}
+
+
+kern_return_t
+mach_port_request_notification(ipc_space_t		task,
+			       mach_port_name_t		name,
+			       integer_t		msgid,
+			       mach_port_name_t		sync,
+			       mach_port_t		notify,
+			       mach_msg_type_name_t	notifyPoly,
+			       mach_port_t		*previous)
+{
+	*previous = MACH_PORT_NULL;
+	return KERN_SUCCESS;
+}
+
+
+kern_return_t
+vm_deallocate(vm_address_t task, vm_address_t address, vm_size_t size)
+{
+	/* "out-of-line" data is malloc()'d (see replay_sc.c) */
+	free((void *)address);
+	return KERN_SUCCESS;
+}
+
+
+const char *
+mach_error_string(kern_return_t error_value)
+{
+	return (error_value == KERN_SUCCESS) ? "success" : "(mach error)";
+}